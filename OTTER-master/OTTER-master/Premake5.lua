@@ -368,6 +368,13 @@ function AddProjects(groupName, folders)
 
 		    buildoptions { "/bigobj" }
 
+			-- Projects can add to these settings with their own premake5.lua (ex: to build against another project's source)
+			local projectScript = path.join(relpath, "premake5.lua")
+			if os.isfile(projectScript) then
+				premake.info("  Applying project settings from: " .. projectScript)
+				include(projectScript)
+			end
+
 			-- This filters for our windows builds
 			filter "system:windows"
 				systemversion "latest"
@@ -0,0 +1,29 @@
+-- The engine tests don't have a copy of the engine, they build against the source in Week6-Tutorial
+-- This is included from AddProjects in the root premake file, after the default project settings
+
+files {
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\**.h",
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\**.cpp",
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\**.c",
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\**.hpp",
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\**.inl",
+    -- The texture converter's encoders, so we can test them without running the tool
+    "%{wks.location}\\projects\\TextureConverter\\src\\**.h",
+    "%{wks.location}\\projects\\TextureConverter\\src\\**.cpp"
+}
+
+-- The tests have their own main
+removefiles {
+    "%{wks.location}\\projects\\Week6-Tutorial\\src\\entry_point.cpp",
+    "%{wks.location}\\projects\\TextureConverter\\src\\main.cpp"
+}
+
+includedirs {
+    "%{wks.location}\\projects\\Week6-Tutorial\\src",
+    "%{wks.location}\\projects\\TextureConverter\\src"
+}
+
+-- Some tests load the engine's assets (ex: shaders and scenes), so we copy them next to the executable as well
+postbuildcommands {
+    "(xcopy /Q /E /Y /I /C \"%{wks.location}projects\\Week6-Tutorial\\res\" \"%{absdir}\")"
+}
@@ -0,0 +1,46 @@
+#include "GlTestContext.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "TestFramework.h"
+
+GLFWwindow* GlTestContext::_window = nullptr;
+bool GlTestContext::_attempted = false;
+
+void GlTestContext::Require() {
+	// Only try once, so a machine without a GPU doesn't pay for failing in every test
+	if (!_attempted) {
+		_attempted = true;
+
+		if (glfwInit() == GLFW_TRUE) {
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+			_window = glfwCreateWindow(64, 64, "EngineTests", nullptr, nullptr);
+
+			if (_window != nullptr) {
+				glfwMakeContextCurrent(_window);
+				if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) == 0 || !GLAD_GL_VERSION_4_5) {
+					glfwDestroyWindow(_window);
+					_window = nullptr;
+				}
+			}
+		}
+	}
+
+	if (_window == nullptr) {
+		TestRegistry::Skip("no OpenGL 4.5 context available");
+	}
+}
+
+void GlTestContext::Shutdown() {
+	if (_window != nullptr) {
+		glfwDestroyWindow(_window);
+		_window = nullptr;
+	}
+	if (_attempted) {
+		glfwTerminate();
+	}
+	_attempted = false;
+}
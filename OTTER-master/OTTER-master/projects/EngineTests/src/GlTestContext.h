@@ -0,0 +1,24 @@
+#pragma once
+
+struct GLFWwindow;
+
+/// <summary>
+/// Creates a hidden window so that tests which need to touch the GPU have an OpenGL context.
+/// The window is created the first time a test asks for it, and is shared by every test after that
+/// </summary>
+class GlTestContext {
+public:
+	/// <summary>
+	/// Makes sure that an OpenGL 4.5 context is current, skipping the calling test if one can't be
+	/// created (ex: on a build machine without a GPU)
+	/// </summary>
+	static void Require();
+	/// <summary>
+	/// Destroys the window and context if they were created, called by main before exiting
+	/// </summary>
+	static void Shutdown();
+
+private:
+	static GLFWwindow* _window;
+	static bool        _attempted;
+};
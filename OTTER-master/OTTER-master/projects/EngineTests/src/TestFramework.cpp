@@ -0,0 +1,73 @@
+#include "TestFramework.h"
+
+int TestRegistry::_currentFailures = 0;
+
+std::vector<TestRegistry::Entry>& TestRegistry::_GetEntries() {
+	// Entries are registered during static initialization, so the list can't be a static member
+	static std::vector<Entry> entries;
+	return entries;
+}
+
+int TestRegistry::Register(const char* name, EntryType type, const std::function<void()>& func) {
+	_GetEntries().push_back(Entry{ name, type, func });
+	return static_cast<int>(_GetEntries().size());
+}
+
+int TestRegistry::RunAll(const std::string& filter, bool runBenchmarks) {
+	int passed = 0, failed = 0, skipped = 0;
+
+	for (const Entry& entry : _GetEntries()) {
+		if (entry.Type == EntryType::Benchmark && !runBenchmarks) {
+			continue;
+		}
+		if (!filter.empty() && entry.Name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		LOG_INFO("[ RUN  ] {}", entry.Name);
+		_currentFailures = 0;
+		Stopwatch timer;
+		try {
+			entry.Func();
+		}
+		catch (const FatalFailure&) {
+			// Already recorded in Fail
+		}
+		catch (const Skipped& skip) {
+			LOG_WARN("[ SKIP ] {} ({})", entry.Name, skip.Reason);
+			skipped++;
+			continue;
+		}
+		catch (const std::exception& e) {
+			LOG_WARN("Unhandled exception: {}", e.what());
+			_currentFailures++;
+		}
+
+		if (_currentFailures == 0) {
+			LOG_INFO("[  OK  ] {} ({:.1f} ms)", entry.Name, timer.ElapsedMs());
+			passed++;
+		} else {
+			LOG_WARN("[ FAIL ] {} ({} failed checks)", entry.Name, _currentFailures);
+			failed++;
+		}
+	}
+
+	LOG_INFO("{} passed, {} failed, {} skipped", passed, failed, skipped);
+	return failed;
+}
+
+void TestRegistry::Fail(const char* file, int line, const std::string& message, bool fatal) {
+	LOG_WARN("{}({}): check failed: {}", file, line, message);
+	_currentFailures++;
+	if (fatal) {
+		throw FatalFailure();
+	}
+}
+
+void TestRegistry::Skip(const std::string& reason) {
+	throw Skipped{ reason };
+}
+
+void TestRegistry::Report(const std::string& metric, double value, const char* unit) {
+	LOG_INFO("    {:<48} {:>12.3f} {}", metric, value, unit);
+}
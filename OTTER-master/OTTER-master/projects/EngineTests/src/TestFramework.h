@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Logging.h"
+
+/// <summary>
+/// A very small test and benchmark runner for checks that run against the engine code without
+/// a window. Tests and benchmarks register themselves at startup using the TEST_CASE and
+/// BENCHMARK macros, and are run by main with an optional name filter
+///
+/// Usage:
+///    TEST_CASE(JobSystem_ParallelForCoversRange) {
+///        REQUIRE(items.size() == 100);
+///        CHECK(items[0] == 1);
+///    }
+/// </summary>
+class TestRegistry {
+public:
+	enum class EntryType {
+		Test,
+		Benchmark
+	};
+
+	struct Entry {
+		std::string           Name;
+		EntryType             Type;
+		std::function<void()> Func;
+	};
+
+	/// <summary>
+	/// Adds a test or benchmark to the registry, used by the TEST_CASE and BENCHMARK macros
+	/// </summary>
+	/// <returns>The number of entries registered so far</returns>
+	static int Register(const char* name, EntryType type, const std::function<void()>& func);
+
+	/// <summary>
+	/// Runs every registered entry who's name contains the filter
+	/// </summary>
+	/// <param name="filter">A substring to match against entry names, or empty to run everything</param>
+	/// <param name="runBenchmarks">True to run benchmarks as well as tests</param>
+	/// <returns>The number of entries that failed</returns>
+	static int RunAll(const std::string& filter, bool runBenchmarks);
+
+	/// <summary>
+	/// Records a failed check in the current entry
+	/// </summary>
+	/// <param name="fatal">If true, the current entry is stopped</param>
+	static void Fail(const char* file, int line, const std::string& message, bool fatal);
+	/// <summary>
+	/// Stops the current entry and marks it as skipped, for entries that need something
+	/// that isn't available on this machine (ex: an OpenGL context)
+	/// </summary>
+	static void Skip(const std::string& reason);
+	/// <summary>
+	/// Logs a measurement from a benchmark
+	/// </summary>
+	static void Report(const std::string& metric, double value, const char* unit);
+
+private:
+	struct FatalFailure {};
+	struct Skipped { std::string Reason; };
+
+	static std::vector<Entry>& _GetEntries();
+	static int _currentFailures;
+};
+
+/// <summary>
+/// Measures the time between when it was started and when it is read
+/// </summary>
+class Stopwatch {
+public:
+	Stopwatch() : _start(std::chrono::high_resolution_clock::now()) { }
+
+	void Restart() { _start = std::chrono::high_resolution_clock::now(); }
+	double ElapsedMs() const {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _start).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point _start;
+};
+
+#define TEST_REGISTER_ENTRY(name, type) \
+	static void name(); \
+	static const int name##_registration = ::TestRegistry::Register(#name, type, name); \
+	static void name()
+
+// Defines a test, which is always run
+#define TEST_CASE(name) TEST_REGISTER_ENTRY(name, ::TestRegistry::EntryType::Test)
+// Defines a benchmark, which is only run when --bench is passed on the command line
+#define BENCHMARK(name) TEST_REGISTER_ENTRY(name, ::TestRegistry::EntryType::Benchmark)
+
+// Records a failure if x is false, and keeps running the test
+#define CHECK(x) { if (!(x)) { ::TestRegistry::Fail(__FILE__, __LINE__, #x, false); } }
+// Records a failure and stops the test if x is false
+#define REQUIRE(x) { if (!(x)) { ::TestRegistry::Fail(__FILE__, __LINE__, #x, true); } }
+// Records a failure if a and b are more than epsilon apart
+#define CHECK_NEAR(a, b, epsilon) { if (!(std::abs((a) - (b)) <= (epsilon))) { ::TestRegistry::Fail(__FILE__, __LINE__, #a " is not near " #b, false); } }
@@ -0,0 +1,215 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <functional>
+#include <typeindex>
+#include <unordered_map>
+
+#include "Gameplay/Components/ComponentManager.h"
+
+using namespace Gameplay;
+
+namespace {
+	/// <summary>
+	/// A minimal component that just counts how many times it's been visited
+	/// </summary>
+	class CounterComponent : public IComponent {
+	public:
+		typedef std::shared_ptr<CounterComponent> Sptr;
+
+		int Visits = 0;
+		float Value = 1.0f;
+
+		virtual void RenderImGui() override {}
+		virtual nlohmann::json ToJson() const override { return nlohmann::json(); }
+		static CounterComponent::Sptr FromJson(const nlohmann::json&) { return std::make_shared<CounterComponent>(); }
+		MAKE_TYPENAME(CounterComponent);
+	};
+
+	/// <summary>
+	/// How ComponentManager stored and iterated components before the pools, kept here so the
+	/// benchmark can compare against it
+	/// </summary>
+	class LegacyComponentStore {
+	public:
+		void Add(const IComponent::Sptr& component) {
+			_components[std::type_index(typeid(*component))].push_back(component);
+		}
+
+		template <typename ComponentType>
+		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
+			for (auto& wptr : _components[std::type_index(typeid(ComponentType))]) {
+				std::shared_ptr<IComponent> sptr = wptr.lock();
+				if (sptr && (sptr->IsEnabled || includeDisabled)) {
+					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+				}
+			}
+		}
+
+	private:
+		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _components;
+	};
+
+	std::vector<CounterComponent::Sptr> CreateCounters(ComponentManager& manager, size_t count) {
+		ComponentManager::RegisterType<CounterComponent>();
+		std::vector<CounterComponent::Sptr> result;
+		result.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			result.push_back(manager.Create<CounterComponent>());
+		}
+		return result;
+	}
+
+	size_t CountVisited(ComponentManager& manager, bool includeDisabled = false) {
+		size_t result = 0;
+		manager.Each<CounterComponent>([&](CounterComponent*) { result++; }, includeDisabled);
+		return result;
+	}
+}
+
+TEST_CASE(ComponentPool_EachVisitsEveryComponentOnce) {
+	ComponentManager manager;
+	std::vector<CounterComponent::Sptr> components = CreateCounters(manager, 1000);
+	for (size_t ix = 0; ix < components.size(); ix += 4) {
+		components[ix]->IsEnabled = false;
+	}
+
+	manager.Each<CounterComponent>([](CounterComponent* component) { component->Visits++; });
+	size_t wrongVisits = 0;
+	for (const auto& component : components) {
+		wrongVisits += component->Visits != (component->IsEnabled ? 1 : 0) ? 1 : 0;
+	}
+	CHECK(wrongVisits == 0);
+	CHECK(CountVisited(manager) == 750);
+	CHECK(CountVisited(manager, true) == 1000);
+}
+
+TEST_CASE(ComponentPool_DestroyedComponentsLeaveThePool) {
+	ComponentManager manager;
+	std::vector<CounterComponent::Sptr> components = CreateCounters(manager, 100);
+	Guid lastId = components.back()->GetGUID();
+	Guid firstId = components.front()->GetGUID();
+
+	// Removing from the front swaps the last component into it's slot, which must still be found
+	components.erase(components.begin());
+	CHECK(CountVisited(manager) == 99);
+	CHECK(manager.GetComponentByGUID<CounterComponent>(firstId) == nullptr);
+	CHECK(manager.GetComponentByGUID<CounterComponent>(lastId) == components.back());
+
+	components.erase(components.begin() + 10, components.begin() + 60);
+	CHECK(CountVisited(manager) == 49);
+
+	components.clear();
+	CHECK(CountVisited(manager, true) == 0);
+}
+
+TEST_CASE(ComponentPool_RemovingDuringEachSkipsNothing) {
+	ComponentManager manager;
+	std::vector<CounterComponent::Sptr> components = CreateCounters(manager, 200);
+	std::vector<CounterComponent*> raw;
+	for (const auto& component : components) {
+		raw.push_back(component.get());
+	}
+
+	// Each visit destroys one component we've already passed and one we haven't reached yet. A
+	// swap-remove here would move an unvisited component behind the iterator, or visit one twice
+	size_t visited = 0;
+	std::vector<bool> destroyed(components.size(), false);
+	manager.Each<CounterComponent>([&](CounterComponent* component) {
+		component->Visits++;
+		visited++;
+		size_t index = std::find(raw.begin(), raw.end(), component) - raw.begin();
+		REQUIRE(!destroyed[index]);
+		if (index % 4 == 1) {
+			destroyed[index - 1] = true;
+			components[index - 1].reset();
+		}
+		if (index % 4 == 2 && index + 1 < components.size()) {
+			destroyed[index + 1] = true;
+			components[index + 1].reset();
+		}
+	});
+
+	size_t twice = 0, missed = 0;
+	for (size_t ix = 0; ix < components.size(); ix++) {
+		if (components[ix] != nullptr) {
+			twice += components[ix]->Visits > 1 ? 1 : 0;
+			missed += components[ix]->Visits == 0 ? 1 : 0;
+		}
+	}
+	CHECK(twice == 0);
+	CHECK(missed == 0);
+	CHECK(visited == 150);
+
+	// Once the iteration is over the holes should be gone, and removal should work normally again
+	CHECK(CountVisited(manager, true) == 100);
+	components.erase(std::remove(components.begin(), components.end(), nullptr), components.end());
+	components.erase(components.begin());
+	CHECK(CountVisited(manager, true) == 99);
+}
+
+TEST_CASE(ComponentPool_AddingDuringEachIsSafe) {
+	ComponentManager manager;
+	std::vector<CounterComponent::Sptr> components = CreateCounters(manager, 10);
+
+	// Growing the pool from inside the callback must not invalidate the iteration, and components
+	// added during the pass are only picked up by the next one
+	size_t visited = 0;
+	manager.Each<CounterComponent>([&](CounterComponent*) {
+		visited++;
+		components.push_back(manager.Create<CounterComponent>());
+	});
+	CHECK(visited == 10);
+	CHECK(components.size() == 20);
+	CHECK(CountVisited(manager) == 20);
+}
+
+TEST_CASE(ComponentPool_ComponentsCanOutliveTheManager) {
+	std::vector<CounterComponent::Sptr> components;
+	{
+		ComponentManager manager;
+		components = CreateCounters(manager, 10);
+	}
+	// The manager flushed it's pools, so these must not try to remove themselves from it
+	components.clear();
+	CHECK(components.empty());
+}
+
+BENCHMARK(ComponentPool_EachVsLegacy) {
+	const size_t count = 100000;
+	const int iterations = 100;
+
+	ComponentManager manager;
+	LegacyComponentStore legacy;
+	std::vector<CounterComponent::Sptr> components = CreateCounters(manager, count);
+	// Disable some of the components, so both paths have to check IsEnabled
+	for (size_t ix = 0; ix < count; ix += 3) {
+		components[ix]->IsEnabled = (ix % 9) != 0;
+	}
+	for (const auto& component : components) {
+		legacy.Add(component);
+	}
+
+	float legacySum = 0.0f;
+	Stopwatch timer;
+	for (int ix = 0; ix < iterations; ix++) {
+		legacy.Each<CounterComponent>([&](const CounterComponent::Sptr& component) {
+			legacySum += component->Value;
+		});
+	}
+	double legacyMs = timer.ElapsedMs() / iterations;
+
+	float poolSum = 0.0f;
+	timer.Restart();
+	for (int ix = 0; ix < iterations; ix++) {
+		manager.Each<CounterComponent>([&](CounterComponent* component) {
+			poolSum += component->Value;
+		});
+	}
+	double poolMs = timer.ElapsedMs() / iterations;
+
+	CHECK(legacySum == poolSum);
+	TestRegistry::Report("weak_ptr + dynamic_pointer_cast Each, 100k components", legacyMs, "ms");
+	TestRegistry::Report("Component pool Each, 100k components", poolMs, "ms");
+	TestRegistry::Report("Speedup", legacyMs / poolMs, "x");
+}
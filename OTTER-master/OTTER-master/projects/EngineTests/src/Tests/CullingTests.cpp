@@ -0,0 +1,185 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Utils/Frustum.h"
+#include "Gameplay/CullingTree.h"
+
+using namespace Gameplay;
+
+namespace {
+	struct TestBox {
+		glm::vec3 Min;
+		glm::vec3 Max;
+	};
+
+	// A camera at the origin looking down -Z, with a 60 degree vertical FOV and a far plane at 100
+	Frustum MakeTestFrustum() {
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		Frustum result;
+		result.Extract(projection * view);
+		return result;
+	}
+
+	TestBox BoxAt(const glm::vec3& center, float halfSize) {
+		return { center - glm::vec3(halfSize), center + glm::vec3(halfSize) };
+	}
+
+	std::vector<TestBox> MakeRandomBoxes(size_t count, uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+		std::uniform_real_distribution<float> size(0.1f, 3.0f);
+
+		std::vector<TestBox> result;
+		result.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			result.push_back(BoxAt(glm::vec3(position(random), position(random), position(random)), size(random)));
+		}
+		return result;
+	}
+
+	std::set<size_t> QueryTree(const CullingTree& tree, const Frustum& frustum) {
+		std::set<size_t> result;
+		tree.Query(frustum, [&](void* data) {
+			result.insert(reinterpret_cast<size_t>(data));
+		});
+		return result;
+	}
+}
+
+TEST_CASE(Culling_FrustumKnownLayout) {
+	Frustum frustum = MakeTestFrustum();
+
+	// In front of the camera
+	TestBox inFront = BoxAt(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f);
+	CHECK(frustum.IntersectsAABB(inFront.Min, inFront.Max));
+	CHECK(frustum.ContainsPoint(glm::vec3(0.0f, 0.0f, -50.0f)));
+	// Behind the camera
+	TestBox behind = BoxAt(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f);
+	CHECK(!frustum.IntersectsAABB(behind.Min, behind.Max));
+	// Past the far plane
+	TestBox farAway = BoxAt(glm::vec3(0.0f, 0.0f, -150.0f), 1.0f);
+	CHECK(!frustum.IntersectsAABB(farAway.Min, farAway.Max));
+	// Outside the left and top of the view, tan(30) * 10 is about 5.8 units at this depth
+	TestBox left = BoxAt(glm::vec3(-20.0f, 0.0f, -10.0f), 1.0f);
+	CHECK(!frustum.IntersectsAABB(left.Min, left.Max));
+	TestBox above = BoxAt(glm::vec3(0.0f, 20.0f, -10.0f), 1.0f);
+	CHECK(!frustum.IntersectsAABB(above.Min, above.Max));
+	// Straddling the right edge of the view is still visible
+	TestBox straddling = BoxAt(glm::vec3(6.0f, 0.0f, -10.0f), 1.0f);
+	CHECK(frustum.IntersectsAABB(straddling.Min, straddling.Max));
+	// A huge box around the camera is visible
+	CHECK(frustum.IntersectsAABB(glm::vec3(-500.0f), glm::vec3(500.0f)));
+
+	// Planes point inwards, so the centre of the view should be on the inside of all of them
+	for (int ix = 0; ix < Frustum::Plane::Count; ix++) {
+		CHECK(glm::dot(glm::vec3(frustum.Planes[ix]), glm::vec3(0.0f, 0.0f, -10.0f)) + frustum.Planes[ix].w > 0.0f);
+	}
+}
+
+TEST_CASE(Culling_TreeMatchesBruteForce) {
+	Frustum frustum = MakeTestFrustum();
+	std::vector<TestBox> boxes = MakeRandomBoxes(10000, 99);
+
+	// With no margin, the tree should report exactly what testing every box would
+	CullingTree tree(0.0f);
+	for (size_t ix = 0; ix < boxes.size(); ix++) {
+		tree.Insert(boxes[ix].Min, boxes[ix].Max, reinterpret_cast<void*>(ix));
+	}
+	CHECK(tree.GetLeafCount() == (int)boxes.size());
+
+	std::set<size_t> expected;
+	for (size_t ix = 0; ix < boxes.size(); ix++) {
+		if (frustum.IntersectsAABB(boxes[ix].Min, boxes[ix].Max)) {
+			expected.insert(ix);
+		}
+	}
+	REQUIRE(!expected.empty());
+	REQUIRE(expected.size() < boxes.size());
+
+	std::set<size_t> visible = QueryTree(tree, frustum);
+	CHECK(visible == expected);
+}
+
+TEST_CASE(Culling_TreeMarginIsConservative) {
+	const float margin = 0.5f;
+	Frustum frustum = MakeTestFrustum();
+	std::vector<TestBox> boxes = MakeRandomBoxes(5000, 1234);
+
+	CullingTree tree(margin);
+	for (size_t ix = 0; ix < boxes.size(); ix++) {
+		tree.Insert(boxes[ix].Min, boxes[ix].Max, reinterpret_cast<void*>(ix));
+	}
+
+	// Fattened leaves can let in a few extra objects, but must never drop a visible one
+	std::set<size_t> visible = QueryTree(tree, frustum);
+	size_t missing = 0, unexpected = 0;
+	for (size_t ix = 0; ix < boxes.size(); ix++) {
+		bool exact = frustum.IntersectsAABB(boxes[ix].Min, boxes[ix].Max);
+		bool fat = frustum.IntersectsAABB(boxes[ix].Min - glm::vec3(margin), boxes[ix].Max + glm::vec3(margin));
+		bool reported = visible.count(ix) > 0;
+		missing += (exact && !reported) ? 1 : 0;
+		unexpected += (reported && !fat) ? 1 : 0;
+	}
+	CHECK(missing == 0);
+	CHECK(unexpected == 0);
+}
+
+TEST_CASE(Culling_TreeUpdateAndRemove) {
+	Frustum frustum = MakeTestFrustum();
+	CullingTree tree(0.1f);
+
+	TestBox inView = BoxAt(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f);
+	CullingTree::Handle handle = tree.Insert(inView.Min, inView.Max, reinterpret_cast<void*>(1));
+	CHECK(QueryTree(tree, frustum).count(1) == 1);
+
+	// A tiny move stays inside the fat bounds, so the tree doesn't need to change
+	CHECK(!tree.Update(handle, inView.Min + glm::vec3(0.05f), inView.Max + glm::vec3(0.05f)));
+
+	// Moving behind the camera should cull it
+	TestBox behind = BoxAt(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f);
+	CHECK(tree.Update(handle, behind.Min, behind.Max));
+	CHECK(QueryTree(tree, frustum).empty());
+
+	tree.Remove(handle);
+	CHECK(tree.GetLeafCount() == 0);
+}
+
+BENCHMARK(Culling_TreeVsBruteForce) {
+	Frustum frustum = MakeTestFrustum();
+	std::vector<TestBox> boxes = MakeRandomBoxes(100000, 5);
+	CullingTree tree;
+	for (size_t ix = 0; ix < boxes.size(); ix++) {
+		tree.Insert(boxes[ix].Min, boxes[ix].Max, reinterpret_cast<void*>(ix));
+	}
+
+	const int iterations = 50;
+	size_t bruteVisible = 0, treeVisible = 0;
+
+	Stopwatch timer;
+	for (int ix = 0; ix < iterations; ix++) {
+		bruteVisible = 0;
+		for (const TestBox& box : boxes) {
+			bruteVisible += frustum.IntersectsAABB(box.Min, box.Max) ? 1 : 0;
+		}
+	}
+	double bruteMs = timer.ElapsedMs() / iterations;
+
+	timer.Restart();
+	for (int ix = 0; ix < iterations; ix++) {
+		treeVisible = 0;
+		tree.Query(frustum, [&](void*) { treeVisible++; });
+	}
+	double treeMs = timer.ElapsedMs() / iterations;
+
+	TestRegistry::Report("Brute force, 100k boxes", bruteMs, "ms");
+	TestRegistry::Report("Culling tree, 100k boxes", treeMs, "ms");
+	TestRegistry::Report("Visible (brute force)", (double)bruteVisible, "objects");
+	TestRegistry::Report("Visible (tree)", (double)treeVisible, "objects");
+}
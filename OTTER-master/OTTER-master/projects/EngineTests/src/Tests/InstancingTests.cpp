@@ -0,0 +1,120 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <algorithm>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Buffers/PersistentRingBuffer.h"
+
+namespace {
+	// The same layout RenderLayer writes for each instance
+	struct InstanceData {
+		glm::mat4 Model;
+		glm::mat4 Normal;
+	};
+}
+
+TEST_CASE(Instancing_RingAllocationsStayInSegment) {
+	GlTestContext::Require();
+
+	const uint32_t segmentSize = 4096;
+	PersistentRingBuffer::Sptr ring = PersistentRingBuffer::Create(BufferType::ShaderStorage, segmentSize);
+	const uint32_t alignment = ring->GetAlignment();
+	REQUIRE(ring->GetSegmentSize() % alignment == 0);
+
+	// Go around the ring a couple times, every allocation should land aligned inside the frame's segment
+	for (uint32_t frame = 0; frame < 7; frame++) {
+		uint32_t segment = frame % 3;
+		ring->BeginFrame(segmentSize);
+		for (int ix = 0; ix < 4; ix++) {
+			uint32_t offset = 0;
+			InstanceData* data = ring->Allocate<InstanceData>(3, offset);
+			REQUIRE(data != nullptr);
+			CHECK(offset % alignment == 0);
+			CHECK(offset >= segment * ring->GetSegmentSize());
+			CHECK(offset + 3 * sizeof(InstanceData) <= (segment + 1) * ring->GetSegmentSize());
+		}
+		ring->EndFrame();
+	}
+}
+
+TEST_CASE(Instancing_RingRejectsOverflowAndGrows) {
+	GlTestContext::Require();
+
+	PersistentRingBuffer::Sptr ring = PersistentRingBuffer::Create(BufferType::ShaderStorage, 1024);
+	uint32_t offset = 0;
+
+	ring->BeginFrame(1024);
+	CHECK(ring->Allocate(ring->GetSegmentSize(), offset) != nullptr);
+	// The segment is full, so anything else has to fail instead of writing into the next segment
+	CHECK(ring->Allocate(1, offset) == nullptr);
+	ring->EndFrame();
+
+	// Asking for more than a segment holds re-creates the buffer with bigger segments
+	ring->BeginFrame(10000);
+	CHECK(ring->GetSegmentSize() >= 10000);
+	CHECK(ring->Allocate(10000, offset) != nullptr);
+	ring->EndFrame();
+}
+
+TEST_CASE(Instancing_RingWritesReachTheGpu) {
+	GlTestContext::Require();
+
+	PersistentRingBuffer::Sptr ring = PersistentRingBuffer::Create(BufferType::ShaderStorage, 64 * sizeof(InstanceData));
+	for (uint32_t frame = 0; frame < 4; frame++) {
+		ring->BeginFrame(64 * sizeof(InstanceData));
+		uint32_t offset = 0;
+		InstanceData* data = ring->Allocate<InstanceData>(64, offset);
+		REQUIRE(data != nullptr);
+		for (int ix = 0; ix < 64; ix++) {
+			data[ix].Model  = glm::mat4(static_cast<float>(frame * 64 + ix));
+			data[ix].Normal = glm::mat4(1.0f);
+		}
+
+		// The buffer is coherent, so once the GPU is idle it should see exactly what we wrote
+		glFinish();
+		std::vector<InstanceData> readBack(64);
+		glGetNamedBufferSubData(ring->GetHandle(), offset, 64 * sizeof(InstanceData), readBack.data());
+		size_t mismatches = 0;
+		for (int ix = 0; ix < 64; ix++) {
+			mismatches += readBack[ix].Model != data[ix].Model ? 1 : 0;
+		}
+		CHECK(mismatches == 0);
+
+		ring->EndFrame();
+	}
+}
+
+BENCHMARK(Instancing_RingUploadThroughput) {
+	GlTestContext::Require();
+
+	// Matches InstancedRenderingTestLayer, 10x10x10 objects sharing a mesh and material
+	const uint32_t instanceCount = 1000;
+	const int frames = 300;
+	const uint32_t frameBytes = instanceCount * sizeof(InstanceData);
+	PersistentRingBuffer::Sptr ring = PersistentRingBuffer::Create(BufferType::ShaderStorage, frameBytes);
+
+	double worstMs = 0.0;
+	Stopwatch total;
+	for (int frame = 0; frame < frames; frame++) {
+		Stopwatch timer;
+		ring->BeginFrame(frameBytes);
+		uint32_t offset = 0;
+		InstanceData* data = ring->Allocate<InstanceData>(instanceCount, offset);
+		for (uint32_t ix = 0; ix < instanceCount; ix++) {
+			data[ix].Model  = glm::mat4(static_cast<float>(ix));
+			data[ix].Normal = glm::mat4(1.0f);
+		}
+		ring->BindRange(3, offset, frameBytes);
+		ring->EndFrame();
+		// Flush like a buffer swap would, so the fences actually make it to the GPU
+		glFlush();
+		worstMs = std::max(worstMs, timer.ElapsedMs());
+	}
+	double totalMs = total.ElapsedMs();
+
+	TestRegistry::Report("Average frame (1000 instances)", totalMs / frames, "ms");
+	TestRegistry::Report("Worst frame (1000 instances)", worstMs, "ms");
+	TestRegistry::Report("Instance data throughput", (double)frameBytes * frames / (1024.0 * 1024.0) / (totalMs / 1000.0), "MB/s");
+}
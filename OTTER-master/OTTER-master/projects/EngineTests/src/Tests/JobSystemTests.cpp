@@ -0,0 +1,164 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "Utils/JobSystem.h"
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/ComponentManager.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+
+using namespace Gameplay;
+
+namespace {
+	// At least 2 workers, so that stealing gets exercised even on single core machines
+	int GetTestWorkerCount() {
+		return std::max(2, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+
+	// Runs a ParallelFor over count items, and checks that every index was visited exactly once
+	void CheckCoverage(size_t count, size_t chunkSize) {
+		std::vector<std::atomic<int>> visits(count);
+		for (auto& visit : visits) {
+			visit = 0;
+		}
+
+		JobSystem::ParallelFor(count, chunkSize, [&](size_t begin, size_t end) {
+			CHECK(begin < end);
+			CHECK(end <= count);
+			for (size_t ix = begin; ix < end; ix++) {
+				visits[ix]++;
+			}
+		});
+
+		size_t badIndices = 0;
+		for (auto& visit : visits) {
+			badIndices += visit != 1 ? 1 : 0;
+		}
+		CHECK(badIndices == 0);
+	}
+
+	// Creates a scene with count objects that each have a RotatingBehaviour with a different speed
+	Scene::Sptr CreateRotatingScene(size_t count, std::vector<GameObject::Sptr>& objects) {
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RotatingBehaviour>();
+
+		Scene::Sptr scene = std::make_shared<Scene>();
+		scene->IsPlaying = true;
+		objects.clear();
+		objects.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			GameObject::Sptr object = scene->CreateGameObject("Rotator");
+			RotatingBehaviour::Sptr behaviour = object->Add<RotatingBehaviour>();
+			behaviour->RotationSpeed = glm::vec3(ix % 7, ix % 13, ix % 29) * 10.0f;
+			objects.push_back(object);
+		}
+		return scene;
+	}
+
+	// Runs a few frames of updates on a rotating scene and returns the final rotations
+	std::vector<glm::quat> RunRotatingScene(size_t count, int frames) {
+		std::vector<GameObject::Sptr> objects;
+		Scene::Sptr scene = CreateRotatingScene(count, objects);
+		for (int frame = 0; frame < frames; frame++) {
+			scene->Update(1.0f / 60.0f);
+		}
+
+		std::vector<glm::quat> result;
+		result.reserve(count);
+		for (const auto& object : objects) {
+			result.push_back(object->GetRotation());
+		}
+		return result;
+	}
+}
+
+TEST_CASE(JobSystem_ParallelForCoversRangeInline) {
+	REQUIRE(!JobSystem::IsInitialized());
+	CheckCoverage(0, 64);
+	CheckCoverage(1, 64);
+	CheckCoverage(1000, 64);
+	CheckCoverage(1000, 1000);
+}
+
+TEST_CASE(JobSystem_ParallelForCoversRangeWithWorkers) {
+	for (int workers : { 1, GetTestWorkerCount() }) {
+		JobSystem::Init(workers);
+		CheckCoverage(1, 64);
+		CheckCoverage(63, 64);
+		CheckCoverage(65, 64);
+		CheckCoverage(100000, 1);
+		CheckCoverage(100000, 256);
+		CheckCoverage(100003, 7);
+		// A chunk size of 0 is treated as 1
+		CheckCoverage(500, 0);
+		JobSystem::Shutdown();
+	}
+}
+
+TEST_CASE(JobSystem_NestedParallelFor) {
+	JobSystem::Init(GetTestWorkerCount());
+	// Jobs that submit their own work have to help with it rather than deadlocking the pool
+	std::atomic<size_t> total(0);
+	JobSystem::ParallelFor(64, 1, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			JobSystem::ParallelFor(256, 16, [&](size_t innerBegin, size_t innerEnd) {
+				total += innerEnd - innerBegin;
+			});
+		}
+	});
+	JobSystem::Shutdown();
+	CHECK(total == 64 * 256);
+}
+
+TEST_CASE(JobSystem_RotatingBehaviourMatchesSerial) {
+	const size_t count = 100000;
+	const int frames = 10;
+
+	REQUIRE(!JobSystem::IsInitialized());
+	std::vector<glm::quat> serial = RunRotatingScene(count, frames);
+
+	JobSystem::Init(GetTestWorkerCount());
+	std::vector<glm::quat> parallel = RunRotatingScene(count, frames);
+	JobSystem::Shutdown();
+
+	REQUIRE(serial.size() == parallel.size());
+	// Each object only touches itself, so the result should be bit for bit the same
+	size_t mismatches = 0;
+	for (size_t ix = 0; ix < count; ix++) {
+		mismatches += serial[ix] != parallel[ix] ? 1 : 0;
+	}
+	CHECK(mismatches == 0);
+}
+
+BENCHMARK(JobSystem_RotatingBehaviourScaling) {
+	const size_t count = 100000;
+	const int frames = 60;
+	const int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	std::vector<GameObject::Sptr> objects;
+	Scene::Sptr scene = CreateRotatingScene(count, objects);
+
+	double baseline = 0.0;
+	// 1 thread is the inline path, N threads is N - 1 workers plus the calling thread
+	for (int threads = 1; threads <= maxThreads; threads++) {
+		if (threads > 1) {
+			JobSystem::Init(threads - 1);
+		}
+
+		Stopwatch timer;
+		for (int frame = 0; frame < frames; frame++) {
+			scene->Update(1.0f / 60.0f);
+		}
+		double frameMs = timer.ElapsedMs() / frames;
+		baseline = threads == 1 ? frameMs : baseline;
+
+		TestRegistry::Report(std::to_string(threads) + " threads, ms per update", frameMs, "ms");
+		TestRegistry::Report(std::to_string(threads) + " threads, speedup", baseline / frameMs, "x");
+
+		if (JobSystem::IsInitialized()) {
+			JobSystem::Shutdown();
+		}
+	}
+}
@@ -0,0 +1,169 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <random>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Graphics/LightClusterGrid.h"
+
+namespace {
+	const float TestNear   = 0.1f;
+	const float TestFar    = 100.0f;
+	const float TestFov    = glm::radians(60.0f);
+	const float TestAspect = 16.0f / 9.0f;
+
+	glm::mat4 MakeTestProjection() {
+		return glm::perspective(TestFov, TestAspect, TestNear, TestFar);
+	}
+
+	std::vector<LightClusterGrid::LightBounds> MakeRandomLights(size_t count, uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> side(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> depth(-110.0f, 5.0f);
+		std::uniform_real_distribution<float> radius(0.5f, 15.0f);
+
+		std::vector<LightClusterGrid::LightBounds> result(count);
+		for (auto& light : result) {
+			light.ViewPosition = glm::vec3(side(random), side(random) * 0.6f, depth(random));
+			light.Radius = radius(random);
+		}
+		return result;
+	}
+
+	// Finds the cluster a view space point lands in, the same way light_accumulation.glsl does
+	uint32_t FindCluster(const LightClusterGrid& grid, const glm::mat4& projection, const glm::vec3& viewPos) {
+		glm::vec4 clip = projection * glm::vec4(viewPos, 1.0f);
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		glm::vec2 tile = glm::clamp((ndc * 0.5f + 0.5f) * glm::vec2(LightClusterGrid::SIZE_X, LightClusterGrid::SIZE_Y),
+			glm::vec2(0.0f), glm::vec2(LightClusterGrid::SIZE_X - 1, LightClusterGrid::SIZE_Y - 1));
+		return LightClusterGrid::GetClusterIndex((uint32_t)tile.x, (uint32_t)tile.y, grid.GetSlice(-viewPos.z));
+	}
+
+	bool ClusterHasLight(const LightClusterGrid& grid, uint32_t clusterIndex, uint32_t light) {
+		const LightClusterGrid::Cluster& cluster = grid.GetClusters()[clusterIndex];
+		const std::vector<uint32_t>& indices = grid.GetLightIndices();
+		return std::find(indices.begin() + cluster.Offset, indices.begin() + cluster.Offset + cluster.Count, light) != indices.begin() + cluster.Offset + cluster.Count;
+	}
+}
+
+TEST_CASE(LightCluster_SlicesCoverDepthRange) {
+	LightClusterGrid grid;
+	grid.Build({}, MakeTestProjection(), TestNear, TestFar);
+
+	CHECK(grid.GetSlice(TestNear) == 0);
+	CHECK(grid.GetSlice(TestNear * 0.5f) == 0);
+	CHECK(grid.GetSlice(TestFar * 0.999f) == LightClusterGrid::SIZE_Z - 1);
+	CHECK(grid.GetSlice(TestFar * 10.0f) == LightClusterGrid::SIZE_Z - 1);
+
+	// Slices should never go backwards, and the shader's formula should agree with ours
+	glm::vec2 params = grid.GetSliceParams();
+	uint32_t lastSlice = 0;
+	size_t decreasing = 0, shaderMismatches = 0;
+	for (float depth = TestNear * 1.01f; depth < TestFar; depth *= 1.01f) {
+		uint32_t slice = grid.GetSlice(depth);
+		decreasing += slice < lastSlice ? 1 : 0;
+		lastSlice = slice;
+
+		float shaderSlice = std::floor(std::log(depth) * params.x - params.y);
+		uint32_t clamped = (uint32_t)std::clamp(shaderSlice, 0.0f, (float)(LightClusterGrid::SIZE_Z - 1));
+		shaderMismatches += clamped != slice ? 1 : 0;
+	}
+	CHECK(decreasing == 0);
+	CHECK(shaderMismatches == 0);
+}
+
+TEST_CASE(LightCluster_IndexListIsConsistent) {
+	std::vector<LightClusterGrid::LightBounds> lights = MakeRandomLights(500, 3);
+	LightClusterGrid grid;
+	grid.Build(lights, MakeTestProjection(), TestNear, TestFar);
+
+	const auto& clusters = grid.GetClusters();
+	REQUIRE(clusters.size() == LightClusterGrid::CLUSTER_COUNT);
+
+	// Clusters should be packed back to back in the index list, with valid light indices
+	uint32_t expectedOffset = 0;
+	size_t badOffsets = 0;
+	for (const auto& cluster : clusters) {
+		badOffsets += cluster.Offset != expectedOffset ? 1 : 0;
+		expectedOffset += cluster.Count;
+	}
+	CHECK(badOffsets == 0);
+	CHECK(expectedOffset == grid.GetLightIndices().size());
+	for (uint32_t index : grid.GetLightIndices()) {
+		REQUIRE(index < lights.size());
+	}
+}
+
+TEST_CASE(LightCluster_KnownLayout) {
+	glm::mat4 projection = MakeTestProjection();
+	std::vector<LightClusterGrid::LightBounds> lights = {
+		{ glm::vec3(0.0f, 0.0f, -10.0f),   1.0f },  // 0: in front of the camera
+		{ glm::vec3(0.0f, 0.0f, 20.0f),    1.0f },  // 1: behind the camera
+		{ glm::vec3(0.0f, 0.0f, -200.0f),  1.0f },  // 2: past the far plane
+		{ glm::vec3(-100.0f, 0.0f, -10.0f), 1.0f }, // 3: off the left of the screen
+		{ glm::vec3(0.0f, 0.0f, 0.0f),     5.0f },  // 4: surrounding the camera
+	};
+	LightClusterGrid grid;
+	grid.Build(lights, projection, TestNear, TestFar);
+
+	size_t clustersWith[5] = { 0 };
+	for (uint32_t cluster = 0; cluster < LightClusterGrid::CLUSTER_COUNT; cluster++) {
+		for (uint32_t light = 0; light < 5; light++) {
+			clustersWith[light] += ClusterHasLight(grid, cluster, light) ? 1 : 0;
+		}
+	}
+
+	CHECK(ClusterHasLight(grid, FindCluster(grid, projection, lights[0].ViewPosition), 0));
+	CHECK(clustersWith[0] < LightClusterGrid::CLUSTER_COUNT / 10);
+	CHECK(clustersWith[1] == 0);
+	CHECK(clustersWith[2] == 0);
+	CHECK(clustersWith[3] == 0);
+	// Crosses the near plane, so it should cover the whole screen for every slice it reaches
+	uint32_t slices = grid.GetSlice(5.0f) + 1;
+	CHECK(clustersWith[4] == LightClusterGrid::SIZE_X * LightClusterGrid::SIZE_Y * slices);
+}
+
+TEST_CASE(LightCluster_BinningIsConservative) {
+	// Any point inside a light's radius must find that light in the cluster it lands in
+	glm::mat4 projection = MakeTestProjection();
+	std::vector<LightClusterGrid::LightBounds> lights = MakeRandomLights(200, 17);
+	LightClusterGrid grid;
+	grid.Build(lights, projection, TestNear, TestFar);
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> ndc(-0.999f, 0.999f);
+	std::uniform_real_distribution<float> depth(TestNear * 1.01f, TestFar * 0.99f);
+	const float tanY = std::tan(TestFov * 0.5f);
+
+	size_t checked = 0, missed = 0;
+	for (int sample = 0; sample < 20000; sample++) {
+		float d = depth(random);
+		glm::vec3 point = glm::vec3(ndc(random) * d * tanY * TestAspect, ndc(random) * d * tanY, -d);
+		uint32_t cluster = FindCluster(grid, projection, point);
+
+		for (uint32_t light = 0; light < lights.size(); light++) {
+			if (glm::length(point - lights[light].ViewPosition) <= lights[light].Radius) {
+				checked++;
+				missed += ClusterHasLight(grid, cluster, light) ? 0 : 1;
+			}
+		}
+	}
+	REQUIRE(checked > 0);
+	CHECK(missed == 0);
+}
+
+BENCHMARK(LightCluster_Build) {
+	glm::mat4 projection = MakeTestProjection();
+	LightClusterGrid grid;
+	for (size_t count : { 64, 256, 1024, 4096 }) {
+		std::vector<LightClusterGrid::LightBounds> lights = MakeRandomLights(count, 11);
+		const int iterations = 100;
+		Stopwatch timer;
+		for (int ix = 0; ix < iterations; ix++) {
+			grid.Build(lights, projection, TestNear, TestFar);
+		}
+		TestRegistry::Report("Build with " + std::to_string(count) + " lights", timer.ElapsedMs() / iterations, "ms");
+	}
+}
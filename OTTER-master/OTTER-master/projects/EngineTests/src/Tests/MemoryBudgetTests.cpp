@@ -0,0 +1,169 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <algorithm>
+#include <vector>
+#include <glad/glad.h>
+#include <Sys.h>
+
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Textures/Texture1D.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/Texture3D.h"
+#include "Graphics/Textures/TextureCube.h"
+#include "Graphics/Font.h"
+#include "Graphics/Framebuffer.h"
+#include "Gameplay/Material.h"
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+#include "Gameplay/Components/JumpBehaviour.h"
+#include "Gameplay/Components/RenderComponent.h"
+#include "Gameplay/Components/TriggerVolumeEnterBehaviour.h"
+#include "Gameplay/Components/SimpleCameraControl.h"
+#include "Gameplay/Components/ParticleSystem.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/TriggerVolume.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+
+namespace {
+	const char* ScenePath    = "scenes/emitter-test.json";
+	const char* ManifestPath = "emitter-test-manifest.json";
+
+	void RegisterTypes() {
+		ResourceManager::RegisterType<Texture1D>();
+		ResourceManager::RegisterType<Texture2D>();
+		ResourceManager::RegisterType<Texture3D>();
+		ResourceManager::RegisterType<TextureCube>();
+		ResourceManager::RegisterType<ShaderProgram>();
+		ResourceManager::RegisterType<Material>();
+		ResourceManager::RegisterType<MeshResource>();
+		ResourceManager::RegisterType<Font>();
+		ResourceManager::RegisterType<Framebuffer>();
+
+		// Everything the emitter test scene uses
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RenderComponent>();
+		ComponentManager::RegisterType<RigidBody>();
+		ComponentManager::RegisterType<TriggerVolume>();
+		ComponentManager::RegisterType<RotatingBehaviour>();
+		ComponentManager::RegisterType<JumpBehaviour>();
+		ComponentManager::RegisterType<TriggerVolumeEnterBehaviour>();
+		ComponentManager::RegisterType<SimpleCameraControl>();
+		ComponentManager::RegisterType<ParticleSystem>();
+	}
+
+	struct CycleMemory {
+		size_t LoadedGpuBytes;
+		size_t UnloadedGpuBytes;
+		size_t ProcessBytes;
+	};
+
+	// Loads the scene the way Application::LoadScene does, then drops it and lets the budget
+	// evict whatever it was using
+	CycleMemory CycleScene() {
+		CycleMemory result;
+
+		ResourceManager::LoadManifest(ManifestPath, true);
+		Scene::Sptr scene = Scene::Load(ScenePath);
+		ResourceManager::WaitForAll();
+		ResourceManager::EnforceMemoryBudget();
+		result.LoadedGpuBytes = ResourceManager::GetTotalGpuMemory();
+
+		scene = nullptr;
+		// The first pass finds the newly unused resources and evicts them, the second measures what's left
+		ResourceManager::EnforceMemoryBudget();
+		ResourceManager::EnforceMemoryBudget();
+		glFinish();
+		result.UnloadedGpuBytes = ResourceManager::GetTotalGpuMemory();
+		result.ProcessBytes = System::GetMemoryUsageBytes();
+		return result;
+	}
+}
+
+TEST_CASE(MemoryBudget_CyclingScenesKeepsMemoryFlat) {
+	GlTestContext::Require();
+
+	ResourceManager::Init();
+	RegisterTypes();
+	// Small enough that anything unused has to go
+	size_t oldBudget = ResourceManager::GetMemoryBudget();
+	ResourceManager::SetMemoryBudget(1);
+
+	const int cycles = 10;
+	std::vector<CycleMemory> results;
+	for (int ix = 0; ix < cycles; ix++) {
+		results.push_back(CycleScene());
+	}
+
+	ResourceManager::SetMemoryBudget(oldBudget);
+	ResourceManager::Cleanup();
+
+	// The scene should actually be holding on to textures and meshes, otherwise there's nothing to evict
+	REQUIRE(results[0].LoadedGpuBytes > 0);
+
+	size_t changedLoaded = 0, leftBehind = 0;
+	for (const CycleMemory& cycle : results) {
+		changedLoaded += cycle.LoadedGpuBytes != results[0].LoadedGpuBytes ? 1 : 0;
+		leftBehind += cycle.UnloadedGpuBytes > 0 ? 1 : 0;
+	}
+	CHECK(changedLoaded == 0);
+	CHECK(leftBehind == 0);
+
+	// The process will settle after the first couple of loads (driver pools, allocator caches), but
+	// after that repeated cycles shouldn't keep adding to it
+	size_t settled = results[2].ProcessBytes;
+	size_t growth = results.back().ProcessBytes > settled ? results.back().ProcessBytes - settled : 0;
+	TestRegistry::Report("Scene GPU memory", results[0].LoadedGpuBytes / (1024.0 * 1024.0), "MB");
+	TestRegistry::Report("Process growth over " + std::to_string(cycles - 3) + " cycles", growth / (1024.0 * 1024.0), "MB");
+	CHECK(growth < std::max<size_t>(16 * 1024 * 1024, results[0].LoadedGpuBytes / 4));
+}
+
+TEST_CASE(MemoryBudget_EvictedResourcesReloadFromTheManifest) {
+	GlTestContext::Require();
+
+	ResourceManager::Init();
+	RegisterTypes();
+	ResourceManager::LoadManifest(ManifestPath, true);
+	ResourceManager::WaitForAll();
+
+	// Grab any texture from the manifest, and remember what it looked like
+	Texture2D::Sptr texture;
+	ResourceManager::Each<Texture2D>([&](const Texture2D::Sptr& item) {
+		if (texture == nullptr) {
+			texture = item;
+		}
+	});
+	REQUIRE(texture != nullptr);
+	Guid id = texture->GetGUID();
+	uint32_t width = texture->GetWidth();
+	uint32_t height = texture->GetHeight();
+	texture = nullptr;
+
+	size_t oldBudget = ResourceManager::GetMemoryBudget();
+	ResourceManager::SetMemoryBudget(1);
+	ResourceManager::EnforceMemoryBudget();
+	ResourceManager::SetMemoryBudget(oldBudget);
+
+	// Nothing was holding on to it, so it should have been evicted and come back from the manifest
+	texture = ResourceManager::Get<Texture2D>(id);
+	REQUIRE(texture != nullptr);
+	ResourceManager::WaitFor(texture);
+	CHECK(texture->GetWidth() == width);
+	CHECK(texture->GetHeight() == height);
+	CHECK(texture->GetHandle() != 0);
+
+	// While something holds it, it must survive no matter how small the budget is
+	ResourceManager::SetMemoryBudget(1);
+	ResourceManager::EnforceMemoryBudget();
+	ResourceManager::EnforceMemoryBudget();
+	ResourceManager::SetMemoryBudget(oldBudget);
+	CHECK(ResourceManager::Get<Texture2D>(id) == texture);
+
+	texture = nullptr;
+	ResourceManager::Cleanup();
+}
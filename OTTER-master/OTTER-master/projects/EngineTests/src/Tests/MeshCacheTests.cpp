@@ -0,0 +1,315 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include <Logging.h>
+#include <glad/glad.h>
+
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/MappedFile.h"
+#include "Utils/MeshFactory.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	/// <summary>
+	/// Exposes the binary format internals of the loader, so the tests can build and parse files directly
+	/// </summary>
+	class TestObjLoader : public OptimizedObjLoader {
+	public:
+		using OptimizedObjLoader::BinaryHeaderV1;
+		using OptimizedObjLoader::BinaryHeaderV2;
+		using OptimizedObjLoader::BinaryMeshView;
+
+		static bool Parse(const uint8_t* data, size_t size, BinaryMeshView& result) {
+			return _ParseBinFile(data, size, "test data", "", result);
+		}
+		static bool Parse(const std::string& data, BinaryMeshView& result) {
+			return Parse(reinterpret_cast<const uint8_t*>(data.data()), data.size(), result);
+		}
+	};
+
+	/// <summary>
+	/// Raises the log level while alive, so that thousands of expected warnings don't bury the test output
+	/// </summary>
+	class QuietLog {
+	public:
+		QuietLog() : _level(Logger::GetLogger()->level()) { Logger::GetLogger()->set_level(spdlog::level::err); }
+		~QuietLog() { Logger::GetLogger()->set_level(_level); }
+	private:
+		spdlog::level::level_enum _level;
+	};
+
+	typedef MeshBuilder<VertexPosNormTexColTangents> TestMesh;
+
+	fs::path GetTestDirectory() {
+		fs::path result = fs::temp_directory_path() / "otter-mesh-cache-test";
+		fs::create_directories(result);
+		return result;
+	}
+
+	std::string ReadBytes(const fs::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void WriteBytes(const fs::path& path, const std::string& data) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+	}
+
+	// Builds a version 1 file the same way the old SaveBinaryFile did, with the sections packed back to back
+	std::string MakeVersion1File(const TestMesh& mesh) {
+		TestObjLoader::BinaryHeaderV1 header;
+		header.Version       = 0x01;
+		header.NumIndices    = static_cast<uint32_t>(mesh.GetIndexCount());
+		header.IndicesType   = IndexType::UInt;
+		header.NumVertices   = static_cast<uint32_t>(mesh.GetVertexCount());
+		header.VertexStride  = sizeof(VertexPosNormTexColTangents);
+		header.NumAttributes = static_cast<uint8_t>(VertexPosNormTexColTangents::V_DECL.size());
+
+		std::string result;
+		result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		result.append(reinterpret_cast<const char*>(VertexPosNormTexColTangents::V_DECL.data()), header.NumAttributes * sizeof(BufferAttribute));
+		result.append(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), header.NumIndices * sizeof(uint32_t));
+		result.append(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), header.NumVertices * sizeof(VertexPosNormTexColTangents));
+		return result;
+	}
+
+	TestMesh MakeTestMesh(int tessellation) {
+		TestMesh mesh;
+		MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 1.0f, tessellation);
+		MeshFactory::AddCube(mesh, glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+		return mesh;
+	}
+
+	// Checks that collision data loaded from a file matches the mesh it was written from
+	bool MatchesMesh(const TestMesh& mesh, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+		if (positions.size() != mesh.GetVertexCount() || indices.size() != mesh.GetIndexCount()) {
+			return false;
+		}
+		for (size_t ix = 0; ix < positions.size(); ix++) {
+			if (positions[ix] != mesh.GetVertexDataPtr()[ix].Position) {
+				return false;
+			}
+		}
+		return memcmp(indices.data(), mesh.GetIndexDataPtr(), indices.size() * sizeof(uint32_t)) == 0;
+	}
+
+	// Any file that is accepted must only point inside of the data it was parsed from
+	bool ViewIsInBounds(const std::string& data, const TestObjLoader::BinaryMeshView& view) {
+		const uint8_t* begin = reinterpret_cast<const uint8_t*>(data.data());
+		const uint8_t* end = begin + data.size();
+		size_t indexBytes = view.NumIndices * GetIndexTypeSize(view.IndicesType);
+		size_t vertexBytes = (size_t)view.NumVertices * view.VertexStride;
+		return view.IndexData >= begin && view.IndexData + indexBytes <= end &&
+			view.VertexData >= begin && view.VertexData + vertexBytes <= end;
+	}
+}
+
+TEST_CASE(MeshCache_RoundTrip) {
+	TestMesh mesh = MakeTestMesh(2);
+	fs::path path = GetTestDirectory() / "round-trip.bin";
+	OptimizedObjLoader::SaveBinaryFile(mesh, path.string());
+
+	std::string data = ReadBytes(path);
+	REQUIRE(data.size() >= sizeof(TestObjLoader::BinaryHeaderV2));
+	TestObjLoader::BinaryHeaderV2 header;
+	memcpy(&header, data.data(), sizeof(header));
+	CHECK(header.Version == 0x02);
+	CHECK(header.IndicesOffset % 64 == 0);
+	CHECK(header.VerticesOffset % 64 == 0);
+
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	CHECK(OptimizedObjLoader::LoadCollisionData(path.string(), positions, indices));
+	CHECK(MatchesMesh(mesh, positions, indices));
+}
+
+TEST_CASE(MeshCache_Version1FilesStillLoad) {
+	TestMesh mesh = MakeTestMesh(2);
+	fs::path path = GetTestDirectory() / "version-1.bin";
+	WriteBytes(path, MakeVersion1File(mesh));
+
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	CHECK(OptimizedObjLoader::LoadCollisionData(path.string(), positions, indices));
+	CHECK(MatchesMesh(mesh, positions, indices));
+}
+
+TEST_CASE(MeshCache_TruncatedFilesAreRejected) {
+	QuietLog quiet;
+	TestMesh mesh = MakeTestMesh(1);
+	fs::path path = GetTestDirectory() / "truncated.bin";
+	OptimizedObjLoader::SaveBinaryFile(mesh, path.string());
+	std::string version2 = ReadBytes(path);
+	std::string version1 = MakeVersion1File(mesh);
+
+	// Every length short of the full file, dense through the headers and sparser through the data
+	size_t accepted = 0;
+	for (const std::string* file : { &version2, &version1 }) {
+		for (size_t length = 0; length < file->size(); length += length < 256 ? 1 : 37) {
+			TestObjLoader::BinaryMeshView view;
+			accepted += TestObjLoader::Parse(file->substr(0, length), view) ? 1 : 0;
+		}
+	}
+	CHECK(accepted == 0);
+
+	// Extra data on the end of a version 2 file means the header doesn't describe it
+	TestObjLoader::BinaryMeshView view;
+	CHECK(!TestObjLoader::Parse(version2 + "x", view));
+	CHECK(TestObjLoader::Parse(version2, view));
+}
+
+TEST_CASE(MeshCache_CorruptedFilesAreRejected) {
+	QuietLog quiet;
+	TestMesh mesh = MakeTestMesh(1);
+	fs::path path = GetTestDirectory() / "corrupted.bin";
+	OptimizedObjLoader::SaveBinaryFile(mesh, path.string());
+	std::string original = ReadBytes(path);
+
+	// Any single bit flip should be caught by one of the checksums
+	size_t accepted = 0;
+	for (size_t ix = 0; ix < sizeof(TestObjLoader::BinaryHeaderV2); ix++) {
+		for (int bit = 0; bit < 8; bit++) {
+			std::string data = original;
+			data[ix] ^= static_cast<char>(1 << bit);
+			TestObjLoader::BinaryMeshView view;
+			accepted += TestObjLoader::Parse(data, view) ? 1 : 0;
+		}
+	}
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<size_t> position(sizeof(TestObjLoader::BinaryHeaderV2), original.size() - 1);
+	for (int ix = 0; ix < 500; ix++) {
+		std::string data = original;
+		data[position(random)] ^= static_cast<char>(1 << (ix % 8));
+		TestObjLoader::BinaryMeshView view;
+		accepted += TestObjLoader::Parse(data, view) ? 1 : 0;
+	}
+	CHECK(accepted == 0);
+}
+
+TEST_CASE(MeshCache_GarbageNeverReadsOutOfBounds) {
+	QuietLog quiet;
+	TestMesh mesh = MakeTestMesh(0);
+	std::string version1 = MakeVersion1File(mesh);
+	std::mt19937 random(99);
+	std::uniform_int_distribution<int> byte(0, 255);
+
+	// Version 1 files have no checksum, so random headers can get through. Whatever gets accepted
+	// must still describe data that is inside the file
+	size_t outOfBounds = 0;
+	for (int ix = 0; ix < 2000; ix++) {
+		std::string data = version1;
+		for (size_t jx = 6; jx < sizeof(TestObjLoader::BinaryHeaderV1) + 4 * sizeof(BufferAttribute); jx++) {
+			if (byte(random) < 16) {
+				data[jx] = static_cast<char>(byte(random));
+			}
+		}
+		TestObjLoader::BinaryMeshView view;
+		if (TestObjLoader::Parse(data, view)) {
+			outOfBounds += ViewIsInBounds(data, view) ? 0 : 1;
+		}
+	}
+	CHECK(outOfBounds == 0);
+
+	// Random bytes behind a valid looking magic and version
+	size_t accepted = 0;
+	for (int ix = 0; ix < 2000; ix++) {
+		std::string data(64 + ix, '\0');
+		for (char& value : data) {
+			value = static_cast<char>(byte(random));
+		}
+		memcpy(&data[0], "BOBJ\x02\x00", 6);
+		TestObjLoader::BinaryMeshView view;
+		accepted += TestObjLoader::Parse(data, view) ? 1 : 0;
+	}
+	CHECK(accepted == 0);
+}
+
+TEST_CASE(MeshCache_StaleFilesAreRegenerated) {
+	fs::path dir = GetTestDirectory();
+	fs::path objPath = dir / "stale.obj";
+	fs::path binPath = dir / "stale.bin";
+	fs::remove(binPath);
+
+	WriteBytes(objPath, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	REQUIRE(OptimizedObjLoader::LoadCollisionData(objPath.string(), positions, indices));
+	CHECK(fs::exists(binPath));
+	CHECK(positions.size() == 3);
+
+	// Change the OBJ file, and make sure it's stamp is different even on file systems with coarse times
+	WriteBytes(objPath, "v 0 0 0\nv 2 0 0\nv 0 2 0\nv 2 2 0\nf 1 2 3\nf 2 4 3\n");
+	fs::last_write_time(objPath, fs::last_write_time(objPath) + std::chrono::seconds(10));
+	REQUIRE(OptimizedObjLoader::LoadCollisionData(objPath.string(), positions, indices));
+	CHECK(positions.size() == 4);
+	CHECK(indices.size() == 6);
+}
+
+BENCHMARK(MeshCache_LoadLargeMesh) {
+	// Three spheres of 327k triangles each, about a million triangles in total
+	TestMesh mesh;
+	for (int ix = 0; ix < 3; ix++) {
+		MeshFactory::AddIcoSphere(mesh, glm::vec3(ix * 3.0f, 0.0f, 0.0f), 1.0f, 7);
+	}
+	fs::path path = GetTestDirectory() / "large.bin";
+	OptimizedObjLoader::SaveBinaryFile(mesh, path.string());
+	size_t fileSize = fs::file_size(path);
+
+	const int iterations = 10;
+	double readMs = 0.0, mappedMs = 0.0;
+	for (int ix = 0; ix < iterations; ix++) {
+		// How version 1 files were loaded, reading the whole file into a heap buffer first
+		Stopwatch timer;
+		{
+			std::ifstream file(path, std::ios::binary);
+			uint8_t* buffer = static_cast<uint8_t*>(malloc(fileSize));
+			file.read(reinterpret_cast<char*>(buffer), fileSize);
+			TestObjLoader::BinaryMeshView view;
+			CHECK(TestObjLoader::Parse(buffer, fileSize, view));
+			free(buffer);
+		}
+		readMs += timer.ElapsedMs();
+
+		timer.Restart();
+		{
+			MappedFile file;
+			REQUIRE(file.Open(path.string()));
+			TestObjLoader::BinaryMeshView view;
+			CHECK(TestObjLoader::Parse(file.GetData(), file.GetSize(), view));
+		}
+		mappedMs += timer.ElapsedMs();
+	}
+
+	TestRegistry::Report("Triangles", (double)mesh.GetTriangleCount(), "");
+	TestRegistry::Report("File size", fileSize / (1024.0 * 1024.0), "MB");
+	TestRegistry::Report("ifstream + heap copy", readMs / iterations, "ms");
+	TestRegistry::Report("Memory mapped", mappedMs / iterations, "ms");
+}
+
+BENCHMARK(MeshCache_UploadLargeMesh) {
+	GlTestContext::Require();
+
+	TestMesh mesh;
+	for (int ix = 0; ix < 3; ix++) {
+		MeshFactory::AddIcoSphere(mesh, glm::vec3(ix * 3.0f, 0.0f, 0.0f), 1.0f, 7);
+	}
+	fs::path path = GetTestDirectory() / "large.bin";
+	OptimizedObjLoader::SaveBinaryFile(mesh, path.string());
+
+	// The whole load, from mapping the file to the data landing in immutable GL buffers
+	const int iterations = 10;
+	Stopwatch timer;
+	for (int ix = 0; ix < iterations; ix++) {
+		VertexArrayObject::Sptr vao = OptimizedObjLoader::LoadFromFile(path.string());
+		REQUIRE(vao != nullptr);
+		glFinish();
+	}
+	TestRegistry::Report("LoadFromFile, 1M triangles", timer.ElapsedMs() / iterations, "ms");
+}
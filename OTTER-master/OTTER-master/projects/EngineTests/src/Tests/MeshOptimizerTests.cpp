@@ -0,0 +1,204 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Utils/MeshBuilder.h"
+#include "Utils/MeshFactory.h"
+#include "Utils/MeshOptimizer.h"
+
+namespace {
+	typedef std::array<uint32_t, 3> Triangle;
+	typedef std::tuple<float, float, float> Point;
+	typedef std::array<Point, 3> PointTriangle;
+
+	// Rotates a triangle so it's smallest element comes first, which keeps the winding intact
+	template <typename T>
+	std::array<T, 3> Canonical(const std::array<T, 3>& tri) {
+		size_t first = std::min_element(tri.begin(), tri.end()) - tri.begin();
+		return { tri[first], tri[(first + 1) % 3], tri[(first + 2) % 3] };
+	}
+
+	std::vector<Triangle> GetTriangles(const std::vector<uint32_t>& indices) {
+		std::vector<Triangle> result;
+		for (size_t ix = 0; ix + 2 < indices.size(); ix += 3) {
+			result.push_back(Canonical<uint32_t>({ indices[ix], indices[ix + 1], indices[ix + 2] }));
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	// Generates a size x size grid of quads, with it's triangles in a random order
+	std::vector<uint32_t> CreateShuffledGrid(uint32_t size, uint32_t seed) {
+		std::vector<Triangle> tris;
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				uint32_t corner = y * (size + 1) + x;
+				tris.push_back({ corner, corner + 1, corner + size + 2 });
+				tris.push_back({ corner, corner + size + 2, corner + size + 1 });
+			}
+		}
+		std::shuffle(tris.begin(), tris.end(), std::mt19937(seed));
+
+		std::vector<uint32_t> result;
+		for (const Triangle& tri : tris) {
+			result.insert(result.end(), tri.begin(), tri.end());
+		}
+		return result;
+	}
+
+	// Since Optimize moves vertices around, triangles from a MeshBuilder are compared by their positions
+	template <typename Vertex>
+	std::vector<PointTriangle> GetPointTriangles(const MeshBuilder<Vertex>& mesh) {
+		std::vector<PointTriangle> result;
+		const Vertex* vertices = mesh.GetVertexDataPtr();
+		const uint32_t* indices = mesh.GetIndexDataPtr();
+		for (size_t ix = 0; ix + 2 < mesh.GetIndexCount(); ix += 3) {
+			PointTriangle tri;
+			for (int corner = 0; corner < 3; corner++) {
+				const glm::vec3& pos = vertices[indices[ix + corner]].Position;
+				tri[corner] = Point(pos.x, pos.y, pos.z);
+			}
+			result.push_back(Canonical(tri));
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	// Stands in for an imported model, an ico sphere with it's triangles scrambled the way an exporter might leave them
+	MeshBuilder<VertexPosNormTexColTangents> CreateShuffledSphere(int tessellation) {
+		MeshBuilder<VertexPosNormTexColTangents> sphere;
+		MeshFactory::AddParameterized(sphere, MeshBuilderParam::CreateIcoSphere(glm::vec3(0.0f), 1.0f, tessellation));
+
+		std::vector<Triangle> tris;
+		const uint32_t* indices = sphere.GetIndexDataPtr();
+		for (size_t ix = 0; ix + 2 < sphere.GetIndexCount(); ix += 3) {
+			tris.push_back({ indices[ix], indices[ix + 1], indices[ix + 2] });
+		}
+		std::shuffle(tris.begin(), tris.end(), std::mt19937(42));
+
+		MeshBuilder<VertexPosNormTexColTangents> result;
+		result.AddVertexRange(sphere.GetVertexDataPtr(), (uint32_t)sphere.GetVertexCount());
+		for (const Triangle& tri : tris) {
+			result.AddIndexTri(tri[0], tri[1], tri[2]);
+		}
+		return result;
+	}
+
+	float GetACMR(const MeshBuilder<VertexPosNormTexColTangents>& mesh) {
+		return MeshOptimizer::CalculateACMR(mesh.GetIndexDataPtr(), mesh.GetIndexCount(), mesh.GetVertexCount());
+	}
+}
+
+TEST_CASE(MeshOptimizer_VertexCacheKeepsTriangles) {
+	const uint32_t size = 64;
+	const size_t vertexCount = (size + 1) * (size + 1);
+	std::vector<uint32_t> indices = CreateShuffledGrid(size, 7);
+	std::vector<uint32_t> original = indices;
+
+	float before = MeshOptimizer::CalculateACMR(indices.data(), indices.size(), vertexCount);
+	MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+	float after = MeshOptimizer::CalculateACMR(indices.data(), indices.size(), vertexCount);
+
+	CHECK(GetTriangles(indices) == GetTriangles(original));
+	// A shuffled grid is close to the worst case of 3, an optimized one should get near the 0.5 limit
+	CHECK(before > 2.0f);
+	CHECK(after < 0.8f);
+}
+
+TEST_CASE(MeshOptimizer_VertexFetchKeepsTriangles) {
+	const uint32_t size = 32;
+	const size_t vertexCount = (size + 1) * (size + 1);
+	std::vector<uint32_t> indices = CreateShuffledGrid(size, 3);
+	std::vector<uint32_t> original = indices;
+
+	std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+	REQUIRE(remap.size() == vertexCount);
+
+	// The remap has to be a permutation, and moving the old triangles through it gives the new ones
+	std::vector<uint32_t> sorted = remap;
+	std::sort(sorted.begin(), sorted.end());
+	size_t notPermutation = 0;
+	for (size_t ix = 0; ix < sorted.size(); ix++) {
+		notPermutation += sorted[ix] != ix ? 1 : 0;
+	}
+	CHECK(notPermutation == 0);
+
+	std::vector<uint32_t> moved = original;
+	for (uint32_t& index : moved) {
+		index = remap[index];
+	}
+	CHECK(GetTriangles(moved) == GetTriangles(indices));
+
+	// Vertices should now be numbered in the order they're first used
+	uint32_t nextNew = 0;
+	size_t outOfOrder = 0;
+	for (uint32_t index : indices) {
+		if (index == nextNew) {
+			nextNew++;
+		} else {
+			outOfOrder += index > nextNew ? 1 : 0;
+		}
+	}
+	CHECK(outOfOrder == 0);
+	CHECK(nextNew == vertexCount);
+}
+
+TEST_CASE(MeshOptimizer_OptimizeImprovesMesh) {
+	MeshBuilder<VertexPosNormTexColTangents> mesh = CreateShuffledSphere(4);
+	std::vector<PointTriangle> original = GetPointTriangles(mesh);
+	size_t vertexCount = mesh.GetVertexCount();
+	float before = GetACMR(mesh);
+
+	mesh.Optimize();
+	CHECK(mesh.GetVertexCount() == vertexCount);
+	CHECK(GetPointTriangles(mesh) == original);
+	TestRegistry::Report("Ico sphere ACMR before", before, "");
+	TestRegistry::Report("Ico sphere ACMR after", GetACMR(mesh), "");
+	CHECK(GetACMR(mesh) < before * 0.75f);
+
+	// Running it again on an already optimized mesh shouldn't make things worse
+	float optimized = GetACMR(mesh);
+	mesh.Optimize();
+	CHECK(GetPointTriangles(mesh) == original);
+	CHECK(GetACMR(mesh) <= optimized + 0.01f);
+}
+
+TEST_CASE(MeshOptimizer_IgnoresBadIndices) {
+	// An index past the end of the vertices means we can't trust the mesh, so it's left alone
+	std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3, 3, 1, 9 };
+	std::vector<uint32_t> original = indices;
+	MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), 4);
+	CHECK(indices == original);
+
+	std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), 4);
+	CHECK(indices == original);
+	CHECK(remap == std::vector<uint32_t>({ 0, 1, 2, 3 }));
+	CHECK(MeshOptimizer::CalculateACMR(indices.data(), indices.size(), 4) == 0.0f);
+}
+
+BENCHMARK(MeshOptimizer_OptimizeTime) {
+	for (uint32_t size : { 128u, 512u }) {
+		const size_t vertexCount = (size + 1) * (size + 1);
+		std::vector<uint32_t> indices = CreateShuffledGrid(size, 11);
+		float before = MeshOptimizer::CalculateACMR(indices.data(), indices.size(), vertexCount);
+
+		Stopwatch timer;
+		MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		double cacheMs = timer.ElapsedMs();
+		timer.Restart();
+		MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+		double fetchMs = timer.ElapsedMs();
+		float after = MeshOptimizer::CalculateACMR(indices.data(), indices.size(), vertexCount);
+
+		std::string label = std::to_string(indices.size() / 3) + " triangle grid";
+		TestRegistry::Report(label + ", ACMR before", before, "");
+		TestRegistry::Report(label + ", ACMR after", after, "");
+		TestRegistry::Report(label + ", vertex cache pass", cacheMs, "ms");
+		TestRegistry::Report(label + ", vertex fetch pass", fetchMs, "ms");
+		CHECK(after < before);
+	}
+}
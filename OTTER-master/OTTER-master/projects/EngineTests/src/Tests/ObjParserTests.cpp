@@ -0,0 +1,301 @@
+#include "TestFramework.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "Utils/ObjLoader.h"
+#include "Utils/StringUtils.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	fs::path WriteTestFile(const std::string& name, const std::string& contents) {
+		fs::path dir = fs::temp_directory_path() / "otter-obj-test";
+		fs::create_directories(dir);
+		fs::path result = dir / name;
+		std::ofstream file(result, std::ios::binary | std::ios::trunc);
+		file.write(contents.data(), contents.size());
+		return result;
+	}
+
+	ObjMeshData Parse(const std::string& name, const std::string& contents) {
+		ObjMeshData result;
+		ObjLoader::ParseFile(WriteTestFile(name, contents).string(), result);
+		return result;
+	}
+
+	/// <summary>
+	/// The stream based parser that ObjLoader used before ParseFile, kept here as the reference for
+	/// the new parser's output. It only understood triangles and quads in the v/vt/vn form
+	/// </summary>
+	void LegacyParseFile(const std::string& filename, ObjMeshData& result) {
+		std::ifstream file;
+		file.open(filename, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Failed to open file");
+		}
+
+		std::unordered_map<uint64_t, uint32_t> vertexMap;
+		std::string line;
+		glm::vec3 vecData;
+		glm::ivec3 vertexIndices;
+
+		while (file.peek() != EOF) {
+			std::string command;
+			file >> command;
+
+			if (command == "#") {
+				std::getline(file, line);
+			}
+			else if (command == "v") {
+				file >> vecData.x >> vecData.y >> vecData.z;
+				result.Positions.push_back(vecData);
+			}
+			else if (command == "vn") {
+				file >> vecData.x >> vecData.y >> vecData.z;
+				result.Normals.push_back(vecData);
+			}
+			else if (command == "vt") {
+				file >> vecData.x >> vecData.y;
+				result.UVs.push_back(vecData);
+			}
+			else if (command == "f") {
+				std::getline(file, line);
+				StringTools::Trim(line);
+				std::stringstream stream = std::stringstream(line);
+
+				uint32_t edges[4];
+				int ix = 0;
+				for (; ix < 4; ix++) {
+					if (stream.peek() != EOF) {
+						char tempChar;
+						vertexIndices = glm::ivec3(0);
+						stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
+						if (vertexIndices.x < 0) { vertexIndices.x = result.Positions.size() + 1 + vertexIndices.x; }
+						if (vertexIndices.y < 0) { vertexIndices.y = result.UVs.size() + 1 + vertexIndices.y; }
+						if (vertexIndices.z < 0) { vertexIndices.z = result.Normals.size() + 1 + vertexIndices.z; }
+
+						const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
+						uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
+
+						auto it = vertexMap.find(key);
+						if (it != vertexMap.end()) {
+							edges[ix] = it->second;
+						} else {
+							result.Vertices.push_back(vertexIndices - glm::ivec3(1));
+							uint32_t index = static_cast<uint32_t>(result.Vertices.size()) - 1;
+							vertexMap[key] = index;
+							edges[ix] = index;
+						}
+					}
+					else { break; }
+				}
+
+				if (ix == 3) {
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[1]);
+					result.Indices.push_back(edges[2]);
+				}
+				else if (ix == 4) {
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[1]);
+					result.Indices.push_back(edges[2]);
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[2]);
+					result.Indices.push_back(edges[3]);
+				}
+			}
+		}
+	}
+
+	// Generates a grid of size x size quads in the v/vt/vn form, with a triangle strip along one edge
+	std::string GenerateGridObj(int size) {
+		std::string result = "# Generated grid\no Grid\n";
+		result.reserve((size_t)(size + 1) * (size + 1) * 90 + (size_t)size * size * 40);
+		char buffer[256];
+		for (int y = 0; y <= size; y++) {
+			for (int x = 0; x <= size; x++) {
+				snprintf(buffer, sizeof(buffer), "v %.6f %.6f %.6f\n", x * 0.01f, y * 0.01f, std::sin(x * 0.1f) * std::cos(y * 0.1f));
+				result += buffer;
+				snprintf(buffer, sizeof(buffer), "vt %.6f %.6f\n", x / (float)size, y / (float)size);
+				result += buffer;
+				snprintf(buffer, sizeof(buffer), "vn %.6f %.6f %.6f\n", 0.0f, std::sin(y * 0.05f), std::cos(y * 0.05f));
+				result += buffer;
+			}
+		}
+		result += "s off\n";
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				int a = y * (size + 1) + x + 1;
+				int b = a + 1;
+				int c = a + size + 2;
+				int d = a + size + 1;
+				if (x == 0) {
+					snprintf(buffer, sizeof(buffer), "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, a, a, a, c, c, c, d, d, d);
+				} else {
+					snprintf(buffer, sizeof(buffer), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+				}
+				result += buffer;
+			}
+		}
+		return result;
+	}
+
+	size_t CountMismatches(const ObjMeshData& a, const ObjMeshData& b) {
+		size_t result = 0;
+		result += a.Positions != b.Positions ? 1 : 0;
+		result += a.Normals   != b.Normals   ? 1 : 0;
+		result += a.UVs       != b.UVs       ? 1 : 0;
+		result += a.Vertices  != b.Vertices  ? 1 : 0;
+		result += a.Indices   != b.Indices   ? 1 : 0;
+		return result;
+	}
+}
+
+TEST_CASE(ObjParser_MatchesLegacyParser) {
+	fs::path path = WriteTestFile("grid.obj", GenerateGridObj(40));
+	ObjMeshData expected, actual;
+	LegacyParseFile(path.string(), expected);
+	ObjLoader::ParseFile(path.string(), actual);
+
+	REQUIRE(!expected.Indices.empty());
+	CHECK(actual.Positions.size() == expected.Positions.size());
+	CHECK(actual.Vertices.size() == expected.Vertices.size());
+	CHECK(actual.Indices.size() == expected.Indices.size());
+	CHECK(CountMismatches(actual, expected) == 0);
+}
+
+TEST_CASE(ObjParser_MatchesLegacyParserWithNegativeIndices) {
+	std::string contents =
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+		"vn 0 0 1\n"
+		"f -4/-4/-1 -3/-3/-1 -2/-2/-1 -1/-1/-1\n"
+		"v 2 0 0\n"
+		"f 2/2/1 -1/1/1 3/3/1\n";
+	fs::path path = WriteTestFile("negative.obj", contents);
+	ObjMeshData expected, actual;
+	LegacyParseFile(path.string(), expected);
+	ObjLoader::ParseFile(path.string(), actual);
+	CHECK(actual.Indices.size() == 9);
+	CHECK(CountMismatches(actual, expected) == 0);
+}
+
+TEST_CASE(ObjParser_HandlesAllFaceForms) {
+	ObjMeshData data = Parse("forms.obj",
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"vt 0.5 0.5\n"
+		"vn 0 0 1\n"
+		"f 1 2 3\n"
+		"f 1/1 2/1 3/1\n"
+		"f 1//1 2//1 3//1\n"
+		"f 1/1/1 2/1/1 3/1/1\n");
+
+	REQUIRE(data.Indices.size() == 12);
+	// Every form refers to the same positions but different attributes, so each is a new set of vertices
+	REQUIRE(data.Vertices.size() == 12);
+	CHECK(data.Vertices[0] == glm::ivec3(0, -1, -1));
+	CHECK(data.Vertices[3] == glm::ivec3(0, 0, -1));
+	CHECK(data.Vertices[6] == glm::ivec3(0, -1, 0));
+	CHECK(data.Vertices[9] == glm::ivec3(0, 0, 0));
+}
+
+TEST_CASE(ObjParser_TriangulatesPolygons) {
+	// A hexagon, which the old parser would have dropped
+	ObjMeshData data = Parse("polygon.obj",
+		"v 1 0 0\nv 0.5 0.87 0\nv -0.5 0.87 0\nv -1 0 0\nv -0.5 -0.87 0\nv 0.5 -0.87 0\n"
+		"f 1 2 3 4 5 6\n");
+
+	REQUIRE(data.Indices.size() == 12);
+	const uint32_t expected[] = { 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5 };
+	size_t mismatches = 0;
+	for (size_t ix = 0; ix < 12; ix++) {
+		mismatches += data.Indices[ix] != expected[ix] ? 1 : 0;
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE(ObjParser_ToleratesFormatting) {
+	// CRLF line endings, tabs, comments, unknown commands, exponents, a leading + and no newline at the end
+	ObjMeshData data = Parse("formatting.obj",
+		"# comment line\r\n"
+		"mtllib test.mtl\r\n"
+		"o Test\r\n"
+		"v\t1.5e1  -2.0E-1 +3\r\n"
+		"v 0 0 0 # trailing comment\r\n"
+		"\r\n"
+		"   v 1 1 1\r\n"
+		"usemtl Material\r\n"
+		"s 1\r\n"
+		"f 1 2 3");
+
+	REQUIRE(data.Positions.size() == 3);
+	CHECK(data.Positions[0] == glm::vec3(15.0f, -0.2f, 3.0f));
+	CHECK(data.Positions[2] == glm::vec3(1.0f));
+	CHECK(data.Indices.size() == 3);
+}
+
+TEST_CASE(ObjParser_SkipsInvalidFaces) {
+	ObjMeshData data = Parse("invalid.obj",
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"f 1 2\n"          // Too few corners
+		"f 1 2 9\n"        // Out of range
+		"f 1 2 x\n"        // Not a number
+		"f 1 2 3\n");
+	CHECK(data.Indices.size() == 3);
+	CHECK(data.Vertices.size() == 3);
+}
+
+TEST_CASE(ObjParser_EmptyFileGivesEmptyMesh) {
+	// The stream parser gave back an empty mesh for an empty file, rather than failing to open it
+	fs::path path = WriteTestFile("empty.obj", "");
+	ObjMeshData expected, actual;
+	LegacyParseFile(path.string(), expected);
+	ObjLoader::ParseFile(path.string(), actual);
+	CHECK(actual.Positions.empty());
+	CHECK(actual.Vertices.empty());
+	CHECK(actual.Indices.empty());
+	CHECK(CountMismatches(expected, actual) == 0);
+
+	// Files that don't exist should still fail
+	bool threw = false;
+	try {
+		ObjLoader::ParseFile((path.parent_path() / "missing.obj").string(), actual);
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+BENCHMARK(ObjParser_Throughput) {
+	fs::path path = WriteTestFile("large-grid.obj", GenerateGridObj(600));
+	double megabytes = fs::file_size(path) / (1024.0 * 1024.0);
+
+	const int iterations = 3;
+	double legacyMs = 0.0, parseMs = 0.0;
+	size_t legacyIndices = 0, parseIndices = 0;
+	for (int ix = 0; ix < iterations; ix++) {
+		Stopwatch timer;
+		{
+			ObjMeshData data;
+			LegacyParseFile(path.string(), data);
+			legacyIndices = data.Indices.size();
+		}
+		legacyMs += timer.ElapsedMs();
+
+		timer.Restart();
+		{
+			ObjMeshData data;
+			ObjLoader::ParseFile(path.string(), data);
+			parseIndices = data.Indices.size();
+		}
+		parseMs += timer.ElapsedMs();
+	}
+	CHECK(legacyIndices == parseIndices);
+
+	TestRegistry::Report("File size", megabytes, "MB");
+	TestRegistry::Report("ifstream >> parser", megabytes / (legacyMs / iterations / 1000.0), "MB/s");
+	TestRegistry::Report("from_chars parser", megabytes / (parseMs / iterations / 1000.0), "MB/s");
+}
@@ -0,0 +1,83 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <algorithm>
+#include <glad/glad.h>
+
+#include "Gameplay/Components/ParticleSystem.h"
+#include "Utils/FileHelpers.h"
+
+namespace {
+	// Finds the first blob stored under the given key anywhere in a JSON document
+	const nlohmann::json* FindKey(const nlohmann::json& data, const std::string& key) {
+		if (data.is_object()) {
+			auto it = data.find(key);
+			if (it != data.end()) {
+				return &(*it);
+			}
+		}
+		if (data.is_object() || data.is_array()) {
+			for (const auto& child : data) {
+				const nlohmann::json* result = FindKey(child, key);
+				if (result != nullptr) {
+					return result;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	struct FrameTimes {
+		double AverageMs = 0.0;
+		double WorstMs = 0.0;
+	};
+
+	// Runs frames of the particle system the way ParticleLayer does, optionally waiting for the
+	// simulation pass to finish after each update the way the old GL_QUERY_RESULT readback did
+	FrameTimes RunFrames(ParticleSystem& system, int frames, bool waitForResult) {
+		FrameTimes result;
+		Stopwatch total;
+		for (int frame = 0; frame < frames; frame++) {
+			Stopwatch timer;
+			system.Update();
+			if (waitForResult) {
+				GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+				glDeleteSync(fence);
+			}
+			system.Render();
+			// Stands in for the buffer swap at the end of a frame
+			glFlush();
+			result.WorstMs = std::max(result.WorstMs, timer.ElapsedMs());
+		}
+		result.AverageMs = total.ElapsedMs() / frames;
+		return result;
+	}
+}
+
+BENCHMARK(Particles_EmitterTestFrameTime) {
+	GlTestContext::Require();
+
+	// The emitter test scene and particle shaders are copied next to the executable by the build
+	std::string sceneText = FileHelpers::ReadFile("scenes/emitter-test.json");
+	REQUIRE(!sceneText.empty());
+	nlohmann::json scene = nlohmann::json::parse(sceneText);
+	const nlohmann::json* blob = FindKey(scene, "ParticleSystem");
+	REQUIRE(blob != nullptr);
+
+	const int frames = 600;
+	for (bool waitForResult : { true, false }) {
+		ParticleSystem::Sptr system = ParticleSystem::FromJson(*blob);
+		system->Awake();
+		// Let the particle count build up before we start timing
+		RunFrames(*system, 120, false);
+		glFinish();
+
+		FrameTimes times = RunFrames(*system, frames, waitForResult);
+		glFinish();
+
+		std::string label = waitForResult ? "Blocking readback" : "Query ring";
+		TestRegistry::Report(label + ", average frame", times.AverageMs, "ms");
+		TestRegistry::Report(label + ", worst frame", times.WorstMs, "ms");
+	}
+}
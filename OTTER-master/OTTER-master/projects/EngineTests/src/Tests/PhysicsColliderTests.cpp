@@ -0,0 +1,162 @@
+#include "TestFramework.h"
+
+#include <filesystem>
+#include <fstream>
+#include <GLFW/glfw3.h>
+#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <BulletCollision/CollisionShapes/btConvexPointCloudShape.h>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Components/RenderComponent.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/Colliders/ConvexMeshCollider.h"
+#include "Gameplay/Physics/Colliders/PlaneCollider.h"
+#include "Utils/MeshFactory.h"
+#include "Utils/GlmBulletConversions.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+namespace fs = std::filesystem;
+
+namespace {
+	/// <summary>
+	/// Releases the current GL context (if an earlier test made one) for as long as it's alive, so that
+	/// any GL call made in the meantime has no context to go to
+	/// </summary>
+	class NoGlContext {
+	public:
+		NoGlContext() : _previous(glfwGetCurrentContext()) {
+			if (_previous != nullptr) {
+				glfwMakeContextCurrent(nullptr);
+			}
+		}
+		~NoGlContext() {
+			if (_previous != nullptr) {
+				glfwMakeContextCurrent(_previous);
+			}
+		}
+	private:
+		GLFWwindow* _previous;
+	};
+
+	// An octahedron with a few points inside it, which the hull should throw away
+	const char* OctahedronObj =
+		"v 1 0 0\nv -1 0 0\nv 0 1 0\nv 0 -1 0\nv 0 0 1\nv 0 0 -1\n"
+		"v 0.1 0.1 0.1\nv -0.2 0 0.3\n"
+		"f 1 3 5\nf 3 2 5\nf 2 4 5\nf 4 1 5\nf 3 1 6\nf 2 3 6\nf 4 2 6\nf 1 4 6\n"
+		"f 7 8 1\n";
+
+	MeshResource::Sptr CreateGeneratedMesh(const MeshBuilderParam& param) {
+		// Only the params are set, GenerateMesh would bake a VAO
+		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->AddParam(param);
+		return result;
+	}
+
+	MeshResource::Sptr CreateFileMesh() {
+		fs::path dir = fs::temp_directory_path() / "otter-collider-test";
+		fs::create_directories(dir);
+		fs::path path = dir / "octahedron.obj";
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << OctahedronObj;
+
+		// The filename constructor would load the mesh onto the GPU, so we set it after the fact
+		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->Filename = path.string();
+		return result;
+	}
+
+	struct Body {
+		GameObject::Sptr Object;
+		ICollider::Sptr  Collider;
+
+		const btConvexPointCloudShape* GetCloud() const {
+			return dynamic_cast<const btConvexPointCloudShape*>(Collider->GetShape());
+		}
+	};
+
+	Body CreateBody(const Scene::Sptr& scene, const MeshResource::Sptr& mesh, const glm::vec3& position) {
+		Body result;
+		result.Object = scene->CreateGameObject("Body");
+		result.Object->SetPostion(position);
+		RenderComponent::Sptr renderer = result.Object->Add<RenderComponent>();
+		renderer->SetMesh(mesh);
+		RigidBody::Sptr body = result.Object->Add<RigidBody>(RigidBodyType::Dynamic);
+		result.Collider = body->AddCollider(ConvexMeshCollider::Create());
+		result.Object->Awake();
+		return result;
+	}
+}
+
+TEST_CASE(PhysicsCollider_HullContainsEveryPoint) {
+	MeshBuilder<VertexPosNormTexColTangents> sphere;
+	MeshFactory::AddParameterized(sphere, MeshBuilderParam::CreateIcoSphere(glm::vec3(0.0f), 1.0f, 4));
+	CollisionMeshData data;
+	for (size_t ix = 0; ix < sphere.GetVertexCount(); ix++) {
+		data.Positions.push_back(sphere.GetVertexDataPtr()[ix].Position);
+	}
+
+	std::shared_ptr<btConvexHullShape> hull = ConvexMeshCollider::BuildHull(data);
+	REQUIRE(hull != nullptr);
+	// The whole point of btShapeHull is to end up with far fewer points than the mesh had
+	CHECK(hull->getNumPoints() > 4);
+	CHECK((size_t)hull->getNumPoints() < data.Positions.size());
+
+	// The simplified hull is sampled from a fixed set of directions so it can cut the corners a little, but in
+	// any direction it should still reach nearly as far as the mesh does
+	size_t outside = 0;
+	for (const glm::vec3& point : data.Positions) {
+		btVector3 direction = ToBt(glm::normalize(point));
+		btScalar reach = hull->localGetSupportingVertexWithoutMargin(direction).dot(direction);
+		outside += reach < direction.dot(ToBt(point)) * 0.85f ? 1 : 0;
+	}
+	CHECK(outside == 0);
+
+	CHECK(ConvexMeshCollider::BuildHull(CollisionMeshData()) == nullptr);
+}
+
+TEST_CASE(PhysicsCollider_BuildsWithoutGlContext) {
+	NoGlContext noContext;
+	ComponentManager::RegisterType<Camera>();
+	ComponentManager::RegisterType<RenderComponent>();
+	ComponentManager::RegisterType<RigidBody>();
+
+	Scene::Sptr scene = std::make_shared<Scene>();
+	GameObject::Sptr ground = scene->CreateGameObject("Ground");
+	ground->Add<RigidBody>(RigidBodyType::Static)->AddCollider(PlaneCollider::Create());
+	ground->Awake();
+
+	MeshResource::Sptr cube = CreateGeneratedMesh(MeshBuilderParam::CreateCube(glm::vec3(0.0f), glm::vec3(1.0f)));
+	MeshResource::Sptr octahedron = CreateFileMesh();
+	Body first = CreateBody(scene, cube, glm::vec3(0.0f, 0.0f, 3.0f));
+	Body second = CreateBody(scene, cube, glm::vec3(5.0f, 0.0f, 3.0f));
+	Body third = CreateBody(scene, octahedron, glm::vec3(-5.0f, 0.0f, 3.0f));
+
+	// Nothing should have been uploaded to the GPU along the way
+	CHECK(cube->Mesh == nullptr);
+	CHECK(octahedron->Mesh == nullptr);
+	CHECK(octahedron->GetCollisionData().Positions.size() >= 6);
+
+	const btConvexPointCloudShape* firstCloud = first.GetCloud();
+	const btConvexPointCloudShape* secondCloud = second.GetCloud();
+	const btConvexPointCloudShape* thirdCloud = third.GetCloud();
+	REQUIRE(firstCloud != nullptr && secondCloud != nullptr && thirdCloud != nullptr);
+	// Bodies using the same mesh share one hull, and only reference it's points
+	CHECK(firstCloud != secondCloud);
+	CHECK(firstCloud->getUnscaledPoints() == secondCloud->getUnscaledPoints());
+	CHECK(firstCloud->getUnscaledPoints() != thirdCloud->getUnscaledPoints());
+	// The octahedron's inner points aren't part of it's hull
+	CHECK(thirdCloud->getNumPoints() >= 4);
+	CHECK(thirdCloud->getNumPoints() <= 6);
+
+	// Let everything settle on the ground, the cube should come to rest on one of it's faces
+	scene->IsPlaying = true;
+	for (int ix = 0; ix < 240; ix++) {
+		scene->DoPhysics(1.0f / 60.0f);
+	}
+	CHECK_NEAR(first.Object->GetPosition().z, 0.5f, 0.1f);
+	CHECK_NEAR(second.Object->GetPosition().z, 0.5f, 0.1f);
+	CHECK(third.Object->GetPosition().z < 1.2f);
+	CHECK(third.Object->GetPosition().z > 0.5f);
+}
@@ -0,0 +1,159 @@
+#include "TestFramework.h"
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/Colliders/PlaneCollider.h"
+#include "Gameplay/Physics/Colliders/SphereCollider.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+
+namespace {
+	// A power of two step, so that frame times made of powers of two add up exactly in the
+	// accumulator, and any difference between runs has to come from the stepping itself
+	const float TestStep = 1.0f / 64.0f;
+
+	struct BodyState {
+		glm::vec3 Position;
+		glm::quat Rotation;
+	};
+
+	// Creates a ground plane with a pile of spheres dropped onto it, with enough sideways
+	// velocity that they bump into each other on the way down
+	Scene::Sptr CreateFallingScene(std::vector<GameObject::Sptr>& bodies) {
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RigidBody>();
+
+		Scene::Sptr scene = std::make_shared<Scene>();
+		scene->SetFixedTimeStep(TestStep);
+		scene->SetMaxSubSteps(4);
+
+		GameObject::Sptr ground = scene->CreateGameObject("Ground");
+		RigidBody::Sptr groundBody = ground->Add<RigidBody>(RigidBodyType::Static);
+		groundBody->AddCollider(PlaneCollider::Create());
+		ground->Awake();
+
+		bodies.clear();
+		for (int ix = 0; ix < 27; ix++) {
+			GameObject::Sptr ball = scene->CreateGameObject("Ball");
+			ball->SetPostion(glm::vec3((ix % 3) * 0.9f, ((ix / 3) % 3) * 0.9f, 1.0f + (ix / 9) * 1.1f));
+			RigidBody::Sptr body = ball->Add<RigidBody>(RigidBodyType::Dynamic);
+			body->AddCollider(SphereCollider::Create(0.5f));
+			body->SetMass(1.0f + (ix % 4));
+			body->SetLinearVelocity(glm::vec3(1.0f - (ix % 3), (ix % 5) * 0.3f - 0.6f, 0.0f));
+			ball->Awake();
+			bodies.push_back(ball);
+		}
+
+		scene->IsPlaying = true;
+		return scene;
+	}
+
+	// Runs the falling scene with the given frame times, and returns where each ball ended up
+	std::vector<BodyState> RunFallingScene(const std::vector<float>& frameTimes) {
+		std::vector<GameObject::Sptr> bodies;
+		Scene::Sptr scene = CreateFallingScene(bodies);
+		for (float dt : frameTimes) {
+			scene->DoPhysics(dt);
+		}
+
+		std::vector<BodyState> result;
+		for (const auto& body : bodies) {
+			result.push_back({ body->GetPosition(), body->GetRotation() });
+		}
+		return result;
+	}
+
+	size_t CountDifferences(const std::vector<BodyState>& a, const std::vector<BodyState>& b) {
+		size_t result = 0;
+		for (size_t ix = 0; ix < a.size(); ix++) {
+			result += (a[ix].Position != b[ix].Position || a[ix].Rotation != b[ix].Rotation) ? 1 : 0;
+		}
+		return result;
+	}
+}
+
+TEST_CASE(PhysicsStep_FrameTimingDoesNotChangeResults) {
+	const int totalSteps = 256;
+
+	// A steady frame rate, exactly one step per frame
+	std::vector<float> steady(totalSteps, TestStep);
+
+	// Fast and slow frames mixed together, including hitches that need several substeps
+	std::vector<float> uneven;
+	const float pattern[] = { TestStep * 0.5f, TestStep * 0.25f, TestStep * 0.25f, TestStep * 3.0f, TestStep * 0.5f, TestStep * 0.5f, TestStep * 4.0f, TestStep };
+	double simulated = 0.0;
+	while (simulated < totalSteps * TestStep) {
+		for (float dt : pattern) {
+			if (simulated + dt <= totalSteps * TestStep) {
+				uneven.push_back(dt);
+				simulated += dt;
+			}
+		}
+	}
+	REQUIRE(simulated == totalSteps * static_cast<double>(TestStep));
+
+	// The same total time, with a single long frame in the middle
+	std::vector<float> hitch(totalSteps - 4, TestStep);
+	hitch[totalSteps / 2] = TestStep * 4.0f;
+	hitch.push_back(TestStep);
+
+	std::vector<BodyState> steadyResult = RunFallingScene(steady);
+	std::vector<BodyState> unevenResult = RunFallingScene(uneven);
+	std::vector<BodyState> hitchResult = RunFallingScene(hitch);
+
+	// Make sure the balls actually did something, otherwise matching would prove nothing
+	size_t moved = 0;
+	for (const BodyState& state : steadyResult) {
+		moved += state.Position.z < 0.6f ? 1 : 0;
+	}
+	CHECK(moved > 0);
+
+	CHECK(CountDifferences(steadyResult, unevenResult) == 0);
+	CHECK(CountDifferences(steadyResult, hitchResult) == 0);
+}
+
+TEST_CASE(PhysicsStep_LeftoverTimeIsInterpolated) {
+	std::vector<GameObject::Sptr> bodies;
+	Scene::Sptr scene = CreateFallingScene(bodies);
+
+	// Less than a step, nothing should be simulated yet
+	scene->DoPhysics(TestStep * 0.5f);
+	CHECK_NEAR(scene->GetPhysicsInterpolation(), 0.5f, 1e-6f);
+
+	scene->DoPhysics(TestStep * 0.75f);
+	CHECK_NEAR(scene->GetPhysicsInterpolation(), 0.25f, 1e-6f);
+
+	// Halfway through a step, a falling ball should be drawn between the two states it's been in
+	glm::vec3 before = bodies[0]->GetPosition();
+	scene->DoPhysics(TestStep * 0.75f);
+	glm::vec3 halfway = bodies[0]->GetPosition();
+	scene->DoPhysics(TestStep * 0.5f);
+	glm::vec3 after = bodies[0]->GetPosition();
+	CHECK(halfway.z < before.z);
+	CHECK(after.z < halfway.z);
+}
+
+TEST_CASE(PhysicsStep_LongFramesAreCapped) {
+	std::vector<GameObject::Sptr> cappedBodies;
+	Scene::Sptr capped = CreateFallingScene(cappedBodies);
+	// A full second in one frame should only run the maximum number of substeps
+	capped->DoPhysics(1.0f);
+
+	std::vector<GameObject::Sptr> steadyBodies;
+	Scene::Sptr steady = CreateFallingScene(steadyBodies);
+	for (int ix = 0; ix < capped->GetMaxSubSteps(); ix++) {
+		steady->DoPhysics(TestStep);
+	}
+
+	size_t differences = 0;
+	for (size_t ix = 0; ix < cappedBodies.size(); ix++) {
+		differences += cappedBodies[ix]->GetPosition() != steadyBodies[ix]->GetPosition() ? 1 : 0;
+	}
+	CHECK(differences == 0);
+	CHECK(capped->GetPhysicsInterpolation() < 1.0f);
+}
@@ -0,0 +1,150 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+
+#include "Utils/JobSystem.h"
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/Colliders/BoxCollider.h"
+#include "Gameplay/Physics/Colliders/PlaneCollider.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+
+namespace {
+	const int StackGrid   = 25;
+	const int StackHeight = 8;
+
+	// 25 x 25 stacks of 8 unit boxes each, 5000 boxes in total, sitting on a ground plane
+	Scene::Sptr CreateStackScene(bool multithreaded, std::vector<GameObject::Sptr>& boxes) {
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RigidBody>();
+
+		Scene::Sptr scene = std::make_shared<Scene>();
+		// Has to happen while the world is still empty
+		scene->SetMultithreadedPhysics(multithreaded);
+
+		GameObject::Sptr ground = scene->CreateGameObject("Ground");
+		ground->Add<RigidBody>(RigidBodyType::Static)->AddCollider(PlaneCollider::Create());
+		ground->Awake();
+
+		boxes.clear();
+		for (int x = 0; x < StackGrid; x++) {
+			for (int y = 0; y < StackGrid; y++) {
+				for (int z = 0; z < StackHeight; z++) {
+					GameObject::Sptr box = scene->CreateGameObject("Box");
+					box->SetPostion(glm::vec3(x * 1.5f, y * 1.5f, 0.5f + z));
+					box->Add<RigidBody>(RigidBodyType::Dynamic)->AddCollider(BoxCollider::Create(glm::vec3(0.5f)));
+					box->Awake();
+					boxes.push_back(box);
+				}
+			}
+		}
+
+		scene->IsPlaying = true;
+		return scene;
+	}
+
+	struct StackResult {
+		size_t BelowGround = 0;
+		size_t Invalid     = 0;
+		float  AverageTop  = 0.0f;
+	};
+
+	StackResult MeasureStacks(const std::vector<GameObject::Sptr>& boxes) {
+		StackResult result;
+		for (size_t ix = 0; ix < boxes.size(); ix++) {
+			glm::vec3 position = boxes[ix]->GetPosition();
+			result.Invalid += glm::any(glm::isnan(position)) ? 1 : 0;
+			result.BelowGround += position.z < 0.4f ? 1 : 0;
+			if (ix % StackHeight == StackHeight - 1) {
+				result.AverageTop += position.z;
+			}
+		}
+		result.AverageTop /= StackGrid * StackGrid;
+		return result;
+	}
+
+	void Step(const Scene::Sptr& scene, int steps) {
+		for (int ix = 0; ix < steps; ix++) {
+			scene->DoPhysics(scene->GetFixedTimeStep());
+		}
+	}
+}
+
+TEST_CASE(PhysicsThreading_StacksSettleLikeSequentialWorld) {
+	REQUIRE(!JobSystem::IsInitialized());
+	JobSystem::Init(std::max(2, (int)std::thread::hardware_concurrency() - 1));
+
+	StackResult results[2];
+	for (bool multithreaded : { false, true }) {
+		std::vector<GameObject::Sptr> boxes;
+		Scene::Sptr scene = CreateStackScene(multithreaded, boxes);
+		bool isMt = dynamic_cast<btDiscreteDynamicsWorldMt*>(scene->GetPhysicsWorld()) != nullptr;
+		CHECK(isMt == multithreaded);
+		CHECK(scene->GetMultithreadedPhysics() == multithreaded);
+
+		// The world can't be swapped out once it has bodies, it stays as it was until the scene is reloaded
+		btDynamicsWorld* world = scene->GetPhysicsWorld();
+		scene->SetMultithreadedPhysics(!multithreaded);
+		CHECK(scene->GetPhysicsWorld() == world);
+		scene->SetMultithreadedPhysics(multithreaded);
+
+		Step(scene, 120);
+		results[multithreaded ? 1 : 0] = MeasureStacks(boxes);
+	}
+	JobSystem::Shutdown();
+
+	// The threaded solver works on islands in a different order so we can't expect identical results,
+	// but the stacks should be standing in both
+	for (const StackResult& result : results) {
+		CHECK(result.Invalid == 0);
+		CHECK(result.BelowGround == 0);
+		CHECK(result.AverageTop > StackHeight - 1.0f);
+	}
+	CHECK_NEAR(results[1].AverageTop, results[0].AverageTop, 0.25f);
+}
+
+BENCHMARK(PhysicsThreading_StepTimeByThreadCount) {
+	REQUIRE(!JobSystem::IsInitialized());
+	const int steps = 60;
+
+	// The thread count includes the calling thread, which runs jobs while it waits on the workers
+	std::vector<int> threadCounts = { 1, 2, 4 };
+	int hardwareThreads = (int)std::thread::hardware_concurrency();
+	if (hardwareThreads > 4) {
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	{
+		std::vector<GameObject::Sptr> boxes;
+		Scene::Sptr scene = CreateStackScene(false, boxes);
+		Step(scene, 10);
+		Stopwatch timer;
+		Step(scene, steps);
+		TestRegistry::Report("5000 boxes, sequential world", timer.ElapsedMs() / steps, "ms/step");
+	}
+
+	for (int threads : threadCounts) {
+		// With no workers the job system runs everything inline
+		if (threads > 1) {
+			JobSystem::Init(threads - 1);
+		}
+		{
+			std::vector<GameObject::Sptr> boxes;
+			Scene::Sptr scene = CreateStackScene(true, boxes);
+			// Let the stacks settle into contact first, so every step has the same amount of work
+			Step(scene, 10);
+			Stopwatch timer;
+			Step(scene, steps);
+			TestRegistry::Report("5000 boxes, multithreaded world, " + std::to_string(threads) + " threads", timer.ElapsedMs() / steps, "ms/step");
+		}
+		if (threads > 1) {
+			JobSystem::Shutdown();
+		}
+	}
+}
@@ -0,0 +1,148 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include "Graphics/RenderQueue.h"
+
+namespace {
+	struct SyntheticDraw {
+		uintptr_t Shader;
+		uintptr_t Material;
+		uintptr_t Vao;
+		float     Depth;
+	};
+
+	// Builds a scene where every material belongs to a single shader, the way Material works in
+	// the engine, with the draws pushed in a random order
+	std::vector<SyntheticDraw> MakeSyntheticScene(size_t count, int shaders, int materialsPerShader, int meshes, uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> shaderDist(0, shaders - 1);
+		std::uniform_int_distribution<int> materialDist(0, materialsPerShader - 1);
+		std::uniform_int_distribution<int> meshDist(0, meshes - 1);
+		std::uniform_real_distribution<float> depthDist(0.1f, 100.0f);
+
+		std::vector<SyntheticDraw> result;
+		result.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			int shader = shaderDist(random);
+			SyntheticDraw draw;
+			// Offset the fake handles so they don't look like dense IDs already
+			draw.Shader   = 1000 + shader;
+			draw.Material = 5000 + shader * materialsPerShader + materialDist(random);
+			draw.Vao      = 9000 + meshDist(random);
+			draw.Depth    = depthDist(random);
+			result.push_back(draw);
+		}
+		return result;
+	}
+
+	void FillQueue(RenderQueue& queue, const std::vector<SyntheticDraw>& draws) {
+		queue.Clear();
+		for (size_t ix = 0; ix < draws.size(); ix++) {
+			const SyntheticDraw& draw = draws[ix];
+			uint64_t key = RenderQueue::MakeKey(
+				queue.GetShaderID(draw.Shader),
+				queue.GetMaterialID(draw.Material),
+				queue.GetVaoID(draw.Vao),
+				draw.Depth, 100.0f);
+			queue.Push(key, static_cast<uint32_t>(ix));
+		}
+	}
+}
+
+TEST_CASE(RenderQueue_SortMatchesStdSort) {
+	std::vector<SyntheticDraw> draws = MakeSyntheticScene(5000, 7, 5, 11, 1234);
+	RenderQueue queue;
+	FillQueue(queue, draws);
+
+	std::vector<RenderQueue::Entry> expected = queue.GetEntries();
+	std::stable_sort(expected.begin(), expected.end(), [](const RenderQueue::Entry& a, const RenderQueue::Entry& b) {
+		return a.Key < b.Key;
+	});
+
+	queue.Sort();
+	REQUIRE(queue.Size() == expected.size());
+	// The radix sort is stable as well, so the payloads should match exactly
+	size_t mismatches = 0;
+	for (size_t ix = 0; ix < expected.size(); ix++) {
+		const RenderQueue::Entry& entry = queue.GetEntries()[ix];
+		mismatches += (entry.Key != expected[ix].Key || entry.Payload != expected[ix].Payload) ? 1 : 0;
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE(RenderQueue_SwitchesAreMinimal) {
+	const int shaders = 3;
+	const int materialsPerShader = 4;
+	const int meshes = 6;
+	std::vector<SyntheticDraw> draws = MakeSyntheticScene(2000, shaders, materialsPerShader, meshes, 42);
+
+	std::set<uintptr_t> usedShaders;
+	std::set<uintptr_t> usedMaterials;
+	std::set<std::tuple<uintptr_t, uintptr_t>> usedMaterialMeshes;
+	for (const SyntheticDraw& draw : draws) {
+		usedShaders.insert(draw.Shader);
+		usedMaterials.insert(draw.Material);
+		usedMaterialMeshes.insert({ draw.Material, draw.Vao });
+	}
+
+	RenderQueue queue;
+	FillQueue(queue, draws);
+	RenderQueue::SwitchStats unsorted = queue.CountSwitches();
+
+	queue.Sort();
+	RenderQueue::SwitchStats sorted = queue.CountSwitches();
+
+	// Every shader and material should only be bound once, and each mesh at most once per material
+	// (less if the last mesh of one material is the first of the next)
+	CHECK(sorted.DrawCalls == draws.size());
+	CHECK(sorted.ProgramSwitches == usedShaders.size());
+	CHECK(sorted.MaterialSwitches == usedMaterials.size());
+	CHECK(sorted.VaoSwitches <= usedMaterialMeshes.size());
+
+	CHECK(sorted.ProgramSwitches < unsorted.ProgramSwitches);
+	CHECK(sorted.MaterialSwitches < unsorted.MaterialSwitches);
+	CHECK(sorted.VaoSwitches < unsorted.VaoSwitches);
+}
+
+TEST_CASE(RenderQueue_DrawsFrontToBackWithinState) {
+	// A single state, so the only thing left to sort on is depth
+	std::vector<SyntheticDraw> draws = MakeSyntheticScene(1000, 1, 1, 1, 7);
+	RenderQueue queue;
+	FillQueue(queue, draws);
+	queue.Sort();
+
+	float lastDepth = 0.0f;
+	size_t outOfOrder = 0;
+	for (const RenderQueue::Entry& entry : queue) {
+		float depth = draws[entry.Payload].Depth;
+		// Depths are quantized to 16 bits, so allow for a single bucket of error
+		outOfOrder += depth + 100.0f / RenderQueue::ID_MASK < lastDepth ? 1 : 0;
+		lastDepth = std::max(lastDepth, depth);
+	}
+	CHECK(outOfOrder == 0);
+
+	RenderQueue::SwitchStats stats = queue.CountSwitches();
+	CHECK(stats.ProgramSwitches == 1);
+	CHECK(stats.MaterialSwitches == 1);
+	CHECK(stats.VaoSwitches == 1);
+}
+
+TEST_CASE(RenderQueue_IdsAreDensePerFrame) {
+	RenderQueue queue;
+	CHECK(queue.GetShaderID(0xDEADBEEF) == 0);
+	CHECK(queue.GetShaderID(0xCAFE) == 1);
+	CHECK(queue.GetShaderID(0xDEADBEEF) == 0);
+
+	uint64_t key = RenderQueue::MakeKey(3, 4, 5, 50.0f, 100.0f);
+	CHECK(RenderQueue::ExtractID(key, RenderQueue::SHADER_SHIFT) == 3);
+	CHECK(RenderQueue::ExtractID(key, RenderQueue::MATERIAL_SHIFT) == 4);
+	CHECK(RenderQueue::ExtractID(key, RenderQueue::VAO_SHIFT) == 5);
+
+	queue.Clear();
+	CHECK(queue.Empty());
+	CHECK(queue.GetShaderID(0xCAFE) == 0);
+}
@@ -0,0 +1,302 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Utils/FileHelpers.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Graphics/Buffers/IndexBuffer.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Textures/Texture1D.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/Texture3D.h"
+#include "Graphics/Textures/TextureCube.h"
+#include "Graphics/Font.h"
+#include "Graphics/Framebuffer.h"
+#include "Gameplay/Material.h"
+#include "Gameplay/MeshResource.h"
+
+using namespace Gameplay;
+
+namespace {
+	// The manifest is copied next to the executable by the build
+	const char* ManifestPath = "emitter-test-manifest.json";
+
+	uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t ix = 0; ix < size; ix++) {
+			hash ^= bytes[ix];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	void RegisterResourceTypes() {
+		// Same list as Application::_RegisterClasses
+		ResourceManager::RegisterType<Texture1D>();
+		ResourceManager::RegisterType<Texture2D>();
+		ResourceManager::RegisterType<Texture3D>();
+		ResourceManager::RegisterType<TextureCube>();
+		ResourceManager::RegisterType<ShaderProgram>();
+		ResourceManager::RegisterType<Material>();
+		ResourceManager::RegisterType<MeshResource>();
+		ResourceManager::RegisterType<Font>();
+		ResourceManager::RegisterType<Framebuffer>();
+	}
+
+	/// <summary>
+	/// Describes every loaded resource by what actually ended up on the GPU, keyed by type and GUID
+	/// </summary>
+	std::map<std::string, std::string> DescribeResources() {
+		std::map<std::string, std::string> result;
+		std::vector<uint8_t> pixels;
+		ResourceManager::Each<Texture2D>([&](const Texture2D::Sptr& texture) {
+			pixels.resize((size_t)texture->GetWidth() * texture->GetHeight() * 4);
+			glGetTextureImage(texture->GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)pixels.size(), pixels.data());
+			result["Texture2D " + texture->GetGUID().str()] =
+				std::to_string(texture->GetWidth()) + "x" + std::to_string(texture->GetHeight()) +
+				" format " + std::to_string((int)texture->GetFormat()) +
+				" pixels " + std::to_string(Fnv1a(pixels.data(), pixels.size()));
+		});
+		ResourceManager::Each<TextureCube>([&](const TextureCube::Sptr& texture) {
+			result["TextureCube " + texture->GetGUID().str()] =
+				std::string(texture->GetHandle() != 0 ? "loaded" : "empty") +
+				" format " + std::to_string((int)texture->GetFormat());
+		});
+		ResourceManager::Each<ShaderProgram>([&](const ShaderProgram::Sptr& shader) {
+			GLint linked = GL_FALSE;
+			if (shader->GetHandle() != 0) {
+				glGetProgramiv(shader->GetHandle(), GL_LINK_STATUS, &linked);
+			}
+			result["ShaderProgram " + shader->GetGUID().str()] = linked == GL_TRUE ? "linked" : "not linked";
+		});
+		ResourceManager::Each<MeshResource>([&](const MeshResource::Sptr& mesh) {
+			std::string description = "no mesh";
+			if (mesh->Mesh != nullptr) {
+				description = std::to_string(mesh->Mesh->GetVertexCount()) + " vertices, " +
+					std::to_string(mesh->Mesh->GetElementCount()) + " elements";
+				IndexBuffer::Sptr indices = mesh->Mesh->GetIndexBuffer();
+				if (indices != nullptr) {
+					std::vector<uint8_t> data(indices->GetTotalSize());
+					glGetNamedBufferSubData(indices->GetHandle(), 0, data.size(), data.data());
+					description += " indices " + std::to_string(Fnv1a(data.data(), data.size()));
+				}
+			}
+			result["MeshResource " + mesh->GetGUID().str()] = description;
+		});
+		ResourceManager::Each<Material>([&](const Material::Sptr& material) {
+			// Materials refer to their shader and textures by GUID, so the JSON covers everything
+			result["Material " + material->GetGUID().str()] = material->ToJson().dump();
+		});
+
+		return result;
+	}
+
+	/// <summary>
+	/// Preloads the manifest with the given number of workers, and describes what came out of it
+	/// </summary>
+	std::map<std::string, std::string> LoadManifestSnapshot(int workers, double* loadMs = nullptr, std::map<std::string, ResourceLoadTiming>* timings = nullptr) {
+		ResourceManager::Init();
+		RegisterResourceTypes();
+		ResourceManager::SetWorkerCount(workers);
+
+		Stopwatch timer;
+		ResourceManager::LoadManifest(ManifestPath, true);
+		ResourceManager::WaitForAll();
+		glFinish();
+		if (loadMs != nullptr) {
+			*loadMs = timer.ElapsedMs();
+		}
+		if (timings != nullptr) {
+			*timings = ResourceManager::GetLoadTimings();
+		}
+
+		std::map<std::string, std::string> result = DescribeResources();
+		ResourceManager::Cleanup();
+		return result;
+	}
+
+	/// <summary>
+	/// Loads the manifest the way it was loaded before preloading was dependency ordered, by requesting
+	/// every entry in manifest order on this thread. Materials end up loading their shaders and textures
+	/// part way through their own load
+	/// </summary>
+	std::map<std::string, std::string> LoadManifestSerialSnapshot(double* loadMs = nullptr) {
+		ResourceManager::Init();
+		RegisterResourceTypes();
+
+		Stopwatch timer;
+		ResourceManager::LoadManifest(ManifestPath);
+		// Loading can add to the manifest, so we walk a copy
+		nlohmann::ordered_json manifest = ResourceManager::GetManifest();
+		for (auto& [typeName, items] : manifest.items()) {
+			if (!items.is_object()) {
+				continue;
+			}
+			for (auto& [guid, data] : items.items()) {
+				Guid id = Guid(guid);
+				if (typeName == "Texture2D") {
+					ResourceManager::Get<Texture2D>(id);
+				} else if (typeName == "TextureCube") {
+					ResourceManager::Get<TextureCube>(id);
+				} else if (typeName == "ShaderProgram") {
+					ResourceManager::Get<ShaderProgram>(id);
+				} else if (typeName == "Gameplay::MeshResource") {
+					ResourceManager::Get<MeshResource>(id);
+				} else if (typeName == "Gameplay::Material") {
+					ResourceManager::Get<Material>(id);
+				}
+			}
+		}
+		ResourceManager::WaitForAll();
+		glFinish();
+		if (loadMs != nullptr) {
+			*loadMs = timer.ElapsedMs();
+		}
+
+		std::map<std::string, std::string> result = DescribeResources();
+		ResourceManager::Cleanup();
+		return result;
+	}
+
+	// Reports every key that is missing from, or different in, the second snapshot
+	size_t CountMismatches(const std::map<std::string, std::string>& expected, const std::map<std::string, std::string>& actual) {
+		size_t result = 0;
+		for (const auto& [key, value] : expected) {
+			auto it = actual.find(key);
+			if (it == actual.end() || it->second != value) {
+				TestRegistry::Fail(__FILE__, __LINE__, key + " differs: " + value + " vs " + (it == actual.end() ? "missing" : it->second), false);
+				result++;
+			}
+		}
+		return result;
+	}
+
+	size_t CountManifestEntries() {
+		nlohmann::json manifest = nlohmann::json::parse(FileHelpers::ReadFile(ManifestPath));
+		size_t result = 0;
+		for (const char* type : { "Texture2D", "TextureCube", "ShaderProgram", "Gameplay::MeshResource", "Gameplay::Material" }) {
+			if (manifest.contains(type) && manifest[type].is_object()) {
+				result += manifest[type].size();
+			}
+		}
+		return result;
+	}
+}
+
+TEST_CASE(ResourceStreaming_WorkerCountDoesNotChangeResults) {
+	GlTestContext::Require();
+
+	std::map<std::string, std::string> serial = LoadManifestSnapshot(1);
+	std::map<std::string, std::string> parallel = LoadManifestSnapshot(std::max(4, (int)std::thread::hardware_concurrency()));
+
+	// Every entry in the manifest should have been loaded, and fully
+	REQUIRE(serial.size() == CountManifestEntries());
+	size_t incomplete = 0;
+	for (const auto& [key, value] : serial) {
+		incomplete += (value == "no mesh" || value == "not linked" || value.rfind("empty", 0) == 0) ? 1 : 0;
+	}
+	CHECK(incomplete == 0);
+
+	CHECK(parallel.size() == serial.size());
+	CHECK(CountMismatches(serial, parallel) == 0);
+}
+
+TEST_CASE(ResourceStreaming_PreloadMatchesSerialLoad) {
+	GlTestContext::Require();
+
+	std::map<std::string, ResourceLoadTiming> timings;
+	std::map<std::string, std::string> serial = LoadManifestSerialSnapshot();
+	std::map<std::string, std::string> preloaded = LoadManifestSnapshot(std::max(4, (int)std::thread::hardware_concurrency()), nullptr, &timings);
+
+	REQUIRE(serial.size() == CountManifestEntries());
+	CHECK(preloaded.size() == serial.size());
+	CHECK(CountMismatches(serial, preloaded) == 0);
+
+	// Every entry should have gone through the preload exactly once. A material loading it's textures part
+	// way through would have pulled them in through Get instead, and they wouldn't be counted
+	size_t timed = 0;
+	for (const auto& [typeName, timing] : timings) {
+		timed += timing.Count;
+	}
+	CHECK(timed == CountManifestEntries());
+	CHECK(timings["Texture2D"].Count > 0);
+	CHECK(timings["Texture2D"].DecodeTime > 0.0f);
+	CHECK(timings["Gameplay::Material"].LoadTime > 0.0f);
+}
+
+TEST_CASE(ResourceStreaming_AsyncHandleWaitsForLoad) {
+	GlTestContext::Require();
+
+	ResourceManager::Init();
+	RegisterResourceTypes();
+	ResourceManager::SetWorkerCount(2);
+	ResourceManager::LoadManifest(ManifestPath);
+
+	nlohmann::ordered_json manifest = ResourceManager::GetManifest();
+	REQUIRE(manifest.contains("Texture2D") && !manifest["Texture2D"].empty());
+	Guid textureId = Guid(manifest["Texture2D"].begin().key());
+
+	// Textures stream, so we should get the placeholder back with the load still in flight
+	ResourceHandle<Texture2D> texture = ResourceManager::GetAsync<Texture2D>(textureId, 10);
+	REQUIRE(texture.IsValid());
+	CHECK(texture.IsReady() == !ResourceManager::IsLoading(texture.Get()));
+
+	// Asking again while it's streaming has to share the same placeholder and request, not start a new load
+	ResourceHandle<Texture2D> again = ResourceManager::GetAsync<Texture2D>(textureId);
+	CHECK(again.Get() == texture.Get());
+	CHECK(ResourceManager::GetPendingLoadCount() <= 1);
+
+	const Texture2D::Sptr& loaded = texture.Wait();
+	CHECK(texture.IsReady());
+	CHECK(again.IsReady());
+	CHECK(!texture.HasFailed());
+	CHECK(!ResourceManager::IsLoading(loaded));
+	CHECK(loaded->GetHandle() != 0);
+	CHECK(loaded->GetWidth() > 0 && loaded->GetHeight() > 0);
+	CHECK(ResourceManager::Get<Texture2D>(textureId) == loaded);
+
+	// Once loaded, handles are ready right away
+	CHECK(ResourceManager::GetAsync<Texture2D>(textureId).IsReady());
+
+	// Types that don't stream are loaded before GetAsync returns
+	REQUIRE(manifest.contains("Gameplay::Material") && !manifest["Gameplay::Material"].empty());
+	ResourceHandle<Material> material = ResourceManager::GetAsync<Material>(Guid(manifest["Gameplay::Material"].begin().key()));
+	CHECK(material.IsValid());
+	CHECK(material.IsReady());
+
+	// Unknown resources give back an invalid handle
+	ResourceHandle<Texture2D> missing = ResourceManager::GetAsync<Texture2D>(Guid::New());
+	CHECK(!missing.IsValid());
+	CHECK(!missing);
+
+	ResourceManager::WaitForAll();
+	ResourceManager::Cleanup();
+}
+
+BENCHMARK(ResourceStreaming_ManifestLoadTime) {
+	GlTestContext::Require();
+
+	// Load once up front so the file cache is warm for both runs
+	LoadManifestSnapshot(1);
+
+	int workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	double lazyMs = 0.0, serialMs = 0.0, parallelMs = 0.0;
+	LoadManifestSerialSnapshot(&lazyMs);
+	LoadManifestSnapshot(1, &serialMs);
+	std::map<std::string, ResourceLoadTiming> timings;
+	LoadManifestSnapshot(workers, &parallelMs, &timings);
+
+	TestRegistry::Report("Emitter test manifest, loaded on request", lazyMs, "ms");
+	TestRegistry::Report("Emitter test manifest, 1 worker", serialMs, "ms");
+	TestRegistry::Report("Emitter test manifest, " + std::to_string(workers) + " workers", parallelMs, "ms");
+	for (const auto& [typeName, timing] : timings) {
+		TestRegistry::Report(typeName + ", decode", timing.DecodeTime * 1000.0, "ms");
+		TestRegistry::Report(typeName + ", GPU", timing.FinalizeTime * 1000.0, "ms");
+		TestRegistry::Report(typeName + ", main thread load", timing.LoadTime * 1000.0, "ms");
+	}
+}
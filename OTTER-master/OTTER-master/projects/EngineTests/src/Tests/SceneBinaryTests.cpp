@@ -0,0 +1,203 @@
+#include "TestFramework.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+
+#include <Logging.h>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+#include "Utils/FileHelpers.h"
+
+using namespace Gameplay;
+namespace fs = std::filesystem;
+
+namespace {
+	fs::path GetTestDirectory() {
+		fs::path dir = fs::temp_directory_path() / "otter-scene-test";
+		fs::create_directories(dir);
+		return dir;
+	}
+
+	// Creates a scene with count objects in a random hierarchy, with random transforms, some shared
+	// names and a component on every few objects, so that every part of the format gets used
+	Scene::Sptr CreateTestScene(size_t count) {
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RotatingBehaviour>();
+
+		Scene::Sptr scene = std::make_shared<Scene>();
+		scene->SetAmbientLight(glm::vec3(0.1f, 0.2f, 0.3f));
+		std::vector<GameObject::Sptr> objects;
+		objects.reserve(count);
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> range(-100.0f, 100.0f);
+		for (size_t ix = 0; ix < count; ix++) {
+			GameObject::Sptr object = scene->CreateGameObject(ix % 7 == 0 ? "Shared Name" : "Object " + std::to_string(ix));
+			object->SetPostion(glm::vec3(range(random), range(random), range(random)));
+			object->SetRotation(glm::vec3(range(random), range(random), range(random)));
+			object->SetScale(glm::vec3(1.0f + ix % 3, 1.0f, 0.5f));
+			object->HideInHierarchy = ix % 11 == 0;
+			if (ix % 5 == 0) {
+				RotatingBehaviour::Sptr rotate = object->Add<RotatingBehaviour>();
+				rotate->RotationSpeed = glm::vec3(0.0f, 0.0f, range(random));
+			}
+			if (ix % 16 != 0) {
+				std::uniform_int_distribution<size_t> parent(0, objects.size() - 1);
+				objects[parent(random)]->AddChild(object);
+			}
+			objects.push_back(object);
+		}
+		return scene;
+	}
+
+	// Makes a copy of a binary scene with the given bytes changed, and tries to load it
+	Scene::Sptr LoadModified(const std::vector<char>& original, const std::function<void(std::vector<char>&)>& modify) {
+		std::vector<char> data = original;
+		modify(data);
+		fs::path path = GetTestDirectory() / "modified.bscene";
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(data.data(), data.size());
+		}
+		return Scene::LoadBinary(path.string());
+	}
+
+	/// <summary>
+	/// Raises the log level while alive, so that the loader's expected warnings don't bury the test output
+	/// </summary>
+	class QuietLog {
+	public:
+		QuietLog() : _level(Logger::GetLogger()->level()) { Logger::GetLogger()->set_level(spdlog::level::err); }
+		~QuietLog() { Logger::GetLogger()->set_level(_level); }
+	private:
+		spdlog::level::level_enum _level;
+	};
+}
+
+TEST_CASE(SceneBinary_RoundTripMatchesJson) {
+	Scene::Sptr original = CreateTestScene(500);
+	fs::path path = GetTestDirectory() / "round-trip.bscene";
+	REQUIRE(original->SaveBinary(path.string()));
+
+	QuietLog quiet;
+	Scene::Sptr loaded = Scene::LoadBinary(path.string());
+	REQUIRE(loaded != nullptr);
+	REQUIRE(loaded->NumObjects() == original->NumObjects());
+
+	// The binary loader has to produce exactly what the JSON writer would have written
+	CHECK(loaded->ToJson() == original->ToJson());
+
+	size_t wrongParents = 0;
+	size_t wrongOrder = 0;
+	for (int ix = 0; ix < original->NumObjects(); ix++) {
+		GameObject::Sptr source = original->GetObjectByIndex(ix);
+		GameObject::Sptr copy = loaded->FindObjectByGUID(source->GetGUID());
+		// Parents are linked by index, so the loaded objects have to come back in the same order
+		wrongOrder += loaded->GetObjectByIndex(ix)->GetGUID() != source->GetGUID() ? 1 : 0;
+		if (copy == nullptr) {
+			wrongParents++;
+			continue;
+		}
+		GameObject::Sptr sourceParent = source->GetParent();
+		GameObject::Sptr copyParent = copy->GetParent();
+		wrongParents += (sourceParent == nullptr) != (copyParent == nullptr) ? 1 : 0;
+		if (sourceParent != nullptr && copyParent != nullptr) {
+			wrongParents += copyParent->GetGUID() != sourceParent->GetGUID() ? 1 : 0;
+		}
+	}
+	CHECK(wrongOrder == 0);
+	CHECK(wrongParents == 0);
+	CHECK(loaded->MainCamera != nullptr);
+	CHECK(loaded->GetAmbientLight() == original->GetAmbientLight());
+}
+
+TEST_CASE(SceneBinary_SaveWritesNewerBinaryCopy) {
+	Scene::Sptr scene = CreateTestScene(10);
+	fs::path jsonPath = GetTestDirectory() / "copy.json";
+	fs::path binaryPath = Scene::GetBinaryPath(jsonPath.string());
+	fs::remove(binaryPath);
+
+	QuietLog quiet;
+	scene->Save(jsonPath.string(), true);
+	REQUIRE(fs::exists(jsonPath));
+	REQUIRE(fs::exists(binaryPath));
+	// Application::LoadScene only prefers the binary copy while it's at least as new as the JSON
+	CHECK(fs::last_write_time(binaryPath) >= fs::last_write_time(jsonPath));
+	CHECK(binaryPath.extension() == ".bscene");
+
+	Scene::Sptr fromJson = Scene::Load(jsonPath.string());
+	Scene::Sptr fromBinary = Scene::Load(binaryPath.string());
+	REQUIRE(fromJson != nullptr);
+	REQUIRE(fromBinary != nullptr);
+	CHECK(fromJson->ToJson() == fromBinary->ToJson());
+}
+
+TEST_CASE(SceneBinary_RejectsDamagedFiles) {
+	fs::path path = GetTestDirectory() / "damaged-source.bscene";
+	REQUIRE(CreateTestScene(50)->SaveBinary(path.string()));
+	std::string contents = FileHelpers::ReadFile(path.string());
+	std::vector<char> original(contents.begin(), contents.end());
+	REQUIRE(original.size() > 64);
+
+	QuietLog quiet;
+	CHECK(LoadModified(original, [](std::vector<char>&) {}) != nullptr);
+	CHECK(LoadModified(original, [](std::vector<char>& data) { data[0] = 'X'; }) == nullptr);
+	// The version follows the 4 byte magic
+	CHECK(LoadModified(original, [](std::vector<char>& data) { data[4] ^= 0x7F; }) == nullptr);
+	CHECK(LoadModified(original, [](std::vector<char>& data) { data.clear(); }) == nullptr);
+
+	// The string and object counts follow the version. Counts far bigger than the file must be rejected
+	// before anything is allocated for them, instead of throwing out of the loader
+	for (size_t countOffset : { 8, 12 }) {
+		CHECK(LoadModified(original, [countOffset](std::vector<char>& data) { memset(&data[countOffset], 0xFF, sizeof(uint32_t)); }) == nullptr);
+		CHECK(LoadModified(original, [countOffset](std::vector<char>& data) { data[countOffset + 3] = 0x40; }) == nullptr);
+	}
+
+	// Cutting the file off anywhere must fail cleanly, rather than reading past the end
+	size_t accepted = 0;
+	size_t step = std::max<size_t>(1, original.size() / 200);
+	for (size_t size = 0; size < original.size(); size += step) {
+		accepted += LoadModified(original, [size](std::vector<char>& data) { data.resize(size); }) != nullptr ? 1 : 0;
+	}
+	CHECK(accepted == 0);
+}
+
+BENCHMARK(SceneBinary_LoadLargeScene) {
+	const size_t count = 50000;
+	Scene::Sptr scene = CreateTestScene(count);
+	fs::path jsonPath = GetTestDirectory() / "large.json";
+	fs::path binaryPath = GetTestDirectory() / "large.bscene";
+
+	QuietLog quiet;
+	Stopwatch timer;
+	scene->Save(jsonPath.string());
+	double jsonSaveMs = timer.ElapsedMs();
+	timer.Restart();
+	scene->SaveBinary(binaryPath.string());
+	double binarySaveMs = timer.ElapsedMs();
+	scene = nullptr;
+
+	timer.Restart();
+	Scene::Sptr fromJson = Scene::Load(jsonPath.string());
+	double jsonLoadMs = timer.ElapsedMs();
+	timer.Restart();
+	Scene::Sptr fromBinary = Scene::LoadBinary(binaryPath.string());
+	double binaryLoadMs = timer.ElapsedMs();
+
+	REQUIRE(fromJson != nullptr);
+	REQUIRE(fromBinary != nullptr);
+	CHECK(fromJson->NumObjects() == (int)count + 1);
+	CHECK(fromBinary->NumObjects() == fromJson->NumObjects());
+
+	TestRegistry::Report("JSON file size, 50k objects", fs::file_size(jsonPath) / (1024.0 * 1024.0), "MB");
+	TestRegistry::Report("Binary file size, 50k objects", fs::file_size(binaryPath) / (1024.0 * 1024.0), "MB");
+	TestRegistry::Report("JSON save", jsonSaveMs, "ms");
+	TestRegistry::Report("Binary save", binarySaveMs, "ms");
+	TestRegistry::Report("JSON load", jsonLoadMs, "ms");
+	TestRegistry::Report("Binary load", binaryLoadMs, "ms");
+	TestRegistry::Report("Load speedup", jsonLoadMs / binaryLoadMs, "x");
+}
@@ -0,0 +1,146 @@
+#include "TestFramework.h"
+
+#include <random>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+
+using namespace Gameplay;
+
+namespace {
+	// Creates a scene with count objects, each parented to a random object created before it
+	Scene::Sptr CreateHierarchyScene(size_t count) {
+		ComponentManager::RegisterType<Camera>();
+
+		Scene::Sptr scene = std::make_shared<Scene>();
+		std::vector<GameObject::Sptr> objects;
+		objects.reserve(count);
+		std::mt19937 random(42);
+		for (size_t ix = 0; ix < count; ix++) {
+			GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix));
+			// Leave every 16th object at the root, so we get a forest instead of a single deep tree
+			if (ix % 16 != 0) {
+				std::uniform_int_distribution<size_t> parent(0, objects.size() - 1);
+				objects[parent(random)]->AddChild(object);
+			}
+			objects.push_back(object);
+		}
+		return scene;
+	}
+
+	// How WeakRef resolution found objects before the index, kept here so the benchmark can compare against it
+	GameObject::Sptr FindByLinearScan(const Scene& scene, const Guid& id) {
+		for (int ix = 0; ix < scene.NumObjects(); ix++) {
+			GameObject::Sptr object = scene.GetObjectByIndex(ix);
+			if (object->GetGUID() == id) {
+				return object;
+			}
+		}
+		return nullptr;
+	}
+}
+
+TEST_CASE(SceneIndex_FindsCreatedObjects) {
+	Scene::Sptr scene = CreateHierarchyScene(500);
+
+	size_t wrongGuid = 0, wrongName = 0;
+	for (int ix = 0; ix < scene->NumObjects(); ix++) {
+		GameObject::Sptr object = scene->GetObjectByIndex(ix);
+		wrongGuid += scene->FindObjectByGUID(object->GetGUID()) != object ? 1 : 0;
+		wrongName += scene->FindObjectByName(object->GetName()) != object ? 1 : 0;
+	}
+	CHECK(wrongGuid == 0);
+	CHECK(wrongName == 0);
+	CHECK(scene->FindObjectByGUID(Guid::New()) == nullptr);
+	CHECK(scene->FindObjectByName("Not in the scene") == nullptr);
+}
+
+TEST_CASE(SceneIndex_FollowsRenamesAndRemoval) {
+	Scene::Sptr scene = CreateHierarchyScene(100);
+	GameObject::Sptr object = scene->FindObjectByName("Object 50");
+	REQUIRE(object != nullptr);
+	Guid id = object->GetGUID();
+
+	object->SetName("Renamed");
+	CHECK(scene->FindObjectByName("Object 50") == nullptr);
+	CHECK(scene->FindObjectByName("Renamed") == object);
+
+	// Objects with a shared name should still be found until the last of them is gone
+	GameObject::Sptr duplicate = scene->CreateGameObject("Renamed");
+	scene->RemoveGameObject(object);
+	// Removal is deferred until the next update
+	CHECK(scene->FindObjectByGUID(id) == object);
+	scene->Update(0.0f);
+	CHECK(scene->FindObjectByGUID(id) == nullptr);
+	CHECK(scene->FindObjectByName("Renamed") == duplicate);
+
+	scene->RemoveGameObject(duplicate);
+	scene->Update(0.0f);
+	CHECK(scene->FindObjectByName("Renamed") == nullptr);
+}
+
+TEST_CASE(SceneIndex_LoadedSceneResolvesReferences) {
+	Scene::Sptr original = CreateHierarchyScene(2000);
+	Scene::Sptr loaded = Scene::FromJson(original->ToJson());
+	REQUIRE(loaded->NumObjects() == original->NumObjects());
+
+	// Every parent reference should resolve to the loaded copy of the same object
+	size_t badParents = 0, badLookups = 0;
+	for (int ix = 0; ix < original->NumObjects(); ix++) {
+		GameObject::Sptr source = original->GetObjectByIndex(ix);
+		GameObject::Sptr copy = loaded->FindObjectByGUID(source->GetGUID());
+		if (copy == nullptr) {
+			badLookups++;
+			continue;
+		}
+		badLookups += loaded->FindObjectByName(source->GetName()) != copy ? 1 : 0;
+
+		GameObject::Sptr sourceParent = source->GetParent();
+		GameObject::Sptr copyParent = copy->GetParent();
+		if (sourceParent == nullptr) {
+			badParents += copyParent != nullptr ? 1 : 0;
+		} else {
+			badParents += (copyParent == nullptr || copyParent->GetGUID() != sourceParent->GetGUID() || copyParent->GetScene() != loaded.get()) ? 1 : 0;
+		}
+	}
+	CHECK(badLookups == 0);
+	CHECK(badParents == 0);
+	CHECK(loaded->MainCamera != nullptr);
+}
+
+BENCHMARK(SceneIndex_LoadLargeScene) {
+	const size_t count = 20000;
+	nlohmann::json data = CreateHierarchyScene(count)->ToJson();
+
+	Stopwatch timer;
+	Scene::Sptr loaded = Scene::FromJson(data);
+	double loadMs = timer.ElapsedMs();
+	REQUIRE(loaded->NumObjects() == (int)count + 1);
+
+	// Resolve the same parent references the way the loader used to, by searching the object list
+	timer.Restart();
+	size_t found = 0;
+	for (const auto& object : data["objects"]) {
+		std::string parent = object["parent"];
+		if (parent != "null") {
+			found += FindByLinearScan(*loaded, Guid(parent)) != nullptr ? 1 : 0;
+		}
+	}
+	double scanMs = timer.ElapsedMs();
+
+	// And once more through the index, to show the per-lookup difference
+	timer.Restart();
+	size_t indexed = 0;
+	for (const auto& object : data["objects"]) {
+		std::string parent = object["parent"];
+		if (parent != "null") {
+			indexed += loaded->FindObjectByGUID(Guid(parent)) != nullptr ? 1 : 0;
+		}
+	}
+	double indexMs = timer.ElapsedMs();
+	CHECK(found == indexed);
+
+	TestRegistry::Report("Scene::FromJson, 20k objects", loadMs, "ms");
+	TestRegistry::Report("Parent lookups by linear scan (old path)", scanMs, "ms");
+	TestRegistry::Report("Parent lookups by GUID index", indexMs, "ms");
+}
@@ -0,0 +1,212 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Graphics/ShaderProgram.h"
+
+namespace {
+	const char* TestVertexShader = R"(
+		#version 450
+		layout (location = 0) in vec3 inPosition;
+		uniform mat4 u_Transform;
+		void main() { gl_Position = u_Transform * vec4(inPosition, 1.0); }
+	)";
+	const char* TestFragmentShader = R"(
+		#version 450
+		layout (location = 0) out vec4 outColor;
+		uniform vec4 u_Color;
+		void main() { outColor = u_Color; }
+	)";
+
+	// Mirrors the header in ShaderProgram.cpp, so that we can write files that pass validation
+	// but contain a binary the driver will refuse
+	struct ProgramBinaryHeader {
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Format;
+		uint32_t Length;
+		uint64_t Checksum;
+	};
+
+	uint64_t Fnv1a(const char* data, size_t size) {
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (size_t ix = 0; ix < size; ix++) {
+			hash ^= static_cast<uint8_t>(data[ix]);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// Points the cache at an empty folder, so earlier runs can't affect the test
+	std::filesystem::path ResetCacheDirectory() {
+		std::filesystem::path dir = std::filesystem::temp_directory_path() / "otter-shader-cache-test";
+		std::filesystem::remove_all(dir);
+		std::filesystem::create_directories(dir);
+		ShaderProgram::SetBinaryCacheEnabled(true);
+		ShaderProgram::SetBinaryCacheDirectory(dir.string());
+		return dir;
+	}
+
+	std::vector<std::filesystem::path> ListCacheFiles(const std::filesystem::path& dir) {
+		std::vector<std::filesystem::path> result;
+		for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+			result.push_back(entry.path());
+		}
+		return result;
+	}
+
+	std::string ReadBytes(const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void WriteBytes(const std::filesystem::path& path, const std::string& data) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+	}
+
+	ShaderProgram::Sptr LinkTestProgram() {
+		ShaderProgram::Sptr result = ShaderProgram::Create();
+		result->LoadShaderPart(TestVertexShader, ShaderPartType::Vertex);
+		result->LoadShaderPart(TestFragmentShader, ShaderPartType::Fragment);
+		CHECK(result->Link());
+		return result;
+	}
+
+	// Checks that a program is actually usable, whichever path it was linked with
+	void CheckProgramIsValid(const ShaderProgram::Sptr& program) {
+		GLint status = GL_FALSE;
+		glGetProgramiv(program->GetHandle(), GL_LINK_STATUS, &status);
+		CHECK(status == GL_TRUE);
+		CHECK(glGetUniformLocation(program->GetHandle(), "u_Color") >= 0);
+		CHECK(glGetUniformLocation(program->GetHandle(), "u_Transform") >= 0);
+	}
+
+	// Populates the cache, then checks that a program linked after corrupting the file falls
+	// back to compiling from source and writes a good cache file again
+	void CheckCorruptionFallsBack(const char* description, const std::function<std::string(const std::string&)>& corrupt) {
+		std::filesystem::path dir = ResetCacheDirectory();
+		LinkTestProgram();
+		std::vector<std::filesystem::path> files = ListCacheFiles(dir);
+		REQUIRE(files.size() == 1);
+
+		WriteBytes(files[0], corrupt(ReadBytes(files[0])));
+
+		ShaderProgram::Sptr program = LinkTestProgram();
+		if (program->WasLoadedFromCache()) {
+			TestRegistry::Fail(__FILE__, __LINE__, std::string("corrupted cache was used: ") + description, false);
+		}
+		CheckProgramIsValid(program);
+
+		// The bad file should have been replaced with a fresh binary
+		ShaderProgram::Sptr reloaded = LinkTestProgram();
+		CHECK(reloaded->WasLoadedFromCache());
+		CheckProgramIsValid(reloaded);
+	}
+}
+
+TEST_CASE(ShaderCache_RoundTrip) {
+	GlTestContext::Require();
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	if (numFormats == 0) {
+		TestRegistry::Skip("driver does not support program binaries");
+	}
+
+	std::filesystem::path dir = ResetCacheDirectory();
+	ShaderProgram::Sptr first = LinkTestProgram();
+	CHECK(!first->WasLoadedFromCache());
+	CHECK(ListCacheFiles(dir).size() == 1);
+
+	ShaderProgram::Sptr second = LinkTestProgram();
+	CHECK(second->WasLoadedFromCache());
+	CheckProgramIsValid(second);
+
+	// Changing the source has to miss the cache
+	ShaderProgram::Sptr changed = ShaderProgram::Create();
+	changed->LoadShaderPart(TestVertexShader, ShaderPartType::Vertex);
+	changed->LoadShaderPart("#version 450\nlayout (location = 0) out vec4 outColor;\nuniform vec4 u_Color;\nvoid main() { outColor = u_Color * 0.5; }\n", ShaderPartType::Fragment);
+	CHECK(changed->Link());
+	CHECK(!changed->WasLoadedFromCache());
+	CHECK(ListCacheFiles(dir).size() == 2);
+}
+
+TEST_CASE(ShaderCache_CorruptedFilesFallBack) {
+	GlTestContext::Require();
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	if (numFormats == 0) {
+		TestRegistry::Skip("driver does not support program binaries");
+	}
+
+	CheckCorruptionFallsBack("empty file", [](const std::string&) {
+		return std::string();
+	});
+	CheckCorruptionFallsBack("truncated header", [](const std::string& data) {
+		return data.substr(0, sizeof(ProgramBinaryHeader) / 2);
+	});
+	CheckCorruptionFallsBack("truncated binary", [](const std::string& data) {
+		return data.substr(0, data.size() - 1);
+	});
+	CheckCorruptionFallsBack("bad magic", [](const std::string& data) {
+		std::string result = data;
+		result[0] ^= 0xFF;
+		return result;
+	});
+	CheckCorruptionFallsBack("flipped byte in binary", [](const std::string& data) {
+		std::string result = data;
+		result[sizeof(ProgramBinaryHeader) + (data.size() - sizeof(ProgramBinaryHeader)) / 2] ^= 0x5A;
+		return result;
+	});
+	CheckCorruptionFallsBack("random garbage", [](const std::string& data) {
+		std::string result = data;
+		for (size_t ix = 0; ix < result.size(); ix++) {
+			result[ix] = static_cast<char>(ix * 131 + 7);
+		}
+		return result;
+	});
+	// Passes all of our own checks, so this is caught by GL_LINK_STATUS after glProgramBinary
+	CheckCorruptionFallsBack("valid header with a garbage binary", [](const std::string& data) {
+		std::string result = data;
+		ProgramBinaryHeader header;
+		memcpy(&header, result.data(), sizeof(ProgramBinaryHeader));
+		for (size_t ix = sizeof(ProgramBinaryHeader); ix < result.size(); ix++) {
+			result[ix] = static_cast<char>(ix * 17);
+		}
+		header.Checksum = Fnv1a(result.data() + sizeof(ProgramBinaryHeader), header.Length);
+		memcpy(&result[0], &header, sizeof(ProgramBinaryHeader));
+		return result;
+	});
+}
+
+BENCHMARK(ShaderCache_LinkTime) {
+	GlTestContext::Require();
+
+	const int iterations = 20;
+	ShaderProgram::SetBinaryCacheEnabled(false);
+	Stopwatch timer;
+	for (int ix = 0; ix < iterations; ix++) {
+		LinkTestProgram();
+	}
+	glFinish();
+	double sourceMs = timer.ElapsedMs() / iterations;
+
+	ResetCacheDirectory();
+	LinkTestProgram();
+	timer.Restart();
+	for (int ix = 0; ix < iterations; ix++) {
+		LinkTestProgram();
+	}
+	glFinish();
+	double cachedMs = timer.ElapsedMs() / iterations;
+
+	TestRegistry::Report("Link from source", sourceMs, "ms");
+	TestRegistry::Report("Link from binary cache", cachedMs, "ms");
+}
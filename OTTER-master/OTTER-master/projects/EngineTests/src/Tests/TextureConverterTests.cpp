@@ -0,0 +1,334 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+#include "BlockEncoder.h"
+#include "Ktx2Writer.h"
+#include "MipChain.h"
+#include "Graphics/Textures/CompressedImage.h"
+
+namespace fs = std::filesystem;
+
+// None of these tests create a GL context, the converter and CompressedImage have to work headless
+
+namespace {
+	// Reference decoders, written from the format specs so the tests don't just check the
+	// encoders against themselves. Each writes 16 RGBA8 pixels in the same order EncodeBlock reads them
+
+	void Expand565(uint16_t color, uint8_t out[3]) {
+		uint8_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		out[0] = (uint8_t)((r << 3) | (r >> 2));
+		out[1] = (uint8_t)((g << 2) | (g >> 4));
+		out[2] = (uint8_t)((b << 3) | (b >> 2));
+	}
+
+	void DecodeBC1(const uint8_t block[8], uint8_t rgba[64]) {
+		uint16_t c0 = block[0] | (block[1] << 8);
+		uint16_t c1 = block[2] | (block[3] << 8);
+		uint8_t palette[4][4] = {};
+		Expand565(c0, palette[0]);
+		Expand565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			if (c0 > c1) {
+				palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+				palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+			} else {
+				palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+				palette[3][c] = 0;
+			}
+		}
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = c0 > c1 ? 255 : 0;
+
+		uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+		for (int ix = 0; ix < 16; ix++) {
+			memcpy(rgba + ix * 4, palette[(indices >> (ix * 2)) & 3], 4);
+		}
+	}
+
+	void DecodeBC4(const uint8_t block[8], uint8_t* values, size_t stride) {
+		int a0 = block[0], a1 = block[1];
+		int palette[8] = { a0, a1 };
+		if (a0 > a1) {
+			for (int ix = 1; ix < 7; ix++) {
+				palette[ix + 1] = ((7 - ix) * a0 + ix * a1) / 7;
+			}
+		} else {
+			for (int ix = 1; ix < 5; ix++) {
+				palette[ix + 1] = ((5 - ix) * a0 + ix * a1) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (int ix = 0; ix < 6; ix++) {
+			indices |= (uint64_t)block[2 + ix] << (ix * 8);
+		}
+		for (int ix = 0; ix < 16; ix++) {
+			values[ix * stride] = (uint8_t)palette[(indices >> (ix * 3)) & 7];
+		}
+	}
+
+	// Reads bits out of a block, least significant bit first
+	struct BitReader {
+		const uint8_t* Data;
+		int Position = 0;
+		uint32_t Read(int count) {
+			uint32_t result = 0;
+			for (int ix = 0; ix < count; ix++, Position++) {
+				result |= ((Data[Position / 8] >> (Position % 8)) & 1u) << ix;
+			}
+			return result;
+		}
+	};
+
+	// Only handles mode 6, which is the only mode the encoder writes. Returns false for anything else
+	bool DecodeBC7(const uint8_t block[16], uint8_t rgba[64]) {
+		BitReader bits{ block };
+		if (bits.Read(7) != (1u << 6)) {
+			return false;
+		}
+		uint32_t endpoints[2][4];
+		for (int c = 0; c < 4; c++) {
+			endpoints[0][c] = bits.Read(7);
+			endpoints[1][c] = bits.Read(7);
+		}
+		uint32_t p0 = bits.Read(1), p1 = bits.Read(1);
+		for (int c = 0; c < 4; c++) {
+			endpoints[0][c] = (endpoints[0][c] << 1) | p0;
+			endpoints[1][c] = (endpoints[1][c] << 1) | p1;
+		}
+
+		const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (int ix = 0; ix < 16; ix++) {
+			// The anchor index has an implied leading 0 bit
+			uint32_t index = bits.Read(ix == 0 ? 3 : 4);
+			for (int c = 0; c < 4; c++) {
+				rgba[ix * 4 + c] = (uint8_t)(((64 - weights[index]) * endpoints[0][c] + weights[index] * endpoints[1][c] + 32) >> 6);
+			}
+		}
+		return true;
+	}
+
+	void DecodeBlock(BlockFormat format, const uint8_t* block, uint8_t rgba[64]) {
+		memset(rgba, 0, 64);
+		switch (format) {
+			case BlockFormat::BC1:
+				DecodeBC1(block, rgba);
+				break;
+			case BlockFormat::BC3:
+				// Alpha goes second, since DecodeBC1 writes opaque alpha
+				DecodeBC1(block + 8, rgba);
+				DecodeBC4(block, rgba + 3, 4);
+				break;
+			case BlockFormat::BC4:
+				DecodeBC4(block, rgba, 4);
+				break;
+			case BlockFormat::BC5:
+				DecodeBC4(block, rgba, 4);
+				DecodeBC4(block + 8, rgba + 1, 4);
+				break;
+			case BlockFormat::BC7:
+				DecodeBC7(block, rgba);
+				break;
+		}
+	}
+
+	// The channels each format actually stores
+	int GetChannelCount(BlockFormat format) {
+		switch (format) {
+			case BlockFormat::BC1: return 3;
+			case BlockFormat::BC4: return 1;
+			case BlockFormat::BC5: return 2;
+			default:               return 4;
+		}
+	}
+
+	// A smooth image with some noise and hard edges in it, so the encoders have to pick good
+	// endpoints rather than getting away with a flat color per block
+	MipChain::Image CreateTestImage(uint32_t width, uint32_t height) {
+		MipChain::Image result;
+		result.Width = width;
+		result.Height = height;
+		result.Pixels.resize(width * height * 4);
+		std::mt19937 random(7);
+		std::uniform_int_distribution<int> noise(-6, 6);
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				uint8_t* pixel = &result.Pixels[(y * width + x) * 4];
+				bool edge = ((x / 13) + (y / 9)) % 5 == 0;
+				int values[4] = {
+					(int)(x * 255 / width) + noise(random),
+					(int)(y * 255 / height) + noise(random),
+					edge ? 220 : (int)(128 + 100 * std::sin(x * 0.05f + y * 0.03f)),
+					(int)((x + y) * 255 / (width + height))
+				};
+				for (int c = 0; c < 4; c++) {
+					pixel[c] = (uint8_t)std::clamp(values[c], 0, 255);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Decodes every block of a level, and returns the root mean square error over the stored channels
+	double MeasureError(const MipChain::Image& image, const Ktx2Writer::Level& level, BlockFormat format) {
+		const uint32_t blocksX = (image.Width + 3) / 4;
+		const size_t blockSize = BlockEncoder::GetBlockSize(format);
+		const int channels = GetChannelCount(format);
+		double sum = 0.0;
+		size_t count = 0;
+		uint8_t decoded[64];
+		for (uint32_t y = 0; y < image.Height; y++) {
+			for (uint32_t x = 0; x < image.Width; x++) {
+				DecodeBlock(format, level.Blocks.data() + ((y / 4) * blocksX + (x / 4)) * blockSize, decoded);
+				const uint8_t* actual = decoded + ((y % 4) * 4 + (x % 4)) * 4;
+				const uint8_t* expected = &image.Pixels[(y * image.Width + x) * 4];
+				for (int c = 0; c < channels; c++) {
+					double diff = (double)actual[c] - expected[c];
+					sum += diff * diff;
+					count++;
+				}
+			}
+		}
+		return std::sqrt(sum / count);
+	}
+
+	const BlockFormat AllFormats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+
+	const char* GetFormatName(BlockFormat format) {
+		switch (format) {
+			case BlockFormat::BC1: return "BC1";
+			case BlockFormat::BC3: return "BC3";
+			case BlockFormat::BC4: return "BC4";
+			case BlockFormat::BC5: return "BC5";
+			case BlockFormat::BC7: return "BC7";
+			default:               return "Unknown";
+		}
+	}
+}
+
+TEST_CASE(TextureConverter_EncodedBlocksDecodeCloseToSource) {
+	MipChain::Image image = CreateTestImage(128, 96);
+	for (BlockFormat format : AllFormats) {
+		Ktx2Writer::Level level = MipChain::Encode(image, format);
+		REQUIRE(level.Blocks.size() == (128 / 4) * (96 / 4) * BlockEncoder::GetBlockSize(format));
+
+		// Loose bounds, these catch broken bit packing and endpoint selection rather than grading quality
+		double error = MeasureError(image, level, format);
+		TestRegistry::Report(std::string(GetFormatName(format)) + " RMS error", error, "");
+		CHECK(error < 10.0);
+	}
+}
+
+TEST_CASE(TextureConverter_SolidBlocksAreExact) {
+	// A color that 565 can store exactly, so BC1 has no excuse for getting it wrong
+	uint8_t block[64];
+	for (int ix = 0; ix < 16; ix++) {
+		block[ix * 4 + 0] = 0xFF;
+		block[ix * 4 + 1] = 0x82;
+		block[ix * 4 + 2] = 0x10;
+		block[ix * 4 + 3] = 0x40;
+	}
+
+	uint8_t encoded[16], decoded[64];
+	size_t wrong = 0;
+
+	BlockEncoder::EncodeBC1(block, encoded);
+	DecodeBC1(encoded, decoded);
+	for (int ix = 0; ix < 16; ix++) {
+		wrong += memcmp(decoded + ix * 4, block + ix * 4, 3) != 0 ? 1 : 0;
+	}
+
+	BlockEncoder::EncodeBC4(block + 3, 4, encoded);
+	DecodeBC4(encoded, decoded, 1);
+	for (int ix = 0; ix < 16; ix++) {
+		wrong += decoded[ix] != 0x40 ? 1 : 0;
+	}
+
+	BlockEncoder::EncodeBC7(block, encoded);
+	REQUIRE(DecodeBC7(encoded, decoded));
+	for (int ix = 0; ix < 64; ix++) {
+		wrong += std::abs(decoded[ix] - block[ix]) > 1 ? 1 : 0;
+	}
+	CHECK(wrong == 0);
+}
+
+TEST_CASE(TextureConverter_MipChainHasEveryLevel) {
+	// Not a power of two, so the chain has to round down and handle partial blocks
+	MipChain::Image image = CreateTestImage(100, 37);
+	std::vector<Ktx2Writer::Level> levels = MipChain::Build(image, BlockFormat::BC1, true, true);
+
+	// 100x37, 50x18, 25x9, 12x4, 6x2, 3x1, 1x1
+	REQUIRE(levels.size() == 7);
+	CHECK(levels.back().Width == 1 && levels.back().Height == 1);
+	size_t wrongSizes = 0;
+	for (size_t ix = 1; ix < levels.size(); ix++) {
+		wrongSizes += levels[ix].Width != std::max(levels[ix - 1].Width / 2, 1u) ? 1 : 0;
+		wrongSizes += levels[ix].Height != std::max(levels[ix - 1].Height / 2, 1u) ? 1 : 0;
+		wrongSizes += levels[ix].Blocks.size() != ((levels[ix].Width + 3) / 4) * ((levels[ix].Height + 3) / 4) * 8 ? 1 : 0;
+	}
+	CHECK(wrongSizes == 0);
+
+	CHECK(MipChain::Build(image, BlockFormat::BC1, false, false).size() == 1);
+}
+
+TEST_CASE(TextureConverter_Ktx2FilesLoadWithoutGl) {
+	fs::path dir = fs::temp_directory_path() / "otter-texture-converter-test";
+	fs::create_directories(dir);
+	MipChain::Image image = CreateTestImage(64, 32);
+
+	const std::pair<BlockFormat, InternalFormat> formats[] = {
+		{ BlockFormat::BC1, InternalFormat::BC1 },
+		{ BlockFormat::BC3, InternalFormat::BC3 },
+		{ BlockFormat::BC4, InternalFormat::BC4 },
+		{ BlockFormat::BC5, InternalFormat::BC5 },
+		{ BlockFormat::BC7, InternalFormat::BC7 }
+	};
+	for (const auto& [blockFormat, internalFormat] : formats) {
+		std::vector<Ktx2Writer::Level> levels = MipChain::Build(image, blockFormat, false, true);
+		fs::path path = dir / (std::string(GetFormatName(blockFormat)) + ".ktx2");
+		REQUIRE(Ktx2Writer::Write(path.string(), blockFormat, false, true, levels));
+
+		// The converter writes bottom up files, so loading them should never need a flip
+		CompressedImage::Sptr loaded = CompressedImage::LoadFromFile(path.string(), true);
+		REQUIRE(loaded != nullptr);
+		CHECK(loaded->GetFormat() == internalFormat);
+		CHECK(loaded->GetWidth() == 64);
+		CHECK(loaded->GetHeight() == 32);
+		CHECK(!loaded->IsTopDown());
+		REQUIRE(loaded->GetLevels().size() == levels.size());
+
+		size_t wrongLevels = 0;
+		for (size_t ix = 0; ix < levels.size(); ix++) {
+			const CompressedImage::MipLevel& mip = loaded->GetLevels()[ix];
+			wrongLevels += (mip.Width != levels[ix].Width || mip.Height != levels[ix].Height || mip.Size != levels[ix].Blocks.size()) ? 1 : 0;
+			if (mip.Size == levels[ix].Blocks.size()) {
+				wrongLevels += memcmp(loaded->GetLevelData(ix), levels[ix].Blocks.data(), mip.Size) != 0 ? 1 : 0;
+			}
+		}
+		CHECK(wrongLevels == 0);
+	}
+
+	// sRGB should survive the round trip as well
+	REQUIRE(Ktx2Writer::Write((dir / "srgb.ktx2").string(), BlockFormat::BC7, true, true, MipChain::Build(image, BlockFormat::BC7, true, false)));
+	CompressedImage::Sptr srgb = CompressedImage::LoadFromFile((dir / "srgb.ktx2").string());
+	REQUIRE(srgb != nullptr);
+	CHECK(srgb->GetFormat() == InternalFormat::BC7_SRGB);
+}
+
+BENCHMARK(TextureConverter_EncodeThroughput) {
+	MipChain::Image image = CreateTestImage(1024, 1024);
+	for (BlockFormat format : AllFormats) {
+		Stopwatch timer;
+		std::vector<Ktx2Writer::Level> levels = MipChain::Build(image, format, false, true);
+		double ms = timer.ElapsedMs();
+		CHECK(levels.size() == 11);
+		TestRegistry::Report(std::string(GetFormatName(format)) + ", 1024x1024 with mips", ms, "ms");
+	}
+}
@@ -0,0 +1,250 @@
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Graphics/TextureUploader.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/TextureCube.h"
+#include "Gameplay/Material.h"
+#include "Gameplay/MeshResource.h"
+
+using namespace Gameplay;
+
+namespace {
+	const uint32_t TestSize = 256;
+	const size_t   TestBytes = TestSize * TestSize * 4;
+
+	std::vector<uint8_t> CreatePixels(uint32_t size, uint32_t seed) {
+		std::vector<uint8_t> result((size_t)size * size * 4);
+		for (size_t ix = 0; ix < result.size(); ix++) {
+			result[ix] = (uint8_t)((ix * 31 + seed * 97 + (ix >> 10)) & 0xFF);
+		}
+		return result;
+	}
+
+	GLuint CreateTexture(uint32_t size) {
+		GLuint result = 0;
+		glCreateTextures(GL_TEXTURE_2D, 1, &result);
+		glTextureStorage2D(result, 1, GL_RGBA8, size, size);
+		return result;
+	}
+
+	std::vector<uint8_t> ReadPixels(GLuint texture, uint32_t size) {
+		std::vector<uint8_t> result((size_t)size * size * 4);
+		glGetTextureImage(texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)result.size(), result.data());
+		return result;
+	}
+
+	// Grabs space in the ring, waiting on the GPU to finish earlier uploads if it has to
+	TextureUploader::Staging AllocateOrWait(size_t size) {
+		TextureUploader::Staging result = TextureUploader::Allocate(size);
+		if (!result.IsValid()) {
+			glFinish();
+			TextureUploader::Update();
+			result = TextureUploader::Allocate(size);
+		}
+		return result;
+	}
+}
+
+TEST_CASE(TextureUpload_RingMatchesClientMemory) {
+	GlTestContext::Require();
+	// Room for a few textures at a time, so the ring has to wrap around several times
+	TextureUploader::Init(TestBytes * 3 + TestBytes / 2);
+	REQUIRE(TextureUploader::IsInitialized());
+
+	GLuint fromRing = CreateTexture(TestSize);
+	GLuint fromClient = CreateTexture(TestSize);
+	const int uploads = 20;
+	size_t mismatches = 0, failedAllocs = 0;
+	for (int ix = 0; ix < uploads; ix++) {
+		std::vector<uint8_t> pixels = CreatePixels(TestSize, ix);
+
+		TextureUploader::Staging staging = AllocateOrWait(pixels.size());
+		if (!staging.IsValid()) {
+			failedAllocs++;
+			continue;
+		}
+		memcpy(staging.Data, pixels.data(), pixels.size());
+		glTextureSubImage2D(fromRing, 0, 0, 0, TestSize, TestSize, GL_RGBA, GL_UNSIGNED_BYTE, TextureUploader::BeginUpload(staging));
+		TextureUploader::EndUpload(staging);
+		CHECK(!staging.IsValid());
+
+		glTextureSubImage2D(fromClient, 0, 0, 0, TestSize, TestSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		mismatches += ReadPixels(fromRing, TestSize) != ReadPixels(fromClient, TestSize) ? 1 : 0;
+		TextureUploader::Update();
+	}
+	CHECK(failedAllocs == 0);
+	CHECK(mismatches == 0);
+
+	TextureUploader::Stats stats = TextureUploader::GetStats();
+	CHECK(stats.Uploads == (uint64_t)uploads);
+	CHECK(stats.BytesUploaded == (uint64_t)uploads * TestBytes);
+	CHECK(stats.PeakBytesInUse <= TextureUploader::GetSize());
+
+	// Once the GPU is done, every region should have been handed back
+	glFinish();
+	TextureUploader::Update();
+	CHECK(TextureUploader::GetStats().BytesInUse == 0);
+
+	glDeleteTextures(1, &fromRing);
+	glDeleteTextures(1, &fromClient);
+	TextureUploader::Cleanup();
+}
+
+TEST_CASE(TextureUpload_FullRingFallsBack) {
+	GlTestContext::Require();
+	TextureUploader::Init(1024 * 1024);
+	REQUIRE(TextureUploader::IsInitialized());
+	const size_t blockSize = 300 * 1024;
+
+	TextureUploader::Staging first  = TextureUploader::Allocate(blockSize);
+	TextureUploader::Staging second = TextureUploader::Allocate(blockSize);
+	TextureUploader::Staging third  = TextureUploader::Allocate(blockSize);
+	REQUIRE(first.IsValid() && second.IsValid() && third.IsValid());
+	CHECK(first.Data + blockSize <= second.Data);
+	CHECK(second.Data + blockSize <= third.Data);
+
+	// The ring is nearly full, this has to fall back to client memory instead of overwriting anything
+	TextureUploader::Staging overflow = TextureUploader::Allocate(blockSize);
+	CHECK(!overflow.IsValid());
+	CHECK(TextureUploader::GetStats().FallbackAllocs == 1);
+	CHECK(!TextureUploader::Allocate(0).IsValid());
+
+	// Regions come back in allocation order, so freeing the middle one doesn't make room yet
+	TextureUploader::Cancel(second);
+	TextureUploader::Update();
+	CHECK(!TextureUploader::Allocate(blockSize).IsValid());
+
+	// A region that is still being written must hold up everything behind it
+	TextureUploader::Cancel(third);
+	TextureUploader::Update();
+	CHECK(TextureUploader::GetStats().BytesInUse >= blockSize * 3);
+
+	// Uploading the first region and waiting on it lets the whole ring be reclaimed
+	GLuint texture = CreateTexture(TestSize);
+	memset(first.Data, 0x7F, TestBytes);
+	glTextureSubImage2D(texture, 0, 0, 0, TestSize, TestSize, GL_RGBA, GL_UNSIGNED_BYTE, TextureUploader::BeginUpload(first));
+	TextureUploader::EndUpload(first);
+	glFinish();
+	TextureUploader::Update();
+	CHECK(TextureUploader::GetStats().BytesInUse == 0);
+
+	TextureUploader::Staging reused = TextureUploader::Allocate(blockSize);
+	CHECK(reused.IsValid());
+	TextureUploader::Cancel(reused);
+	TextureUploader::Update();
+
+	std::vector<uint8_t> pixels = ReadPixels(texture, TestSize);
+	CHECK(std::all_of(pixels.begin(), pixels.end(), [](uint8_t value) { return value == 0x7F; }));
+	glDeleteTextures(1, &texture);
+	TextureUploader::Cleanup();
+}
+
+BENCHMARK(TextureUpload_Throughput) {
+	GlTestContext::Require();
+
+	// Enough 1k textures to overflow the default ring a few times
+	const uint32_t size = 1024;
+	const int count = 96;
+	std::vector<uint8_t> pixels = CreatePixels(size, 3);
+	std::vector<GLuint> textures(count);
+	for (GLuint& texture : textures) {
+		texture = CreateTexture(size);
+	}
+	double megabytes = (double)pixels.size() * count / (1024.0 * 1024.0);
+
+	// Each upload is its own frame, like the streaming budget would do with big textures. The copy into
+	// the ring happens on a worker in the engine, so it isn't counted against the frame
+	for (bool useRing : { false, true }) {
+		if (useRing) {
+			TextureUploader::Init();
+		}
+		glFinish();
+
+		double worstMs = 0.0;
+		Stopwatch total;
+		for (GLuint texture : textures) {
+			TextureUploader::Staging staging = useRing ? AllocateOrWait(pixels.size()) : TextureUploader::Staging();
+			if (staging.IsValid()) {
+				memcpy(staging.Data, pixels.data(), pixels.size());
+			}
+
+			Stopwatch frame;
+			if (staging.IsValid()) {
+				glTextureSubImage2D(texture, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, TextureUploader::BeginUpload(staging));
+				TextureUploader::EndUpload(staging);
+				TextureUploader::Update();
+			} else {
+				glTextureSubImage2D(texture, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+			}
+			// Stands in for the buffer swap at the end of a frame
+			glFlush();
+			worstMs = std::max(worstMs, frame.ElapsedMs());
+		}
+		glFinish();
+		double totalMs = total.ElapsedMs();
+
+		std::string label = useRing ? "PBO ring" : "Client memory";
+		TestRegistry::Report(label + ", throughput", megabytes / (totalMs / 1000.0), "MB/s");
+		TestRegistry::Report(label + ", worst frame", worstMs, "ms");
+		if (useRing) {
+			TestRegistry::Report("PBO ring, fallbacks", (double)TextureUploader::GetStats().FallbackAllocs, "");
+			TextureUploader::Cleanup();
+		}
+	}
+	glDeleteTextures(count, textures.data());
+}
+
+BENCHMARK(TextureUpload_StreamingFrameTimes) {
+	GlTestContext::Require();
+
+	// Streams the emitter test manifest (textures and a cubemap) in the way the app does, one
+	// PollStreaming per frame, and records how long the worst frame took
+	for (bool useRing : { false, true }) {
+		if (useRing) {
+			TextureUploader::Init();
+		}
+		ResourceManager::Init();
+		ResourceManager::RegisterType<Texture2D>();
+		ResourceManager::RegisterType<TextureCube>();
+		ResourceManager::RegisterType<ShaderProgram>();
+		ResourceManager::RegisterType<Material>();
+		ResourceManager::RegisterType<MeshResource>();
+		glFinish();
+
+		Stopwatch total;
+		ResourceManager::LoadManifest("emitter-test-manifest.json", true);
+		double worstMs = 0.0;
+		int frames = 0;
+		while (ResourceManager::GetPendingLoadCount() > 0 && frames < 100000) {
+			Stopwatch frame;
+			ResourceManager::PollStreaming();
+			if (useRing) {
+				TextureUploader::Update();
+			}
+			glFlush();
+			worstMs = std::max(worstMs, frame.ElapsedMs());
+			frames++;
+		}
+		glFinish();
+		double totalMs = total.ElapsedMs();
+		CHECK(ResourceManager::GetPendingLoadCount() == 0);
+
+		std::string label = useRing ? "PBO ring" : "Client memory";
+		TestRegistry::Report(label + ", worst frame", worstMs, "ms");
+		TestRegistry::Report(label + ", frames to load", (double)frames, "");
+		TestRegistry::Report(label + ", total load time", totalMs, "ms");
+
+		ResourceManager::Cleanup();
+		if (useRing) {
+			TextureUploader::Cleanup();
+		}
+	}
+}
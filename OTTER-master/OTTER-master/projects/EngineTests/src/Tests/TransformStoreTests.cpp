@@ -0,0 +1,263 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Gameplay/TransformStore.h"
+
+using namespace Gameplay;
+
+namespace {
+	/// <summary>
+	/// The per-object path that the store replaced, every object owns it's own TRS and matrices and
+	/// finds it's parent through a weak pointer. Used as the reference for the store's results
+	/// </summary>
+	struct LegacyTransform {
+		glm::vec3 Position = glm::vec3(0.0f);
+		glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 Scale    = glm::vec3(1.0f);
+		std::weak_ptr<LegacyTransform> Parent;
+		std::vector<std::shared_ptr<LegacyTransform>> Children;
+		glm::mat4 World    = glm::mat4(1.0f);
+
+		void Update(const glm::mat4& parentWorld) {
+			World = parentWorld *
+				glm::translate(glm::mat4(1.0f), Position) *
+				glm::mat4_cast(Rotation) *
+				glm::scale(glm::mat4(1.0f), Scale);
+			for (const auto& child : Children) {
+				child->Update(World);
+			}
+		}
+	};
+	typedef std::shared_ptr<LegacyTransform> LegacyPtr;
+
+	void SetLegacyParent(const LegacyPtr& node, const LegacyPtr& parent) {
+		LegacyPtr oldParent = node->Parent.lock();
+		if (oldParent != nullptr) {
+			oldParent->Children.erase(std::find(oldParent->Children.begin(), oldParent->Children.end(), node));
+		}
+		node->Parent = parent;
+		if (parent != nullptr) {
+			parent->Children.push_back(node);
+		}
+	}
+
+	void UpdateLegacy(const std::vector<LegacyPtr>& nodes) {
+		for (const LegacyPtr& node : nodes) {
+			if (node != nullptr && node->Parent.expired()) {
+				node->Update(glm::mat4(1.0f));
+			}
+		}
+	}
+
+	bool IsAncestor(const LegacyPtr& ancestor, LegacyPtr node) {
+		for (; node != nullptr; node = node->Parent.lock()) {
+			if (node == ancestor) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Deep chains end up far from the origin, so the error is measured relative to the size of the values
+	float RelativeError(const glm::mat4& actual, const glm::mat4& expected) {
+		float result = 0.0f;
+		for (int col = 0; col < 4; col++) {
+			float scale = std::max(1.0f, glm::length(expected[col]));
+			result = std::max(result, glm::length(actual[col] - expected[col]) / scale);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// A store and the legacy objects for the same hierarchy, indexed by store handle
+	/// </summary>
+	struct Hierarchy {
+		TransformStore          Store;
+		std::vector<LegacyPtr>  Legacy;
+		std::vector<TransformStore::Handle> Live;
+
+		TransformStore::Handle Add() {
+			TransformStore::Handle handle = Store.Allocate();
+			if (handle >= Legacy.size()) {
+				Legacy.resize(handle + 1);
+			}
+			Legacy[handle] = std::make_shared<LegacyTransform>();
+			Live.push_back(handle);
+			return handle;
+		}
+
+		void Remove(size_t liveIndex) {
+			TransformStore::Handle handle = Live[liveIndex];
+			// The store treats the children of a freed transform as roots
+			LegacyPtr node = Legacy[handle];
+			for (const LegacyPtr& child : std::vector<LegacyPtr>(node->Children)) {
+				SetLegacyParent(child, nullptr);
+			}
+			SetLegacyParent(node, nullptr);
+			Legacy[handle] = nullptr;
+			Store.Free(handle);
+			Live.erase(Live.begin() + liveIndex);
+		}
+
+		void SetParent(TransformStore::Handle handle, TransformStore::Handle parent) {
+			Store.SetParent(handle, parent);
+			SetLegacyParent(Legacy[handle], parent == TransformStore::INVALID_HANDLE ? nullptr : Legacy[parent]);
+		}
+
+		void SetTRS(TransformStore::Handle handle, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+			Store.SetPosition(handle, position);
+			Store.SetRotation(handle, rotation);
+			Store.SetScale(handle, scale);
+			LegacyPtr node = Legacy[handle];
+			node->Position = position;
+			node->Rotation = rotation;
+			node->Scale = scale;
+		}
+	};
+
+	glm::quat RandomRotation(std::mt19937& random) {
+		std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+		return glm::quat(glm::vec3(angle(random), angle(random), angle(random)));
+	}
+
+	// Builds a random hierarchy, where each node is parented to one of the few hundred before it
+	void BuildRandomHierarchy(Hierarchy& hierarchy, size_t count, std::mt19937& random) {
+		std::uniform_real_distribution<float> range(-5.0f, 5.0f);
+		std::uniform_real_distribution<float> scale(0.8f, 1.2f);
+		for (size_t ix = 0; ix < count; ix++) {
+			TransformStore::Handle handle = hierarchy.Add();
+			hierarchy.SetTRS(handle, glm::vec3(range(random), range(random), range(random)), RandomRotation(random), glm::vec3(scale(random), scale(random), scale(random)));
+			if (ix % 50 != 0) {
+				std::uniform_int_distribution<size_t> parent(ix > 300 ? ix - 300 : 0, ix - 1);
+				hierarchy.SetParent(handle, hierarchy.Live[parent(random)]);
+			}
+		}
+	}
+}
+
+TEST_CASE(TransformStore_MatchesPerObjectPath) {
+	Hierarchy hierarchy;
+	std::mt19937 random(2024);
+	BuildRandomHierarchy(hierarchy, 2000, random);
+
+	std::uniform_real_distribution<float> range(-5.0f, 5.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+	float worstWorld = 0.0f, worstLazy = 0.0f, worstInverse = 0.0f;
+	for (int round = 0; round < 20; round++) {
+		// Move, free, add and re-parent a bunch of nodes. Re-parenting to a later node forces a re-sort
+		for (int ix = 0; ix < 50; ix++) {
+			std::uniform_int_distribution<size_t> pick(0, hierarchy.Live.size() - 1);
+			TransformStore::Handle handle = hierarchy.Live[pick(random)];
+			hierarchy.SetTRS(handle, glm::vec3(range(random), range(random), range(random)), RandomRotation(random), glm::vec3(scale(random), scale(random), scale(random)));
+		}
+		for (int ix = 0; ix < 10; ix++) {
+			std::uniform_int_distribution<size_t> pick(0, hierarchy.Live.size() - 1);
+			hierarchy.Remove(pick(random));
+			TransformStore::Handle parent = hierarchy.Live[std::uniform_int_distribution<size_t>(0, hierarchy.Live.size() - 1)(random)];
+			hierarchy.SetParent(hierarchy.Add(), parent);
+		}
+		for (int ix = 0; ix < 20; ix++) {
+			std::uniform_int_distribution<size_t> pick(0, hierarchy.Live.size() - 1);
+			TransformStore::Handle handle = hierarchy.Live[pick(random)];
+			TransformStore::Handle parent = hierarchy.Live[pick(random)];
+			if (!IsAncestor(hierarchy.Legacy[handle], hierarchy.Legacy[parent])) {
+				hierarchy.SetParent(handle, ix % 5 == 0 ? TransformStore::INVALID_HANDLE : parent);
+			}
+		}
+		UpdateLegacy(hierarchy.Legacy);
+
+		// Every other round, read some transforms lazily before the batched update
+		if (round % 2 == 0) {
+			for (int ix = 0; ix < 100; ix++) {
+				std::uniform_int_distribution<size_t> pick(0, hierarchy.Live.size() - 1);
+				TransformStore::Handle handle = hierarchy.Live[pick(random)];
+				worstLazy = std::max(worstLazy, RelativeError(hierarchy.Store.GetWorldTransform(handle), hierarchy.Legacy[handle]->World));
+			}
+		}
+		hierarchy.Store.UpdateAll();
+
+		for (TransformStore::Handle handle : hierarchy.Live) {
+			glm::mat4 world = hierarchy.Store.GetWorldTransform(handle);
+			worstWorld = std::max(worstWorld, RelativeError(world, hierarchy.Legacy[handle]->World));
+			// Deep chains of non-uniform scales are poorly conditioned, so the inverse is checked against one done in doubles
+			glm::mat4 inverse = glm::mat4(glm::inverse(glm::dmat4(hierarchy.Legacy[handle]->World)));
+			worstInverse = std::max(worstInverse, RelativeError(hierarchy.Store.GetInverseWorldTransform(handle), inverse));
+		}
+	}
+
+	CHECK(hierarchy.Store.Size() == hierarchy.Live.size());
+	// Relative errors, in millionths
+	TestRegistry::Report("Worst world transform error", worstWorld * 1e6, "ppm");
+	TestRegistry::Report("Worst lazy world transform error", worstLazy * 1e6, "ppm");
+	TestRegistry::Report("Worst inverse world transform error", worstInverse * 1e6, "ppm");
+	CHECK(worstWorld < 1e-5f);
+	CHECK(worstLazy < 1e-5f);
+	CHECK(worstInverse < 1e-5f);
+}
+
+TEST_CASE(TransformStore_FreedParentLeavesRoots) {
+	TransformStore store;
+	TransformStore::Handle parent = store.Allocate();
+	TransformStore::Handle child = store.Allocate();
+	store.SetParent(child, parent);
+	store.SetPosition(parent, glm::vec3(10.0f, 0.0f, 0.0f));
+	store.SetPosition(child, glm::vec3(0.0f, 1.0f, 0.0f));
+	store.UpdateAll();
+	CHECK(glm::vec3(store.GetWorldTransform(child)[3]) == glm::vec3(10.0f, 1.0f, 0.0f));
+
+	// The freed handle gets re-used straight away, the child must not end up attached to the new transform
+	store.Free(parent);
+	TransformStore::Handle reused = store.Allocate();
+	store.SetPosition(reused, glm::vec3(0.0f, 0.0f, 5.0f));
+	CHECK(reused == parent);
+	CHECK(glm::vec3(store.GetWorldTransform(child)[3]) == glm::vec3(0.0f, 1.0f, 0.0f));
+	store.UpdateAll();
+	CHECK(glm::vec3(store.GetWorldTransform(child)[3]) == glm::vec3(0.0f, 1.0f, 0.0f));
+	CHECK(glm::vec3(store.GetWorldTransform(reused)[3]) == glm::vec3(0.0f, 0.0f, 5.0f));
+	CHECK(store.Size() == 2);
+}
+
+BENCHMARK(TransformStore_UpdateThroughput) {
+	for (size_t count : { (size_t)10000, (size_t)100000 }) {
+		Hierarchy hierarchy;
+		std::mt19937 random(7);
+		BuildRandomHierarchy(hierarchy, count, random);
+		hierarchy.Store.UpdateAll();
+		UpdateLegacy(hierarchy.Legacy);
+
+		// Moving every root dirties the whole hierarchy, on both sides
+		const int runs = 10;
+		double storeMs = 0.0, legacyMs = 0.0;
+		for (int run = 0; run < runs; run++) {
+			for (TransformStore::Handle handle : hierarchy.Live) {
+				if (hierarchy.Legacy[handle]->Parent.expired()) {
+					hierarchy.SetTRS(handle, glm::vec3((float)run), glm::quat(glm::vec3(0.1f * run)), glm::vec3(1.0f));
+				}
+			}
+
+			Stopwatch timer;
+			hierarchy.Store.UpdateAll();
+			storeMs += timer.ElapsedMs();
+			timer.Restart();
+			UpdateLegacy(hierarchy.Legacy);
+			legacyMs += timer.ElapsedMs();
+		}
+
+		// These hierarchies get far deeper than the one in the test above, so float error has more room to build up
+		size_t mismatched = 0;
+		for (TransformStore::Handle handle : hierarchy.Live) {
+			mismatched += RelativeError(hierarchy.Store.GetWorldTransform(handle), hierarchy.Legacy[handle]->World) > 1e-4f ? 1 : 0;
+		}
+		CHECK(mismatched == 0);
+
+		std::string label = std::to_string(count) + " transforms";
+		TestRegistry::Report(label + ", per-object update", legacyMs / runs, "ms");
+		TestRegistry::Report(label + ", transform store update", storeMs / runs, "ms");
+		TestRegistry::Report(label + ", speedup", legacyMs / storeMs, "x");
+	}
+}
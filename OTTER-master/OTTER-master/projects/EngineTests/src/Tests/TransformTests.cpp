@@ -0,0 +1,176 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+
+using namespace Gameplay;
+
+namespace {
+	// Builds the world transform the slow way, by multiplying every local TRS matrix up to the root
+	glm::mat4 ReferenceTransform(const GameObject::Sptr& object) {
+		glm::mat4 local =
+			glm::translate(glm::mat4(1.0f), object->GetPosition()) *
+			glm::mat4_cast(object->GetRotation()) *
+			glm::scale(glm::mat4(1.0f), object->GetScale());
+		GameObject::Sptr parent = object->GetParent();
+		return parent != nullptr ? ReferenceTransform(parent) * local : local;
+	}
+
+	float MaxDifference(const glm::mat4& a, const glm::mat4& b) {
+		float result = 0.0f;
+		for (int col = 0; col < 4; col++) {
+			for (int row = 0; row < 4; row++) {
+				result = std::max(result, std::abs(a[col][row] - b[col][row]));
+			}
+		}
+		return result;
+	}
+
+	// Counts the objects whose world transform (or it's inverse) doesn't match the reference
+	size_t CountStale(const std::vector<GameObject::Sptr>& objects) {
+		size_t result = 0;
+		for (const GameObject::Sptr& object : objects) {
+			glm::mat4 transform = object->GetTransform();
+			result += MaxDifference(transform, ReferenceTransform(object)) > 1e-4f ? 1 : 0;
+			result += MaxDifference(object->GetInverseTransform() * transform, glm::mat4(1.0f)) > 1e-4f ? 1 : 0;
+		}
+		return result;
+	}
+
+	Scene::Sptr CreateScene() {
+		ComponentManager::RegisterType<Camera>();
+		return std::make_shared<Scene>();
+	}
+}
+
+TEST_CASE(Transform_DeepChainFollowsEveryParent) {
+	Scene::Sptr scene = CreateScene();
+
+	// Every link is offset, rotated and scaled so that any missed parent shows up at the end of the chain
+	std::vector<GameObject::Sptr> chain;
+	for (int ix = 0; ix < 10; ix++) {
+		GameObject::Sptr object = scene->CreateGameObject("Link " + std::to_string(ix));
+		object->SetPostion(glm::vec3(1.0f, 0.0f, 0.5f));
+		object->SetRotation(glm::vec3(0.0f, 10.0f, 30.0f));
+		object->SetScale(glm::vec3(1.1f));
+		if (!chain.empty()) {
+			chain.back()->AddChild(object);
+		}
+		chain.push_back(object);
+	}
+	scene->UpdateTransforms();
+	CHECK(CountStale(chain) == 0);
+
+	// Moving the root has to reach the bottom of the chain, even without a batched update
+	chain[0]->SetPostion(glm::vec3(5.0f, -3.0f, 2.0f));
+	glm::vec3 expected = ReferenceTransform(chain.back())[3];
+	CHECK(glm::length(chain.back()->GetWorldPosition() - expected) < 1e-4f);
+	CHECK(CountStale(chain) == 0);
+
+	// Same thing from the middle, through the batched update
+	chain[4]->SetRotation(glm::vec3(45.0f, 0.0f, -20.0f));
+	chain[6]->SetScale(glm::vec3(0.5f, 2.0f, 1.0f));
+	scene->UpdateTransforms();
+	CHECK(CountStale(chain) == 0);
+
+	// Reading a grandchild first must not leave the objects between it and the change stale
+	chain[2]->SetPostion(glm::vec3(0.0f, 1.0f, 0.0f));
+	chain[8]->GetTransform();
+	scene->UpdateTransforms();
+	CHECK(CountStale(chain) == 0);
+
+	// Detaching the middle makes it a root, and it's children have to follow
+	chain[4]->RemoveChild(chain[5]);
+	CHECK(chain[5]->GetParent() == nullptr);
+	scene->UpdateTransforms();
+	CHECK(CountStale(chain) == 0);
+	CHECK(MaxDifference(chain[5]->GetTransform(), chain[5]->GetLocalTransform()) < 1e-6f);
+
+	// And re-attaching it somewhere else
+	chain[1]->AddChild(chain[5]);
+	chain[1]->SetPostion(glm::vec3(-2.0f, 0.0f, 0.0f));
+	CHECK(CountStale(chain) == 0);
+}
+
+TEST_CASE(Transform_UnchangedObjectsKeepTheirMatrices) {
+	Scene::Sptr scene = CreateScene();
+	GameObject::Sptr parent = scene->CreateGameObject("Parent");
+	GameObject::Sptr child = scene->CreateGameObject("Child");
+	GameObject::Sptr sibling = scene->CreateGameObject("Sibling");
+	parent->AddChild(child);
+	child->SetPostion(glm::vec3(0.0f, 0.0f, 1.0f));
+	sibling->SetPostion(glm::vec3(3.0f, 0.0f, 0.0f));
+	scene->UpdateTransforms();
+
+	glm::mat4 siblingBefore = sibling->GetTransform();
+	parent->SetPostion(glm::vec3(0.0f, 2.0f, 0.0f));
+	scene->UpdateTransforms();
+
+	CHECK(child->GetWorldPosition() == glm::vec3(0.0f, 2.0f, 1.0f));
+	CHECK(sibling->GetTransform() == siblingBefore);
+}
+
+BENCHMARK(Transform_LargeHierarchy) {
+	Scene::Sptr scene = CreateScene();
+
+	// A bushy hierarchy of 100k nodes, each parented to a random earlier node
+	const size_t count = 100000;
+	std::vector<GameObject::Sptr> objects;
+	objects.reserve(count);
+	std::mt19937 random(99);
+	std::uniform_real_distribution<float> range(-10.0f, 10.0f);
+	Stopwatch timer;
+	for (size_t ix = 0; ix < count; ix++) {
+		GameObject::Sptr object = scene->CreateGameObject("Node");
+		object->SetPostion(glm::vec3(range(random), range(random), range(random)));
+		object->SetRotation(glm::vec3(range(random), range(random), range(random)));
+		if (ix % 100 != 0) {
+			std::uniform_int_distribution<size_t> parent(std::max<size_t>(ix, 1000) - 1000, ix - 1);
+			objects[parent(random)]->AddChild(object);
+		}
+		objects.push_back(object);
+	}
+	TestRegistry::Report("Create 100k nodes", timer.ElapsedMs(), "ms");
+
+	timer.Restart();
+	scene->UpdateTransforms();
+	TestRegistry::Report("First update, everything dirty", timer.ElapsedMs(), "ms");
+
+	timer.Restart();
+	scene->UpdateTransforms();
+	TestRegistry::Report("Update with nothing changed", timer.ElapsedMs(), "ms");
+
+	// Moving the roots dirties the whole tree
+	for (size_t ix = 0; ix < count; ix += 100) {
+		objects[ix]->SetPostion(objects[ix]->GetPosition() + glm::vec3(0.0f, 0.0f, 1.0f));
+	}
+	timer.Restart();
+	scene->UpdateTransforms();
+	TestRegistry::Report("Update after moving every root", timer.ElapsedMs(), "ms");
+
+	// The same again, but letting every object rebuild itself lazily as it's read
+	for (size_t ix = 0; ix < count; ix += 100) {
+		objects[ix]->SetPostion(objects[ix]->GetPosition() - glm::vec3(0.0f, 0.0f, 1.0f));
+	}
+	timer.Restart();
+	glm::vec3 sum = glm::vec3(0.0f);
+	for (const GameObject::Sptr& object : objects) {
+		sum += glm::vec3(object->GetTransform()[3]);
+	}
+	TestRegistry::Report("Lazy reads after moving every root", timer.ElapsedMs(), "ms");
+
+	// Spot check the results, deep nodes end up far from the origin so the tolerance is relative
+	size_t stale = 0;
+	for (size_t ix = 0; ix < count; ix += 997) {
+		glm::vec3 expected = ReferenceTransform(objects[ix])[3];
+		float error = glm::length(objects[ix]->GetWorldPosition() - expected);
+		stale += error > 1e-4f * std::max(1.0f, glm::length(expected)) ? 1 : 0;
+	}
+	CHECK(stale == 0);
+	CHECK(!glm::any(glm::isnan(sum)));
+}
@@ -0,0 +1,292 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <BulletDynamics/Dynamics/btDynamicsWorld.h>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/TriggerVolume.h"
+#include "Gameplay/Physics/Colliders/BoxCollider.h"
+#include "Gameplay/Physics/Colliders/PlaneCollider.h"
+#include "Gameplay/Physics/Colliders/SphereCollider.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+
+namespace {
+	struct TriggerEvent {
+		int              Trigger;
+		const RigidBody* Body;
+		bool             Entered;
+
+		bool operator <(const TriggerEvent& other) const {
+			return std::tie(Trigger, Body, Entered) < std::tie(other.Trigger, other.Body, other.Entered);
+		}
+		bool operator ==(const TriggerEvent& other) const {
+			return Trigger == other.Trigger && Body == other.Body && Entered == other.Entered;
+		}
+	};
+
+	/// <summary>
+	/// Sits next to a trigger volume and records the events that it raises
+	/// </summary>
+	class TriggerEventLog : public IComponent {
+	public:
+		typedef std::shared_ptr<TriggerEventLog> Sptr;
+
+		int Index = 0;
+		std::vector<TriggerEvent>* Events = nullptr;
+
+		virtual void OnTriggerVolumeEntered(const std::shared_ptr<RigidBody>& body) override {
+			Events->push_back({ Index, body.get(), true });
+		}
+		virtual void OnTriggerVolumeLeaving(const std::shared_ptr<RigidBody>& body) override {
+			Events->push_back({ Index, body.get(), false });
+		}
+
+		virtual void RenderImGui() override {}
+		virtual nlohmann::json ToJson() const override { return nlohmann::json(); }
+		static TriggerEventLog::Sptr FromJson(const nlohmann::json&) { return std::make_shared<TriggerEventLog>(); }
+		MAKE_TYPENAME(TriggerEventLog);
+	};
+
+	// Lets us get at a trigger's ghost object, without giving the engine a getter that only tests need
+	struct GhostAccess : public TriggerVolume {
+		static btPairCachingGhostObject* Get(TriggerVolume& trigger) {
+			return trigger.*(&GhostAccess::_ghost);
+		}
+	};
+
+	/// <summary>
+	/// The contact tracking that TriggerVolume::PhysicsPostStep used before it was keyed on the body. Runs
+	/// against a trigger's ghost after each step, and records the events that it would have raised. The
+	/// overlapping object is taken from the pair, as the old lookup by pair index into the ghost's object
+	/// list was the one intended change in behaviour
+	/// </summary>
+	class LegacyTriggerTracker {
+	public:
+		LegacyTriggerTracker(const TriggerVolume::Sptr& trigger, int index) : _trigger(trigger), _index(index), _currentCollisions() {}
+
+		void PostStep(btDynamicsWorld* world, std::vector<TriggerEvent>& events) {
+			btPairCachingGhostObject* ghost = GhostAccess::Get(*_trigger);
+			std::vector<std::weak_ptr<RigidBody>> thisFrameCollision;
+
+			world->getDispatcher()->dispatchAllCollisionPairs(ghost->getOverlappingPairCache(), world->getDispatchInfo(), world->getDispatcher());
+			btBroadphasePairArray& collisionPairs = ghost->getOverlappingPairCache()->getOverlappingPairArray();
+			const int numObjects = collisionPairs.size();
+			thisFrameCollision.reserve(numObjects);
+
+			static btManifoldArray m_manifoldArray;
+			for (int i = 0; i < numObjects; ++i) {
+				m_manifoldArray.resize(0);
+
+				btBroadphasePair* pair = &collisionPairs[i];
+				const btCollisionObject* obj = static_cast<const btCollisionObject*>(pair->m_pProxy0->m_clientObject);
+				if (obj == ghost) {
+					obj = static_cast<const btCollisionObject*>(pair->m_pProxy1->m_clientObject);
+				}
+				if (pair->m_algorithm != nullptr) {
+					pair->m_algorithm->getAllContactManifolds(m_manifoldArray);
+				} else {
+					continue;
+				}
+
+				bool hasCollision = false;
+				for (int j = 0; j < m_manifoldArray.size(); j++) {
+					btPersistentManifold* manifold = m_manifoldArray[j];
+					if (manifold != nullptr && manifold->getNumContacts() > 0) {
+						hasCollision = true;
+						break;
+					}
+				}
+
+				if (hasCollision && (obj->getBroadphaseHandle()->m_collisionFilterGroup & _trigger->GetCollisionMask())) {
+					if (obj->getInternalType() == btCollisionObject::CO_RIGID_BODY) {
+						const btRigidBody* body = (const btRigidBody*)obj;
+						TriggerTypeFlags typeFlags = _trigger->GetFlags();
+						if (((body->getCollisionFlags() & btCollisionObject::CF_STATIC_OBJECT & btCollisionObject::CF_KINEMATIC_OBJECT) == 0) ||
+							((body->getCollisionFlags() & btCollisionObject::CF_STATIC_OBJECT) == *(typeFlags & TriggerTypeFlags::Statics)) ||
+							((body->getCollisionFlags() & btCollisionObject::CF_KINEMATIC_OBJECT) == *(typeFlags & TriggerTypeFlags::Kinematics))) {
+
+							std::weak_ptr<IComponent> rawPtr = *reinterpret_cast<std::weak_ptr<IComponent>*>(body->getUserPointer());
+							std::shared_ptr<RigidBody> physicsPtr = std::dynamic_pointer_cast<RigidBody>(rawPtr.lock());
+
+							if (physicsPtr != nullptr && physicsPtr->GetGameObject() != _trigger->GetGameObject()) {
+								thisFrameCollision.push_back(physicsPtr);
+
+								auto it = std::find_if(_currentCollisions.begin(), _currentCollisions.end(), [&](const std::weak_ptr<RigidBody>& item) {
+									return item.lock() == physicsPtr;
+								});
+								if (it == _currentCollisions.end()) {
+									events.push_back({ _index, physicsPtr.get(), true });
+								}
+							}
+						}
+					}
+				}
+			}
+
+			for (auto& weakPtr : _currentCollisions) {
+				auto it = std::find_if(thisFrameCollision.begin(), thisFrameCollision.end(), [&](const std::weak_ptr<RigidBody>& item) {
+					return item.lock() == weakPtr.lock();
+				});
+				if (it == thisFrameCollision.end()) {
+					RigidBody::Sptr body = weakPtr.lock();
+					if (body != nullptr) {
+						events.push_back({ _index, body.get(), false });
+					}
+				}
+			}
+
+			_currentCollisions.swap(thisFrameCollision);
+		}
+
+	private:
+		TriggerVolume::Sptr _trigger;
+		int _index;
+		std::vector<std::weak_ptr<RigidBody>> _currentCollisions;
+	};
+
+	struct TriggerField {
+		Scene::Sptr                       ActiveScene;
+		std::vector<TriggerVolume::Sptr>  Triggers;
+		std::vector<LegacyTriggerTracker> Legacy;
+		std::vector<GameObject::Sptr>     Bodies;
+		std::vector<TriggerEvent>         Events;
+	};
+
+	// Lays out a grid of trigger boxes above a ground plane, with balls raining down through them. The balls
+	// have some sideways velocity, so that they scatter and roll into neighbouring triggers
+	void CreateTriggerField(TriggerField& field, int triggerCount, int bodyCount) {
+		ComponentManager::RegisterType<Camera>();
+		ComponentManager::RegisterType<RigidBody>();
+		ComponentManager::RegisterType<TriggerVolume>();
+		ComponentManager::RegisterType<TriggerEventLog>();
+
+		field.ActiveScene = std::make_shared<Scene>();
+		GameObject::Sptr ground = field.ActiveScene->CreateGameObject("Ground");
+		ground->Add<RigidBody>(RigidBodyType::Static)->AddCollider(PlaneCollider::Create());
+		ground->Awake();
+
+		const int columns = 40;
+		const float spacing = 3.0f;
+		const int rows = (triggerCount + columns - 1) / columns;
+		for (int ix = 0; ix < triggerCount; ix++) {
+			GameObject::Sptr object = field.ActiveScene->CreateGameObject("Trigger");
+			object->SetPostion(glm::vec3((ix % columns) * spacing, (ix / columns) * spacing, 2.0f));
+			TriggerVolume::Sptr trigger = object->Add<TriggerVolume>();
+			trigger->AddCollider(BoxCollider::Create(glm::vec3(1.2f, 1.2f, 1.0f)));
+			TriggerEventLog::Sptr log = object->Add<TriggerEventLog>();
+			log->Index = ix;
+			log->Events = &field.Events;
+			object->Awake();
+
+			field.Triggers.push_back(trigger);
+			field.Legacy.emplace_back(trigger, ix);
+		}
+
+		std::mt19937 random(31);
+		std::uniform_real_distribution<float> x(-2.0f, columns * spacing);
+		std::uniform_real_distribution<float> y(-2.0f, rows * spacing);
+		std::uniform_real_distribution<float> z(4.0f, 30.0f);
+		std::uniform_real_distribution<float> speed(-3.0f, 3.0f);
+		for (int ix = 0; ix < bodyCount; ix++) {
+			GameObject::Sptr ball = field.ActiveScene->CreateGameObject("Ball");
+			ball->SetPostion(glm::vec3(x(random), y(random), z(random)));
+			RigidBody::Sptr body = ball->Add<RigidBody>(RigidBodyType::Dynamic);
+			body->AddCollider(SphereCollider::Create(0.4f));
+			body->SetLinearVelocity(glm::vec3(speed(random), speed(random), 0.0f));
+			ball->Awake();
+			field.Bodies.push_back(ball);
+		}
+
+		field.ActiveScene->IsPlaying = true;
+	}
+
+	// Steps the world exactly once, which runs every trigger's PhysicsPostStep through the scene's tick callback
+	void Step(TriggerField& field) {
+		float step = field.ActiveScene->GetFixedTimeStep();
+		field.ActiveScene->GetPhysicsWorld()->stepSimulation(step, 0, step);
+	}
+}
+
+TEST_CASE(TriggerVolume_EventsMatchLegacyTracking) {
+	TriggerField field;
+	CreateTriggerField(field, 1000, 5000);
+
+	size_t totalEvents = 0, enters = 0, mismatchedSteps = 0;
+	std::vector<TriggerEvent> legacyEvents;
+	for (int ix = 0; ix < 240; ix++) {
+		field.Events.clear();
+		legacyEvents.clear();
+		Step(field);
+		for (LegacyTriggerTracker& legacy : field.Legacy) {
+			legacy.PostStep(field.ActiveScene->GetPhysicsWorld(), legacyEvents);
+		}
+
+		// The order that events are raised in isn't part of the behaviour, so we only compare what was raised
+		std::sort(field.Events.begin(), field.Events.end());
+		std::sort(legacyEvents.begin(), legacyEvents.end());
+		if (field.Events != legacyEvents) {
+			if (mismatchedSteps == 0) {
+				TestRegistry::Fail(__FILE__, __LINE__, "Step " + std::to_string(ix) + " raised " + std::to_string(field.Events.size()) +
+					" events, the legacy tracking raised " + std::to_string(legacyEvents.size()), false);
+			}
+			mismatchedSteps++;
+		}
+		totalEvents += field.Events.size();
+		enters += std::count_if(field.Events.begin(), field.Events.end(), [](const TriggerEvent& e) { return e.Entered; });
+	}
+
+	TestRegistry::Report("Trigger events over 240 steps", (double)totalEvents, "");
+	// Plenty of balls have to pass all the way through a trigger for this to mean anything
+	CHECK(enters > 1000);
+	CHECK(totalEvents - enters > 1000);
+	CHECK(mismatchedSteps == 0);
+}
+
+BENCHMARK(TriggerVolume_PostStepTime) {
+	TriggerField field;
+	CreateTriggerField(field, 1000, 5000);
+	btDynamicsWorld* world = field.ActiveScene->GetPhysicsWorld();
+	float step = field.ActiveScene->GetFixedTimeStep();
+
+	// Get the balls in amongst the triggers before we start timing
+	std::vector<TriggerEvent> legacyEvents;
+	for (int ix = 0; ix < 60; ix++) {
+		Step(field);
+		for (LegacyTriggerTracker& legacy : field.Legacy) {
+			legacy.PostStep(world, legacyEvents);
+		}
+	}
+
+	// Each step already ran the new tracking through the tick callback, so running it again does the same
+	// contact generation and diff but raises nothing. The legacy pass raises this step's events, which we
+	// let it do since it's work the old tracking did too
+	const int steps = 60;
+	double newMs = 0.0, legacyMs = 0.0;
+	for (int ix = 0; ix < steps; ix++) {
+		Step(field);
+
+		Stopwatch timer;
+		for (const TriggerVolume::Sptr& trigger : field.Triggers) {
+			trigger->PhysicsPostStep(step);
+		}
+		newMs += timer.ElapsedMs();
+
+		timer.Restart();
+		for (LegacyTriggerTracker& legacy : field.Legacy) {
+			legacy.PostStep(world, legacyEvents);
+		}
+		legacyMs += timer.ElapsedMs();
+	}
+
+	TestRegistry::Report("1000 triggers, 5000 bodies, legacy post step", legacyMs / steps, "ms");
+	TestRegistry::Report("1000 triggers, 5000 bodies, keyed post step", newMs / steps, "ms");
+	TestRegistry::Report("Speedup", legacyMs / newMs, "x");
+}
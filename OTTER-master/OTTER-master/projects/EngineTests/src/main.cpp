@@ -0,0 +1,37 @@
+/*
+ * Headless tests and benchmarks for the engine code in Week6-Tutorial
+ *
+ * Usage:
+ *    EngineTests [filter] [--bench]
+ *
+ * Only entries who's name contains the filter are run. Benchmarks are skipped unless --bench is
+ * given, so that a plain run stays fast enough to use before every commit. Tests that need an
+ * OpenGL context are skipped on machines that can't create one
+ *
+ * Returns the number of failed entries, so that scripts can check for 0
+ */
+#include <string>
+
+#include "TestFramework.h"
+#include "GlTestContext.h"
+
+int main(int argc, char** args) {
+	Logger::Init();
+
+	std::string filter = "";
+	bool runBenchmarks = false;
+	for (int ix = 1; ix < argc; ix++) {
+		std::string arg = args[ix];
+		if (arg == "--bench") {
+			runBenchmarks = true;
+		} else {
+			filter = arg;
+		}
+	}
+
+	int result = TestRegistry::RunAll(filter, runBenchmarks);
+	GlTestContext::Shutdown();
+
+	Logger::Uninitialize();
+	return result;
+}
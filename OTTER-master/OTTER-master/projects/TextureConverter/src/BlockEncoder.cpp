@@ -0,0 +1,362 @@
+#include "BlockEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	/// <summary>
+	/// Finds the endpoints of the line that best fits a set of points, by projecting them onto their principal axis
+	/// </summary>
+	/// <param name="points">16 points with the given number of channels</param>
+	/// <param name="channels">The number of channels per point (up to 4)</param>
+	/// <param name="min">Receives the endpoint at the low end of the axis</param>
+	/// <param name="max">Receives the endpoint at the high end of the axis</param>
+	void FitLine(const float* points, int channels, float* min, float* max) {
+		float mean[4] = { 0.0f };
+		for (int ix = 0; ix < 16; ix++) {
+			for (int c = 0; c < channels; c++) {
+				mean[c] += points[ix * channels + c] / 16.0f;
+			}
+		}
+
+		float covariance[4][4] = { { 0.0f } };
+		for (int ix = 0; ix < 16; ix++) {
+			for (int a = 0; a < channels; a++) {
+				for (int b = 0; b < channels; b++) {
+					covariance[a][b] += (points[ix * channels + a] - mean[a]) * (points[ix * channels + b] - mean[b]);
+				}
+			}
+		}
+
+		// Power iteration to find the principal axis, starting from the diagonal of the covariance
+		float axis[4] = { 0.0f };
+		for (int c = 0; c < channels; c++) {
+			axis[c] = covariance[c][c];
+		}
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = { 0.0f };
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++) {
+				for (int b = 0; b < channels; b++) {
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, std::abs(next[a]));
+			}
+			if (length <= 0.0f) {
+				break;
+			}
+			for (int c = 0; c < channels; c++) {
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float minT = 0.0f;
+		float maxT = 0.0f;
+		for (int ix = 0; ix < 16; ix++) {
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++) {
+				t += (points[ix * channels + c] - mean[c]) * axis[c];
+			}
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (int c = 0; c < channels; c++) {
+			min[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			max[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	uint16_t PackRgb565(const float* color) {
+		uint16_t r = (uint16_t)std::lround(color[0] * 31.0f / 255.0f);
+		uint16_t g = (uint16_t)std::lround(color[1] * 63.0f / 255.0f);
+		uint16_t b = (uint16_t)std::lround(color[2] * 31.0f / 255.0f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	void UnpackRgb565(uint16_t value, int* color) {
+		int r = (value >> 11) & 31;
+		int g = (value >> 5) & 63;
+		int b = value & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	/// <summary>
+	/// Picks the closest palette entry for every pixel in a BC1 block
+	/// </summary>
+	/// <param name="rgba">The 16 pixels in the block</param>
+	/// <param name="color0">The first endpoint, in 565 format</param>
+	/// <param name="color1">The second endpoint, in 565 format</param>
+	/// <param name="indices">Receives the 2 bit indices for each pixel</param>
+	/// <returns>The total squared error of the block</returns>
+	int PickBC1Indices(const uint8_t rgba[64], uint16_t color0, uint16_t color1, uint32_t& indices) {
+		// We always encode in the 4 color mode, the endpoints get put in order when writing
+		int palette[4][3];
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		indices = 0;
+		int total = 0;
+		for (int ix = 0; ix < 16; ix++) {
+			int best = 0;
+			int bestError = INT32_MAX;
+			for (int p = 0; p < 4; p++) {
+				int error = 0;
+				for (int c = 0; c < 3; c++) {
+					int delta = rgba[ix * 4 + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= (uint32_t)best << (ix * 2);
+			total += bestError;
+		}
+		return total;
+	}
+
+	/// <summary>
+	/// Writes bits into a 128 bit block, starting from the least significant bit of the first byte
+	/// </summary>
+	struct BitWriter {
+		uint8_t* Data;
+		int      Position;
+
+		void Write(uint32_t value, int count) {
+			for (int ix = 0; ix < count; ix++, Position++) {
+				if ((value >> ix) & 1) {
+					Data[Position / 8] |= (uint8_t)(1 << (Position % 8));
+				}
+			}
+		}
+	};
+}
+
+namespace BlockEncoder {
+	size_t GetBlockSize(BlockFormat format) {
+		return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+	}
+
+	void EncodeBlock(BlockFormat format, const uint8_t rgba[64], uint8_t* output) {
+		switch (format) {
+			case BlockFormat::BC1:
+				EncodeBC1(rgba, output);
+				break;
+			case BlockFormat::BC3:
+				EncodeBC4(rgba + 3, 4, output);
+				EncodeBC1(rgba, output + 8);
+				break;
+			case BlockFormat::BC4:
+				EncodeBC4(rgba, 4, output);
+				break;
+			case BlockFormat::BC5:
+				EncodeBC4(rgba, 4, output);
+				EncodeBC4(rgba + 1, 4, output + 8);
+				break;
+			case BlockFormat::BC7:
+				EncodeBC7(rgba, output);
+				break;
+		}
+	}
+
+	void EncodeBC1(const uint8_t rgba[64], uint8_t output[8]) {
+		float points[16 * 3];
+		for (int ix = 0; ix < 16; ix++) {
+			for (int c = 0; c < 3; c++) {
+				points[ix * 3 + c] = rgba[ix * 4 + c];
+			}
+		}
+
+		float min[3], max[3];
+		FitLine(points, 3, min, max);
+
+		uint16_t color0 = PackRgb565(max);
+		uint16_t color1 = PackRgb565(min);
+		uint32_t indices = 0;
+		int error = PickBC1Indices(rgba, color0, color1, indices);
+
+		// Refine the endpoints with a least squares fit to the indices we picked, keeping the
+		// result only if it actually reduces the error
+		static const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		for (int iteration = 0; iteration < 2 && color0 != color1; iteration++) {
+			float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			float ax[3] = { 0.0f }, bx[3] = { 0.0f };
+			for (int ix = 0; ix < 16; ix++) {
+				float a = WEIGHTS[(indices >> (ix * 2)) & 3];
+				float b = 1.0f - a;
+				aa += a * a;
+				ab += a * b;
+				bb += b * b;
+				for (int c = 0; c < 3; c++) {
+					ax[c] += a * rgba[ix * 4 + c];
+					bx[c] += b * rgba[ix * 4 + c];
+				}
+			}
+
+			float determinant = aa * bb - ab * ab;
+			if (std::abs(determinant) < 1e-6f) {
+				break;
+			}
+
+			float refined0[3], refined1[3];
+			for (int c = 0; c < 3; c++) {
+				refined0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+				refined1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+			}
+
+			uint16_t refinedColor0 = PackRgb565(refined0);
+			uint16_t refinedColor1 = PackRgb565(refined1);
+			uint32_t refinedIndices = 0;
+			int refinedError = PickBC1Indices(rgba, refinedColor0, refinedColor1, refinedIndices);
+			if (refinedError >= error) {
+				break;
+			}
+			color0  = refinedColor0;
+			color1  = refinedColor1;
+			indices = refinedIndices;
+			error   = refinedError;
+		}
+
+		// color0 > color1 selects the 4 color mode, so swap the endpoints and remap the indices
+		// if needed (0 <-> 1 and 2 <-> 3, which is just flipping the low bit)
+		if (color0 < color1) {
+			std::swap(color0, color1);
+			indices ^= 0x55555555;
+		}
+		// If the endpoints are equal the block is in 3 color mode, where index 3 is black
+		if (color0 == color1) {
+			indices = 0;
+		}
+
+		output[0] = (uint8_t)(color0 & 0xFF);
+		output[1] = (uint8_t)(color0 >> 8);
+		output[2] = (uint8_t)(color1 & 0xFF);
+		output[3] = (uint8_t)(color1 >> 8);
+		for (int ix = 0; ix < 4; ix++) {
+			output[4 + ix] = (uint8_t)(indices >> (ix * 8));
+		}
+	}
+
+	void EncodeBC4(const uint8_t* values, size_t stride, uint8_t output[8]) {
+		uint8_t min = 255;
+		uint8_t max = 0;
+		for (int ix = 0; ix < 16; ix++) {
+			min = std::min(min, values[ix * stride]);
+			max = std::max(max, values[ix * stride]);
+		}
+
+		// We always use the 8 value mode (endpoint 0 greater than endpoint 1), where the codes
+		// are 0 = max, 1 = min, and 2-7 step from max towards min
+		uint64_t indices = 0;
+		if (max != min) {
+			for (int ix = 0; ix < 16; ix++) {
+				int step = (int)std::lround((max - values[ix * stride]) * 7.0f / (max - min));
+				uint64_t code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+				indices |= code << (ix * 3);
+			}
+		}
+
+		output[0] = max;
+		output[1] = min;
+		for (int ix = 0; ix < 6; ix++) {
+			output[2 + ix] = (uint8_t)(indices >> (ix * 8));
+		}
+	}
+
+	void EncodeBC7(const uint8_t rgba[64], uint8_t output[16]) {
+		static const int WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		float points[16 * 4];
+		for (int ix = 0; ix < 64; ix++) {
+			points[ix] = rgba[ix];
+		}
+
+		float min[4], max[4];
+		FitLine(points, 4, min, max);
+
+		// Mode 6 stores 7 bits per channel, plus a shared low bit (p-bit) per endpoint. We pick the
+		// p-bit that gets each endpoint closest to it's unquantized value
+		int endpoints[2][4];
+		int quantized[2][4];
+		int pbits[2];
+		const float* targets[2] = { min, max };
+		for (int e = 0; e < 2; e++) {
+			float bestError = -1.0f;
+			for (int p = 0; p < 2; p++) {
+				int candidate[4];
+				float error = 0.0f;
+				for (int c = 0; c < 4; c++) {
+					candidate[c] = std::clamp((int)std::lround((targets[e][c] - p) / 2.0f), 0, 127);
+					float delta = (float)((candidate[c] << 1) | p) - targets[e][c];
+					error += delta * delta;
+				}
+				if (bestError < 0.0f || error < bestError) {
+					bestError = error;
+					pbits[e] = p;
+					for (int c = 0; c < 4; c++) {
+						quantized[e][c] = candidate[c];
+						endpoints[e][c] = (candidate[c] << 1) | p;
+					}
+				}
+			}
+		}
+
+		int palette[16][4];
+		for (int ix = 0; ix < 16; ix++) {
+			for (int c = 0; c < 4; c++) {
+				palette[ix][c] = ((64 - WEIGHTS[ix]) * endpoints[0][c] + WEIGHTS[ix] * endpoints[1][c] + 32) >> 6;
+			}
+		}
+
+		int indices[16];
+		for (int ix = 0; ix < 16; ix++) {
+			int bestError = INT32_MAX;
+			for (int p = 0; p < 16; p++) {
+				int error = 0;
+				for (int c = 0; c < 4; c++) {
+					int delta = rgba[ix * 4 + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					indices[ix] = p;
+				}
+			}
+		}
+
+		// The first index is stored with it's high bit implied to be zero, so if it's set we
+		// swap the endpoints and invert every index
+		if (indices[0] >= 8) {
+			for (int c = 0; c < 4; c++) {
+				std::swap(quantized[0][c], quantized[1][c]);
+			}
+			std::swap(pbits[0], pbits[1]);
+			for (int ix = 0; ix < 16; ix++) {
+				indices[ix] = 15 - indices[ix];
+			}
+		}
+
+		memset(output, 0, 16);
+		BitWriter writer = { output, 0 };
+		writer.Write(1 << 6, 7);
+		for (int c = 0; c < 4; c++) {
+			writer.Write(quantized[0][c], 7);
+			writer.Write(quantized[1][c], 7);
+		}
+		writer.Write(pbits[0], 1);
+		writer.Write(pbits[1], 1);
+		writer.Write(indices[0], 3);
+		for (int ix = 1; ix < 16; ix++) {
+			writer.Write(indices[ix], 4);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// The block compressed formats that the converter can write
+/// </summary>
+enum class BlockFormat {
+	BC1,
+	BC3,
+	BC4,
+	BC5,
+	BC7
+};
+
+/// <summary>
+/// Simple CPU encoders for 4x4 blocks of BCn compressed data. These favour being small and
+/// predictable over quality, and never touch a graphics API so they can run headless
+/// </summary>
+namespace BlockEncoder {
+	/// <summary>
+	/// Gets the number of bytes in a single encoded block of the given format
+	/// </summary>
+	size_t GetBlockSize(BlockFormat format);
+
+	/// <summary>
+	/// Encodes a single 4x4 block of pixels
+	/// </summary>
+	/// <param name="format">The format to encode into</param>
+	/// <param name="rgba">16 RGBA8 pixels in row major order, where the first row is the first row of the block in memory</param>
+	/// <param name="output">The destination for the block, must be GetBlockSize(format) bytes long</param>
+	void EncodeBlock(BlockFormat format, const uint8_t rgba[64], uint8_t* output);
+
+	/// <summary>
+	/// Encodes a BC1 block, ignoring alpha
+	/// </summary>
+	void EncodeBC1(const uint8_t rgba[64], uint8_t output[8]);
+	/// <summary>
+	/// Encodes a single channel BC4 block
+	/// </summary>
+	/// <param name="values">The 16 values to encode</param>
+	/// <param name="stride">The distance between values in bytes</param>
+	void EncodeBC4(const uint8_t* values, size_t stride, uint8_t output[8]);
+	/// <summary>
+	/// Encodes a BC7 block using mode 6 (a single RGBA line with 4 bit indices)
+	/// </summary>
+	void EncodeBC7(const uint8_t rgba[64], uint8_t output[16]);
+}
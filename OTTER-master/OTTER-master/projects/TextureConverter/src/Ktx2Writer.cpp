@@ -0,0 +1,169 @@
+#include "Ktx2Writer.h"
+
+#include <fstream>
+#include <cstring>
+
+namespace {
+	const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	// Data format descriptor values, see the Khronos Data Format Specification
+	const uint32_t KHR_DF_MODEL_BC1A = 128;
+	const uint32_t KHR_DF_MODEL_BC3  = 130;
+	const uint32_t KHR_DF_MODEL_BC4  = 131;
+	const uint32_t KHR_DF_MODEL_BC5  = 132;
+	const uint32_t KHR_DF_MODEL_BC7  = 134;
+	const uint32_t KHR_DF_PRIMARIES_BT709   = 1;
+	const uint32_t KHR_DF_TRANSFER_LINEAR   = 1;
+	const uint32_t KHR_DF_TRANSFER_SRGB     = 2;
+	const uint32_t KHR_DF_SAMPLE_LINEAR     = 0x10;
+
+	struct Sample {
+		uint32_t Channel;
+		uint32_t BitOffset;
+		uint32_t BitLength;
+		bool     Linear;
+	};
+
+	uint32_t GetVkFormat(BlockFormat format, bool srgb) {
+		switch (format) {
+			case BlockFormat::BC1: return srgb ? 132 : 131;
+			case BlockFormat::BC3: return srgb ? 138 : 137;
+			case BlockFormat::BC4: return 139;
+			case BlockFormat::BC5: return 141;
+			case BlockFormat::BC7: return srgb ? 146 : 145;
+			default: return 0;
+		}
+	}
+
+	void Append(std::vector<uint8_t>& buffer, const void* data, size_t size) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+
+	void Append32(std::vector<uint8_t>& buffer, uint32_t value) {
+		Append(buffer, &value, sizeof(value));
+	}
+
+	void Write32(std::vector<uint8_t>& buffer, size_t offset, uint32_t value) {
+		memcpy(buffer.data() + offset, &value, sizeof(value));
+	}
+
+	void Write64(std::vector<uint8_t>& buffer, size_t offset, uint64_t value) {
+		memcpy(buffer.data() + offset, &value, sizeof(value));
+	}
+
+	void Align(std::vector<uint8_t>& buffer, size_t alignment) {
+		buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+	}
+
+	std::vector<uint8_t> BuildDataFormatDescriptor(BlockFormat format, bool srgb) {
+		uint32_t model = 0;
+		std::vector<Sample> samples;
+		switch (format) {
+			case BlockFormat::BC1:
+				model = KHR_DF_MODEL_BC1A;
+				samples = { { 0, 0, 64, false } };
+				break;
+			case BlockFormat::BC3:
+				model = KHR_DF_MODEL_BC3;
+				samples = { { 15, 0, 64, true }, { 0, 64, 64, false } };
+				break;
+			case BlockFormat::BC4:
+				model = KHR_DF_MODEL_BC4;
+				samples = { { 0, 0, 64, false } };
+				break;
+			case BlockFormat::BC5:
+				model = KHR_DF_MODEL_BC5;
+				samples = { { 0, 0, 64, false }, { 1, 64, 64, false } };
+				break;
+			case BlockFormat::BC7:
+				model = KHR_DF_MODEL_BC7;
+				samples = { { 0, 0, 128, false } };
+				break;
+		}
+
+		uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+		std::vector<uint8_t> result;
+		Append32(result, 4 + blockSize);
+		Append32(result, 0); // Khronos vendor, basic descriptor type
+		Append32(result, 2 | (blockSize << 16)); // Version 2
+		Append32(result, model | (KHR_DF_PRIMARIES_BT709 << 8) | ((srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16));
+		Append32(result, 3 | (3 << 8)); // 4x4 texel blocks (stored as size - 1)
+		Append32(result, (uint32_t)BlockEncoder::GetBlockSize(format));
+		Append32(result, 0);
+		for (const Sample& sample : samples) {
+			uint32_t qualifiers = srgb && sample.Linear ? KHR_DF_SAMPLE_LINEAR : 0;
+			Append32(result, sample.BitOffset | ((sample.BitLength - 1) << 16) | ((sample.Channel | qualifiers) << 24));
+			Append32(result, 0);
+			Append32(result, 0);
+			Append32(result, 0xFFFFFFFF);
+		}
+		return result;
+	}
+
+	void AppendKeyValue(std::vector<uint8_t>& buffer, const std::string& key, const std::string& value) {
+		uint32_t length = (uint32_t)(key.size() + 1 + value.size() + 1);
+		Append32(buffer, length);
+		Append(buffer, key.c_str(), key.size() + 1);
+		Append(buffer, value.c_str(), value.size() + 1);
+		Align(buffer, 4);
+	}
+}
+
+namespace Ktx2Writer {
+	bool Write(const std::string& filename, BlockFormat format, bool srgb, bool bottomUp, const std::vector<Level>& levels) {
+		if (levels.empty()) {
+			return false;
+		}
+
+		std::vector<uint8_t> dfd = BuildDataFormatDescriptor(format, srgb);
+		std::vector<uint8_t> kvd;
+		AppendKeyValue(kvd, "KTXorientation", bottomUp ? "ru" : "rd");
+		AppendKeyValue(kvd, "KTXwriter", "OTTER TextureConverter");
+
+		std::vector<uint8_t> file;
+		Append(file, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+		Append32(file, GetVkFormat(format, srgb));
+		Append32(file, 1); // Type size, always 1 for block compressed formats
+		Append32(file, levels[0].Width);
+		Append32(file, levels[0].Height);
+		Append32(file, 0); // Depth
+		Append32(file, 0); // Layer count
+		Append32(file, 1); // Face count
+		Append32(file, (uint32_t)levels.size());
+		Append32(file, 0); // No supercompression
+
+		// Index, the offsets get patched once we know them
+		size_t indexOffset = file.size();
+		file.resize(file.size() + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t), 0);
+
+		size_t levelIndexOffset = file.size();
+		file.resize(file.size() + levels.size() * 3 * sizeof(uint64_t), 0);
+
+		Write32(file, indexOffset, (uint32_t)file.size());
+		Write32(file, indexOffset + 4, (uint32_t)dfd.size());
+		Append(file, dfd.data(), dfd.size());
+
+		Write32(file, indexOffset + 8, (uint32_t)file.size());
+		Write32(file, indexOffset + 12, (uint32_t)kvd.size());
+		Append(file, kvd.data(), kvd.size());
+
+		// Level data is stored smallest first, aligned to the block size
+		size_t blockSize = BlockEncoder::GetBlockSize(format);
+		for (size_t ix = levels.size(); ix-- > 0;) {
+			Align(file, blockSize);
+			size_t entry = levelIndexOffset + ix * 3 * sizeof(uint64_t);
+			Write64(file, entry, file.size());
+			Write64(file, entry + 8, levels[ix].Blocks.size());
+			Write64(file, entry + 16, levels[ix].Blocks.size());
+			Append(file, levels[ix].Blocks.data(), levels[ix].Blocks.size());
+		}
+
+		std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open()) {
+			return false;
+		}
+		stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+		return stream.good();
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "BlockEncoder.h"
+
+/// <summary>
+/// Writes block compressed mip chains into KTX2 files that the engine's Texture2D can load
+/// </summary>
+namespace Ktx2Writer {
+	/// <summary>
+	/// A single encoded mip level
+	/// </summary>
+	struct Level {
+		uint32_t             Width;
+		uint32_t             Height;
+		std::vector<uint8_t> Blocks;
+	};
+
+	/// <summary>
+	/// Writes a KTX2 file containing the given mip levels
+	/// </summary>
+	/// <param name="filename">The path of the file to write</param>
+	/// <param name="format">The block format that the levels were encoded in</param>
+	/// <param name="srgb">True if the color channels are sRGB encoded</param>
+	/// <param name="bottomUp">True if the first row of blocks is the bottom of the image, this is recorded in the KTXorientation key</param>
+	/// <param name="levels">The mip levels to store, starting with the largest</param>
+	/// <returns>True if the file was written, false if otherwise</returns>
+	bool Write(const std::string& filename, BlockFormat format, bool srgb, bool bottomUp, const std::vector<Level>& levels);
+}
@@ -0,0 +1,81 @@
+#include "MipChain.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	inline float SrgbToLinear(float value) {
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	inline float LinearToSrgb(float value) {
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+}
+
+namespace MipChain {
+	Image Downsample(const Image& source, bool srgb) {
+		Image result;
+		result.Width  = std::max(source.Width / 2, 1u);
+		result.Height = std::max(source.Height / 2, 1u);
+		result.Pixels.resize(result.Width * result.Height * 4);
+
+		for (uint32_t y = 0; y < result.Height; y++) {
+			for (uint32_t x = 0; x < result.Width; x++) {
+				for (int c = 0; c < 4; c++) {
+					bool convert = srgb && c < 3;
+					float sum = 0.0f;
+					for (uint32_t dy = 0; dy < 2; dy++) {
+						for (uint32_t dx = 0; dx < 2; dx++) {
+							uint32_t sx = std::min(x * 2 + dx, source.Width - 1);
+							uint32_t sy = std::min(y * 2 + dy, source.Height - 1);
+							float value = source.Pixels[(sy * source.Width + sx) * 4 + c] / 255.0f;
+							sum += convert ? SrgbToLinear(value) : value;
+						}
+					}
+					float average = sum / 4.0f;
+					average = convert ? LinearToSrgb(average) : average;
+					result.Pixels[(y * result.Width + x) * 4 + c] = (uint8_t)std::lround(std::clamp(average, 0.0f, 1.0f) * 255.0f);
+				}
+			}
+		}
+		return result;
+	}
+
+	Ktx2Writer::Level Encode(const Image& image, BlockFormat format) {
+		Ktx2Writer::Level result;
+		result.Width  = image.Width;
+		result.Height = image.Height;
+
+		const uint32_t blocksX   = (image.Width + 3) / 4;
+		const uint32_t blocksY   = (image.Height + 3) / 4;
+		const size_t   blockSize = BlockEncoder::GetBlockSize(format);
+		result.Blocks.resize(blocksX * blocksY * blockSize);
+
+		uint8_t block[64];
+		for (uint32_t by = 0; by < blocksY; by++) {
+			for (uint32_t bx = 0; bx < blocksX; bx++) {
+				for (uint32_t py = 0; py < 4; py++) {
+					for (uint32_t px = 0; px < 4; px++) {
+						uint32_t x = std::min(bx * 4 + px, image.Width - 1);
+						uint32_t y = std::min(by * 4 + py, image.Height - 1);
+						memcpy(block + (py * 4 + px) * 4, image.Pixels.data() + (y * image.Width + x) * 4, 4);
+					}
+				}
+				BlockEncoder::EncodeBlock(format, block, result.Blocks.data() + (by * blocksX + bx) * blockSize);
+			}
+		}
+		return result;
+	}
+
+	std::vector<Ktx2Writer::Level> Build(Image image, BlockFormat format, bool srgb, bool mips) {
+		std::vector<Ktx2Writer::Level> levels;
+		levels.push_back(Encode(image, format));
+		while (mips && (image.Width > 1 || image.Height > 1)) {
+			image = Downsample(image, srgb);
+			levels.push_back(Encode(image, format));
+		}
+		return levels;
+	}
+}
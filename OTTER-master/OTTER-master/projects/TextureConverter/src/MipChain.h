@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "BlockEncoder.h"
+#include "Ktx2Writer.h"
+
+/// <summary>
+/// Builds and encodes mip chains for the converter. Like the rest of the converter this is
+/// CPU only, so the engine tests can run it without a GL context
+/// </summary>
+namespace MipChain {
+	/// <summary>
+	/// An uncompressed RGBA8 image
+	/// </summary>
+	struct Image {
+		uint32_t             Width;
+		uint32_t             Height;
+		std::vector<uint8_t> Pixels;
+	};
+
+	/// <summary>
+	/// Creates the next mip level down with a 2x2 box filter, filtering sRGB colors in linear space
+	/// </summary>
+	Image Downsample(const Image& source, bool srgb);
+
+	/// <summary>
+	/// Encodes a whole image into blocks, edge pixels are repeated to fill partial blocks
+	/// </summary>
+	Ktx2Writer::Level Encode(const Image& image, BlockFormat format);
+
+	/// <summary>
+	/// Encodes an image and, if requested, every mip level below it down to 1x1
+	/// </summary>
+	/// <param name="image">The top level of the image</param>
+	/// <param name="format">The block format to encode into</param>
+	/// <param name="srgb">True if the color channels are sRGB encoded</param>
+	/// <param name="mips">True to generate the full mip chain, false to only encode the top level</param>
+	/// <returns>The encoded levels, starting with the largest</returns>
+	std::vector<Ktx2Writer::Level> Build(Image image, BlockFormat format, bool srgb, bool mips);
+}
@@ -0,0 +1,81 @@
+/*
+ * Offline texture converter, compresses images into BCn KTX2 files with a prebuilt mip chain
+ * so that the engine doesn't need to decode PNGs or generate mip maps at load time
+ *
+ * Usage:
+ *    TextureConverter <input> <output.ktx2> [--format bc1|bc3|bc4|bc5|bc7] [--srgb] [--no-mips]
+ *
+ * The converter has no window or GL context, so it can be run headless from scripts
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "MipChain.h"
+
+bool ParseFormat(const std::string& name, BlockFormat& format) {
+	if (name == "bc1") { format = BlockFormat::BC1; return true; }
+	if (name == "bc3") { format = BlockFormat::BC3; return true; }
+	if (name == "bc4") { format = BlockFormat::BC4; return true; }
+	if (name == "bc5") { format = BlockFormat::BC5; return true; }
+	if (name == "bc7") { format = BlockFormat::BC7; return true; }
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " <input> <output.ktx2> [--format bc1|bc3|bc4|bc5|bc7] [--srgb] [--no-mips]" << std::endl;
+		return 1;
+	}
+
+	std::string input  = argv[1];
+	std::string output = argv[2];
+	BlockFormat format = BlockFormat::BC7;
+	bool srgb = false;
+	bool mips = true;
+
+	for (int ix = 3; ix < argc; ix++) {
+		std::string arg = argv[ix];
+		if (arg == "--format" && ix + 1 < argc) {
+			if (!ParseFormat(argv[++ix], format)) {
+				std::cerr << "Unknown format: " << argv[ix] << std::endl;
+				return 1;
+			}
+		} else if (arg == "--srgb") {
+			srgb = true;
+		} else if (arg == "--no-mips") {
+			mips = false;
+		} else {
+			std::cerr << "Unknown argument: " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	// We load the image bottom up like the engine does, and record that in the file so
+	// the engine never needs to flip the blocks
+	stbi_set_flip_vertically_on_load(true);
+	int width = 0, height = 0, channels = 0;
+	uint8_t* pixels = stbi_load(input.c_str(), &width, &height, &channels, 4);
+	if (pixels == nullptr) {
+		std::cerr << "Failed to load \"" << input << "\": " << stbi_failure_reason() << std::endl;
+		return 1;
+	}
+
+	MipChain::Image image;
+	image.Width  = (uint32_t)width;
+	image.Height = (uint32_t)height;
+	image.Pixels.assign(pixels, pixels + width * height * 4);
+	stbi_image_free(pixels);
+
+	std::vector<Ktx2Writer::Level> levels = MipChain::Build(std::move(image), format, srgb, mips);
+
+	if (!Ktx2Writer::Write(output, format, srgb, true, levels)) {
+		std::cerr << "Failed to write \"" << output << "\"" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Wrote " << width << "x" << height << " image with " << levels.size() << " levels to \"" << output << "\"" << std::endl;
+	return 0;
+}
@@ -4,8 +4,10 @@ layout(location = 0) in vec2 inUV;
 layout(location = 0) out vec4 outDiffuse;
 layout(location = 1) out vec4 outSpecular;
 
-// The maximum number of lights the shader supports, increasing this will lower performance!
-#define MAX_LIGHTS 8
+// The size of our light cluster grid, these need to match LightClusterGrid.h
+#define CLUSTER_SIZE_X 16
+#define CLUSTER_SIZE_Y 9
+#define CLUSTER_SIZE_Z 24
 
 // Represents a single light source
 struct Light {
@@ -14,21 +16,31 @@ struct Light {
 	vec4  ColorAttenuation;
 };
 
-// Our uniform buffer that will store all our lighting data
-// so that it can be shared between shaders
-layout (std140, binding = 2) uniform b_LightBlock {
-    // Stores ambient light color in rgb, and number
-	// of lights in w, allowing for easier struct packing
-	// on the C++ side
-    vec4  AmbientColAndNumLights;
+// Every light in the scene, in view space
+layout (std430, binding = 4) readonly buffer b_ClusterLights {
+    Light u_Lights[];
+};
 
-    // Our array of all lights
-    Light Lights[MAX_LIGHTS];
+// One entry per cluster, x is the offset into the light index list, y is the number of lights
+layout (std430, binding = 5) readonly buffer b_ClusterGrid {
+    uvec2 u_Clusters[];
+};
 
-    // The rotation of the skybox/environment map
-	mat3  EnvironmentRotation;
+// The indices of the lights that touch each cluster, packed together
+layout (std430, binding = 6) readonly buffer b_ClusterLightIndices {
+    uint u_LightIndices[];
 };
 
+// The scale (x) and bias (y) for converting from view depth to a depth slice
+uniform vec2 u_ClusterSliceParams;
+
+// Gets the index of the cluster that a fragment belongs to
+uint GetClusterIndex(vec2 uv, float viewDepth) {
+    uvec2 tile = uvec2(clamp(uv * vec2(CLUSTER_SIZE_X, CLUSTER_SIZE_Y), vec2(0), vec2(CLUSTER_SIZE_X - 1, CLUSTER_SIZE_Y - 1)));
+    uint slice = uint(clamp(floor(log(viewDepth) * u_ClusterSliceParams.x - u_ClusterSliceParams.y), 0, CLUSTER_SIZE_Z - 1));
+    return (slice * CLUSTER_SIZE_Y + tile.y) * CLUSTER_SIZE_X + tile.x;
+}
+
 #include "../fragments/deferred_post_common.glsl"
 
 #include "../fragments/frame_uniforms.glsl"
@@ -76,8 +88,11 @@ void main() {
 
     vec3 diffuse = vec3(0);
     vec3 specular = vec3(0);
-    for (int ix = 0; ix < AmbientColAndNumLights.w && ix < MAX_LIGHTS; ix++) {
-        CalcPointLightContribution(viewPos, normal, Lights[ix], specularPow, diffuse, specular);
+
+    // Only loop over the lights that can reach our cluster
+    uvec2 cluster = u_Clusters[GetClusterIndex(inUV, max(-viewPos.z, 0.0001))];
+    for (uint ix = 0; ix < cluster.y; ix++) {
+        CalcPointLightContribution(viewPos, normal, u_Lights[u_LightIndices[cluster.x + ix]], specularPow, diffuse, specular);
     }
 
     outDiffuse = vec4(diffuse, 1);
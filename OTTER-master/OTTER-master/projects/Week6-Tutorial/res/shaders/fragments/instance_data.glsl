@@ -0,0 +1,13 @@
+// Stores the per-instance data for objects that the renderer batches together
+// The renderer binds a range of it's instance ring buffer to this block for every batch,
+// so gl_InstanceID indexes directly into it
+struct InstanceData {
+    // Just the model transform
+    mat4 Model;
+    // Normal Matrix for transforming normals
+    mat4 NormalMatrix;
+};
+
+layout (std430, binding = 3) readonly buffer b_InstanceData {
+    InstanceData u_Instances[];
+};
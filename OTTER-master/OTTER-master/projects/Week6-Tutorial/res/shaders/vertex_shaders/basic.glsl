@@ -2,22 +2,27 @@
 
 // Include our common vertex shader attributes and uniforms
 #include "../fragments/vs_common.glsl"
+// Our transforms come from the instance data, so the renderer can batch objects using this shader
+#include "../fragments/instance_data.glsl"
 
 void main() {
+	InstanceData instance = u_Instances[gl_InstanceID];
+	mat3 normalMatrix = mat3(instance.NormalMatrix);
+	vec4 worldPos = instance.Model * vec4(inPosition, 1.0);
 
-	gl_Position = u_ModelViewProjection * vec4(inPosition, 1.0);
+	gl_Position = u_ViewProjection * worldPos;
 
 	// Lecture 5
 	// Pass vertex pos in world space to frag shader
-	outViewPos = (u_ModelView * vec4(inPosition, 1.0)).xyz;
+	outViewPos = (u_View * worldPos).xyz;
 
 	// Normals
-	outNormal = (u_View * vec4(mat3(u_NormalMatrix) * inNormal, 0)).xyz;
+	outNormal = (u_View * vec4(normalMatrix * inNormal, 0)).xyz;
 
     // We use a TBN matrix for tangent space normal mapping
-    vec3 T = normalize((u_View * vec4(mat3(u_NormalMatrix) * inTangent, 0)).xyz);
-    vec3 B = normalize((u_View * vec4(mat3(u_NormalMatrix) * inBiTangent, 0)).xyz);
-    vec3 N = normalize((u_View * vec4(mat3(u_NormalMatrix) * inNormal, 0)).xyz);
+    vec3 T = normalize((u_View * vec4(normalMatrix * inTangent, 0)).xyz);
+    vec3 B = normalize((u_View * vec4(normalMatrix * inBiTangent, 0)).xyz);
+    vec3 N = normalize((u_View * vec4(normalMatrix * inNormal, 0)).xyz);
     mat3 TBN = mat3(T, B, N);
 
     // We can pass the TBN matrix to the fragment shader to save computation
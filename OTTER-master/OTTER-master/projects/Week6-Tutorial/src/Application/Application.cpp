@@ -12,6 +12,7 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JobSystem.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -26,6 +27,8 @@
 #include "Graphics/Font.h"
 #include "Graphics/GuiBatcher.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/TextureUploader.h"
 
 // Gameplay
 #include "Gameplay/Material.h"
@@ -64,6 +67,9 @@ std::string Application::_applicationName = "INFR-2350U - DEMO";
 
 #define DEFAULT_WINDOW_WIDTH 1280
 #define DEFAULT_WINDOW_HEIGHT 720
+#define DEFAULT_RESOURCE_BUDGET_MB 512
+#define DEFAULT_UPLOAD_BUDGET_MB 16
+#define DEFAULT_JOB_THREADS 0
 
 Application::Application() :
 	_window(nullptr),
@@ -112,15 +118,26 @@ void Application::Quit() {
 }
 
 bool Application::LoadScene(const std::string& path) {
-	if (std::filesystem::exists(path)) { 
+	// Scenes saved from the editor have a binary copy next to the JSON, we prefer it as long as
+	// the JSON hasn't been edited since it was written
+	std::string binaryPath = Gameplay::Scene::GetBinaryPath(path);
+	bool hasJson   = std::filesystem::exists(path);
+	bool hasBinary = binaryPath != path && std::filesystem::exists(binaryPath);
+	bool useBinary = hasBinary && (!hasJson || std::filesystem::last_write_time(binaryPath) >= std::filesystem::last_write_time(path));
+
+	if (hasJson || hasBinary) { 
 
 		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
 		if (std::filesystem::exists(manifestPath)) {
 			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
-			ResourceManager::LoadManifest(manifestPath);
+			// Textures and meshes will stream in over the next few frames
+			ResourceManager::LoadManifest(manifestPath, true);
 		}
 
-		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
+		Gameplay::Scene::Sptr scene = useBinary ? Gameplay::Scene::LoadBinary(binaryPath) : nullptr;
+		if (scene == nullptr && hasJson) {
+			scene = Gameplay::Scene::Load(path);
+		}
 		LoadScene(scene);
 		return scene != nullptr;
 	}
@@ -172,6 +189,13 @@ void Application::_Run()
 	// Register all component and resource types
 	_RegisterClasses();
 
+	// Unused resources will be evicted once they use more than this much GPU memory
+	ResourceManager::SetMemoryBudget(JsonGet(_appSettings, "resource_budget_mb", DEFAULT_RESOURCE_BUDGET_MB) * 1024ull * 1024ull);
+	// Streamed resources will upload at most this much to the GPU per frame
+	ResourceManager::SetUploadBudget(JsonGet(_appSettings, "upload_budget_mb", DEFAULT_UPLOAD_BUDGET_MB) * 1024ull * 1024ull);
+	// Worker threads for parallel component updates, 0 picks based on the number of cores
+	JobSystem::Init(JsonGet(_appSettings, "job_threads", DEFAULT_JOB_THREADS));
+
 
 	// Load all layers
 	_Load();
@@ -192,6 +216,12 @@ void Application::_Run()
 		// Receive events like input and window position/size changes from GLFW
 		glfwPollEvents();
 
+		// Finish off any resources that have been loaded in the background, and evict
+		// unused ones if we're over our memory budget
+		TextureUploader::Update();
+		ResourceManager::PollStreaming();
+		ResourceManager::EnforceMemoryBudget();
+
 		// Handle closing the app via the close button
 		if (glfwWindowShouldClose(_window)) {
 			_isRunning = false;
@@ -217,11 +247,13 @@ void Application::_Run()
 
 		// Core update loop
 		if (_currentScene != nullptr) {
+			GpuProfiler::BeginFrame();
 			_Update();
 			_LateUpdate();
 			_PreRender();
 			_RenderScene(); 
 			_PostRender();
+			GpuProfiler::EndFrame();
 		}
 
 		// Store timing for next loop
@@ -318,6 +350,7 @@ void Application::_PreRender()
 
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPreRender)) {
+			GpuProfiler::Scope scope(layer->Name + "::OnPreRender");
 			layer->OnPreRender();
 		}
 	}
@@ -328,6 +361,7 @@ void Application::_RenderScene() {
 	Framebuffer::Sptr result = nullptr;
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnRender)) {
+			GpuProfiler::Scope scope(layer->Name + "::OnRender");
 			layer->OnRender(result);
 			Framebuffer::Sptr layerResult = layer->GetRenderOutput(); 
 			result = layerResult != nullptr ? layerResult : result;
@@ -342,6 +376,7 @@ void Application::_PostRender() {
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPostRender)) {
+			GpuProfiler::Scope scope(layer->Name + "::OnPostRender");
 			layer->OnPostRender();
 		}
 	}
@@ -356,6 +391,18 @@ void Application::_Unload() {
 		}
 	}
 
+	// Release our profiling queries while we still have a context
+	GpuProfiler::Cleanup();
+
+	// Stop the streaming workers, and release our resources while we still have a context
+	ResourceManager::Cleanup();
+
+	// Now that the workers are stopped, nothing can be writing to the upload ring
+	TextureUploader::Cleanup();
+
+	// Stop the job system workers
+	JobSystem::Shutdown();
+
 	// Clean up ImGui
 	ImGuiHelper::Cleanup();
 }
@@ -441,6 +488,9 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["resource_budget_mb"] = DEFAULT_RESOURCE_BUDGET_MB;
+	result["upload_budget_mb"] = DEFAULT_UPLOAD_BUDGET_MB;
+	result["job_threads"] = DEFAULT_JOB_THREADS;
 	return result;
 }
 
@@ -2,6 +2,7 @@
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 #include "Application/Application.h"
+#include "Graphics/TextureUploader.h"
 
 GLAppLayer::GLAppLayer() :
 	ApplicationLayer() {
@@ -27,6 +28,9 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 	LOG_ASSERT(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0, "Failed to initialize glad");
 
 	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	// Texture streaming needs a context for it's upload ring, so we set it up as soon as we have one
+	TextureUploader::Init();
 }
 
 void GLAppLayer::OnAppUnload()
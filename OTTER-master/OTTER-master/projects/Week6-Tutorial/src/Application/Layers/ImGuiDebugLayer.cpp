@@ -14,6 +14,7 @@
 #include "../Windows/TextureWindow.h"
 #include "../Windows/DebugWindow.h"
 #include "../Windows/GBufferPreviews.h"
+#include "../Windows/ProfilerWindow.h"
 
 ImGuiDebugLayer::ImGuiDebugLayer() :
 	ApplicationLayer(),
@@ -36,6 +37,7 @@ void ImGuiDebugLayer::OnAppLoad(const nlohmann::json& config)
 	RegisterWindow<TextureWindow>();
 	RegisterWindow<DebugWindow>();
 	RegisterWindow<GBufferPreviews>();
+	RegisterWindow<ProfilerWindow>();
 }
 
 void ImGuiDebugLayer::OnAppUnload()
@@ -171,7 +173,8 @@ void ImGuiDebugLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 				if (ImGui::MenuItem("Save Scene", NULL, false)) {
 					std::optional<std::string> path = FileDialogs::SaveFile("Scene File\0*.json\0\0");
 					if (path.has_value()) {
-						app.CurrentScene()->Save(path.value());
+						// Scenes saved from the editor get a binary copy, so they load faster next time
+						app.CurrentScene()->Save(path.value(), true);
 
 						std::string newFilename = std::filesystem::path(path.value()).stem().string() + "-manifest.json";
 						ResourceManager::SaveManifest(newFilename);
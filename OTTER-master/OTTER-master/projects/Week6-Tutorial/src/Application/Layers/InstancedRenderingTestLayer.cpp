@@ -1,52 +1,51 @@
 #include "InstancedRenderingTestLayer.h"
-#include "Utils/ObjLoader.h"
 #include "Gameplay/Scene.h"
 #include "Application/Application.h"
 #include "Gameplay/Components/RotatingBehaviour.h"
+#include "Gameplay/Components/RenderComponent.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Utils/ResourceManager/ResourceManager.h"
 
 InstancedRenderingTestLayer::InstancedRenderingTestLayer()
 	: ApplicationLayer()
 {
 	Name = "Instanced Rendering";
-	Overrides = AppLayerFunctions::OnSceneLoad | AppLayerFunctions::OnRender | AppLayerFunctions::OnUpdate;
+	Overrides = AppLayerFunctions::OnSceneLoad;
 }
 
 InstancedRenderingTestLayer::~InstancedRenderingTestLayer()
 { }
 
 void InstancedRenderingTestLayer::OnSceneLoad() {
-	Gameplay::Scene::Sptr scene = Application::Get().CurrentScene();
+	using namespace Gameplay;
+
+	Scene::Sptr scene = Application::Get().CurrentScene();
 
 	// The number of elements we're generating as a cube
 	const glm::ivec3 size = { 10, 10, 10 };
 	float distance = 2.0f;   
 
-	// Create a buffer to store out data, and reserve enough space for all our instances
-	_instanceBuffer = VertexBuffer::Create(BufferUsage::DynamicDraw);
-	_instanceBuffer->LoadData<InstanceInfo>(nullptr, size.x * size.y * size.z);
-
-	// Sending our 2 matrices as attributes
-	std::vector<BufferAttribute> instancedParams = {
-		BufferAttribute(8,  4, AttributeType::Float, sizeof(InstanceInfo), 0, AttribUsage::User0),
-		BufferAttribute(9,  4, AttributeType::Float, sizeof(InstanceInfo), 4 * sizeof(float), AttribUsage::User0),
-		BufferAttribute(10, 4, AttributeType::Float, sizeof(InstanceInfo), 8 * sizeof(float), AttribUsage::User0),
-		BufferAttribute(11, 4, AttributeType::Float, sizeof(InstanceInfo), 12 * sizeof(float), AttribUsage::User0),
-
-		BufferAttribute(12, 3, AttributeType::Float, sizeof(InstanceInfo), 16 * sizeof(float), AttribUsage::User0),
-		BufferAttribute(13, 3, AttributeType::Float, sizeof(InstanceInfo), 20 * sizeof(float), AttribUsage::User0),
-		BufferAttribute(14, 3, AttributeType::Float, sizeof(InstanceInfo), 24 * sizeof(float), AttribUsage::User0),
-	};
-
-	// Load a file to get the base VAO, then add the instanced buffers
-	_vao = ObjLoader::LoadFromFile("monkey.obj");
-	_vao->AddVertexBuffer(_instanceBuffer, instancedParams, true);
-
-	// Load our instanced shader
-	_shader = ShaderProgram::Create();
-	_shader->LoadShaderPartFromFile("shaders/vertex_shaders/basic_instanced.glsl", ShaderPartType::Vertex); 
-	_shader->LoadShaderPartFromFile("shaders/fragment_shaders/frag_environment_mirror.glsl", ShaderPartType::Fragment);
-	_shader->Link();
-
+	// We only need to create our assets once, every instance will share them so that
+	// the render layer can batch them together
+	if (_material == nullptr) {
+		// basic.glsl reads it's transforms from the instance data block, so the render
+		// layer will draw everything using this shader with instancing
+		ShaderProgram::Sptr shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
+			{ ShaderPartType::Fragment, "shaders/fragment_shaders/deferred_forward.glsl" }
+		});
+		shader->SetDebugName("Instancing Benchmark");
+
+		// Generated rather than loaded, so the benchmark doesn't depend on model files being present
+		_mesh = ResourceManager::CreateAsset<MeshResource>();
+		_mesh->AddParam(MeshBuilderParam::CreateIcoSphere(glm::vec3(0.0f), 0.5f, 3));
+		_mesh->GenerateMesh();
+
+		_material = ResourceManager::CreateAsset<Material>(shader);
+		_material->Name = "Instancing Benchmark";
+		_material->Set("u_Material.AlbedoMap", ResourceManager::CreateAsset<Texture2D>("textures/box-diffuse.png"));
+		_material->Set("u_Material.Shininess", 0.5f);
+	}
 
 	// Due to how scene stuff is handled in editor, we'll remove all existing instances and re-add them
 	for (auto& instance : _instances) {
@@ -59,7 +58,7 @@ void InstancedRenderingTestLayer::OnSceneLoad() {
 	for (int ix = 0; ix < size.x; ix++) {
 		for (int iy = 0; iy < size.y; iy++) {
 			for (int iz = 0; iz < size.z; iz++) {
-				Gameplay::GameObject::Sptr instance = scene->CreateGameObject("Instanced");
+				GameObject::Sptr instance = scene->CreateGameObject("Instanced");
 				instance->SetPostion({ ix * distance, iy * distance, iz * distance });
 				instance->HideInHierarchy = true;
 				instance->Add<RotatingBehaviour>()->RotationSpeed = { 
@@ -67,36 +66,13 @@ void InstancedRenderingTestLayer::OnSceneLoad() {
 					0,
 					(rand() / (float)RAND_MAX) * 90.0f
 				};
+
+				RenderComponent::Sptr renderer = instance->Add<RenderComponent>();
+				renderer->SetMesh(_mesh);
+				renderer->SetMaterial(_material);
+
 				_instances.push_back(instance);
 			}
 		}
 	}
-
-	// Upload instance data
-	_UpdateInstances();
-}
-
-void InstancedRenderingTestLayer::OnUpdate() {
-	//_UpdateInstances();
-}
-
-void InstancedRenderingTestLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
-	_shader->Bind();
-	_vao->DrawInstanced(_instances.size());
-}
-
-void InstancedRenderingTestLayer::_UpdateInstances() {
-	// We map our data into CPU-accessible memory, then cast it to our structure
-	InstanceInfo* data = reinterpret_cast<InstanceInfo*>(_instanceBuffer->Map(BufferMapMode::Write));
-
-	// Iterate over all instances
-	for (int ix = 0; ix < _instances.size(); ix++) {
-		// For now just update everything regardless of if it's changed or not
-		// A smarter system would only update if the data is old
-		data[ix].ModelMatrix  = _instances[ix]->GetTransform();
-		data[ix].NormalMatrix = glm::mat3(glm::transpose(glm::inverse(_instances[ix]->GetTransform())));
-	}
-
-	// Unmap the buffer so that the GPU can see it again
-	_instanceBuffer->Unmap();
 }
@@ -2,13 +2,15 @@
 #include "Application/ApplicationLayer.h"
 #include <glad/glad.h>
 #include <json.hpp>
-#include "Graphics/VertexArrayObject.h"
-#include "Graphics/ShaderProgram.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Material.h"
 
 
 /**
- * Handles demonstrating our instanced rendering
+ * Benchmark scene for the render layer's automatic instancing. Spawns a cube of spheres
+ * that all share the same mesh and material, which the render layer should batch into
+ * a single instanced draw (see the draw call count in the debug menu)
  */
 class InstancedRenderingTestLayer final : public ApplicationLayer {
 public:
@@ -20,21 +22,10 @@ public:
 	// Inherited from ApplicationLayer
 
 	virtual void OnSceneLoad() override;
-	virtual void OnUpdate() override;
-	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 
 protected:
-	VertexArrayObject::Sptr _vao;
-	VertexBuffer::Sptr _instanceBuffer;
-	ShaderProgram::Sptr _shader;
-	Texture2D::Sptr     _texture;
+	Gameplay::MeshResource::Sptr _mesh;
+	Gameplay::Material::Sptr     _material;
 		
 	std::vector<Gameplay::GameObject::WeakRef> _instances;
-
-	struct InstanceInfo {
-		glm::mat4 ModelMatrix;
-		glm::mat4 NormalMatrix;
-	};
-
-	void _UpdateInstances();
 };
\ No newline at end of file
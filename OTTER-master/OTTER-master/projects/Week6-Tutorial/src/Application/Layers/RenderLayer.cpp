@@ -53,7 +53,9 @@ void RenderLayer::OnPreRender()
 	// Clear the framebuffer. Note that this also binds and sets the viewport
 	_ClearFramebuffer(_primaryFBO, colors, 4);
 
-	
+	// Bring every changed transform up to date in one pass, parents before children
+	app.CurrentScene()->UpdateTransforms();
+
 	// Grab shorthands to the camera and shader from the scene
 	Camera::Sptr camera = app.CurrentScene()->MainCamera;
 
@@ -113,10 +115,6 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Cache the camera's viewprojection
 	glm::mat4 viewProj = camera->GetViewProjection(); 
 
-	// The current material that is bound for rendering
-	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
-
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
 
 	// Make sure depth testing and culling are re-enabled
@@ -127,10 +125,24 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Disable blending, we want to override any existing colors
 	glDisable(GL_BLEND);
 
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
-		// Early bail if mesh not set
-		if (renderable->GetMesh() == nullptr) {
+	// Make sure our culling tree is up to date with where all the objects are this frame
+	const CullingTree::Sptr& cullingTree = app.CurrentScene()->GetCullingTree();
+	uint32_t totalObjects = 0;
+	app.CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent* renderable) {
+		renderable->UpdateCullingBounds(cullingTree);
+		totalObjects++;
+	});
+
+	// Build our render queue for this frame, so that we can sort objects to minimize state changes
+	// Only objects that the culling tree reports as inside the camera's frustum make it into the queue
+	_renderQueue.Clear();
+	_drawItems.clear();
+	float maxDepth = camera->GetFarPlane();
+	cullingTree->Query(camera->GetFrustum(), [&](void* data) {
+		RenderComponent* renderable = static_cast<RenderComponent*>(data);
+
+		// Early bail if mesh not set, or if the component has been disabled
+		if (!renderable->IsEnabled || renderable->GetMesh() == nullptr) {
 			return;
 		}
 
@@ -144,32 +156,107 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 			}
 		}
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+		const Material::Sptr& material = renderable->GetMaterial();
+		const ShaderProgram::Sptr& shader = material->GetShader();
+		if (shader == nullptr) {
+			return;
+		}
+		VertexArrayObject* vao = renderable->GetMesh().get();
+
+		// Our depth is the distance along the camera's forward axis (which is -Z in view space)
+		glm::vec4 viewPos = view * glm::vec4(renderable->GetGameObject()->GetWorldPosition(), 1.0f);
+
+		uint64_t key = RenderQueue::MakeKey(
+			_renderQueue.GetShaderID(shader->GetHandle()),
+			_renderQueue.GetMaterialID(reinterpret_cast<uintptr_t>(material.get())),
+			_renderQueue.GetVaoID(vao->GetHandle()),
+			-viewPos.z, maxDepth
+		);
+		_renderQueue.Push(key, static_cast<uint32_t>(_drawItems.size()));
+		_drawItems.push_back({ renderable, material.get(), shader.get(), vao });
+	});
+
+	_cullStats.Drawn  = (uint32_t)_drawItems.size();
+	_cullStats.Culled = totalObjects - _cullStats.Drawn;
+
+	// Sort by shader, then material, then mesh, then front to back
+	_renderQueue.Sort();
+	_renderStats = _renderQueue.CountSwitches();
 
-			shader->Bind();
+	// Make sure there's enough room in the ring for every object, plus alignment padding
+	// for every possible batch
+	uint32_t instanceBytes = (uint32_t)_drawItems.size() * (sizeof(InstanceData) + _instanceRing->GetAlignment());
+	_instanceRing->BeginFrame(instanceBytes);
+
+	// The state that is currently bound for rendering
+	ShaderProgram*     currentShader = nullptr;
+	Material*          currentMat    = nullptr;
+	VertexArrayObject* currentVao    = nullptr;
+	bool               instanced     = false;
+
+	// The queue only knows about individual objects, we'll count how many draws we actually issue
+	uint32_t drawCalls = 0;
+
+	// Render all our objects
+	const std::vector<RenderQueue::Entry>& entries = _renderQueue.GetEntries();
+	for (size_t ix = 0; ix < entries.size(); ix++) {
+		const DrawItem& item = _drawItems[entries[ix].Payload];
+
+		// Only bind state when it has changed from the previous item, since the queue is
+		// sorted these switches should be at a minimum
+		if (item.Shader != currentShader) {
+			currentShader = item.Shader;
+			currentShader->Bind();
+			instanced = currentShader->HasStorageBlock("b_InstanceData");
+		}
+		if (item.Material != currentMat) {
+			currentMat = item.Material;
 			currentMat->Apply();
 		}
+		if (item.Vao != currentVao) {
+			currentVao = item.Vao;
+			currentVao->Bind();
+		}
+
+		// If our shader supports instancing, find the run of objects that share our material and
+		// mesh (they're next to each other since the queue is sorted), and draw them all at once
+		if (instanced) {
+			size_t end = ix + 1;
+			while (end < entries.size()) {
+				const DrawItem& next = _drawItems[entries[end].Payload];
+				if (next.Material != currentMat || next.Vao != currentVao) {
+					break;
+				}
+				end++;
+			}
+
+			if (_DrawInstanced(ix, end)) {
+				drawCalls++;
+			}
+			ix = end - 1;
+			continue;
+		}
 
 		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+		GameObject* object = item.Renderable->GetGameObject();
+		const glm::mat4& transform = object->GetTransform();
 
 		// Use our uniform buffer for our instance level uniforms
 		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_ModelView = view * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
+		instanceData.u_Model = transform;
+		instanceData.u_ModelViewProjection = viewProj * transform;
+		instanceData.u_ModelView = view * transform;
+		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(transform)));
 		_instanceUniforms->Update();
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
-	});
-
+		// Draw the object, our VAO is already bound
+		currentVao->DrawBound();
+		drawCalls++;
+	}
 
+	// Fence off this frame's instance data so we don't overwrite it while the GPU is still reading
+	_instanceRing->EndFrame();
+	_renderStats.DrawCalls = drawCalls;
 
 	VertexArrayObject::Unbind(); 
 }
@@ -240,48 +327,68 @@ void RenderLayer::_AccumulateLighting()
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color2)->Bind(3); // emissive
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color3)->Bind(4); // view pos
 
-	const glm::mat4& view = scene->MainCamera->GetView();
+	Camera::Sptr camera = scene->MainCamera;
+	const glm::mat4& view = camera->GetView();
 
 	// Send in how many active lights we have and the global lighting settings
 	data.AmbientCol = glm::vec3(0.1f);
-	int ix = 0;
-	app.CurrentScene()->Components().Each<Light>([&](const Light::Sptr& light) {
+	_clusterLights.clear();
+	_clusterLightBounds.clear();
+	app.CurrentScene()->Components().Each<Light>([&](Light* light) {
 		// Get the light's position in view space, since we're doing view space lighting
 		glm::vec4 pos = glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
 		pos = view * pos;
 
-		// Copy to the ubo data
-		data.Lights[ix].Position = (glm::vec3)(pos) / pos.w;
-		data.Lights[ix].Intensity = light->GetIntensity();
-		data.Lights[ix].Color = light->GetColor();
-		data.Lights[ix].Attenuation = 1.0f / (1.0f + light->GetRadius());  
-
-		ix++;
-
-		// If we've reached the max # of lights the shader supports, draw to the screen and start the next batch
-		if (ix == MAX_LIGHTS) {
-			data.NumLights = MAX_LIGHTS;
-
-			// Send updated data to OpenGL
-			_lightingUbo->Update();
-
-			// Draw the fullscreen quad to accumulate the lights
-			_fullscreenQuad->Draw();
-
-			ix = 0;
+		LightingUboStruct::Light entry;
+		entry.Position = (glm::vec3)(pos) / pos.w;
+		entry.Intensity = light->GetIntensity();
+		entry.Color = light->GetColor();
+		entry.Attenuation = 1.0f / (1.0f + light->GetRadius());
+
+		// Our attenuation never actually reaches zero, so we cut the light off once it's contribution
+		// drops below what we can see in an 8 bit channel
+		//    I * C / (1 + a * d^2) = 1/256  ->  d = sqrt((256 * I * C - 1) / a)
+		float brightest = entry.Intensity * glm::max(entry.Color.r, glm::max(entry.Color.g, entry.Color.b));
+		float radius = glm::sqrt(glm::max(256.0f * brightest - 1.0f, 0.0f) / entry.Attenuation);
+
+		// The UBO still gets the first few lights, since the forward shaders use it
+		if (_clusterLights.size() < MAX_LIGHTS) {
+			data.Lights[_clusterLights.size()] = entry;
 		}
-	});
 
-	// If we have lights left over that haven't been drawn, draw them now
-	if (ix > 0) {
-		data.NumLights = ix;
+		_clusterLights.push_back(entry);
+		_clusterLightBounds.push_back({ entry.Position, radius });
+	});
+	data.NumLights = (float)glm::min(_clusterLights.size(), (size_t)MAX_LIGHTS);
+	_lightingUbo->Update();
+
+	// Bin all the lights into our cluster grid, so each fragment only needs to look at the lights near it
+	_lightClusters.Build(_clusterLightBounds, camera->GetProjection(), camera->GetNearPlane(), camera->GetFarPlane());
+
+	// Upload the results, we always upload at least one element since empty buffers can't be bound
+	const std::vector<LightClusterGrid::Cluster>& clusters = _lightClusters.GetClusters();
+	const std::vector<uint32_t>& indices = _lightClusters.GetLightIndices();
+	LightingUboStruct::Light emptyLight = LightingUboStruct::Light();
+	uint32_t emptyIndex = 0;
+	if (_clusterLights.empty()) {
+		_clusterLightBuffer->UpdateData(&emptyLight, sizeof(LightingUboStruct::Light), 1);
+	} else {
+		_clusterLightBuffer->UpdateData(_clusterLights.data(), sizeof(LightingUboStruct::Light), (uint32_t)_clusterLights.size());
+	}
+	_clusterGridBuffer->UpdateData(clusters.data(), sizeof(LightClusterGrid::Cluster), (uint32_t)clusters.size());
+	if (indices.empty()) {
+		_clusterIndexBuffer->UpdateData(&emptyIndex, sizeof(uint32_t), 1);
+	} else {
+		_clusterIndexBuffer->UpdateData(indices.data(), sizeof(uint32_t), (uint32_t)indices.size());
+	}
 
-		// Send updated data to OpenGL
-		_lightingUbo->Update();
+	_clusterLightBuffer->Bind(CLUSTER_LIGHTS_SSBO_BINDING);
+	_clusterGridBuffer->Bind(CLUSTER_GRID_SSBO_BINDING);
+	_clusterIndexBuffer->Bind(CLUSTER_INDICES_SSBO_BINDING);
+	_lightAccumulationShader->SetUniform("u_ClusterSliceParams", _lightClusters.GetSliceParams());
 
-		// Draw the fullscreen quad to accumulate the lights
-		_fullscreenQuad->Draw();
-	}
+	// All the lights are handled in a single pass
+	_fullscreenQuad->Draw();
 
 	// Unbind the lighting FBO so we can read its textures
 	_lightingFBO->Unbind();
@@ -448,6 +555,40 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	_frameUniforms = std::make_shared<UniformBuffer<FrameLevelUniforms>>(BufferUsage::DynamicDraw);
 	_instanceUniforms = std::make_shared<UniformBuffer<InstanceLevelUniforms>>(BufferUsage::DynamicDraw);
 	_lightingUbo = std::make_shared<UniformBuffer<LightingUboStruct>>(BufferUsage::DynamicDraw);
+
+	// Our instance data is triple buffered, start with enough room for 1024 instances per frame
+	_instanceRing = PersistentRingBuffer::Create(BufferType::ShaderStorage, 1024 * sizeof(InstanceData), 3);
+
+	// Storage for our clustered lighting, these will grow as needed
+	_clusterLightBuffer = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+	_clusterGridBuffer  = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+	_clusterIndexBuffer = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+}
+
+bool RenderLayer::_DrawInstanced(size_t begin, size_t end)
+{
+	const std::vector<RenderQueue::Entry>& entries = _renderQueue.GetEntries();
+	uint32_t count = (uint32_t)(end - begin);
+
+	uint32_t offset = 0;
+	InstanceData* data = _instanceRing->Allocate<InstanceData>(count, offset);
+	if (data == nullptr) {
+		return false;
+	}
+
+	// Write directly into the mapped memory, the buffer is coherent so there's no need to flush
+	for (size_t ix = begin; ix < end; ix++) {
+		const glm::mat4& transform = _drawItems[entries[ix].Payload].Renderable->GetGameObject()->GetTransform();
+		InstanceData& instance = data[ix - begin];
+		instance.Model = transform;
+		// We only need the upper 3x3 for the normal matrix, which is much cheaper to invert
+		instance.NormalMatrix = glm::mat3(glm::transpose(glm::inverse(glm::mat3(transform))));
+	}
+
+	// All the items share a VAO, so we can just use the first one
+	_instanceRing->BindRange(INSTANCE_DATA_SSBO_BINDING, offset, count * sizeof(InstanceData));
+	_drawItems[entries[begin].Payload].Vao->DrawInstancedBound(count);
+	return true;
 }
 
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
@@ -482,6 +623,14 @@ RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
 
+const RenderQueue::SwitchStats& RenderLayer::GetRenderStats() const {
+	return _renderStats;
+}
+
+const RenderLayer::CullStats& RenderLayer::GetCullStats() const {
+	return _cullStats;
+}
+
 const Framebuffer::Sptr& RenderLayer::GetLightingBuffer() const {
 	return _lightingFBO;
 }
@@ -2,11 +2,22 @@
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
 #include "Graphics/Buffers/UniformBuffer.h"
+#include "Graphics/Buffers/PersistentRingBuffer.h"
+#include "Graphics/Buffers/ShaderStorageBuffer.h"
+#include "Graphics/LightClusterGrid.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/RenderQueue.h"
 
+// The number of lights in the lighting UBO used by our forward shaders, the deferred
+// light accumulation pass is clustered and has no limit
 #define MAX_LIGHTS 8
 
+class RenderComponent;
+namespace Gameplay {
+	class Material;
+}
+
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
 	EnableColorCorrection = 1 << 0
@@ -50,6 +61,16 @@ public:
 		glm::mat4 u_NormalMatrix;
 	};
 
+	// Structure for a single element of our instance data, matches layout from
+	// fragments/instance_data.glsl
+	// For use with an SSBO, written into our instance ring buffer
+	struct InstanceData {
+		// Just the model transform
+		glm::mat4 Model;
+		// Normal Matrix for transforming normals
+		glm::mat4 NormalMatrix;
+	};
+
 	/// <summary>
 	/// Represents a c++ struct layout that matches that of
 	/// our multiple light uniform buffer
@@ -95,6 +116,25 @@ public:
 
 	const Framebuffer::Sptr& GetLightingBuffer() const;
 
+	/// <summary>
+	/// Gets the number of state changes and draw calls from the last frame's
+	/// sorted render queue
+	/// </summary>
+	const RenderQueue::SwitchStats& GetRenderStats() const;
+
+	/// <summary>
+	/// Stores how many render components were frustum culled in a frame
+	/// </summary>
+	struct CullStats {
+		uint32_t Drawn  = 0;
+		uint32_t Culled = 0;
+	};
+
+	/// <summary>
+	/// Gets the number of objects that were drawn and culled in the last frame
+	/// </summary>
+	const CullStats& GetCullStats() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -126,6 +166,50 @@ protected:
 	const int LIGHTING_UBO_BINDING = 2;
 	UniformBuffer<LightingUboStruct>::Sptr _lightingUbo;
 
+	// Shaders that declare this storage block get their transforms from the instance
+	// ring buffer, which lets us draw many copies of a mesh with a single draw call
+	const int INSTANCE_DATA_SSBO_BINDING = 3;
+	PersistentRingBuffer::Sptr _instanceRing;
+
+	// Clustered lighting, every light goes into an SSBO, and the light accumulation
+	// pass only evaluates the lights that were binned into each fragment's cluster
+	const int CLUSTER_LIGHTS_SSBO_BINDING  = 4;
+	const int CLUSTER_GRID_SSBO_BINDING    = 5;
+	const int CLUSTER_INDICES_SSBO_BINDING = 6;
+	ShaderStorageBuffer::Sptr _clusterLightBuffer;
+	ShaderStorageBuffer::Sptr _clusterGridBuffer;
+	ShaderStorageBuffer::Sptr _clusterIndexBuffer;
+	LightClusterGrid          _lightClusters;
+	std::vector<LightingUboStruct::Light>       _clusterLights;
+	std::vector<LightClusterGrid::LightBounds> _clusterLightBounds;
+
+	/// <summary>
+	/// The state needed to issue a single draw from the render queue. These are
+	/// raw pointers since they only live for the duration of OnRender, while the
+	/// scene is holding onto the real objects
+	/// </summary>
+	struct DrawItem {
+		RenderComponent*    Renderable;
+		Gameplay::Material* Material;
+		ShaderProgram*      Shader;
+		VertexArrayObject*  Vao;
+	};
+
+	// Our per-frame draw list, sorted by state to minimize switching
+	RenderQueue               _renderQueue;
+	std::vector<DrawItem>     _drawItems;
+	RenderQueue::SwitchStats  _renderStats;
+	CullStats                 _cullStats;
+
+	/// <summary>
+	/// Draws a run of items from the render queue that all share the same material and VAO
+	/// with a single instanced draw. The material and VAO must already be bound
+	/// </summary>
+	/// <param name="begin">The index of the first entry in the render queue</param>
+	/// <param name="end">The index after the last entry in the render queue</param>
+	/// <returns>True if the draw was issued, false if the instance ring had no room for the run</returns>
+	bool _DrawInstanced(size_t begin, size_t end);
+
 	void _AccumulateLighting();
 	void _Composite();
 	void _ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers);
@@ -37,4 +37,17 @@ void DebugWindow::RenderMenuBar()
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	ImGui::Separator();
+
+	// Show how well the render queue is batching our draws
+	const RenderQueue::SwitchStats& stats = renderLayer->GetRenderStats();
+	ImGui::Text("Draw Calls: %u", stats.DrawCalls);
+	ImGui::Text("Program Switches: %u", stats.ProgramSwitches);
+	ImGui::Text("Material Switches: %u", stats.MaterialSwitches);
+	ImGui::Text("VAO Switches: %u", stats.VaoSwitches);
+
+	const RenderLayer::CullStats& cullStats = renderLayer->GetCullStats();
+	ImGui::Text("Objects Drawn: %u", cullStats.Drawn);
+	ImGui::Text("Objects Culled: %u", cullStats.Culled);
 }
@@ -0,0 +1,141 @@
+#include "ProfilerWindow.h"
+#include "Application/Timing.h"
+#include "Utils/ImGuiHelper.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Graphics/TextureUploader.h"
+#include <algorithm>
+#include <Sys.h>
+
+ProfilerWindow::ProfilerWindow() :
+	IEditorWindow(),
+	_frameTimes(),
+	_frameOffset(0),
+	_sharedScale(true)
+{
+	Name = "Profiler";
+	SplitDirection = ImGuiDir_::ImGuiDir_None;
+	Requirements = EditorWindowRequirements::Window;
+	Open = false;
+}
+
+ProfilerWindow::~ProfilerWindow() = default;
+
+void ProfilerWindow::Render()
+{
+	const int count = GpuProfiler::HISTORY_LENGTH;
+
+	// Track the total CPU frame time so we have something to compare the passes against
+	_frameTimes[_frameOffset] = Timing::Current().UnscaledDeltaTime() * 1000.0f;
+	_frameOffset = (_frameOffset + 1) % count;
+
+	bool enabled = GpuProfiler::IsEnabled();
+	if (ImGui::Checkbox("Enabled", &enabled)) {
+		GpuProfiler::SetEnabled(enabled);
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Shared Scale", &_sharedScale);
+
+	float width = ImGui::GetContentRegionAvailWidth();
+	char overlay[64];
+
+	float frameAvg = _Average(_frameTimes, count);
+	snprintf(overlay, 64, "Frame: %.2f ms (%.0f FPS)", frameAvg, frameAvg > 0.0f ? 1000.0f / frameAvg : 0.0f);
+	ImGui::PlotHistogram("##frame", _frameTimes, count, _frameOffset, overlay, 0.0f, _Max(_frameTimes, count), ImVec2(width, 50.0f));
+
+	ImGui::Separator();
+
+	const std::vector<GpuProfiler::PassTimings>& passes = GpuProfiler::GetPasses();
+	uint64_t frame = GpuProfiler::GetFrameIndex();
+
+	// Figure out the scale that all passes share, so that taller bars mean more time
+	float sharedMax = 0.0f;
+	for (const auto& pass : passes) {
+		sharedMax = std::max(sharedMax, _Max(pass.GpuTimes, count));
+		sharedMax = std::max(sharedMax, _Max(pass.CpuTimes, count));
+	}
+
+	for (const auto& pass : passes) {
+		// Skip passes that haven't run recently, like disabled layers
+		if (frame - pass.LastFrame > count) {
+			continue;
+		}
+
+		ImGui::PushID(&pass);
+		float gpuAvg = _Average(pass.GpuTimes, count);
+		float cpuAvg = _Average(pass.CpuTimes, count);
+		ImGui::Text("%s", pass.Name.c_str());
+
+		ImGui::Columns(2, nullptr, false);
+		float columnWidth = ImGui::GetColumnWidth() - ImGui::GetStyle().ItemSpacing.x * 2.0f;
+
+		snprintf(overlay, 64, "GPU: %.3f ms", gpuAvg);
+		float gpuMax = _sharedScale ? sharedMax : _Max(pass.GpuTimes, count);
+		ImGui::PlotHistogram("##gpu", pass.GpuTimes, count, pass.Offset, overlay, 0.0f, gpuMax, ImVec2(columnWidth, 40.0f));
+		ImGui::NextColumn();
+
+		snprintf(overlay, 64, "CPU: %.3f ms", cpuAvg);
+		float cpuMax = _sharedScale ? sharedMax : _Max(pass.CpuTimes, count);
+		ImGui::PlotHistogram("##cpu", pass.CpuTimes, count, pass.Offset, overlay, 0.0f, cpuMax, ImVec2(columnWidth, 40.0f));
+		ImGui::Columns(1);
+
+		ImGui::PopID();
+	}
+
+	ImGui::Separator();
+	_RenderMemoryStats();
+}
+
+void ProfilerWindow::_RenderMemoryStats() {
+	if (!ImGui::CollapsingHeader("Memory")) {
+		return;
+	}
+
+	ImGui::Text("Process:   %.1f MB (peak %.1f MB)", System::GetMemoryUsageMB(), System::GetPeakMemoryUsageMB());
+
+	size_t budget = ResourceManager::GetMemoryBudget();
+	double resourceMb = ResourceManager::GetTotalGpuMemory() / (1024.0 * 1024.0);
+	if (budget > 0) {
+		ImGui::Text("Resources: %.1f MB / %.1f MB budget", resourceMb, budget / (1024.0 * 1024.0));
+	} else {
+		ImGui::Text("Resources: %.1f MB (no budget)", resourceMb);
+	}
+	ImGui::Text("Streaming: %d pending", static_cast<int>(ResourceManager::GetPendingLoadCount()));
+
+	if (TextureUploader::IsInitialized()) {
+		TextureUploader::Stats uploads = TextureUploader::GetStats();
+		ImGui::Text("Uploads:   %.1f MB in %d uploads (%d fell back to client memory)",
+			uploads.BytesUploaded / (1024.0 * 1024.0), (int)uploads.Uploads, (int)uploads.FallbackAllocs);
+		ImGui::Text("Ring:      %.1f MB / %.1f MB (peak %.1f MB)", uploads.BytesInUse / (1024.0 * 1024.0),
+			TextureUploader::GetSize() / (1024.0 * 1024.0), uploads.PeakBytesInUse / (1024.0 * 1024.0));
+	}
+
+	ImGui::Columns(4, "resource_memory");
+	ImGui::Text("Type");        ImGui::NextColumn();
+	ImGui::Text("Loaded");      ImGui::NextColumn();
+	ImGui::Text("GPU (MB)");    ImGui::NextColumn();
+	ImGui::Text("Unused (MB)"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const ResourceMemoryStats& stats : ResourceManager::GetMemoryStats()) {
+		ImGui::Text("%s", stats.TypeName.c_str());                                ImGui::NextColumn();
+		ImGui::Text("%d (%d unused)", (int)stats.Count, (int)stats.UnusedCount); ImGui::NextColumn();
+		ImGui::Text("%.2f", stats.GpuBytes / (1024.0 * 1024.0));                  ImGui::NextColumn();
+		ImGui::Text("%.2f", stats.UnusedGpuBytes / (1024.0 * 1024.0));            ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+float ProfilerWindow::_Average(const float* values, int count) {
+	float total = 0.0f;
+	for (int ix = 0; ix < count; ix++) {
+		total += values[ix];
+	}
+	return count > 0 ? total / count : 0.0f;
+}
+
+float ProfilerWindow::_Max(const float* values, int count) {
+	float result = 0.0f;
+	for (int ix = 0; ix < count; ix++) {
+		result = std::max(result, values[ix]);
+	}
+	return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Application/IEditorWindow.h"
+#include "Graphics/GpuProfiler.h"
+
+/**
+ * Displays rolling GPU and CPU timings for each profiled pass, alongside the
+ * total frame time, as well as process and resource memory usage
+ */
+class ProfilerWindow final : public IEditorWindow {
+public:
+	MAKE_PTRS(ProfilerWindow);
+	ProfilerWindow();
+	virtual ~ProfilerWindow();
+
+	// Inherited from IEditorWindow
+
+	virtual void Render() override;
+
+protected:
+	// Frame times from Timing, in milliseconds, stored the same way as the pass histories
+	float _frameTimes[GpuProfiler::HISTORY_LENGTH];
+	int   _frameOffset;
+	// If true, all histograms share the same vertical scale so passes can be compared
+	bool  _sharedScale;
+
+	void _RenderMemoryStats();
+
+	static float _Average(const float* values, int count);
+	static float _Max(const float* values, int count);
+};
@@ -105,6 +105,11 @@ namespace Gameplay {
 		return _viewProjection;
 	}
 
+	const Frustum& Camera::GetFrustum() const {
+		_frustum.Extract(_viewProjection);
+		return _frustum;
+	}
+
 	const glm::vec4& Camera::GetClearColor() const
 	{
 		return _clearColor;
@@ -3,6 +3,7 @@
 #include <memory>
 #include <GLM/glm.hpp>
 #include "Gameplay/Components/IComponent.h"
+#include "Utils/Frustum.h"
 
 namespace Gameplay {
 	/// <summary>
@@ -67,6 +68,14 @@ namespace Gameplay {
 		/// Gets whether this camera is in orthographic mode
 		/// </summary>
 		bool GetOrthoEnabled() const { return _isOrtho; }
+		/// <summary>
+		/// Gets the distance to the camera's near clipping plane
+		/// </summary>
+		float GetNearPlane() const { return _nearPlane; }
+		/// <summary>
+		/// Gets the distance to the camera's far clipping plane
+		/// </summary>
+		float GetFarPlane() const { return _farPlane; }
 
 		/// <summary>
 		/// Gets the view matrix for this camera
@@ -80,6 +89,11 @@ namespace Gameplay {
 		/// Gets the combined view-projection matrix for this camera, calculating if needed
 		/// </summary>
 		const glm::mat4& GetViewProjection() const;
+		/// <summary>
+		/// Gets the world space frustum planes for this camera, extracted from the
+		/// view-projection matrix that was last calculated by GetViewProjection
+		/// </summary>
+		const Frustum& GetFrustum() const;
 
 		const glm::vec4& GetClearColor() const;
 		void SetClearColor(const glm::vec4& color);
@@ -100,6 +114,8 @@ namespace Gameplay {
 		mutable glm::mat4 _viewProjection;
 		// A dirty flag that indicates whether we need to re-calculate our view projection matrix
 		mutable bool      _isDirty;
+		// The frustum planes, extracted from _viewProjection
+		mutable Frustum   _frustum;
 
 		glm::vec4         _clearColor;
 
@@ -1,9 +1,13 @@
 #pragma once
 #include <functional>
 #include "IComponent.h"
+#include "ComponentPool.h"
 #include <typeindex>
 #include <optional>
 #include <Logging.h>
+#include <unordered_set>
+#include "Utils/JobSystem.h"
+#include "Utils/Macros.h"
 
 namespace Gameplay {
 	/// <summary>
@@ -16,6 +20,15 @@ namespace Gameplay {
 		typedef std::function<IComponent::Sptr(const nlohmann::json&)> LoadComponentFunc;
 		typedef std::function<IComponent::Sptr()> CreateComponentFunc;
 
+		ComponentManager() = default;
+		inline ~ComponentManager() {
+			// Any components that outlive us need to know not to remove themselves
+			FlushAll();
+		}
+
+		NO_COPY(ComponentManager);
+		NO_MOVE(ComponentManager);
+
 		/// <summary>
 		/// Loads a component with the given type name from a JSON blob
 		/// If the type name does not correspond to a registered type, will
@@ -42,7 +55,7 @@ namespace Gameplay {
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
@@ -71,7 +84,7 @@ namespace Gameplay {
 					result->_realType = typeIndex.value();
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
@@ -98,7 +111,7 @@ namespace Gameplay {
 				result->_realType = type;
 				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_AddToPool(result.get());
 				return result;
 			}
 			return nullptr;
@@ -140,7 +153,7 @@ namespace Gameplay {
 			component->_weakSelfPtr = component;
 
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_AddToPool(component.get());
 
 			// Return the result
 			return component;
@@ -161,52 +174,85 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
-			} else {
+			// Look up the component, and make sure it's actually the type that was requested
+			auto it = _ComponentsByGuid.find(id);
+			if (it == _ComponentsByGuid.end() || it->second->_realType != type) {
 				return nullptr;
 			}
+
+			// We've checked the concrete type, so we know this cast is safe
+			return std::static_pointer_cast<ComponentType>(it->second->SelfRef().lock());
 		}
 
 		/// <summary>
 		/// Iterates over all components of the given type and invokes a method with them
+		/// 
+		/// The callback is invoked with a raw pointer to each component, any callable that
+		/// accepts a ComponentType* will work (ex: a lambda)
 		/// </summary>
 		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
 		/// <param name="callback">The callback to invoke with the components</param>
 		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
 		template <
 			typename ComponentType,
+			typename Func,
 			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
-		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
+		void Each(Func&& callback, bool includeDisabled = false) {
 			// We can use typeid and type_index to get a unique ID for our types
 			std::type_index type = std::type_index(typeid(ComponentType));
-			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
+			LOG_ASSERT(_TypeLoadRegistry.find(type) != _TypeLoadRegistry.end(), "You must register component types before creating them!");
 
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+			auto it = _Components.find(type);
+			if (it == _Components.end()) {
+				return;
+			}
+
+			// We iterate by index, so that callbacks that add new components don't invalidate our iteration,
+			// and hold an iteration scope so that components removed by the callback leave a hole instead
+			// of swapping the last component into a slot we've already passed. The size is taken up front,
+			// so components added by the callback are only visited on the next pass
+			ComponentPool& pool = it->second;
+			ComponentPool::IterationScope scope(pool);
+			const size_t count = pool.Size();
+			for (size_t ix = 0; ix < count; ix++) {
+				// Every component in the pool has this exact type, so we can skip the dynamic_cast
+				ComponentType* component = static_cast<ComponentType*>(pool[ix]);
+				if (component == nullptr) {
+					continue;
+				}
+				if (component->IsEnabled || includeDisabled) {
+					callback(component);
 				}
 			}
 		}
 
+		/// <summary>
+		/// Invokes Update on all enabled components whose type is marked with IsUpdateThreadSafe, splitting
+		/// each type's pool into chunks that are spread across the job system. Returns once every
+		/// update has finished
+		/// </summary>
+		/// <param name="dt">The time since the last frame, in seconds</param>
+		/// <param name="chunkSize">The number of components to update in each job</param>
+		inline void ParallelUpdate(float dt, size_t chunkSize = JobSystem::DEFAULT_CHUNK_SIZE) {
+			for (const std::type_index& type : _ThreadSafeTypes) {
+				auto it = _Components.find(type);
+				if (it == _Components.end()) {
+					continue;
+				}
+
+				// Components can't be added or removed from within a thread safe update, so the pool is stable
+				const ComponentPool& pool = it->second;
+				JobSystem::ParallelFor(pool.Size(), chunkSize, [&pool, dt](size_t begin, size_t end) {
+					for (size_t ix = begin; ix < end; ix++) {
+						IComponent* component = pool[ix];
+						if (component->IsEnabled) {
+							component->Update(dt);
+						}
+					}
+				});
+			}
+		}
+
 		/// <summary>
 		/// Attempts to register a given type as a component, should be called for each component type 
 		/// at the start of you application
@@ -227,6 +273,9 @@ namespace Gameplay {
 				_TypeLoadRegistry[type] = &ComponentManager::ParseTypeFromBlob<T>;
 				_TypeCreateRegistry[type] = &ComponentManager::_InternalCreate<T>;
 				_TypeNameMap[StringTools::SanitizeClassName(typeid(T).name())] = type;
+				if (T::IsUpdateThreadSafe) {
+					_ThreadSafeTypes.insert(type);
+				}
 			}
 		}
 
@@ -234,7 +283,16 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			for (auto& [type, pool] : _Components) {
+				for (size_t ix = 0; ix < pool.Size(); ix++) {
+					if (pool[ix] != nullptr) {
+						pool[ix]->_manager = nullptr;
+						pool[ix]->_isUpdateThreadSafe = false;
+					}
+				}
+				pool.Clear();
+			}
+			_ComponentsByGuid.clear();
 		}
 
 	private:
@@ -249,11 +307,24 @@ namespace Gameplay {
 		inline static std::unordered_map<std::type_index, LoadComponentFunc> _TypeLoadRegistry;
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
+		// The component types that can be updated in parallel, see IComponent::IsUpdateThreadSafe
+		inline static std::unordered_set<std::type_index> _ThreadSafeTypes;
 
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		// Stores a densely packed pool of components for each type. The pools hold raw pointers, so they
+		// don't keep components alive, instead components remove themselves when they are destroyed
+		std::unordered_map<std::type_index, ComponentPool> _Components;
+		// Lets us find components by their GUID without searching every pool
+		std::unordered_map<Guid, IComponent*> _ComponentsByGuid;
+
+		/// <summary>
+		/// Adds a newly created component to the pool for it's type
+		/// </summary>
+		inline void _AddToPool(IComponent* component) {
+			_Components[component->_realType].Add(component);
+			_ComponentsByGuid[component->GetGUID()] = component;
+			component->_manager = this;
+			component->_isUpdateThreadSafe = _ThreadSafeTypes.count(component->_realType) > 0;
+		}
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -281,23 +352,20 @@ namespace Gameplay {
 		/// <summary>
 		/// Removes a given component from the global pools. To be used in the IComponent destructor
 		/// </summary>
-		/// <typeparam name="ComponentType">The type of component to destroy</typeparam>
 		/// <param name="component">A raw pointer to the component to remove (should be called from IComponent destructor)</param>
-		/// <returns>True if the element was removed, false if not</returns>
-		inline void Remove(const IComponent* component) {
-			// Make sure the component's type was one that was registered
-			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
-
-			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
-
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+		inline void Remove(IComponent* component) {
+			auto it = _Components.find(component->_realType);
+			if (it != _Components.end()) {
+				it->second.Remove(component);
+			}
+
+			// Only remove the GUID entry if it's ours, in case another component has the same GUID
+			auto guidIt = _ComponentsByGuid.find(component->GetGUID());
+			if (guidIt != _ComponentsByGuid.end() && guidIt->second == component) {
+				_ComponentsByGuid.erase(guidIt);
 			}
+			component->_manager = nullptr;
+			component->_isUpdateThreadSafe = false;
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include "IComponent.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Stores a densely packed list of all components of a single type, so that
+	/// iterating over them is just walking a contiguous array of pointers
+	///
+	/// Each component stores it's own slot in the pool (the sparse side of the set),
+	/// so removal is O(1) by swapping the last component into the removed slot
+	///
+	/// While the pool is being iterated (see IterationScope) removals leave a null hole
+	/// instead of swapping, so that components don't move under the iterator. The holes
+	/// are compacted away once the outermost iteration ends
+	///
+	/// The pool does not own the components, they are still owned by their game
+	/// objects and remove themselves from the pool when they are destroyed
+	/// </summary>
+	class ComponentPool final {
+	public:
+		static constexpr size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
+
+		ComponentPool() = default;
+		~ComponentPool() { Clear(); }
+
+		ComponentPool(const ComponentPool& other) = delete;
+		ComponentPool& operator =(const ComponentPool& other) = delete;
+
+		/// <summary>
+		/// Marks the pool as being iterated for as long as the scope is alive, entries
+		/// may be null while a scope is active
+		/// </summary>
+		class IterationScope final {
+		public:
+			inline IterationScope(ComponentPool& pool) : _pool(pool) { _pool._iterationDepth++; }
+			inline ~IterationScope() { _pool._EndIteration(); }
+
+			IterationScope(const IterationScope& other) = delete;
+			IterationScope& operator =(const IterationScope& other) = delete;
+
+		private:
+			ComponentPool& _pool;
+		};
+
+		/// <summary>
+		/// Adds a component to the end of the pool
+		/// </summary>
+		inline void Add(IComponent* component) {
+			component->_poolIndex = _components.size();
+			_components.push_back(component);
+		}
+
+		/// <summary>
+		/// Removes a component from the pool, does nothing if the component is not
+		/// in this pool (ex: if the pool has been cleared)
+		/// </summary>
+		inline void Remove(IComponent* component) {
+			size_t index = component->_poolIndex;
+			if (index >= _components.size() || _components[index] != component) {
+				return;
+			}
+
+			// Someone is walking the pool, leave a hole so nothing gets skipped or visited twice
+			if (_iterationDepth > 0) {
+				_components[index] = nullptr;
+				_hasHoles = true;
+				component->_poolIndex = INVALID_INDEX;
+				return;
+			}
+
+			// Move the last element into the hole, and update it's index
+			IComponent* last = _components.back();
+			_components[index] = last;
+			last->_poolIndex = index;
+			_components.pop_back();
+
+			component->_poolIndex = INVALID_INDEX;
+		}
+
+		/// <summary>
+		/// Removes all components from the pool
+		/// </summary>
+		inline void Clear() {
+			for (IComponent* component : _components) {
+				if (component != nullptr) {
+					component->_poolIndex = INVALID_INDEX;
+				}
+			}
+			_components.clear();
+			_hasHoles = false;
+		}
+
+		inline size_t Size() const { return _components.size(); }
+		inline IComponent* operator[](size_t index) const { return _components[index]; }
+
+	private:
+		std::vector<IComponent*> _components;
+		// How many iterations are currently walking the pool, and whether any removals left holes
+		int  _iterationDepth = 0;
+		bool _hasHoles = false;
+
+		inline void _EndIteration() {
+			_iterationDepth--;
+			if (_iterationDepth > 0 || !_hasHoles) {
+				return;
+			}
+
+			// Squeeze out the holes, keeping the remaining components in order
+			size_t count = 0;
+			for (size_t ix = 0; ix < _components.size(); ix++) {
+				IComponent* component = _components[ix];
+				if (component != nullptr) {
+					component->_poolIndex = count;
+					_components[count++] = component;
+				}
+			}
+			_components.resize(count);
+			_hasHoles = false;
+		}
+	};
+}
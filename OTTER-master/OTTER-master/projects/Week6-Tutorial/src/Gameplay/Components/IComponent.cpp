@@ -28,10 +28,15 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
-		_context(nullptr)
+		_context(nullptr),
+		_manager(nullptr),
+		_poolIndex(std::numeric_limits<size_t>::max()),
+		_isUpdateThreadSafe(false)
 	{ }
 
 	IComponent::~IComponent() {
-		_context->GetScene()->Components().Remove(this);
+		if (_manager != nullptr) {
+			_manager->Remove(this);
+		}
 	}
 }
@@ -12,6 +12,7 @@
 namespace Gameplay {
 	// We pre-declare GameObject to avoid circular dependencies in the headers
 	class GameObject;
+	class ComponentManager;
 
 	namespace Physics {
 		class TriggerVolume;
@@ -100,6 +101,24 @@ namespace Gameplay {
 		/// <param name="deltaTime">The time since the last frame, in seconds</param>
 		virtual void Update(float deltaTime) {};
 
+		/// <summary>
+		/// Invoked after every component in the scene has been updated, including those updated
+		/// in parallel. Always runs on the main thread
+		/// </summary>
+		/// <param name="deltaTime">The time since the last frame, in seconds</param>
+		virtual void LateUpdate(float deltaTime) {};
+
+		/// <summary>
+		/// Component types can hide this with their own value of true to have their Update invoked
+		/// in parallel on the job system, rather than on the main thread
+		///
+		/// Only do this if Update reads and writes nothing but the component itself and the
+		/// transform of it's own gameobject (no other objects, components, resources or GL calls). Note
+		/// that world transforms are evaluated lazily through the parents, so only the local position,
+		/// rotation and scale are safe to use
+		/// </summary>
+		static constexpr bool IsUpdateThreadSafe = false;
+
 		/// <summary>
 		/// All components should override this to allow us to render component
 		/// info in ImGui for easy editing
@@ -158,11 +177,19 @@ namespace Gameplay {
 
 	private:
 		friend class ComponentManager;
+		friend class ComponentPool;
 		friend class GameObject;
 
 		std::type_index _realType;
 		GameObject* _context;
 
+		// The manager and slot in it's pool that this component is stored in,
+		// so that we can remove ourselves in constant time when we're destroyed
+		ComponentManager* _manager;
+		size_t _poolIndex;
+		// Cached from the type's IsUpdateThreadSafe when added to the pool, so the serial update can skip us
+		bool _isUpdateThreadSafe;
+
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
 		// for things like bullet user pointers
 		std::weak_ptr<IComponent> _weakSelfPtr;
@@ -3,6 +3,7 @@
 #include "Application/Timing.h"
 #include "Application/Application.h"
 #include "Utils/ImGuiHelper.h"
+#include <chrono>
 
 ParticleSystem::ParticleSystem() :
 	IComponent(),
@@ -11,7 +12,11 @@ ParticleSystem::ParticleSystem() :
 	_numParticles(0),
 	_particleBuffers(),
 	_feedbackBuffers(),
-	_query(0),
+	_queries(),
+	_queryFrames(),
+	_queryFrame(0),
+	_resultFrame(-1),
+	_updateCpuTime(0.0f),
 	_currentVertexBuffer(0),
 	_currentFeedbackBuffer(1),
 	_updateShader(nullptr),
@@ -25,7 +30,7 @@ ParticleSystem::~ParticleSystem()
 	if (_hasInit) {
 		glDeleteBuffers(2, _particleBuffers);
 		glDeleteTransformFeedbacks(2, _feedbackBuffers);
-		glDeleteQueries(1, &_query);
+		glDeleteQueries(QUERY_RING_SIZE, _queries);
 		_updateShader = nullptr;
 		_renderShader = nullptr;
 	}
@@ -33,6 +38,8 @@ ParticleSystem::~ParticleSystem()
 
 void ParticleSystem::Update()
 {
+	auto startTime = std::chrono::high_resolution_clock::now();
+
 	// If we haven't previously initialized our data, initialize it now
 	if (!_hasInit) {
 		// Allocate some temp space for particles, so we can init the emitters
@@ -61,8 +68,12 @@ void ParticleSystem::Update()
 		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
 		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
 
-		// We create a query object to track the number of particles we're simulating
-		glGenQueries(1, &_query);
+		// We create a ring of query objects to track the number of particles we're simulating,
+		// so that we never have to wait on the GPU to read back a result
+		glGenQueries(QUERY_RING_SIZE, _queries);
+		for (int ix = 0; ix < QUERY_RING_SIZE; ix++) {
+			_queryFrames[ix] = -1;
+		}
 
 		// We no longer need the CPU copy
 		delete[] data;
@@ -98,8 +109,15 @@ void ParticleSystem::Update()
 	_updateShader->Bind();
 	_updateShader->SetUniform("u_Gravity", _gravity);
 
+	// Grab any results from previous frames that are ready, this has to happen before we
+	// re-use the oldest query below, or we'd throw away it's result
+	_PollQueries();
+
+	int querySlot = static_cast<int>(_queryFrame % QUERY_RING_SIZE);
+	_queryFrames[querySlot] = _queryFrame;
+
 	// Our particles are points that we're simulating
-	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _query);
+	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _queries[querySlot]);
 	glBeginTransformFeedback(GL_POINTS);
 
 	// If this is our first pass, we use drawArrays to get the initial state, otherwise we use transform feedback for rendering
@@ -114,14 +132,7 @@ void ParticleSystem::Update()
 	glEndTransformFeedback();
 	glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
 
-	// Use our query to get the number of particles
-	glGetQueryObjectuiv(_query, GL_QUERY_RESULT, &_numParticles);
-	if (_numParticles >= _emitters.size()) {
-		_numParticles -= _emitters.size();
-	}
-	else {
-		_numParticles = 0;
-	}
+	_queryFrame++;
 
 	// Clean up our state
 	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
@@ -141,6 +152,35 @@ void ParticleSystem::Update()
 	// Double-buffering, swap which buffers we're operating on
 	_currentVertexBuffer = _currentFeedbackBuffer;
 	_currentFeedbackBuffer = (_currentFeedbackBuffer + 1) & 0x01;
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	_updateCpuTime = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+}
+
+void ParticleSystem::_PollQueries()
+{
+	for (int ix = 0; ix < QUERY_RING_SIZE; ix++) {
+		// Skip slots that aren't waiting on anything
+		if (_queryFrames[ix] < 0) {
+			continue;
+		}
+
+		// Only read the result if the GPU is done with it, otherwise we'll just check again next frame
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(_queries[ix], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE) {
+			continue;
+		}
+
+		// Results can come back out of order, so only keep the newest one
+		if (_queryFrames[ix] > _resultFrame) {
+			GLuint written = 0;
+			glGetQueryObjectuiv(_queries[ix], GL_QUERY_RESULT, &written);
+			_numParticles = written >= _emitters.size() ? written - static_cast<GLuint>(_emitters.size()) : 0;
+			_resultFrame = _queryFrames[ix];
+		}
+		_queryFrames[ix] = -1;
+	}
 }
 
 void ParticleSystem::Render()
@@ -190,6 +230,8 @@ void ParticleSystem::AddEmitter(const glm::vec3& position, const glm::vec3& dire
 void ParticleSystem::RenderImGui()
 {
 	LABEL_LEFT(ImGui::LabelText, "Particle Count", "%u", _numParticles);
+	LABEL_LEFT(ImGui::LabelText, "Update Time   ", "%.3f ms", _updateCpuTime);
+	LABEL_LEFT(ImGui::LabelText, "Count Latency ", "%d frames", _resultFrame < 0 ? 0 : (int)(_queryFrame - _resultFrame));
 
 	Application& app = Application::Get();
 
@@ -39,6 +39,11 @@ protected:
 		glm::vec4    Metadata;
 	};
 
+	// How many transform feedback queries we keep in flight, we only ever read results
+	// that the GPU has already finished with, so this should be at least the number of
+	// frames the driver is allowed to queue up
+	static const int QUERY_RING_SIZE = 3;
+
 	bool _hasInit;
 
 	uint32_t _maxParticles;
@@ -46,7 +51,14 @@ protected:
 
 	uint32_t _particleBuffers[2];
 	uint32_t _feedbackBuffers[2];
-	uint32_t _query;
+	uint32_t _queries[QUERY_RING_SIZE];
+	// The frame that each query was last issued in, or -1 if it's not waiting on a result
+	int64_t  _queryFrames[QUERY_RING_SIZE];
+	int64_t  _queryFrame;
+	// The frame that _numParticles was read from, used to skip results older than what we have
+	int64_t  _resultFrame;
+	// How long Update() took on the CPU last frame, in milliseconds
+	float    _updateCpuTime;
 
 	uint32_t _currentVertexBuffer;
 	uint32_t _currentFeedbackBuffer;
@@ -56,4 +68,10 @@ protected:
 	glm::vec3           _gravity;
 
 	std::vector<ParticleData> _emitters;
+
+	/// <summary>
+	/// Polls the in-flight queries without blocking, and updates _numParticles
+	/// from the most recent one that the GPU has finished with
+	/// </summary>
+	void _PollQueries();
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Gameplay/Components/RenderComponent.h"
+#include "Gameplay/GameObject.h"
 
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
@@ -7,15 +8,27 @@
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
 	_mesh(mesh), 
 	_material(material), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_cullingTree(),
+	_cullingHandle(nullptr)
 { }
 
 RenderComponent::RenderComponent() : 
 	_mesh(nullptr), 
 	_material(nullptr), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>())
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_cullingTree(),
+	_cullingHandle(nullptr)
 { }
 
+RenderComponent::~RenderComponent() {
+	Gameplay::CullingTree::Sptr tree = _cullingTree.lock();
+	if (tree != nullptr) {
+		tree->Remove(_cullingHandle);
+	}
+	_cullingHandle = nullptr;
+}
+
 void RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
 	_mesh = mesh;
 }
@@ -36,6 +49,49 @@ const Gameplay::Material::Sptr& RenderComponent::GetMaterial() const {
 	return _material;
 }
 
+void RenderComponent::UpdateCullingBounds(const Gameplay::CullingTree::Sptr& tree) {
+	// If we've moved to a different tree (or the old one was destroyed), drop our old leaf
+	Gameplay::CullingTree::Sptr oldTree = _cullingTree.lock();
+	if (oldTree != tree) {
+		if (oldTree != nullptr) {
+			oldTree->Remove(_cullingHandle);
+		}
+		_cullingHandle = nullptr;
+		_cullingTree = tree;
+	}
+	if (tree == nullptr) {
+		return;
+	}
+
+	// Objects with no mesh have nothing to cull
+	if (GetMesh() == nullptr) {
+		if (_cullingHandle != nullptr) {
+			tree->Remove(_cullingHandle);
+			_cullingHandle = nullptr;
+		}
+		return;
+	}
+
+	// Transform our object space box into a world space box that contains it, by transforming
+	// the center and projecting the extents onto the world axes (Arvo's method)
+	const glm::mat4& transform = GetGameObject()->GetTransform();
+	glm::vec3 center  = (_mesh->GetBoundsMax() + _mesh->GetBoundsMin()) * 0.5f;
+	glm::vec3 extents = (_mesh->GetBoundsMax() - _mesh->GetBoundsMin()) * 0.5f;
+
+	glm::mat3 absolute = glm::mat3(transform);
+	for (int ix = 0; ix < 3; ix++) {
+		absolute[ix] = glm::abs(absolute[ix]);
+	}
+	glm::vec3 worldCenter  = glm::vec3(transform * glm::vec4(center, 1.0f));
+	glm::vec3 worldExtents = absolute * extents;
+
+	if (_cullingHandle == nullptr) {
+		_cullingHandle = tree->Insert(worldCenter - worldExtents, worldCenter + worldExtents, this);
+	} else {
+		tree->Update(_cullingHandle, worldCenter - worldExtents, worldCenter + worldExtents);
+	}
+}
+
 nlohmann::json RenderComponent::ToJson() const {
 	nlohmann::json result;
 	result["mesh"] = _mesh ? _mesh->GetGUID().str() : "null";
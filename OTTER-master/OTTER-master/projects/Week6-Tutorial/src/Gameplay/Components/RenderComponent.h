@@ -2,6 +2,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
+#include "Gameplay/CullingTree.h"
 #include "Utils/MeshFactory.h"
 
 /// <summary>
@@ -15,6 +16,7 @@ public:
 
 	RenderComponent();
 	RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material);
+	virtual ~RenderComponent();
 
 	/// <summary>
 	/// Gets the mesh resource which contains the mesh and serialization info for
@@ -42,6 +44,13 @@ public:
 	/// <param name="mat">The material for this object</param>
 	void SetMaterial(const Gameplay::Material::Sptr& mat);
 
+	/// <summary>
+	/// Updates this component's leaf in the culling tree to match the world space bounds of
+	/// it's mesh, inserting or removing the leaf as needed. The render layer calls this every frame
+	/// </summary>
+	/// <param name="tree">The culling tree for the scene that this component belongs to</param>
+	void UpdateCullingBounds(const Gameplay::CullingTree::Sptr& tree);
+
 	// Inherited from IComponent
 
 	virtual void RenderImGui() override;
@@ -57,4 +66,9 @@ protected:
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
+
+	// Our leaf in the scene's culling tree, we hold a weak pointer so that we
+	// can remove ourselves if the tree outlives us
+	std::weak_ptr<Gameplay::CullingTree> _cullingTree;
+	Gameplay::CullingTree::Handle        _cullingHandle;
 };
\ No newline at end of file
@@ -11,6 +11,9 @@ public:
 	RotatingBehaviour() = default;
 	glm::vec3 RotationSpeed;
 
+	// Only touches our own gameobject's rotation, so we can be updated on the job system
+	static constexpr bool IsUpdateThreadSafe = true;
+
 	virtual void Update(float deltaTime) override;
 
 	virtual void RenderImGui() override;
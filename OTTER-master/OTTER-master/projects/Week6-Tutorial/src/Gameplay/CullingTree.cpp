@@ -0,0 +1,64 @@
+#include "CullingTree.h"
+
+namespace Gameplay {
+	// Bullet's policy object for collideKDOP, forwards leaves to our callback
+	struct FrustumCollider : public btDbvt::ICollide {
+		const std::function<void(void*)>& Callback;
+
+		FrustumCollider(const std::function<void(void*)>& callback) : Callback(callback) {}
+
+		void Process(const btDbvtNode* leaf) override {
+			Callback(leaf->data);
+		}
+	};
+
+	CullingTree::CullingTree(float margin) :
+		_tree(),
+		_margin(margin)
+	{ }
+
+	CullingTree::~CullingTree() {
+		_tree.clear();
+	}
+
+	CullingTree::Handle CullingTree::Insert(const glm::vec3& min, const glm::vec3& max, void* userData) {
+		btDbvtVolume volume = btDbvtVolume::FromMM(btVector3(min.x, min.y, min.z), btVector3(max.x, max.y, max.z));
+		volume.Expand(btVector3(_margin, _margin, _margin));
+		return _tree.insert(volume, userData);
+	}
+
+	bool CullingTree::Update(Handle handle, const glm::vec3& min, const glm::vec3& max) {
+		btDbvtVolume volume = btDbvtVolume::FromMM(btVector3(min.x, min.y, min.z), btVector3(max.x, max.y, max.z));
+		// This will early out if the leaf's fat bounds still contain the new bounds
+		return _tree.update(handle, volume, _margin);
+	}
+
+	void CullingTree::Remove(Handle handle) {
+		if (handle != nullptr) {
+			_tree.remove(handle);
+		}
+	}
+
+	void CullingTree::Clear() {
+		_tree.clear();
+	}
+
+	int CullingTree::GetLeafCount() const {
+		return _tree.m_leaves;
+	}
+
+	void CullingTree::Query(const Frustum& frustum, const std::function<void(void*)>& callback) const {
+		// Convert our planes into the normal/offset form that bullet wants, the convention
+		// (dot(n, p) + offset >= 0 is inside) matches ours
+		btVector3 normals[Frustum::Plane::Count];
+		btScalar  offsets[Frustum::Plane::Count];
+		for (int ix = 0; ix < Frustum::Plane::Count; ix++) {
+			const glm::vec4& plane = frustum.Planes[ix];
+			normals[ix] = btVector3(plane.x, plane.y, plane.z);
+			offsets[ix] = plane.w;
+		}
+
+		FrustumCollider collider(callback);
+		btDbvt::collideKDOP(_tree.m_root, normals, offsets, Frustum::Plane::Count, collider);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <functional>
+#include <GLM/glm.hpp>
+#include <BulletCollision/BroadphaseCollision/btDbvt.h>
+
+#include "Utils/Macros.h"
+#include "Utils/Frustum.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// A dynamic AABB tree used for visibility culling, this is a thin wrapper around
+	/// Bullet's btDbvt (the same structure that drives our physics broadphase)
+	///
+	/// Leaves are stored with fattened bounds, so objects that move a small amount
+	/// don't need to be re-inserted into the tree every frame
+	/// </summary>
+	class CullingTree {
+	public:
+		MAKE_PTRS(CullingTree);
+		NO_COPY(CullingTree);
+		NO_MOVE(CullingTree);
+
+		// Opaque handle to a leaf in the tree
+		typedef btDbvtNode* Handle;
+
+		/// <summary>
+		/// Creates a new empty culling tree
+		/// </summary>
+		/// <param name="margin">The amount to fatten leaf bounds by when they are updated, in world units</param>
+		CullingTree(float margin = 0.1f);
+		~CullingTree();
+
+		/// <summary>
+		/// Inserts a new leaf into the tree
+		/// </summary>
+		/// <param name="min">The minimum corner of the leaf's bounds, in world space</param>
+		/// <param name="max">The maximum corner of the leaf's bounds, in world space</param>
+		/// <param name="userData">The data that will be passed to Query callbacks</param>
+		/// <returns>A handle to the leaf, for use with Update and Remove</returns>
+		Handle Insert(const glm::vec3& min, const glm::vec3& max, void* userData);
+		/// <summary>
+		/// Updates the bounds of a leaf. If the new bounds are still inside the leaf's
+		/// fattened bounds, the tree is left untouched
+		/// </summary>
+		/// <param name="handle">The leaf to update</param>
+		/// <param name="min">The new minimum corner of the leaf's bounds, in world space</param>
+		/// <param name="max">The new maximum corner of the leaf's bounds, in world space</param>
+		/// <returns>True if the tree was modified</returns>
+		bool Update(Handle handle, const glm::vec3& min, const glm::vec3& max);
+		/// <summary>
+		/// Removes a leaf from the tree, the handle is invalid after this call
+		/// </summary>
+		void Remove(Handle handle);
+		/// <summary>
+		/// Removes all leaves from the tree, invalidating all handles
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Gets the number of leaves in the tree
+		/// </summary>
+		int GetLeafCount() const;
+
+		/// <summary>
+		/// Invokes the callback for the user data of every leaf which intersects the frustum
+		/// </summary>
+		/// <param name="frustum">The frustum to test against</param>
+		/// <param name="callback">The callback to invoke with the user data of each visible leaf</param>
+		void Query(const Frustum& frustum, const std::function<void(void*)>& callback) const;
+
+	protected:
+		btDbvt _tree;
+		float  _margin;
+	};
+}
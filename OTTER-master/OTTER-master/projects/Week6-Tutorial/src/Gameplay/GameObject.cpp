@@ -14,63 +14,33 @@
 #include "Gameplay/Scene.h"
 
 namespace Gameplay {
-	GameObject::GameObject() :
+	GameObject::GameObject(Scene* scene) :
 		IResource(),
-		Name("Unknown"),
 		HideInHierarchy(false),
-		_components(std::vector<IComponent::Sptr>()),
-		_scene(nullptr),
-		_position(ZERO),
-		_rotation(glm::quat(glm::vec3(0.0f))),
-		_scale(ONE),
-		_localTransform(MAT4_IDENTITY),
-		_inverseLocalTransform(MAT4_IDENTITY),
-		_isLocalTransformDirty(true),
-		_worldTransform(MAT4_IDENTITY),
-		_inverseWorldTransform(MAT4_IDENTITY),
-		_isWorldTransformDirty(true),
+		_name("Unknown"),
+		_transforms(scene->GetTransformStore()),
+		_transformHandle(TransformStore::INVALID_HANDLE),
 		_parent(WeakRef()),
-		_children(std::vector<WeakRef>())
-	{ }
-
-	void GameObject::_RecalcLocalTransform() const
+		_children(std::vector<WeakRef>()),
+		_components(std::vector<IComponent::Sptr>()),
+		_selfRef(),
+		_scene(scene)
 	{
-		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
-			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
-		}
+		_transformHandle = _transforms->Allocate();
 	}
 
-	void GameObject::_RecalcWorldTransform() const {
-		// Start by determining our local transform if required
-		_RecalcLocalTransform();
-
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
-
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
+	GameObject::~GameObject() {
+		_transforms->Free(_transformHandle);
+	}
 
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
-			}
-			_isWorldTransformDirty = false;
+	void GameObject::SetName(const std::string& name) {
+		if (name == _name) {
+			return;
+		}
+		std::string oldName = _name;
+		_name = name;
+		if (_scene != nullptr) {
+			_scene->_OnObjectRenamed(this, oldName);
 		}
 	}
 
@@ -82,7 +52,7 @@ namespace Gameplay {
 	}
 
 	void GameObject::LookAt(const glm::vec3& point) {
-		glm::mat4 rot = glm::lookAt(_position, point, glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 rot = glm::lookAt(GetPosition(), point, glm::vec3(0.0f, 0.0f, 1.0f));
 		// Take the conjugate of the quaternion, as lookAt returns the *inverse* rotation
 		SetRotation(glm::conjugate(glm::quat_cast(rot)));
 	}
@@ -112,12 +82,11 @@ namespace Gameplay {
 	}
 
 	void GameObject::SetPostion(const glm::vec3& position) {
-		_position = position;
-		_isLocalTransformDirty = true;
+		_transforms->SetPosition(_transformHandle, position);
 	}
 
-	const glm::vec3& GameObject::GetPosition() const {
-		return _position;
+	glm::vec3 GameObject::GetPosition() const {
+		return _transforms->GetPosition(_transformHandle);
 	}
 
 	glm::vec3 GameObject::GetWorldPosition() const {
@@ -125,51 +94,44 @@ namespace Gameplay {
 	}
 
 	void GameObject::SetRotation(const glm::quat& value) {
-		_rotation = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformHandle, value);
 	}
 
-	const glm::quat& GameObject::GetRotation() const {
-		return _rotation;
+	glm::quat GameObject::GetRotation() const {
+		return _transforms->GetRotation(_transformHandle);
 	}
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
-		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformHandle, glm::quat(glm::radians(eulerAngles)));
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
-		return glm::degrees(glm::eulerAngles(_rotation));
+		return glm::degrees(glm::eulerAngles(_transforms->GetRotation(_transformHandle)));
 	}
 
 	void GameObject::SetScale(const glm::vec3& value) {
-		_scale = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetScale(_transformHandle, value);
 	}
 
-	const glm::vec3& GameObject::GetScale() const {
-		return _scale;
+	glm::vec3 GameObject::GetScale() const {
+		return _transforms->GetScale(_transformHandle);
 	}
 
-	const glm::mat4& GameObject::GetTransform() const {
-		_RecalcWorldTransform();
-		return _worldTransform;
+	glm::mat4 GameObject::GetTransform() const {
+		return _transforms->GetWorldTransform(_transformHandle);
 	}
 
-	const glm::mat4& GameObject::GetInverseTransform() const {
-		_RecalcWorldTransform();
-		return _inverseWorldTransform;
+	glm::mat4 GameObject::GetInverseTransform() const {
+		return _transforms->GetInverseWorldTransform(_transformHandle);
 	}
 
-	const glm::mat4& GameObject::GetLocalTransform() const
+	glm::mat4 GameObject::GetLocalTransform() const
 	{
-		_RecalcLocalTransform();
-		return _localTransform;
+		return _transforms->GetLocalTransform(_transformHandle);
 	}
 
-	const glm::mat4& GameObject::GetInverseLocalTransform() const {
-		_RecalcLocalTransform();
-		return _inverseLocalTransform;
+	glm::mat4 GameObject::GetInverseLocalTransform() const {
+		return _transforms->GetInverseLocalTransform(_transformHandle);
 	}
 
 	void GameObject::RenderGUI() {
@@ -211,13 +173,19 @@ namespace Gameplay {
 
 	void GameObject::Update(float dt) {
 		for (auto& component : _components) {
-			if (component->IsEnabled) {
+			if (component->IsEnabled && !component->_isUpdateThreadSafe) {
 				component->Update(dt);
 			}
 		}
+	}
+
+	void GameObject::LateUpdate(float dt) {
+		for (auto& component : _components) {
+			if (component->IsEnabled) {
+				component->LateUpdate(dt);
+			}
+		}
 
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 		_PurgeDeletedChildren();
 	}
 
@@ -275,13 +243,13 @@ namespace Gameplay {
 
 		// As long as the child is not already a child of this gameobject, add it
 		if (it == _children.end()) {
-			// Add child, set parent, and mark it's world transform as dirty, since the parent's transform now 
-			// applies to the child
+			// Add child and set parent, the child will notice that it's parent has changed the next
+			// time it's world transform is needed
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			child->_transforms->SetParent(child->_transformHandle, _transformHandle);
 		} else {
-			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
+			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->GetName());
 		}
 	}
 
@@ -292,6 +260,7 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			child->_transforms->SetParent(child->_transformHandle, TransformStore::INVALID_HANDLE);
 			_children.erase(it);
 			return true;
 		} else {
@@ -315,16 +284,16 @@ namespace Gameplay {
 		ImGui::PushID(this); // Push a new ImGui ID scope for this object
 		// Since we're allowing names to change, we need to use the ### to have a static ID for the header
 		static char buffer[256];
-		sprintf_s(buffer, 256, "%s###GO_HEADER", Name.c_str());
+		sprintf_s(buffer, 256, "%s###GO_HEADER", _name.c_str());
 		if (ImGui::CollapsingHeader(buffer)) {
 			ImGui::Indent();
 
 			// Draw a textbox for our name
 			static char nameBuff[256];
-			memcpy(nameBuff, Name.c_str(), Name.size());
-			nameBuff[Name.size()] = '\0';
+			memcpy(nameBuff, _name.c_str(), _name.size());
+			nameBuff[_name.size()] = '\0';
 			if (ImGui::InputText("", nameBuff, 256)) {
-				Name = nameBuff;
+				SetName(nameBuff);
 			}
 			ImGui::SameLine();
 			if (ImGuiHelper::WarningButton("Delete")) {
@@ -354,16 +323,19 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			glm::vec3 position = GetPosition();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &position.x, 0.01f)) {
+				SetPostion(position);
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
 			ImGuiStorage* guiStore = ImGui::GetStateStorage();
 
-			// Extract the angles from the storage, note that we're only using the address of the position for unique IDs
-			euler.x = guiStore->GetFloat(ImGui::GetID(&_position.x), euler.x);
-			euler.y = guiStore->GetFloat(ImGui::GetID(&_position.y), euler.y);
-			euler.z = guiStore->GetFloat(ImGui::GetID(&_position.z), euler.z);
+			// Extract the angles from the storage, the IDs are unique since we're inside this object's ID scope
+			euler.x = guiStore->GetFloat(ImGui::GetID("##euler_x"), euler.x);
+			euler.y = guiStore->GetFloat(ImGui::GetID("##euler_y"), euler.y);
+			euler.z = guiStore->GetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 			//Draw the slider for angles
 			if (LABEL_LEFT(ImGui::DragFloat3, "Rotation", &euler.x, 1.0f)) {
@@ -371,16 +343,19 @@ namespace Gameplay {
 				euler = Wrap(euler, -180.0f, 180.0f);
 
 				// Update the editor state with our new values
-				guiStore->SetFloat(ImGui::GetID(&_position.x), euler.x);
-				guiStore->SetFloat(ImGui::GetID(&_position.y), euler.y);
-				guiStore->SetFloat(ImGui::GetID(&_position.z), euler.z);
+				guiStore->SetFloat(ImGui::GetID("##euler_x"), euler.x);
+				guiStore->SetFloat(ImGui::GetID("##euler_y"), euler.y);
+				guiStore->SetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 				//Send new rotation to the gameobject
 				SetRotation(euler);
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			glm::vec3 scale = GetScale();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &scale.x, 0.01f, 0.0f)) {
+				SetScale(scale);
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -438,10 +413,6 @@ namespace Gameplay {
 			ImGui::Unindent();
 		}
 		ImGui::PopID(); // Pop the ImGui ID scope for the object
-
-		// For if we're not in play mode
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 	}
 
 	std::shared_ptr<GameObject> GameObject::SelfRef() {
@@ -452,61 +423,62 @@ namespace Gameplay {
 	{
 		// We need to manually construct since the GameObject constructor is
 		// protected. We can call it here since Scene is a friend class of GameObjects
-		GameObject::Sptr result(new GameObject());
-		result->_scene = scene;
+		GameObject::Sptr result(new GameObject(scene));
 
 		// Load in basic info
-		result->Name = data["name"];
+		result->_name = data["name"];
 		result->_guid = Guid(data["guid"]);
 		result->_parent = WeakRef(Guid(data.contains("parent") ? data["parent"] : "null"), nullptr);
-		result->_position = (data["position"]);
-		result->_rotation = (data["rotation"]);
-		result->_scale    = (data["scale"]);
+		result->SetPostion(data["position"].get<glm::vec3>());
+		result->SetRotation(data["rotation"].get<glm::quat>());
+		result->SetScale(data["scale"].get<glm::vec3>());
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
-		result->_isLocalTransformDirty = true;
-		result->_isWorldTransformDirty = true;
 
 		// Since our components are stored based on the type name, we iterate
 		// on the keys and values from the components object
 		nlohmann::json components = data["components"];
 		for (auto& [typeName, value] : components.items()) {
-			// We need to reference the component registry to load our components
-			// based on the type name (note that all component types need to be
-			// registered at the start of the application)
-			IComponent::Sptr component = scene->Components().Load(typeName, value);
-			component->_context = result.get();
-
-			// Add component to object and allow it to perform self initialization
-			result->_components.push_back(component);
-			component->OnLoad();
+			result->_LoadComponent(typeName, value);
 		}
 
 		return result;
 	}
 
+	void GameObject::_LoadComponent(const std::string& typeName, const nlohmann::json& blob) {
+		// We need to reference the component registry to load our components
+		// based on the type name (note that all component types need to be
+		// registered at the start of the application)
+		IComponent::Sptr component = _scene->Components().Load(typeName, blob);
+		component->_context = this;
+
+		// Add component to object and allow it to perform self initialization
+		_components.push_back(component);
+		component->OnLoad();
+	}
+
+	nlohmann::json GameObject::_SaveComponent(const IComponent::Sptr& component) {
+		nlohmann::json result = component->ToJson();
+		IComponent::SaveBaseJson(component, result);
+		return result;
+	}
+
 	nlohmann::json GameObject::ToJson() const {
 		GameObject::Sptr parent = _parent;
 		nlohmann::json result = {
-			{ "name", Name },
+			{ "name", _name },
 			{ "guid", _guid.str() },
-			{ "position", _position },
-			{ "rotation", _rotation },
-			{ "scale",    _scale },
+			{ "position", GetPosition() },
+			{ "rotation", GetRotation() },
+			{ "scale",    GetScale() },
 			{ "parent",   parent == nullptr ? "null" : parent->_guid.str() },
 			{ "hide_in_inspector", HideInHierarchy }
 		};
 		result["components"] = nlohmann::json();
 		for (auto& component : _components) {
-			result["components"][component->ComponentTypeName()] = component->ToJson();
-			IComponent::SaveBaseJson(component, result["components"][component->ComponentTypeName()]);
-		}
-		result["children"] = std::vector<nlohmann::json>();
-		for (auto& child : _children) {
-			GameObject::Sptr childPtr = child;
-			if (childPtr != nullptr) {
-				result["children"].push_back(childPtr->ToJson());
-			}
+			result["components"][component->ComponentTypeName()] = _SaveComponent(component);
 		}
+		// Note that children are not stored here, every object in the scene is saved in the scene's
+		// flat object list, and the hierarchy is rebuilt from the parent GUIDs on load
 		return result;
 	}
 
@@ -12,6 +12,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Utils/ResourceManager/IResource.h"
+#include "Gameplay/TransformStore.h"
 
 class InspectorWindow;
 class HierarchyWindow;
@@ -133,12 +134,21 @@ namespace Gameplay {
 			void Reset();
 		};
 
-		// Human readable name for the object
-		std::string             Name;
-
 		// Hack to hide instances from the hierarchy (like when adding lots of instances)
 		bool HideInHierarchy = false;
 
+		virtual ~GameObject();
+
+		/// <summary>
+		/// Gets the human readable name for the object
+		/// </summary>
+		const std::string& GetName() const { return _name; }
+		/// <summary>
+		/// Sets the human readable name for the object, and updates the scene's name index
+		/// so that FindObjectByName stays in sync
+		/// </summary>
+		void SetName(const std::string& name);
+
 		/// <summary>
 		/// Rotates this object to look at the given point in world coordinates
 		/// </summary>
@@ -178,7 +188,7 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets the object's position in world space
 		/// </summary>
-		const glm::vec3& GetPosition() const;
+		glm::vec3 GetPosition() const;
 
 		glm::vec3 GetWorldPosition() const;
 
@@ -190,7 +200,7 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets the object's rotation as a quaternion value
 		/// </summary>
-		const glm::quat& GetRotation() const;
+		glm::quat GetRotation() const;
 
 		/// <summary>
 		/// Sets the rotation of the object in euler degrees (yaw, pitch, roll)
@@ -210,21 +220,21 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets the scaling factor for the game object
 		/// </summary>
-		const glm::vec3& GetScale() const;
+		glm::vec3 GetScale() const;
 
 		/// <summary>
 		/// Gets or recalculates and gets the object's world transform
 		/// This matrix transforms points from local space to world space
 		/// </summary>
-		const glm::mat4& GetTransform() const;
+		glm::mat4 GetTransform() const;
 		/// <summary>
 		/// Gets or recalculates the inverse of this object's world transform
 		/// This matrix transforms points from world space to local space
 		/// </summary>
-		const glm::mat4& GetInverseTransform() const;
+		glm::mat4 GetInverseTransform() const;
 
-		const glm::mat4& GetLocalTransform() const;
-		const glm::mat4& GetInverseLocalTransform() const;
+		glm::mat4 GetLocalTransform() const;
+		glm::mat4 GetInverseLocalTransform() const;
 
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
@@ -242,11 +252,18 @@ namespace Gameplay {
 		void Awake();
 
 		/// <summary>
-		/// Calls update on all enabled components in this object
+		/// Calls update on all enabled components in this object, except for those marked with
+		/// IsUpdateThreadSafe, which the scene updates in parallel via it's component manager
 		/// </summary>
 		/// <param name="deltaTime">The time since the last frame, in seconds</param>
 		void Update(float dt);
 
+		/// <summary>
+		/// Calls late update on all enabled components in this object
+		/// </summary>
+		/// <param name="deltaTime">The time since the last frame, in seconds</param>
+		void LateUpdate(float dt);
+
 		/// <summary>
 		/// Checks whether this gameobject has a component of the given type
 		/// </summary>
@@ -339,21 +356,13 @@ namespace Gameplay {
 		friend class InspectorWindow;
 		friend class HierarchyWindow;
 
-		// Rotation of the object as a quaternion
-		glm::quat _rotation;
-		// Position of the object
-		glm::vec3 _position;
-		// The scale of the object
-		glm::vec3 _scale;
-
-		// The object's world transform
-		mutable glm::mat4 _localTransform;
-		mutable glm::mat4 _inverseLocalTransform;
-		mutable bool _isLocalTransformDirty;
+		// Human readable name for the object, see SetName
+		std::string _name;
 
-		mutable glm::mat4 _worldTransform;
-		mutable glm::mat4 _inverseWorldTransform;
-		mutable bool _isWorldTransformDirty;
+		// Our position, rotation, scale and matrices live in the scene's transform store, we hold a
+		// reference to the store so that it outlives us even if the scene is destroyed first
+		TransformStore::Sptr   _transforms;
+		TransformStore::Handle _transformHandle;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -371,13 +380,22 @@ namespace Gameplay {
 		/// <summary>
 		/// Only scenes will be allowed to create gameobjects
 		/// </summary>
-		GameObject();
-
-		// Recalculates the transform matrix for the object when required
-		void _RecalcLocalTransform() const;
-		void _RecalcWorldTransform() const;
+		/// <param name="scene">The scene that the object belongs to, it's transform is stored in the scene</param>
+		GameObject(Scene* scene);
 
 		void _PurgeDeletedChildren();
+
+		/// <summary>
+		/// Loads a component from it's type name and JSON blob via the component registry,
+		/// attaches it to this object and lets it perform self initialization
+		/// </summary>
+		/// <param name="typeName">The registered type name of the component</param>
+		/// <param name="blob">The JSON data for the component, including the base component data</param>
+		void _LoadComponent(const std::string& typeName, const nlohmann::json& blob);
+		/// <summary>
+		/// Converts a component into it's JSON blob, including the base component data
+		/// </summary>
+		static nlohmann::json _SaveComponent(const IComponent::Sptr& component);
 	};
 
 }
\ No newline at end of file
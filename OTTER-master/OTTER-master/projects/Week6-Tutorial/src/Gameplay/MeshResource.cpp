@@ -1,7 +1,9 @@
 #include "MeshResource.h"
 #include <filesystem>
+#include <Logging.h>
 
 #include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
@@ -9,7 +11,12 @@ namespace Gameplay {
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		_boundsSource(nullptr),
+		_boundsMin(glm::vec3(0.0f)),
+		_boundsMax(glm::vec3(0.0f)),
+		_hasCollisionData(false),
+		_collisionData(),
+		_revision(0)
 	{ }
 
 	MeshResource::MeshResource(const std::string& filename) :
@@ -17,13 +24,63 @@ namespace Gameplay {
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		_boundsSource(nullptr),
+		_boundsMin(glm::vec3(0.0f)),
+		_boundsMax(glm::vec3(0.0f)),
+		_hasCollisionData(false),
+		_collisionData(),
+		_revision(0)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		MeshBuilder<VertexPosNormTexColTangents> mesh;
+		ObjLoader::LoadFromFile(filename, mesh);
+		Mesh = mesh.Bake(MeshOptimizeFlags::All);
+		_SetBounds(mesh);
 	}
 
 	MeshResource::~MeshResource() = default;
 
+	MeshResource::Sptr MeshResource::FromJsonDeferred(const nlohmann::json& blob) {
+		// Generated meshes are cheap enough to just create right away
+		if (blob.contains("params") && blob["params"].is_array()) {
+			return FromJson(blob);
+		}
+
+		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->Filename = JsonGet<std::string>(blob, "filename", "null");
+		return result;
+	}
+
+	bool MeshResource::StreamDecode() {
+		// Note that this may be on a worker thread, so we can't create the VAO here
+		if (Filename == "null" || !std::filesystem::exists(Filename)) {
+			return true;
+		}
+
+		#ifdef OPTIMIZED_OBJ_LOADER
+		// The binary loader creates it's buffers straight from the mapped file, so it has to run on the main thread
+		return true;
+		#else
+		_streamMesh = std::make_unique<MeshBuilder<VertexPosNormTexColTangents>>();
+		ObjLoader::LoadFromFile(Filename, *_streamMesh);
+		// Optimizing is the expensive part of baking, so we do it here while we're off the main thread
+		_streamMesh->Optimize();
+		return true;
+		#endif
+	}
+
+	void MeshResource::StreamFinalize() {
+		if (_streamMesh != nullptr) {
+			Mesh = _streamMesh->Bake(MeshOptimizeFlags::ShortIndices);
+			_SetBounds(*_streamMesh);
+			_streamMesh.reset();
+		}
+		#ifdef OPTIMIZED_OBJ_LOADER
+		else if (Filename != "null" && std::filesystem::exists(Filename)) {
+			Mesh = OptimizedObjLoader::LoadFromFile(Filename);
+		}
+		#endif
+	}
+
 	nlohmann::json MeshResource::ToJson() const {
 		nlohmann::json result;
 		if (MeshBuilderParams.size() > 0) {
@@ -51,14 +108,18 @@ namespace Gameplay {
 				MeshFactory::AddParameterized(mesh, p);
 			}
 			MeshFactory::CalculateTBN(mesh);
-			result->Mesh = mesh.Bake();
+			result->Mesh = mesh.Bake(MeshOptimizeFlags::All);
+			result->_SetBounds(mesh);
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
 				#ifdef OPTIMIZED_OBJ_LOADER
 				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
 				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
+				MeshBuilder<VertexPosNormTexColTangents> mesh;
+				ObjLoader::LoadFromFile(result->Filename, mesh);
+				result->Mesh = mesh.Bake(MeshOptimizeFlags::All);
+				result->_SetBounds(mesh);
 				#endif
 
 			}
@@ -66,16 +127,109 @@ namespace Gameplay {
 		return result;
 	}
 
+	size_t MeshResource::GetGpuMemoryUsage() const {
+		return Mesh != nullptr ? Mesh->GetTotalBufferSize() : 0;
+	}
+
 	void MeshResource::GenerateMesh() {
 		MeshBuilder<VertexPosNormTexColTangents> mesh;
 		for (auto& param : MeshBuilderParams) {
 			MeshFactory::AddParameterized(mesh, param);
 		}
 		MeshFactory::CalculateTBN(mesh);
-		Mesh = mesh.Bake();
+		Mesh = mesh.Bake(MeshOptimizeFlags::All);
+		_SetBounds(mesh);
+
+		// Our params may have changed, so any collision data we had is stale
+		_hasCollisionData = false;
+		_collisionData = CollisionMeshData();
+		_revision++;
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	const glm::vec3& MeshResource::GetBoundsMin() const {
+		_UpdateBounds();
+		return _boundsMin;
+	}
+
+	const glm::vec3& MeshResource::GetBoundsMax() const {
+		_UpdateBounds();
+		return _boundsMax;
+	}
+
+	const CollisionMeshData& MeshResource::GetCollisionData() const {
+		if (_hasCollisionData) {
+			return _collisionData;
+		}
+		_hasCollisionData = true;
+
+		// Generated meshes are cheap to build on the CPU, we just skip the tangents and the upload
+		if (MeshBuilderParams.size() > 0) {
+			MeshBuilder<VertexPosNormTexColTangents> mesh;
+			for (auto& param : MeshBuilderParams) {
+				MeshFactory::AddParameterized(mesh, param);
+			}
+			const VertexPosNormTexColTangents* vertices = mesh.GetVertexDataPtr();
+			_collisionData.Positions.resize(mesh.GetVertexCount());
+			for (size_t ix = 0; ix < mesh.GetVertexCount(); ix++) {
+				_collisionData.Positions[ix] = vertices[ix].Position;
+			}
+			_collisionData.Indices.assign(mesh.GetIndexDataPtr(), mesh.GetIndexDataPtr() + mesh.GetIndexCount());
+		}
+		// Otherwise we can pull the positions and indices straight out of the binary mesh file
+		else if (Filename != "null" && !Filename.empty() && std::filesystem::exists(Filename)) {
+			if (!OptimizedObjLoader::LoadCollisionData(Filename, _collisionData.Positions, _collisionData.Indices)) {
+				LOG_WARN("Failed to load collision data for \"{}\"", Filename);
+			}
+		}
+		else {
+			LOG_WARN("Mesh has no params or file to load collision data from");
+		}
+
+		return _collisionData;
+	}
+
+	void MeshResource::_UpdateBounds() const {
+		if (_boundsSource == Mesh.get()) {
+			return;
+		}
+
+		if (Mesh == nullptr) {
+			_SetBounds(nullptr, 0, 0);
+			return;
+		}
+
+		// The VAO came from somewhere other than our own loaders (ex: the binary mesh loader, or someone
+		// assigning Mesh directly), so we fall back to the CPU copy rather than reading back from the GPU
+		const CollisionMeshData& data = GetCollisionData();
+		if (data.Positions.empty()) {
+			LOG_WARN("Mesh has no CPU side positions, cannot calculate bounds");
+		}
+		_SetBounds(data.Positions.data(), data.Positions.size(), sizeof(glm::vec3));
+	}
+
+	void MeshResource::_SetBounds(const MeshBuilder<VertexPosNormTexColTangents>& mesh) const {
+		const VertexPosNormTexColTangents* vertices = mesh.GetVertexDataPtr();
+		_SetBounds(vertices != nullptr ? &vertices->Position : nullptr, mesh.GetVertexCount(), sizeof(VertexPosNormTexColTangents));
+	}
+
+	void MeshResource::_SetBounds(const glm::vec3* positions, size_t count, size_t stride) const {
+		_boundsSource = Mesh.get();
+		_boundsMin = glm::vec3(0.0f);
+		_boundsMax = glm::vec3(0.0f);
+
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(positions);
+		for (size_t ix = 0; ix < count; ix++) {
+			const glm::vec3& pos = *reinterpret_cast<const glm::vec3*>(data + ix * stride);
+			if (ix == 0) {
+				_boundsMin = _boundsMax = pos;
+			} else {
+				_boundsMin = glm::min(_boundsMin, pos);
+				_boundsMax = glm::max(_boundsMax, pos);
+			}
+		}
+	}
 }
\ No newline at end of file
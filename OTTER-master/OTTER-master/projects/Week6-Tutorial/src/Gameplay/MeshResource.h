@@ -3,10 +3,16 @@
 #include "Graphics/VertexArrayObject.h"
 #include "Utils/MeshFactory.h"
 
-// bullet triangle mesh pre-declaration
-class btTriangleMesh;
-
 namespace Gameplay {
+	/// <summary>
+	/// A CPU side copy of a mesh's geometry, so that colliders can be built without a GL context
+	/// </summary>
+	struct CollisionMeshData {
+		std::vector<glm::vec3> Positions;
+		// Empty if the mesh is not indexed, in which case every 3 positions form a triangle
+		std::vector<uint32_t>  Indices;
+	};
+
 	/// <summary>
 	/// A mesh resource contains information on how to generate a VAO at runtime
 	/// It can either load a VAO from a file, or generate one using the mesh 
@@ -46,10 +52,6 @@ namespace Gameplay {
 		/// The optional mesh resource for generating colliders from this mesh
 		/// </summary>
 		MeshResource::Sptr             ColliderMeshData;
-		/// <summary>
-		/// Allows for bullet to generate a triangle mesh from this mesh and cache it
-		/// </summary>
-		std::shared_ptr<btTriangleMesh> BulletTriMesh;
 
 		/// <summary>
 		/// Generates a new mesh from the mesh builder parameters
@@ -61,9 +63,70 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Gets the minimum corner of the mesh's object space bounding box. The bounds are
+		/// calculated on the CPU when the mesh is built, if the VAO is replaced from outside
+		/// they are re-calculated from the collision data
+		/// </summary>
+		const glm::vec3& GetBoundsMin() const;
+		/// <summary>
+		/// Gets the maximum corner of the mesh's object space bounding box
+		/// </summary>
+		const glm::vec3& GetBoundsMax() const;
+
+		/// <summary>
+		/// Gets the positions and indices of this mesh in CPU memory. The data is loaded the first
+		/// time it is needed, from the mesh builder params or the binary mesh cache, and never
+		/// touches the GPU
+		/// </summary>
+		const CollisionMeshData& GetCollisionData() const;
+		/// <summary>
+		/// Gets a counter that goes up every time the mesh is regenerated, so that anything built
+		/// from the mesh's data (ex: collider hulls) can tell when it's stale
+		/// </summary>
+		uint32_t GetRevision() const { return _revision; }
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+		/// <summary>
+		/// Creates a mesh resource from JSON without loading it's file, the mesh
+		/// will be loaded when the resource manager streams it in
+		/// </summary>
+		static MeshResource::Sptr FromJsonDeferred(const nlohmann::json& blob);
+
+		virtual bool StreamDecode() override;
+		virtual void StreamFinalize() override;
+		virtual size_t GetGpuMemoryUsage() const override;
+
+	protected:
+		// The mesh data loaded by StreamDecode, waiting to be uploaded to the GPU
+		std::unique_ptr<MeshBuilder<VertexPosNormTexColTangents>> _streamMesh;
+
+		// The VAO that our bounds were calculated from
+		mutable const VertexArrayObject* _boundsSource;
+		mutable glm::vec3 _boundsMin;
+		mutable glm::vec3 _boundsMax;
+
+		mutable bool _hasCollisionData;
+		mutable CollisionMeshData _collisionData;
+
+		uint32_t _revision;
+
+		/// <summary>
+		/// Calculates our bounds from the collision data's positions, if the VAO has
+		/// changed since the last time they were calculated
+		/// </summary>
+		void _UpdateBounds() const;
+		/// <summary>
+		/// Calculates our bounds from the vertices of the mesh that was just baked into our VAO
+		/// </summary>
+		/// <param name="mesh">The mesh builder that Mesh was created from</param>
+		void _SetBounds(const MeshBuilder<VertexPosNormTexColTangents>& mesh) const;
+		/// <summary>
+		/// Sets our bounds to enclose a list of positions, and marks them as belonging to the current VAO
+		/// </summary>
+		void _SetBounds(const glm::vec3* positions, size_t count, size_t stride) const;
 	};
 }
\ No newline at end of file
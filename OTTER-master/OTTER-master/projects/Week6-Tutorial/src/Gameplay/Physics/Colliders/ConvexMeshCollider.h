@@ -1,10 +1,18 @@
 #pragma once
 
+#include <unordered_map>
 #include "Gameplay/Physics/ICollider.h"
 
+namespace Gameplay {
+	struct CollisionMeshData;
+}
+
 namespace Gameplay::Physics {
 	/// <summary>
 	/// A complex collider type that allows us to construct collision hulls from arbitrary convex meshes
+	///
+	/// Hulls are built from the mesh's CPU side collision data and simplified with btShapeHull, then
+	/// cached per mesh GUID and revision so that every collider using the same mesh shares a single hull
 	/// </summary>
 	class ConvexMeshCollider final : public ICollider {
 	public:
@@ -18,10 +26,31 @@ namespace Gameplay::Physics {
 		virtual void ToJson(nlohmann::json& blob) const override;
 		virtual void FromJson(const nlohmann::json& data) override;
 
+		/// <summary>
+		/// Builds a simplified convex hull that contains the given mesh data
+		/// </summary>
+		/// <returns>The new hull, or nullptr if the mesh has no positions</returns>
+		static std::shared_ptr<btConvexHullShape> BuildHull(const CollisionMeshData& data);
+
 	protected:
-		btTriangleMesh* _triMesh;
+		// The hull shared between all colliders using our mesh
+		std::shared_ptr<btConvexHullShape> _hull;
 		ConvexMeshCollider();
 
 		virtual btCollisionShape* CreateShape() const override;
+
+		struct CachedHull {
+			// The mesh's revision when the hull was built, see MeshResource::GetRevision
+			uint32_t                          Revision;
+			std::weak_ptr<btConvexHullShape>  Hull;
+		};
+		// Hulls that have been built for each mesh GUID, these are weak so that hulls are
+		// released once the last collider using them is destroyed
+		static std::unordered_map<Guid, CachedHull> _hullCache;
+
+		/// <summary>
+		/// Removes all cache entries who's hulls have been released
+		/// </summary>
+		static void _PruneHullCache();
 	};
 }
\ No newline at end of file
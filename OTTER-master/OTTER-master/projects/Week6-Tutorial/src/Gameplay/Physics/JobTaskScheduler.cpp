@@ -0,0 +1,57 @@
+#include "Gameplay/Physics/JobTaskScheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Utils/JobSystem.h"
+
+JobTaskScheduler::JobTaskScheduler() :
+	btITaskScheduler("JobSystem")
+{ }
+
+JobTaskScheduler* JobTaskScheduler::Get() {
+	static JobTaskScheduler instance;
+	return &instance;
+}
+
+int JobTaskScheduler::getMaxNumThreads() const {
+	// The thread that calls into bullet also runs jobs while it waits
+	return std::min(JobSystem::GetWorkerCount() + 1, static_cast<int>(BT_MAX_THREAD_COUNT));
+}
+
+int JobTaskScheduler::getNumThreads() const {
+	return getMaxNumThreads();
+}
+
+void JobTaskScheduler::setNumThreads(int /*numThreads*/) {
+	// The job system decides how many threads we have, see the job_threads app setting
+}
+
+void JobTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) {
+	if (iEnd <= iBegin) {
+		return;
+	}
+	JobSystem::ParallelFor(static_cast<size_t>(iEnd - iBegin), static_cast<size_t>(grainSize), [&](size_t begin, size_t end) {
+		body.forLoop(iBegin + static_cast<int>(begin), iBegin + static_cast<int>(end));
+	});
+}
+
+btScalar JobTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) {
+	if (iEnd <= iBegin) {
+		return btScalar(0);
+	}
+
+	// Each chunk writes it's own partial sum, chunks always start on a multiple of the grain size
+	size_t count = static_cast<size_t>(iEnd - iBegin);
+	size_t chunkSize = static_cast<size_t>(std::max(grainSize, 1));
+	std::vector<btScalar> partials((count + chunkSize - 1) / chunkSize, btScalar(0));
+	JobSystem::ParallelFor(count, chunkSize, [&](size_t begin, size_t end) {
+		partials[begin / chunkSize] = body.sumLoop(iBegin + static_cast<int>(begin), iBegin + static_cast<int>(end));
+	});
+
+	btScalar result = btScalar(0);
+	for (btScalar partial : partials) {
+		result += partial;
+	}
+	return result;
+}
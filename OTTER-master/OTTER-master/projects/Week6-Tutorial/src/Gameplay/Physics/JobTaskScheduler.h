@@ -0,0 +1,28 @@
+#pragma once
+#include <LinearMath/btThreads.h>
+
+/// <summary>
+/// Implements Bullet's btITaskScheduler on top of our JobSystem, so that the multithreaded
+/// physics world shares the same worker threads as the rest of the engine instead of
+/// spinning up it's own pool
+///
+/// The number of threads is owned by the job system, so setNumThreads is ignored. Note that
+/// Bullet will only dispatch work through the scheduler if it was built with BT_THREADSAFE,
+/// otherwise everything runs on the calling thread
+/// </summary>
+class JobTaskScheduler : public btITaskScheduler {
+public:
+	JobTaskScheduler();
+	virtual ~JobTaskScheduler() = default;
+
+	/// <summary>
+	/// Gets the shared scheduler instance, for passing to btSetTaskScheduler
+	/// </summary>
+	static JobTaskScheduler* Get();
+
+	virtual int getMaxNumThreads() const override;
+	virtual int getNumThreads() const override;
+	virtual void setNumThreads(int numThreads) override;
+	virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+	virtual btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+};
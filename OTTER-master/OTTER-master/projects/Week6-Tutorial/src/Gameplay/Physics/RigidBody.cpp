@@ -27,7 +27,12 @@ namespace Gameplay::Physics {
 		_angularVelocity(btVector3(0, 0, 0)),
 		_angularVelocityDirty(false),
 		_angularFactor(btVector3(1,1,1)),
-		_angularFactorDirty(false)
+		_angularFactorDirty(false),
+		_previousTransform(btTransform::getIdentity()),
+		_currentTransform(btTransform::getIdentity()),
+		_writtenPosition(glm::vec3(0.0f)),
+		_writtenRotation(glm::quat()),
+		_hasWrittenTransform(false)
 	{ }
 
 	RigidBody::~RigidBody() {
@@ -164,7 +169,17 @@ namespace Gameplay::Physics {
 
 			// Copy to body and to it's motion state
 			if (_type == RigidBodyType::Dynamic) {
-				_body->setWorldTransform(transform);
+				// The game object holds an interpolated transform, so we only push it to
+				// bullet if something other than us has moved the object
+				GameObject* context = GetGameObject();
+				if (!_hasWrittenTransform || context->GetPosition() != _writtenPosition || context->GetRotation() != _writtenRotation) {
+					_body->setWorldTransform(transform);
+					_previousTransform = transform;
+					_currentTransform = transform;
+					_writtenPosition = context->GetPosition();
+					_writtenRotation = context->GetRotation();
+					_hasWrittenTransform = true;
+				}
 			} else {
 				// Kinematics prefer to be driven my motion state for some reason :|
 				_body->getMotionState()->setWorldTransform(transform); 
@@ -174,14 +189,33 @@ namespace Gameplay::Physics {
 
 	void RigidBody::PhysicsPostStep(float dt) {
 		// Kinematics are driven externally and statics don't move, so only need to get data out for dynamics!
-		if (_type == RigidBodyType::Dynamic && _body->isActive()) {
-			btTransform transform = _body->getWorldTransform();
-			_CopyGameobjectTransformFrom(transform);
+		if (_type == RigidBodyType::Dynamic) {
+			// Shift our state history, the game object gets updated in InterpolateTransform
+			_previousTransform = _currentTransform;
+			if (_body->isActive()) {
+				_currentTransform = _body->getWorldTransform();
+
+				// Store a copy of our velocities
+				_linearVelocity = _body->getLinearVelocity();
+				_angularVelocity = _body->getAngularVelocity();
+			}
+		}
+	}
 
-			// Store a copy of our velocities
-			_linearVelocity = _body->getLinearVelocity();
-			_angularVelocity = _body->getAngularVelocity();
+	void RigidBody::InterpolateTransform(float alpha) {
+		if (_type != RigidBodyType::Dynamic || !_hasWrittenTransform) {
+			return;
 		}
+
+		btTransform transform;
+		transform.setOrigin(_previousTransform.getOrigin().lerp(_currentTransform.getOrigin(), alpha));
+		transform.setRotation(_previousTransform.getRotation().slerp(_currentTransform.getRotation(), alpha));
+		_CopyGameobjectTransformFrom(transform);
+
+		// Remember what we wrote, so PreStep can tell if anything else has moved us since
+		GameObject* context = GetGameObject();
+		_writtenPosition = context->GetPosition();
+		_writtenRotation = context->GetRotation();
 	}
 
 	void RigidBody::Awake() {
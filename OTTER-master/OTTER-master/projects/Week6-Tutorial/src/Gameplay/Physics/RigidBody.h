@@ -2,6 +2,7 @@
 #include <EnumToString.h>
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
+#include <GLM/gtc/quaternion.hpp>
 
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Physics/ICollider.h"
@@ -153,17 +154,23 @@ namespace Gameplay::Physics {
 		RigidBodyType GetType() const;
 
 		/// <summary>
-		/// Invoked for each RigidBody before the physics world is stepped forward a frame,
+		/// Invoked for each RigidBody before every fixed physics step,
 		/// handles body initialization, shape changes, mass changes, etc...
 		/// </summary>
-		/// <param name="dt">The time in seconds since the last frame</param>
+		/// <param name="dt">The length of the physics step, in seconds</param>
 		virtual void PhysicsPreStep(float dt) override;
 		/// <summary>
-		/// Invoked for each RigidBody after the physics world is stepped forward a frame,
-		/// handles copying transform to the OpenGL state
+		/// Invoked for each RigidBody after every fixed physics step, stores the
+		/// new physics state for InterpolateTransform
 		/// </summary>
-		/// <param name="dt">The time in seconds since the last frame</param>
+		/// <param name="dt">The length of the physics step, in seconds</param>
 		virtual void PhysicsPostStep(float dt) override;
+		/// <summary>
+		/// Blends the game object's transform between the last two fixed physics steps,
+		/// so that rendering stays smooth when the frame rate doesn't match the physics rate
+		/// </summary>
+		/// <param name="alpha">How far we are between the previous (0) and current (1) physics states</param>
+		void InterpolateTransform(float alpha);
 
 		// Inherited from IComponent
 		virtual void Awake() override;
@@ -198,6 +205,15 @@ namespace Gameplay::Physics {
 		btVector3        _angularFactor;
 		bool             _angularFactorDirty;
 
+		// The body's transform as of the last two fixed steps, for render interpolation
+		btTransform      _previousTransform;
+		btTransform      _currentTransform;
+		// The transform we last wrote to the game object, if the game object no longer
+		// matches then outside code has moved it and we need to teleport the body
+		glm::vec3        _writtenPosition;
+		glm::quat        _writtenRotation;
+		bool             _hasWrittenTransform;
+
 		// Handles resolving any dirty state stuff for our object
 		void _HandleStateDirty();
 
@@ -37,105 +37,111 @@ namespace Gameplay::Physics {
 	}
 
 	void TriggerVolume::PhysicsPostStep(float dt) {
-		// This will store all the objects inside the trigger this frame
-		std::vector<std::weak_ptr<RigidBody>> thisFrameCollision;
+		_thisFrameCollisions.clear();
 
-		// Get all our collisions from from the world
-		_scene->GetPhysicsWorld()->getDispatcher()->dispatchAllCollisionPairs(_ghost->getOverlappingPairCache(), _scene->GetPhysicsWorld()->getDispatchInfo(), _scene->GetPhysicsWorld()->getDispatcher());
+		// Our ghost only tracks pairs that involve itself, so we only need to generate contacts for those
+		btDynamicsWorld* world = _scene->GetPhysicsWorld();
+		world->getDispatcher()->dispatchAllCollisionPairs(_ghost->getOverlappingPairCache(), world->getDispatchInfo(), world->getDispatcher());
 		btBroadphasePairArray& collisionPairs = _ghost->getOverlappingPairCache()->getOverlappingPairArray();
 
-		// Determine how many objects are intersecting the volume
-		const int numObjects=collisionPairs.size();
-		thisFrameCollision.reserve(numObjects);
+		// Iterate over all the objects that we're overlapping
+		const int numPairs = collisionPairs.size();
+		for (int i = 0; i < numPairs; ++i) {
+			btBroadphasePair& pair = collisionPairs[i];
 
-		// Will store our contact manifolds, can be static to be shared between frames and instances
-		static btManifoldArray	m_manifoldArray;
-
-		// Iterate over all the objects that we're colliding with
-		for (int i = 0; i < numObjects; ++i) {
-			// resize the number of manifolds to zero for everything we collide with
-			m_manifoldArray.resize(0);
+			// Get the btCollisionObject that we're colliding with, which is whichever side of the pair isn't us
+			const btCollisionObject* obj = static_cast<const btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+			if (obj == _ghost) {
+				obj = static_cast<const btCollisionObject*>(pair.m_pProxy1->m_clientObject);
+			}
 
-			// Get the btCollisionObject that we're colliding with
-			btCollisionObject *obj = _ghost->getOverlappingObject(i);
+			if (!_ShouldTrigger(obj, pair)) {
+				continue;
+			}
 
-			// Get the contact pair and resolve contact manifolds
-			btBroadphasePair* pair = &collisionPairs[i];
-			if (pair != nullptr && pair->m_algorithm != nullptr) {
-				pair->m_algorithm->getAllContactManifolds(m_manifoldArray);
-			} else {
+			// If the body was inside us last frame we already have it's component, otherwise we need to look it up
+			auto prev = _currentCollisions.find(obj);
+			if (prev != _currentCollisions.end() && !prev->second.expired()) {
+				_thisFrameCollisions.emplace(obj, prev->second);
 				continue;
 			}
 
-			// Iterate over all the contact manifolds and check if any of them have contacts
-			bool hasCollision = false;
-			for (int j=0; j < m_manifoldArray.size(); j++) {
-				btPersistentManifold* manifold = m_manifoldArray[j];
-				if (manifold != nullptr && manifold->getNumContacts() > 0) {
-					hasCollision = true;
-					break;
-				}
+			// Extract the weak pointer that we stored in all our rigidbody user pointers
+			std::weak_ptr<IComponent> rawPtr = *reinterpret_cast<std::weak_ptr<IComponent>*>(obj->getUserPointer());
+			// Cast lock the raw pointer and cast up to a RigidBody
+			std::shared_ptr<RigidBody> physicsPtr = std::dynamic_pointer_cast<RigidBody>(rawPtr.lock());
+
+			// As long as we got a pointer out, we can add it to the known collisions for this frame
+			if (physicsPtr != nullptr && physicsPtr->GetGameObject() != GetGameObject()) {
+				_thisFrameCollisions.emplace(obj, physicsPtr);
 			}
+		}
+
+		TriggerVolume::Sptr self = nullptr;
 
-			// If we have contacts and the object's group matches our mask (since this isn't filtered for us)
-			if (hasCollision && (obj->getBroadphaseHandle()->m_collisionFilterGroup & _collisionMask)) {
-				// Make sure the internal type is a bullet rigid body (no trigger-trigger interactions)
-				if (obj->getInternalType() == btCollisionObject::CO_RIGID_BODY) {
-					// Get the collision object as a btRigidBody
-					const btRigidBody *body = (const btRigidBody *)obj;
-
-					// Make sure that the object is not a kinematic or static object (note: you may want
-					// to modify this behaviour depending on your game)
-					if (((body->getCollisionFlags() & btCollisionObject::CF_STATIC_OBJECT & btCollisionObject::CF_KINEMATIC_OBJECT) == 0) ||
-						((body->getCollisionFlags() & btCollisionObject::CF_STATIC_OBJECT) == *(_typeFlags & TriggerTypeFlags::Statics)) ||
-						((body->getCollisionFlags() & btCollisionObject::CF_KINEMATIC_OBJECT) == *(_typeFlags & TriggerTypeFlags::Kinematics))) {
-
-						// Extract the weak pointer that we stored in all our rigidbody user pointers
-						std::weak_ptr<IComponent> rawPtr = *reinterpret_cast<std::weak_ptr<IComponent>*>(body->getUserPointer());
-						// Cast lock the raw pointer and cast up to a RigidBody
-						std::shared_ptr<RigidBody> physicsPtr = std::dynamic_pointer_cast<RigidBody>(rawPtr.lock());
-
-						// As long as we got a pointer out, we can proceed to try and invoke
-						if (physicsPtr != nullptr && physicsPtr->GetGameObject() != GetGameObject()) {
-							// Add the object to the known collisions for this frame
-							thisFrameCollision.push_back(physicsPtr);
-
-							// Check to see if the object has been added to our object cache
-							auto& it = std::find_if(_currentCollisions.begin(), _currentCollisions.end(), [&](const std::weak_ptr<RigidBody>& item) {
-								return item.lock() == physicsPtr;
-							});
-
-							// If the object is NOT in the cache, we invoke all the callbacks
-							if (it == _currentCollisions.end()) {
-								physicsPtr->GetGameObject()->OnEnteredTrigger(std::dynamic_pointer_cast<TriggerVolume>(SelfRef().lock()));
-								GetGameObject()->OnTriggerVolumeEntered(physicsPtr);
-							}
-						}
+		// Anything that wasn't in the trigger last frame has just entered
+		for (auto& [obj, weakPtr] : _thisFrameCollisions) {
+			auto prev = _currentCollisions.find(obj);
+			if (prev == _currentCollisions.end() || prev->second.expired()) {
+				// Callbacks may have destroyed the body since we found it
+				RigidBody::Sptr body = weakPtr.lock();
+				if (body != nullptr) {
+					if (self == nullptr) {
+						self = std::dynamic_pointer_cast<TriggerVolume>(SelfRef().lock());
 					}
+					body->GetGameObject()->OnEnteredTrigger(self);
+					GetGameObject()->OnTriggerVolumeEntered(body);
 				}
-
 			}
 		}
-	
-		// Compare our current frame list to the previous frame to see if anything has left
-		for (auto& weakPtr : _currentCollisions) {
-			// Search the the current list to see if the item still exists
-			auto& it = std::find_if(thisFrameCollision.begin(), thisFrameCollision.end(), [&](const std::weak_ptr<RigidBody>& item) {
-				return item.lock() == weakPtr.lock();
-			});
-
-			// If the item no longer exists in the list, we need to invoke exit callbacks
-			if (it == thisFrameCollision.end()) {
+
+		// Anything that was in the trigger last frame but isn't anymore has left
+		for (auto& [obj, weakPtr] : _currentCollisions) {
+			if (_thisFrameCollisions.find(obj) == _thisFrameCollisions.end()) {
 				RigidBody::Sptr body = weakPtr.lock();
 				if (body != nullptr) {
-					body->GetGameObject()->OnLeavingTrigger(std::dynamic_pointer_cast<TriggerVolume>(SelfRef().lock()));
+					if (self == nullptr) {
+						self = std::dynamic_pointer_cast<TriggerVolume>(SelfRef().lock());
+					}
+					body->GetGameObject()->OnLeavingTrigger(self);
 					GetGameObject()->OnTriggerVolumeLeaving(body);
 				}
 			}
 		}
 
 		// Load the contents of the current collision items into the cache
-		_currentCollisions.swap(thisFrameCollision);
+		_currentCollisions.swap(_thisFrameCollisions);
+	}
+
+	bool TriggerVolume::_ShouldTrigger(const btCollisionObject* obj, btBroadphasePair& pair) {
+		// Make sure the internal type is a bullet rigid body (no trigger-trigger interactions), and that the
+		// object's group matches our mask (since this isn't filtered for us)
+		if (obj->getInternalType() != btCollisionObject::CO_RIGID_BODY ||
+			(obj->getBroadphaseHandle()->m_collisionFilterGroup & _collisionMask) == 0) {
+			return false;
+		}
+
+		// Make sure that the object is not a kinematic or static object (note: you may want
+		// to modify this behaviour depending on your game)
+		const int flags = obj->getCollisionFlags();
+		if (!(((flags & btCollisionObject::CF_STATIC_OBJECT & btCollisionObject::CF_KINEMATIC_OBJECT) == 0) ||
+			((flags & btCollisionObject::CF_STATIC_OBJECT) == *(_typeFlags & TriggerTypeFlags::Statics)) ||
+			((flags & btCollisionObject::CF_KINEMATIC_OBJECT) == *(_typeFlags & TriggerTypeFlags::Kinematics)))) {
+			return false;
+		}
+
+		// Resolve contact manifolds, and check if any of them have contacts
+		if (pair.m_algorithm == nullptr) {
+			return false;
+		}
+		_manifolds.resize(0);
+		pair.m_algorithm->getAllContactManifolds(_manifolds);
+		for (int j = 0; j < _manifolds.size(); j++) {
+			if (_manifolds[j] != nullptr && _manifolds[j]->getNumContacts() > 0) {
+				return true;
+			}
+		}
+		return false;
 	}
 
 	void TriggerVolume::Awake() {
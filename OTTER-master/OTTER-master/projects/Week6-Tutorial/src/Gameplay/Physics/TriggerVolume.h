@@ -3,8 +3,12 @@
 #include "Gameplay/Physics/PhysicsBase.h"
 #include "Gameplay/Physics/RigidBody.h"
 #include "EnumToString.h"
+#include <unordered_map>
+#include <LinearMath/btAlignedObjectArray.h>
 
 class btPairCachingGhostObject;
+class btPersistentManifold;
+class btCollisionObject;
 
 namespace Gameplay::Physics {
 
@@ -54,7 +58,18 @@ namespace Gameplay::Physics {
 		btPairCachingGhostObject*   _ghost;
 		TriggerTypeFlags            _typeFlags;
 
-		std::vector<std::weak_ptr<RigidBody>> _currentCollisions;
+		// The bodies inside the trigger, keyed on their bullet object so that we can diff
+		// the last frame against this one without searching
+		typedef std::unordered_map<const btCollisionObject*, std::weak_ptr<RigidBody>> CollisionSet;
+		CollisionSet _currentCollisions;
+		// Only used during PhysicsPostStep, kept around so we don't allocate every frame
+		CollisionSet _thisFrameCollisions;
+		btAlignedObjectArray<btPersistentManifold*> _manifolds;
+
+		/// <summary>
+		/// Returns true if the object has any contacts with the trigger and passes our type flags
+		/// </summary>
+		bool _ShouldTrigger(const btCollisionObject* obj, btBroadphasePair& pair);
 
 		virtual btBroadphaseProxy* _GetBroadphaseHandle() override;
 
@@ -3,12 +3,19 @@
 #include <GLFW/glfw3.h>
 #include <locale>
 #include <codecvt>
+#include <filesystem>
+#include <fstream>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/MappedFile.h"
+
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
+#include "Gameplay/Physics/JobTaskScheduler.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
 
@@ -18,6 +25,92 @@
 #include "Application/Application.h"
 
 namespace Gameplay {
+	namespace {
+		// Binary scene files (.bscene) start with this header, followed by:
+		//    string table - StringCount entries of [uint32 length][characters], shared by
+		//                   object names and component type names
+		//    settings     - SettingsSize bytes of MessagePack encoded scene settings
+		//    objects      - ObjectCount BinarySceneObject records, each followed by ComponentCount
+		//                   entries of [uint32 type name index][uint32 size][MessagePack blob]
+		// All values are stored little-endian, and objects are stored in a flat array with
+		// parents referenced by index, so no subtree is ever written twice
+		struct BinarySceneHeader {
+			char     Magic[4];
+			uint32_t Version;
+			uint32_t StringCount;
+			uint32_t ObjectCount;
+			uint32_t SettingsSize;
+			uint32_t Reserved;
+		};
+
+		struct BinarySceneObject {
+			uint32_t NameIndex;
+			uint8_t  Guid[16];
+			int32_t  ParentIndex; // -1 if the object has no parent
+			float    Position[3];
+			float    Rotation[4]; // x, y, z, w
+			float    Scale[3];
+			uint32_t Flags;
+			uint32_t ComponentCount;
+		};
+
+		const char     BSCENE_MAGIC[4]    = { 'B', 'S', 'C', 'N' };
+		const uint32_t BSCENE_VERSION     = 1;
+		const uint32_t BSCENE_FLAG_HIDDEN = 1 << 0;
+
+		/// <summary>
+		/// Appends raw values to a byte buffer
+		/// </summary>
+		struct BinaryWriter {
+			std::vector<uint8_t> Data;
+
+			void WriteBytes(const void* data, size_t size) {
+				const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+				Data.insert(Data.end(), bytes, bytes + size);
+			}
+
+			template <typename T>
+			void Write(const T& value) {
+				static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+				WriteBytes(&value, sizeof(T));
+			}
+		};
+
+		/// <summary>
+		/// Reads raw values from a byte buffer, refusing to read past the end of it
+		/// </summary>
+		struct BinaryReader {
+			const uint8_t* Data;
+			size_t         Size;
+			size_t         Offset;
+
+			BinaryReader(const uint8_t* data, size_t size) : Data(data), Size(size), Offset(0) { }
+
+			size_t Remaining() const { return Size - Offset; }
+
+			const uint8_t* Skip(size_t size) {
+				if (size > Size - Offset) {
+					return nullptr;
+				}
+				const uint8_t* result = Data + Offset;
+				Offset += size;
+				return result;
+			}
+
+			template <typename T>
+			bool Read(T& value) {
+				static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+				const uint8_t* source = Skip(sizeof(T));
+				if (source == nullptr) {
+					return false;
+				}
+				// Records are not aligned in the file, so we copy instead of casting
+				memcpy(&value, source, sizeof(T));
+				return true;
+			}
+		};
+	}
+
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
@@ -31,7 +124,14 @@ namespace Gameplay {
 		_skyboxTexture(nullptr),
 		_skyboxRotation(glm::mat3(1.0f)),
 		_ambientLight(glm::vec3(0.1f)),
-		_gravity(glm::vec3(0.0f, 0.0f, -9.81f))
+		_gravity(glm::vec3(0.0f, 0.0f, -9.81f)),
+		_fixedTimeStep(1.0f / 60.0f),
+		_maxSubSteps(4),
+		_multithreadedPhysics(false),
+		_physicsAccumulator(0.0),
+		_physicsInterpolation(0.0f),
+		_cullingTree(std::make_shared<CullingTree>()),
+		_transforms(std::make_shared<TransformStore>())
 	{
 		GameObject::Sptr mainCam = CreateGameObject("Main Camera");		
 		MainCamera = mainCam->Add<Camera>();
@@ -92,11 +192,11 @@ namespace Gameplay {
 
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
-		GameObject::Sptr result(new GameObject());
-		result->Name = name;
-		result->_scene = this;
+		GameObject::Sptr result(new GameObject(this));
+		result->_name = name;
 		result->_selfRef = result;
 		_objects.push_back(result);
+		_AddToIndex(result);
 		return result;
 	}
 
@@ -105,17 +205,22 @@ namespace Gameplay {
 	}
 
 	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		// Renames update the index, so if the name isn't in here no object has it
+		auto range = _objectsByName.equal_range(name);
+		for (auto it = range.first; it != range.second;) {
+			GameObject::Sptr obj = it->second.lock();
+			if (obj != nullptr) {
+				return obj;
+			}
+			// The object was destroyed without being removed from the scene, drop the stale entry
+			it = _objectsByName.erase(it);
+		}
+		return nullptr;
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByGuid.find(id);
+		return it == _objectsByGuid.end() ? nullptr : it->second.lock();
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -151,24 +256,88 @@ namespace Gameplay {
 	}
 
 	void Scene::DoPhysics(float dt) {
-		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
-			body->PhysicsPreStep(dt);
-		});
-		_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
-			body->PhysicsPreStep(dt);
+		// When we're not playing we still want bullet to follow any changes made in the editor
+		if (!IsPlaying) {
+			_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
+				body->PhysicsPreStep(dt);
+			});
+			_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
+				body->PhysicsPreStep(dt);
+			});
+			_physicsAccumulator = 0.0;
+			_physicsInterpolation = 0.0f;
+			return;
+		}
+
+		// We use a double for the accumulator, so that different sequences of frame times that
+		// add up to the same total will take the same number of steps
+		_physicsAccumulator += dt;
+		int numSteps = static_cast<int>(_physicsAccumulator / _fixedTimeStep);
+
+		// If we've fallen too far behind, drop the time we can't catch up on
+		if (numSteps > _maxSubSteps) {
+			_physicsAccumulator -= (numSteps - _maxSubSteps) * static_cast<double>(_fixedTimeStep);
+			numSteps = _maxSubSteps;
+		}
+
+		// Each step invokes our tick callbacks, which handle the pre and post step for bodies
+		for (int ix = 0; ix < numSteps; ix++) {
+			_physicsWorld->stepSimulation(_fixedTimeStep, 0, _fixedTimeStep);
+			_physicsAccumulator -= _fixedTimeStep;
+		}
+
+		// Blend the render transforms using whatever time we have left over
+		_physicsInterpolation = glm::clamp(static_cast<float>(_physicsAccumulator / _fixedTimeStep), 0.0f, 1.0f);
+		_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
+			body->InterpolateTransform(_physicsInterpolation);
 		});
+	}
 
-		if (IsPlaying) {
+	void Scene::SetFixedTimeStep(float value) {
+		LOG_ASSERT(value > 0.0f, "Fixed time step must be greater than zero!");
+		_fixedTimeStep = value;
+	}
 
-			_physicsWorld->stepSimulation(dt, 1);
+	void Scene::SetMaxSubSteps(int value) {
+		_maxSubSteps = value < 1 ? 1 : value;
+	}
 
-			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
-				body->PhysicsPostStep(dt);
-			});
-			_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
-				body->PhysicsPostStep(dt);
-			});
+	void Scene::SetMultithreadedPhysics(bool value) {
+		if (value == _multithreadedPhysics) {
+			return;
 		}
+		_multithreadedPhysics = value;
+
+		// Bodies hold on to the world they were added to, so we can't swap it out from under them
+		if (_physicsWorld->getNumCollisionObjects() > 0) {
+			LOG_WARN("Physics world already has bodies, multithreaded physics will be {} the next time the scene is loaded", value ? "enabled" : "disabled");
+			return;
+		}
+
+		BulletDebugMode debugMode = GetPhysicsDebugDrawMode();
+		_CleanupPhysics();
+		_InitPhysics();
+		SetPhysicsDebugDrawMode(debugMode);
+	}
+
+	void Scene::_PhysicsPreTick(btDynamicsWorld* world, btScalar timeStep) {
+		Scene* scene = static_cast<Scene*>(world->getWorldUserInfo());
+		scene->_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
+			body->PhysicsPreStep(timeStep);
+		});
+		scene->_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
+			body->PhysicsPreStep(timeStep);
+		});
+	}
+
+	void Scene::_PhysicsPostTick(btDynamicsWorld* world, btScalar timeStep) {
+		Scene* scene = static_cast<Scene*>(world->getWorldUserInfo());
+		scene->_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
+			body->PhysicsPostStep(timeStep);
+		});
+		scene->_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
+			body->PhysicsPostStep(timeStep);
+		});
 	}
 
 	void Scene::DrawPhysicsDebug() {
@@ -181,13 +350,24 @@ namespace Gameplay {
 	void Scene::Update(float dt) {
 		_FlushDeleteQueue();
 		if (IsPlaying) {
+			// Thread safe component types are updated first, across all the cores. This blocks
+			// until they're done, so nothing below can see a half updated scene
+			_components.ParallelUpdate(dt);
+
 			for (auto& obj : _objects) {
 				obj->Update(dt);
 			}
+			for (auto& obj : _objects) {
+				obj->LateUpdate(dt);
+			}
 		}
 		_FlushDeleteQueue();
 	}
 
+	void Scene::UpdateTransforms() {
+		_transforms->UpdateAll();
+	}
+
 	void Scene::RenderGUI()
 	{
 		for (auto& obj : _objects) {
@@ -208,28 +388,20 @@ namespace Gameplay {
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
 		result->_objects.clear();
-		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
-
-		if (data.contains("ambient")) {
-			result->SetAmbientLight((data["ambient"]));
-		}
-
-		if (data.contains("skybox") && data["skybox"].is_object()) {
-			nlohmann::json& blob = data["skybox"].get<nlohmann::json>();
-			result->_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
-			result->SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"])));
-			result->SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"])));
-			result->SetSkyboxRotation(glm::mat3_cast((glm::quat)(blob["orientation"])));
-		}
+		result->_objectsByGuid.clear();
+		result->_objectsByName.clear();
+		result->_LoadSettings(data);
 
 		// Make sure the scene has objects, then load them all in!
 		LOG_ASSERT(data["objects"].is_array(), "Objects not present in scene!");
+		result->_objects.reserve(data["objects"].size());
+		result->_objectsByGuid.reserve(data["objects"].size());
 		for (auto& object : data["objects"]) {
 			GameObject::Sptr obj = GameObject::FromJson(result.get(), object);
-			obj->_scene = result.get();
 			obj->_parent.SceneContext = result.get();
 			obj->_selfRef = obj;
 			result->_objects.push_back(obj);
+			result->_AddToIndex(obj);
 		}
 
 		// Re-build the parent hierarchy 
@@ -247,11 +419,48 @@ namespace Gameplay {
 
 	nlohmann::json Scene::ToJson() const
 	{
+		nlohmann::json blob = _SaveSettings();
+
+		// Save renderables
+		std::vector<nlohmann::json> objects;
+		objects.resize(_objects.size());
+		for (int ix = 0; ix < _objects.size(); ix++) {
+			objects[ix] = _objects[ix]->ToJson();
+		}
+		blob["objects"] = objects;
+
+		return blob;
+	}
+
+	void Scene::_LoadSettings(const nlohmann::json& data) {
+		DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
+
+		if (data.contains("ambient")) {
+			SetAmbientLight((data["ambient"]));
+		}
+
+		SetFixedTimeStep(JsonGet(data, "physics_step", _fixedTimeStep));
+		SetMaxSubSteps(JsonGet(data, "physics_max_substeps", _maxSubSteps));
+		SetMultithreadedPhysics(JsonGet(data, "physics_multithreaded", _multithreadedPhysics));
+
+		if (data.contains("skybox") && data["skybox"].is_object()) {
+			const nlohmann::json& blob = data["skybox"];
+			_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
+			SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"])));
+			SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"])));
+			SetSkyboxRotation(glm::mat3_cast((glm::quat)(blob["orientation"])));
+		}
+	}
+
+	nlohmann::json Scene::_SaveSettings() const {
 		nlohmann::json blob;
 		// Save the default shader (really need a material class)
 		blob["default_material"] = DefaultMaterial ? DefaultMaterial->GetGUID().str() : "null";
 
 		blob["ambient"] = GetAmbientLight();
+		blob["physics_step"] = _fixedTimeStep;
+		blob["physics_max_substeps"] = _maxSubSteps;
+		blob["physics_multithreaded"] = _multithreadedPhysics;
 
 		blob["skybox"] = nlohmann::json();
 		blob["skybox"]["mesh"] = _skyboxMesh ? _skyboxMesh->GetGUID().str() : "null";
@@ -259,29 +468,34 @@ namespace Gameplay {
 		blob["skybox"]["texture"] = _skyboxTexture ? _skyboxTexture->GetGUID().str() : "null";
 		blob["skybox"]["orientation"] = (glm::quat)_skyboxRotation;
 
-		// Save renderables
-		std::vector<nlohmann::json> objects;
-		objects.resize(_objects.size());
-		for (int ix = 0; ix < _objects.size(); ix++) {
-			objects[ix] = _objects[ix]->ToJson();
-		}
-		blob["objects"] = objects;
-
 		// Save camera info
 		blob["main_camera"] = MainCamera != nullptr ? MainCamera->GetGUID().str() : "null";
 
 		return blob;
 	}
 
-	void Scene::Save(const std::string& path) {
+	void Scene::Save(const std::string& path, bool writeBinaryCopy) {
 		_filePath = path;
 		// Save data to file
-		FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
+		if (std::filesystem::path(path).extension() == ".bscene") {
+			SaveBinary(path);
+		} else {
+			FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
+			// The binary copy is written after the JSON so that it's newer and will be
+			// preferred the next time the scene is loaded
+			if (writeBinaryCopy) {
+				SaveBinary(GetBinaryPath(path));
+			}
+		}
 		LOG_INFO("Saved scene to \"{}\"", path);
 	}
 
 	Scene::Sptr Scene::Load(const std::string& path)
 	{
+		if (std::filesystem::path(path).extension() == ".bscene") {
+			return LoadBinary(path);
+		}
+
 		LOG_INFO("Loading scene from \"{}\"", path);
 		std::string content = FileHelpers::ReadFile(path);
 		nlohmann::json blob = nlohmann::json::parse(content);
@@ -290,6 +504,246 @@ namespace Gameplay {
 		return result;
 	}
 
+	std::string Scene::GetBinaryPath(const std::string& path) {
+		return std::filesystem::path(path).replace_extension(".bscene").string();
+	}
+
+	bool Scene::SaveBinary(const std::string& path) const {
+		// Lets us look up objects by index when writing parent links
+		std::unordered_map<const GameObject*, int32_t> objectIndices;
+		objectIndices.reserve(_objects.size());
+		for (int ix = 0; ix < _objects.size(); ix++) {
+			objectIndices[_objects[ix].get()] = ix;
+		}
+
+		// We build the object section first, since we need to know all the strings
+		// before we can write the string table
+		std::vector<std::string> strings;
+		std::unordered_map<std::string, uint32_t> stringIndices;
+		auto internString = [&](const std::string& value) {
+			auto it = stringIndices.find(value);
+			if (it != stringIndices.end()) {
+				return it->second;
+			}
+			uint32_t index = static_cast<uint32_t>(strings.size());
+			strings.push_back(value);
+			stringIndices[value] = index;
+			return index;
+		};
+
+		BinaryWriter objects;
+		for (const auto& object : _objects) {
+			GameObject::Sptr parent = object->GetParent();
+			auto parentIt = parent != nullptr ? objectIndices.find(parent.get()) : objectIndices.end();
+
+			BinarySceneObject record;
+			record.NameIndex = internString(object->GetName());
+			memcpy(record.Guid, object->_guid.bytes(), sizeof(record.Guid));
+			record.ParentIndex = parentIt != objectIndices.end() ? parentIt->second : -1;
+			glm::vec3 position = object->GetPosition();
+			glm::quat rotation = object->GetRotation();
+			glm::vec3 scale = object->GetScale();
+			memcpy(record.Position, &position[0], sizeof(record.Position));
+			record.Rotation[0] = rotation.x;
+			record.Rotation[1] = rotation.y;
+			record.Rotation[2] = rotation.z;
+			record.Rotation[3] = rotation.w;
+			memcpy(record.Scale, &scale[0], sizeof(record.Scale));
+			record.Flags = object->HideInHierarchy ? BSCENE_FLAG_HIDDEN : 0;
+			record.ComponentCount = static_cast<uint32_t>(object->_components.size());
+			objects.Write(record);
+
+			// Components go through their existing JSON serialization, we just store the
+			// result as MessagePack so we don't need to deal with text when loading
+			for (const auto& component : object->_components) {
+				std::vector<uint8_t> packed = nlohmann::json::to_msgpack(GameObject::_SaveComponent(component));
+
+				objects.Write(internString(component->ComponentTypeName()));
+				objects.Write(static_cast<uint32_t>(packed.size()));
+				objects.WriteBytes(packed.data(), packed.size());
+			}
+		}
+
+		std::vector<uint8_t> settings = nlohmann::json::to_msgpack(_SaveSettings());
+
+		BinarySceneHeader header;
+		memcpy(header.Magic, BSCENE_MAGIC, sizeof(header.Magic));
+		header.Version      = BSCENE_VERSION;
+		header.StringCount  = static_cast<uint32_t>(strings.size());
+		header.ObjectCount  = static_cast<uint32_t>(_objects.size());
+		header.SettingsSize = static_cast<uint32_t>(settings.size());
+		header.Reserved     = 0;
+
+		BinaryWriter file;
+		file.Data.reserve(sizeof(BinarySceneHeader) + settings.size() + objects.Data.size());
+		file.Write(header);
+		for (const std::string& value : strings) {
+			file.Write(static_cast<uint32_t>(value.size()));
+			file.WriteBytes(value.data(), value.size());
+		}
+		file.WriteBytes(settings.data(), settings.size());
+		file.WriteBytes(objects.Data.data(), objects.Data.size());
+
+		// Write to a temporary file first so we never leave a half written scene behind
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			if (!stream.is_open()) {
+				LOG_WARN("Failed to open \"{}\" for writing", tempPath);
+				return false;
+			}
+			stream.write(reinterpret_cast<const char*>(file.Data.data()), file.Data.size());
+			if (!stream.good()) {
+				LOG_WARN("Failed to write binary scene to \"{}\"", tempPath);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			LOG_WARN("Failed to replace \"{}\": {}", path, error.message());
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		return true;
+	}
+
+	Scene::Sptr Scene::LoadBinary(const std::string& path)
+	{
+		LOG_INFO("Loading binary scene from \"{}\"", path);
+
+		MappedFile file;
+		if (!file.Open(path)) {
+			LOG_WARN("Failed to open binary scene \"{}\"", path);
+			return nullptr;
+		}
+		BinaryReader reader(file.GetData(), file.GetSize());
+
+		BinarySceneHeader header;
+		if (!reader.Read(header) || memcmp(header.Magic, BSCENE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != BSCENE_VERSION) {
+			LOG_WARN("\"{}\" is not a valid binary scene, or was written by a different version", path);
+			return nullptr;
+		}
+
+		// The counts come straight from the file, so make sure they could actually fit in what's left of it
+		// before we reserve anything for them. Every string has at least it's length, and every object is at
+		// least a record
+		if (header.StringCount > reader.Remaining() / sizeof(uint32_t) ||
+			header.ObjectCount > reader.Remaining() / sizeof(BinarySceneObject)) {
+			LOG_WARN("Binary scene \"{}\" has a corrupt header", path);
+			return nullptr;
+		}
+
+		// Load the string table
+		std::vector<std::string> strings;
+		strings.reserve(header.StringCount);
+		for (uint32_t ix = 0; ix < header.StringCount; ix++) {
+			uint32_t length = 0;
+			const uint8_t* chars = reader.Read(length) ? reader.Skip(length) : nullptr;
+			if (chars == nullptr) {
+				LOG_WARN("Binary scene \"{}\" is truncated", path);
+				return nullptr;
+			}
+			strings.emplace_back(reinterpret_cast<const char*>(chars), length);
+		}
+
+		const uint8_t* settingsData = reader.Skip(header.SettingsSize);
+		nlohmann::json settings = settingsData != nullptr ?
+			nlohmann::json::from_msgpack(settingsData, settingsData + header.SettingsSize, true, false) :
+			nlohmann::json(nlohmann::json::value_t::discarded);
+		if (settings.is_discarded()) {
+			LOG_WARN("Binary scene \"{}\" has invalid settings", path);
+			return nullptr;
+		}
+
+		Scene::Sptr result = std::make_shared<Scene>();
+		result->MainCamera = nullptr;
+		result->_filePath = path;
+		// The parent indices in the file only line up with _objects if the constructor's default camera is gone
+		result->_objects.clear();
+		result->_objectsByGuid.clear();
+		result->_objectsByName.clear();
+		result->_LoadSettings(settings);
+
+		result->_objects.reserve(header.ObjectCount);
+		result->_objectsByGuid.reserve(header.ObjectCount);
+
+		std::vector<int32_t> parents;
+		parents.reserve(header.ObjectCount);
+
+		for (uint32_t ix = 0; ix < header.ObjectCount; ix++) {
+			BinarySceneObject record;
+			if (!reader.Read(record) || record.NameIndex >= strings.size() ||
+				record.ParentIndex < -1 || record.ParentIndex >= static_cast<int32_t>(header.ObjectCount)) {
+				LOG_WARN("Binary scene \"{}\" has an invalid object record at index {}", path, ix);
+				return nullptr;
+			}
+
+			// We need to manually construct since the GameObject constructor is protected
+			GameObject::Sptr obj(new GameObject(result.get()));
+			obj->_name = strings[record.NameIndex];
+			obj->_guid = Guid::FromBytes(record.Guid);
+			obj->SetPostion(glm::vec3(record.Position[0], record.Position[1], record.Position[2]));
+			obj->SetRotation(glm::quat(record.Rotation[3], record.Rotation[0], record.Rotation[1], record.Rotation[2]));
+			obj->SetScale(glm::vec3(record.Scale[0], record.Scale[1], record.Scale[2]));
+			obj->HideInHierarchy = (record.Flags & BSCENE_FLAG_HIDDEN) != 0;
+
+			for (uint32_t iy = 0; iy < record.ComponentCount; iy++) {
+				uint32_t typeIndex = 0;
+				uint32_t size = 0;
+				const uint8_t* data = reader.Read(typeIndex) && reader.Read(size) ? reader.Skip(size) : nullptr;
+				nlohmann::json blob = data != nullptr ?
+					nlohmann::json::from_msgpack(data, data + size, true, false) :
+					nlohmann::json(nlohmann::json::value_t::discarded);
+				if (typeIndex >= strings.size() || blob.is_discarded()) {
+					LOG_WARN("Binary scene \"{}\" has an invalid component on object \"{}\"", path, obj->GetName());
+					return nullptr;
+				}
+				obj->_LoadComponent(strings[typeIndex], blob);
+			}
+
+			obj->_parent.SceneContext = result.get();
+			obj->_selfRef = obj;
+			result->_objects.push_back(obj);
+			result->_AddToIndex(obj);
+			parents.push_back(record.ParentIndex);
+		}
+
+		// A corrupt file could have an object be it's own ancestor, which would leave the hierarchy (and the
+		// transform store's depth sort) without a root. Walk up from every object, marking objects as we go
+		// so that each one is only walked once
+		enum VisitState : uint8_t { Unvisited = 0, Visiting = 1, Visited = 2 };
+		std::vector<uint8_t> visitState(parents.size(), Unvisited);
+		for (size_t ix = 0; ix < parents.size(); ix++) {
+			int32_t current = static_cast<int32_t>(ix);
+			while (current >= 0 && visitState[current] == Unvisited) {
+				visitState[current] = Visiting;
+				current = parents[current];
+			}
+			// If we ran into an object on the path we just walked, the path loops back on itself
+			if (current >= 0 && visitState[current] == Visiting) {
+				LOG_WARN("Binary scene \"{}\" has a cycle in it's hierarchy at object \"{}\"", path, result->_objects[current]->GetName());
+				return nullptr;
+			}
+			for (current = static_cast<int32_t>(ix); current >= 0 && visitState[current] == Visiting; current = parents[current]) {
+				visitState[current] = Visited;
+			}
+		}
+
+		// Re-build the parent hierarchy, we can link directly by index instead of searching by GUID
+		for (size_t ix = 0; ix < parents.size(); ix++) {
+			if (parents[ix] >= 0) {
+				result->_objects[parents[ix]]->AddChild(result->_objects[ix]);
+			}
+		}
+
+		// Create and load camera config
+		result->MainCamera = result->_components.GetComponentByGUID<Camera>(Guid(settings["main_camera"]));
+
+		return result;
+	}
+
 	int Scene::NumObjects() const {
 		return static_cast<int>(_objects.size());
 	}
@@ -299,19 +753,46 @@ namespace Gameplay {
 	}
 
 	void Scene::_InitPhysics() {
-		_collisionConfig = new btDefaultCollisionConfiguration();
-		_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
 		_broadphaseInterface = new btDbvtBroadphase();
 		_ghostCallback = new btGhostPairCallback();
 		_broadphaseInterface->getOverlappingPairCache()->setInternalGhostPairCallback(_ghostCallback);
-		_constraintSolver = new btSequentialImpulseConstraintSolver();
-		_physicsWorld = new btDiscreteDynamicsWorld(
-			_collisionDispatcher,
-			_broadphaseInterface,
-			_constraintSolver,
-			_collisionConfig
-		);
+
+		if (_multithreadedPhysics) {
+			// The pools are shared between all threads, so we give them more room up front to avoid
+			// falling back to the (locked) heap allocations when lots of pairs are in contact
+			btDefaultCollisionConstructionInfo info;
+			info.m_defaultMaxPersistentManifoldPoolSize = 80000;
+			info.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+			_collisionConfig = new btDefaultCollisionConfiguration(info);
+
+			// Bullet's scheduler is global, route it through our job system so we don't end up with
+			// two thread pools fighting over the same cores
+			btSetTaskScheduler(JobTaskScheduler::Get());
+			_collisionDispatcher = new btCollisionDispatcherMt(_collisionConfig);
+			btConstraintSolverPoolMt* solverPool = new btConstraintSolverPoolMt(btGetTaskScheduler()->getMaxNumThreads());
+			_constraintSolver = solverPool;
+			_physicsWorld = new btDiscreteDynamicsWorldMt(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				solverPool,
+				nullptr,
+				_collisionConfig
+			);
+		} else {
+			_collisionConfig = new btDefaultCollisionConfiguration();
+			_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
+			_constraintSolver = new btSequentialImpulseConstraintSolver();
+			_physicsWorld = new btDiscreteDynamicsWorld(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				_constraintSolver,
+				_collisionConfig
+			);
+		}
 		_physicsWorld->setGravity(ToBt(_gravity));
+		// Let bodies handle their state before and after every fixed step, rather than once per frame
+		_physicsWorld->setInternalTickCallback(&Scene::_PhysicsPreTick, this, true);
+		_physicsWorld->setInternalTickCallback(&Scene::_PhysicsPostTick, this, false);
 		// TODO bullet debug drawing
 		_bulletDebugDraw = new BulletDebugDraw();
 		_physicsWorld->setDebugDrawer(_bulletDebugDraw);
@@ -325,20 +806,56 @@ namespace Gameplay {
 		delete _ghostCallback;
 		delete _collisionDispatcher;
 		delete _collisionConfig;
+		delete _bulletDebugDraw;
 	}
 
 
 	void Scene::_FlushDeleteQueue() {
 		for (auto& weakPtr : _deletionQueue) {
 			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
+			GameObject::Sptr object = weakPtr.lock();
+			auto& it = std::find(_objects.begin(), _objects.end(), object);
 			if (it != _objects.end()) {
+				_RemoveFromIndex(object);
 				_objects.erase(it);
 			}
 		}
 		_deletionQueue.clear();
 	}
 
+	void Scene::_AddToIndex(const GameObject::Sptr& object) {
+		_objectsByGuid[object->_guid] = object;
+		_objectsByName.emplace(object->_name, object);
+	}
+
+	void Scene::_RemoveFromIndex(const GameObject::Sptr& object) {
+		auto guidIt = _objectsByGuid.find(object->_guid);
+		if (guidIt != _objectsByGuid.end() && guidIt->second.lock() == object) {
+			_objectsByGuid.erase(guidIt);
+		}
+
+		auto range = _objectsByName.equal_range(object->_name);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second.lock() == object) {
+				_objectsByName.erase(it);
+				break;
+			}
+		}
+	}
+
+	void Scene::_OnObjectRenamed(GameObject* object, const std::string& oldName) {
+		// Objects that are still being loaded aren't in the index yet, they get added under their final name
+		auto range = _objectsByName.equal_range(oldName);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second.lock().get() == object) {
+				std::weak_ptr<GameObject> ref = it->second;
+				_objectsByName.erase(it);
+				_objectsByName.emplace(object->_name, ref);
+				return;
+			}
+		}
+	}
+
 	void Scene::DrawAllGameObjectGUIs()
 	{
 		for (auto& object : _objects) {
@@ -4,12 +4,15 @@
 
 #include "Gameplay/Components/Camera.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/CullingTree.h"
 
 #include "Physics/BulletDebugDraw.h"
 
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/Textures/Texture3D.h"
 
+#include <unordered_map>
+
 struct GLFWwindow;
 
 class TextureCube;
@@ -82,16 +85,14 @@ namespace Gameplay {
 		void RemoveGameObject(const GameObject::Sptr& object);
 
 		/// <summary>
-		/// Searches all objects in the scene and returns the first
-		/// one who's name matches the one given, or nullptr if no object
-		/// is found
+		/// Looks up an object in the scene who's name matches the one given,
+		/// or nullptr if no object has that name
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
 		GameObject::Sptr FindObjectByName(const std::string name) const;
 		/// <summary>
-		/// Searches all render objects in the scene and returns the first
-		/// one who's guid matches the one given, or nullptr if no object
-		/// is found
+		/// Looks up the object in the scene who's guid matches the one given,
+		/// or nullptr if no object is found
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
@@ -121,10 +122,36 @@ namespace Gameplay {
 		/// Performs physics updates for all physics bodies in this scene,
 		/// should be called after Update in the main loop
 		/// 
+		/// The simulation is always advanced in fixed steps, frame time is accumulated
+		/// and any leftover time is used to interpolate the render transforms of bodies
+		/// 
 		/// Only invokes events if IsPlaying is true
 		/// </summary>
 		/// <param name="dt">The time in seconds since the last frame</param>
 		void DoPhysics(float dt);
+
+		/// <summary>
+		/// Sets the length of a single physics step in seconds, default is 1/60
+		/// </summary>
+		void SetFixedTimeStep(float value);
+		float GetFixedTimeStep() const { return _fixedTimeStep; }
+		/// <summary>
+		/// Sets the maximum number of physics steps to take in a single frame, any time
+		/// beyond this is dropped so that a long frame can't cause a spiral of ever longer frames
+		/// </summary>
+		void SetMaxSubSteps(int value);
+		int GetMaxSubSteps() const { return _maxSubSteps; }
+		/// <summary>
+		/// Sets whether the scene uses bullet's multithreaded world, with it's work spread over the
+		/// JobSystem's threads. The world can only be rebuilt while it's empty, so if bodies have
+		/// already been added this will only take effect the next time the scene is loaded
+		/// </summary>
+		void SetMultithreadedPhysics(bool value);
+		bool GetMultithreadedPhysics() const { return _multithreadedPhysics; }
+		/// <summary>
+		/// Gets how far between the last two physics steps the render transforms are, in the 0-1 range
+		/// </summary>
+		float GetPhysicsInterpolation() const { return _physicsInterpolation; }
 		/// <summary>
 		/// Renders debug information for the physics scene
 		/// </summary>
@@ -132,13 +159,22 @@ namespace Gameplay {
 
 		/// <summary>
 		/// Performs updates on all enabled components and gameobjects in the
-		/// scene
+		/// scene. Thread safe components are updated in parallel first, then the
+		/// remaining components, then LateUpdate for all components
 		/// 
 		/// Only invokes events if IsPlaying is true
 		/// </summary>
 		/// <param name="dt">The time in seconds since the last frame</param>
 		void Update(float dt);
 
+		/// <summary>
+		/// Rebuilds the world transforms of any objects that have changed in a single pass over
+		/// the scene's transform store, which keeps every parent before it's children.
+		/// Should be called once per frame before rendering, so that drawing doesn't have
+		/// to lazily evaluate transforms up the hierarchy for every object
+		/// </summary>
+		void UpdateTransforms();
+
 		/// <summary>
 		/// Draws all GUI objects in the scene
 		/// </summary>
@@ -170,17 +206,47 @@ namespace Gameplay {
 		const ComponentManager& Components() const { return _components; }
 
 		/// <summary>
-		/// Saves this scene to an output JSON file
+		/// Gets the dynamic AABB tree that the renderer uses to cull objects in this scene
+		/// </summary>
+		const CullingTree::Sptr& GetCullingTree() const { return _cullingTree; }
+		/// <summary>
+		/// Gets the store that holds the transforms for all the objects in this scene
+		/// </summary>
+		const TransformStore::Sptr& GetTransformStore() const { return _transforms; }
+
+		/// <summary>
+		/// Saves this scene to an output file. Paths ending in .bscene are written in the
+		/// binary scene format, otherwise the scene is written as JSON
 		/// </summary>
 		/// <param name="path">The path of the file to write to</param>
-		void Save(const std::string& path);
+		/// <param name="writeBinaryCopy">True to also write a .bscene next to a JSON scene, which Application::LoadScene will prefer while it's newer</param>
+		void Save(const std::string& path, bool writeBinaryCopy = false);
 		/// <summary>
-		/// Loads a scene from an input JSON file
+		/// Loads a scene from an input file, paths ending in .bscene are loaded as binary
+		/// scenes and all other paths are loaded as JSON
 		/// </summary>
 		/// <param name="path">The path of the file to read from</param>
-		/// <returns>A new scene loaded from the file</returns>
+		/// <returns>A new scene loaded from the file, or nullptr if it failed to load</returns>
 		static Scene::Sptr Load(const std::string& path);
 
+		/// <summary>
+		/// Saves this scene to a binary scene file (see BinarySceneHeader in Scene.cpp for the layout)
+		/// </summary>
+		/// <param name="path">The path of the file to write to</param>
+		/// <returns>True if the file was written, false if otherwise</returns>
+		bool SaveBinary(const std::string& path) const;
+		/// <summary>
+		/// Loads a scene from a binary scene file
+		/// </summary>
+		/// <param name="path">The path of the file to read from</param>
+		/// <returns>A new scene loaded from the file, or nullptr if the file is missing or invalid</returns>
+		static Scene::Sptr LoadBinary(const std::string& path);
+
+		/// <summary>
+		/// Gets the path of the binary scene that is stored alongside the given JSON scene
+		/// </summary>
+		static std::string GetBinaryPath(const std::string& path);
+
 
 		int NumObjects() const;
 		GameObject::Sptr GetObjectByIndex(int index) const;
@@ -191,6 +257,10 @@ namespace Gameplay {
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
+		// Stores the world space bounds of our render components for visibility culling
+		CullingTree::Sptr _cullingTree;
+		// The positions, rotations, scales and matrices of all our objects, stored in depth order
+		TransformStore::Sptr _transforms;
 
 		// Bullet physics stuff world
 		btDynamicsWorld*          _physicsWorld;
@@ -207,6 +277,13 @@ namespace Gameplay {
 
 		BulletDebugDraw* _bulletDebugDraw;
 
+		// Fixed timestep settings, and the amount of frame time that we haven't simulated yet
+		float  _fixedTimeStep;
+		int    _maxSubSteps;
+		bool   _multithreadedPhysics;
+		double _physicsAccumulator;
+		float  _physicsInterpolation;
+
 		// The path that we've saved or loaded this scene from
 		std::string             _filePath;
 
@@ -217,6 +294,13 @@ namespace Gameplay {
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Indices for looking up objects without scanning the whole scene, these are kept
+		// up to date as objects are added and removed
+		std::unordered_map<Guid, std::weak_ptr<GameObject>> _objectsByGuid;
+		// GameObject::SetName moves an object's entry when it's renamed, entries for objects
+		// that were destroyed without being removed are dropped when they are found
+		mutable std::unordered_multimap<std::string, std::weak_ptr<GameObject>> _objectsByName;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -239,6 +323,30 @@ namespace Gameplay {
 		/// </summary>
 		void _CleanupPhysics();
 
+		/// <summary>
+		/// Bullet internal tick callbacks, invoked before and after every fixed step. The
+		/// world user info is the scene
+		/// </summary>
+		static void _PhysicsPreTick(btDynamicsWorld* world, btScalar timeStep);
+		static void _PhysicsPostTick(btDynamicsWorld* world, btScalar timeStep);
+
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Loads or saves the scene level settings (everything but the objects), these
+		/// are shared between the JSON and binary scene formats
+		/// </summary>
+		void _LoadSettings(const nlohmann::json& data);
+		nlohmann::json _SaveSettings() const;
+
+		/// <summary>
+		/// Adds or removes an object from our lookup indices
+		/// </summary>
+		void _AddToIndex(const GameObject::Sptr& object);
+		void _RemoveFromIndex(const GameObject::Sptr& object);
+		/// <summary>
+		/// Moves an object's entry in the name index after it has been renamed, see GameObject::SetName
+		/// </summary>
+		void _OnObjectRenamed(GameObject* object, const std::string& oldName);
 	};
 }
\ No newline at end of file
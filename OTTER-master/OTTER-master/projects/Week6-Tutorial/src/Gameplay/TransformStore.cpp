@@ -0,0 +1,310 @@
+#include "Gameplay/TransformStore.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define TRANSFORM_STORE_SSE 1
+#else
+	#define TRANSFORM_STORE_SSE 0
+#endif
+
+namespace Gameplay {
+	namespace {
+		/// <summary>
+		/// Calculates result = a * b for column major matrices. Each column of the result is a
+		/// sum of the columns of a weighted by the matching column of b, which maps directly onto
+		/// 4 wide multiply-adds. Unaligned loads are used since glm does not align it's matrices
+		/// </summary>
+		inline void MultiplyMatrices(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+		#if TRANSFORM_STORE_SSE
+			const float* pa = &a[0][0];
+			const float* pb = &b[0][0];
+			float* pr = &result[0][0];
+
+			const __m128 a0 = _mm_loadu_ps(pa);
+			const __m128 a1 = _mm_loadu_ps(pa + 4);
+			const __m128 a2 = _mm_loadu_ps(pa + 8);
+			const __m128 a3 = _mm_loadu_ps(pa + 12);
+
+			for (int col = 0; col < 4; col++) {
+				const float* bc = pb + col * 4;
+				__m128 sum = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+				sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+				_mm_storeu_ps(pr + col * 4, sum);
+			}
+		#else
+			result = a * b;
+		#endif
+		}
+
+		template <typename T>
+		void Permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+			std::vector<T> result;
+			result.reserve(order.size());
+			for (uint32_t slot : order) {
+				result.push_back(values[slot]);
+			}
+			values.swap(result);
+		}
+	}
+
+	TransformStore::TransformStore() :
+		_positions(),
+		_rotations(),
+		_scales(),
+		_parents(),
+		_dirty(),
+		_localMatrices(),
+		_inverseLocalMatrices(),
+		_worldMatrices(),
+		_inverseWorldMatrices(),
+		_worldGenerations(),
+		_worldParentGenerations(),
+		_handles(),
+		_slots(),
+		_freeHandles(),
+		_orderDirty(false),
+		_depths(),
+		_order(),
+		_newSlots()
+	{ }
+
+	TransformStore::Handle TransformStore::Allocate() {
+		Handle handle;
+		if (!_freeHandles.empty()) {
+			handle = _freeHandles.back();
+			_freeHandles.pop_back();
+		} else {
+			handle = static_cast<Handle>(_slots.size());
+			_slots.push_back(0);
+		}
+
+		// New transforms are roots, so they can always go on the end without breaking the depth order
+		_slots[handle] = static_cast<uint32_t>(_handles.size());
+		_positions.push_back(glm::vec3(0.0f));
+		_rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		_scales.push_back(glm::vec3(1.0f));
+		_parents.push_back(-1);
+		_dirty.push_back(DIRTY_ALL);
+		_localMatrices.push_back(glm::mat4(1.0f));
+		_inverseLocalMatrices.push_back(glm::mat4(1.0f));
+		_worldMatrices.push_back(glm::mat4(1.0f));
+		_inverseWorldMatrices.push_back(glm::mat4(1.0f));
+		_worldGenerations.push_back(0);
+		_worldParentGenerations.push_back(0);
+		_handles.push_back(handle);
+		return handle;
+	}
+
+	void TransformStore::Free(Handle handle) {
+		// The slot stays in place until the next sort, so children can still see that their parent is gone
+		uint32_t slot = _slots[handle];
+		_handles[slot] = INVALID_HANDLE;
+		_freeHandles.push_back(handle);
+		_orderDirty = true;
+	}
+
+	void TransformStore::SetParent(Handle handle, Handle parent) {
+		uint32_t slot = _slots[handle];
+		int32_t parentSlot = parent == INVALID_HANDLE ? -1 : static_cast<int32_t>(_slots[parent]);
+		_parents[slot] = parentSlot;
+		_dirty[slot] |= DIRTY_WORLD;
+
+		// Our own children come after us, so we only break the ordering if the new parent does too
+		if (parentSlot > static_cast<int32_t>(slot)) {
+			_orderDirty = true;
+		}
+	}
+
+	const glm::mat4& TransformStore::GetLocalTransform(Handle handle) {
+		uint32_t slot = _slots[handle];
+		_RecalcLocal(slot);
+		return _localMatrices[slot];
+	}
+
+	const glm::mat4& TransformStore::GetInverseLocalTransform(Handle handle) {
+		uint32_t slot = _slots[handle];
+		_RecalcLocal(slot);
+		return _inverseLocalMatrices[slot];
+	}
+
+	const glm::mat4& TransformStore::GetWorldTransform(Handle handle) {
+		uint32_t slot = _slots[handle];
+		_RecalcWorldChain(slot);
+		return _worldMatrices[slot];
+	}
+
+	const glm::mat4& TransformStore::GetInverseWorldTransform(Handle handle) {
+		uint32_t slot = _slots[handle];
+		_RecalcWorldChain(slot);
+		return _inverseWorldMatrices[slot];
+	}
+
+	void TransformStore::UpdateAll() {
+		if (_orderDirty) {
+			_SortByDepth();
+		}
+
+		// Parents always come first, so a single pass is enough
+		const uint32_t count = static_cast<uint32_t>(_handles.size());
+		for (uint32_t slot = 0; slot < count; slot++) {
+			_RecalcWorld(slot);
+		}
+	}
+
+	int32_t TransformStore::_LiveParent(uint32_t slot) {
+		int32_t parent = _parents[slot];
+		if (parent >= 0 && _handles[parent] == INVALID_HANDLE) {
+			_parents[slot] = -1;
+			_dirty[slot] |= DIRTY_WORLD;
+			parent = -1;
+		}
+		return parent;
+	}
+
+	void TransformStore::_RecalcLocal(uint32_t slot) {
+		if (!(_dirty[slot] & DIRTY_LOCAL)) {
+			return;
+		}
+
+		// Build the TRS matrix from it's parts directly, rather than multiplying 3 full matrices
+		const glm::vec3& position = _positions[slot];
+		const glm::vec3& scale = _scales[slot];
+		glm::mat3 rotation = glm::mat3_cast(_rotations[slot]);
+
+		glm::mat4& local = _localMatrices[slot];
+		local[0] = glm::vec4(rotation[0] * scale.x, 0.0f);
+		local[1] = glm::vec4(rotation[1] * scale.y, 0.0f);
+		local[2] = glm::vec4(rotation[2] * scale.z, 0.0f);
+		local[3] = glm::vec4(position, 1.0f);
+
+		// The inverse is S^-1 * R^T * T^-1, the rows of the rotation scaled by the inverse scale
+		glm::vec3 invScale = 1.0f / scale;
+		glm::mat4& inverse = _inverseLocalMatrices[slot];
+		for (int col = 0; col < 3; col++) {
+			inverse[col] = glm::vec4(
+				rotation[0][col] * invScale.x,
+				rotation[1][col] * invScale.y,
+				rotation[2][col] * invScale.z,
+				0.0f);
+		}
+		inverse[3] = glm::vec4(-(glm::vec3(inverse[0]) * position.x + glm::vec3(inverse[1]) * position.y + glm::vec3(inverse[2]) * position.z), 1.0f);
+
+		// The world transform still needs rebuilding, so only clear the local flag
+		_dirty[slot] &= static_cast<uint8_t>(~DIRTY_LOCAL);
+	}
+
+	void TransformStore::_RecalcWorld(uint32_t slot) {
+		int32_t parent = _LiveParent(slot);
+		uint64_t parentGeneration = parent >= 0 ? _worldGenerations[parent] : 0;
+		if (!(_dirty[slot] & DIRTY_WORLD) && _worldParentGenerations[slot] == parentGeneration) {
+			return;
+		}
+
+		_RecalcLocal(slot);
+		_dirty[slot] = 0;
+
+		// If out parent exists, we apply our local transformation relative to the parent's world transformation
+		if (parent >= 0) {
+			MultiplyMatrices(_worldMatrices[parent], _localMatrices[slot], _worldMatrices[slot]);
+			MultiplyMatrices(_inverseLocalMatrices[slot], _inverseWorldMatrices[parent], _inverseWorldMatrices[slot]);
+		}
+		// If our parent is null, we can simply use the local transform as the world transform
+		else {
+			_worldMatrices[slot] = _localMatrices[slot];
+			_inverseWorldMatrices[slot] = _inverseLocalMatrices[slot];
+		}
+
+		_worldParentGenerations[slot] = parentGeneration;
+		_worldGenerations[slot]++;
+	}
+
+	void TransformStore::_RecalcWorldChain(uint32_t slot) {
+		// Collect the chain up to the root, then rebuild from the top down so each parent is ready for it's child
+		static thread_local std::vector<uint32_t> chain;
+		chain.clear();
+		for (int32_t current = static_cast<int32_t>(slot); current >= 0; current = _LiveParent(current)) {
+			chain.push_back(static_cast<uint32_t>(current));
+		}
+		for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+			_RecalcWorld(*it);
+		}
+	}
+
+	void TransformStore::_SortByDepth() {
+		const uint32_t count = static_cast<uint32_t>(_handles.size());
+
+		// Work out the depth of every live slot, walking up until we hit a slot we already know
+		_depths.assign(count, -1);
+		_order.clear();
+		int32_t maxDepth = 0;
+		for (uint32_t slot = 0; slot < count; slot++) {
+			if (_handles[slot] == INVALID_HANDLE || _depths[slot] >= 0) {
+				continue;
+			}
+
+			_order.clear();
+			int32_t current = static_cast<int32_t>(slot);
+			int32_t depth = -1;
+			while (current >= 0) {
+				if (_depths[current] >= 0) {
+					depth = _depths[current];
+					break;
+				}
+				_order.push_back(static_cast<uint32_t>(current));
+				current = _LiveParent(current);
+			}
+			for (auto it = _order.rbegin(); it != _order.rend(); it++) {
+				_depths[*it] = ++depth;
+			}
+			maxDepth = std::max(maxDepth, depth);
+		}
+
+		// Counting sort on the depth, this is stable so siblings keep their relative order
+		std::vector<uint32_t> offsets(maxDepth + 2, 0);
+		for (uint32_t slot = 0; slot < count; slot++) {
+			if (_depths[slot] >= 0) {
+				offsets[_depths[slot] + 1]++;
+			}
+		}
+		for (size_t ix = 1; ix < offsets.size(); ix++) {
+			offsets[ix] += offsets[ix - 1];
+		}
+		uint32_t liveCount = offsets.back();
+		_order.assign(liveCount, 0);
+		_newSlots.assign(count, 0);
+		for (uint32_t slot = 0; slot < count; slot++) {
+			if (_depths[slot] >= 0) {
+				uint32_t newSlot = offsets[_depths[slot]]++;
+				_order[newSlot] = slot;
+				_newSlots[slot] = newSlot;
+			}
+		}
+
+		Permute(_positions, _order);
+		Permute(_rotations, _order);
+		Permute(_scales, _order);
+		Permute(_parents, _order);
+		Permute(_dirty, _order);
+		Permute(_localMatrices, _order);
+		Permute(_inverseLocalMatrices, _order);
+		Permute(_worldMatrices, _order);
+		Permute(_inverseWorldMatrices, _order);
+		Permute(_worldGenerations, _order);
+		Permute(_worldParentGenerations, _order);
+		Permute(_handles, _order);
+
+		// Point parents and handles at the new slots. Dead parents were already cleared when finding the depths
+		for (uint32_t slot = 0; slot < liveCount; slot++) {
+			if (_parents[slot] >= 0) {
+				_parents[slot] = static_cast<int32_t>(_newSlots[_parents[slot]]);
+			}
+			_slots[_handles[slot]] = slot;
+		}
+
+		_orderDirty = false;
+	}
+}
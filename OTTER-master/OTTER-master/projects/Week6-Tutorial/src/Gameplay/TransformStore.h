@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Stores the transforms for all the objects in a scene as a structure of arrays, so that the
+	/// world matrices for the whole scene can be rebuilt in a single tight loop instead of chasing
+	/// pointers through every object
+	///
+	/// Objects refer to their transform by a handle, which stays valid while the slots behind it are
+	/// re-ordered. Slots are kept sorted by depth in the hierarchy, so that every parent comes before
+	/// it's children and UpdateAll can rebuild each world matrix from an already up to date parent
+	///
+	/// Changes are tracked with a dirty flag per slot and a generation counter per world matrix. Setting
+	/// a transform never touches the children, they notice that their parent's generation has changed
+	/// the next time they are updated
+	///
+	/// Setting a transform is safe from multiple threads as long as each thread works on different
+	/// handles. Everything else (including reading world transforms) must happen on the main thread
+	/// </summary>
+	class TransformStore {
+	public:
+		MAKE_PTRS(TransformStore);
+		NO_COPY(TransformStore);
+		NO_MOVE(TransformStore);
+
+		typedef uint32_t Handle;
+		static const Handle INVALID_HANDLE = ~0u;
+
+		TransformStore();
+		~TransformStore() = default;
+
+		/// <summary>
+		/// Adds a new transform at the origin, with no rotation, a scale of 1 and no parent
+		/// </summary>
+		Handle Allocate();
+		/// <summary>
+		/// Releases a transform, the handle is invalid after this call. Any children will
+		/// behave as if they have no parent
+		/// </summary>
+		void Free(Handle handle);
+		/// <summary>
+		/// Gets the number of transforms that are in use
+		/// </summary>
+		size_t Size() const { return _slots.size() - _freeHandles.size(); }
+
+		const glm::vec3& GetPosition(Handle handle) const { return _positions[_slots[handle]]; }
+		const glm::quat& GetRotation(Handle handle) const { return _rotations[_slots[handle]]; }
+		const glm::vec3& GetScale(Handle handle) const { return _scales[_slots[handle]]; }
+
+		void SetPosition(Handle handle, const glm::vec3& value) {
+			uint32_t slot = _slots[handle];
+			_positions[slot] = value;
+			_dirty[slot] = DIRTY_ALL;
+		}
+		void SetRotation(Handle handle, const glm::quat& value) {
+			uint32_t slot = _slots[handle];
+			_rotations[slot] = value;
+			_dirty[slot] = DIRTY_ALL;
+		}
+		void SetScale(Handle handle, const glm::vec3& value) {
+			uint32_t slot = _slots[handle];
+			_scales[slot] = value;
+			_dirty[slot] = DIRTY_ALL;
+		}
+
+		/// <summary>
+		/// Sets the parent of a transform, the world transform will be relative to the parent's
+		/// </summary>
+		/// <param name="handle">The transform to re-parent</param>
+		/// <param name="parent">The new parent, or INVALID_HANDLE to make the transform a root</param>
+		void SetParent(Handle handle, Handle parent);
+
+		/// <summary>
+		/// Gets the local transform, rebuilding it if it has changed
+		/// </summary>
+		const glm::mat4& GetLocalTransform(Handle handle);
+		const glm::mat4& GetInverseLocalTransform(Handle handle);
+		/// <summary>
+		/// Gets the world transform, rebuilding it and any parents that have changed. Note
+		/// that this walks up the hierarchy, use UpdateAll to rebuild many transforms at once
+		/// </summary>
+		const glm::mat4& GetWorldTransform(Handle handle);
+		const glm::mat4& GetInverseWorldTransform(Handle handle);
+
+		/// <summary>
+		/// Rebuilds every world transform that has changed, in depth order. Should be called
+		/// once per frame before the transforms are used for rendering
+		/// </summary>
+		void UpdateAll();
+
+	protected:
+		enum DirtyFlags : uint8_t {
+			DIRTY_LOCAL = 1 << 0,
+			DIRTY_WORLD = 1 << 1,
+			DIRTY_ALL   = DIRTY_LOCAL | DIRTY_WORLD
+		};
+
+		// The per-slot data, all of these arrays have the same length
+		std::vector<glm::vec3> _positions;
+		std::vector<glm::quat> _rotations;
+		std::vector<glm::vec3> _scales;
+		// The slot of each transform's parent, or -1 for roots
+		std::vector<int32_t>   _parents;
+		// DirtyFlags for which matrices need to be rebuilt. This is a byte rather than a
+		// vector<bool> so that threads can write to neighbouring slots
+		std::vector<uint8_t>   _dirty;
+		std::vector<glm::mat4> _localMatrices;
+		std::vector<glm::mat4> _inverseLocalMatrices;
+		std::vector<glm::mat4> _worldMatrices;
+		std::vector<glm::mat4> _inverseWorldMatrices;
+		// Bumped whenever the world matrix is rebuilt
+		std::vector<uint64_t>  _worldGenerations;
+		// The parent's world generation that the world matrix was built from
+		std::vector<uint64_t>  _worldParentGenerations;
+		// The handle that owns each slot, or INVALID_HANDLE if the slot has been freed
+		std::vector<Handle>    _handles;
+
+		// Maps handles to their current slot
+		std::vector<uint32_t>  _slots;
+		std::vector<Handle>    _freeHandles;
+
+		// Set when a slot has been freed, or a transform has been parented to one that comes after it
+		bool _orderDirty;
+
+		// Scratch space for sorting, kept around so we don't allocate every time the hierarchy changes
+		std::vector<int32_t>  _depths;
+		std::vector<uint32_t> _order;
+		std::vector<uint32_t> _newSlots;
+
+		// Gets the slot of the parent, clearing the parent if it has been freed
+		int32_t _LiveParent(uint32_t slot);
+		void _RecalcLocal(uint32_t slot);
+		// Rebuilds the world transform for a slot if needed, assuming the parent is already up to date
+		void _RecalcWorld(uint32_t slot);
+		// Rebuilds the world transform for a slot and all of it's parents if needed
+		void _RecalcWorldChain(uint32_t slot);
+		// Compacts out freed slots and re-orders the slots so that parents come before children
+		void _SortByDepth();
+	};
+}
@@ -5,7 +5,8 @@ IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 	IGraphicsResource(),
 	_elementCount(0),
 	_elementSize(0),
-	_size(0)
+	_size(0),
+	_isImmutable(false)
 {
 	_type = type;
 	_usage = usage;
@@ -24,6 +25,8 @@ IBuffer::~IBuffer() {
 }
 
 void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	LOG_ASSERT(!_isImmutable, "Cannot re-specify an immutable buffer!");
+
 	// Note, this is part of the bindless state access stuff added in 4.5
 	glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
 
@@ -34,6 +37,8 @@ void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementC
 
 void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize /*= true*/)
 {
+	LOG_ASSERT(!_isImmutable, "Cannot update an immutable buffer!");
+
 	if (elementSize * elementCount > _size) {
 		if (allowResize) {
 			glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
@@ -59,10 +64,28 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 	}
 }
 
+void IBuffer::LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	LOG_ASSERT(!_isImmutable, "Cannot re-specify an immutable buffer!");
+
+	// No flags means the GPU owns the memory completely, which gives the driver the most freedom in where it
+	// places it. Unlike glNamedBufferData the size can't change later, so we don't need a CPU-side copy
+	glNamedBufferStorage(_rendererId, (GLsizeiptr)elementSize * elementCount, data, 0);
+
+	_elementCount = elementCount;
+	_elementSize = elementSize;
+	_size = elementCount * elementSize;
+	_isImmutable = true;
+}
+
 void* IBuffer::Map(BufferMapMode mode) {
 	return glMapNamedBufferRange(_rendererId, 0, _size, *mode);
 }
 
+void* IBuffer::MapRange(uint32_t offset, uint32_t length, BufferMapMode mode) {
+	LOG_ASSERT(offset + length <= _size, "Attempting to map beyond the end of the buffer!");
+	return glMapNamedBufferRange(_rendererId, offset, length, *mode);
+}
+
 void IBuffer::Unmap() {
 	glUnmapNamedBuffer(_rendererId);
 }
@@ -76,6 +99,11 @@ void IBuffer::Bind(uint32_t slot) const
 	glBindBufferBase((GLenum)_type, slot, _rendererId);
 }
 
+void IBuffer::BindRange(uint32_t slot, uint32_t offset, uint32_t size) const
+{
+	glBindBufferRange((GLenum)_type, slot, _rendererId, offset, size);
+}
+
 void IBuffer::UnBind(BufferType type) {
 	glBindBuffer((GLenum)type, 0);
 }
@@ -52,6 +52,15 @@ public:
 	/// <param name="allowResize">True if resizing the buffer is allowed, otherwise an assertion is thrown for oversized writes</param>
 	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true);
 
+	/// <summary>
+	/// Loads data into this buffer using immutable storage (glNamedBufferStorage). The driver can upload
+	/// directly from the given pointer, but the buffer can never be resized or written to again afterwards
+	/// </summary>
+	/// <param name="data">The data that you want to load into the buffer</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	virtual void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount);
+
 	/// <summary>
 	/// Loads an array of data into this buffer, using the bindless method glNamedBufferData
 	/// </summary>
@@ -76,6 +85,10 @@ public:
 	/// </summary>
 	uint32_t GetTotalSize() const { return _size; }
 	/// <summary>
+	/// Returns true if this buffer's storage was created with LoadImmutableData
+	/// </summary>
+	bool IsImmutable() const { return _isImmutable; }
+	/// <summary>
 	/// Returns the type of buffer (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER, etc...)
 	/// </summary>
 	BufferType GetType() const { return _type; }
@@ -93,6 +106,15 @@ public:
 	/// <returns>A pointer to the data in the buffer, or nullptr if an error occurs</returns>
 	void* Map(BufferMapMode mode);
 	/// <summary>
+	/// Maps a sub-range of the buffer's data to a pointer that the CPU can access
+	/// </summary>
+	/// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glMapBufferRange.xhtml</see>
+	/// <param name="offset">The offset into the buffer to start mapping at, in bytes</param>
+	/// <param name="length">The number of bytes to map</param>
+	/// <param name="mode">The mode, as a series of bit flags</param>
+	/// <returns>A pointer to the start of the range, or nullptr if an error occurs</returns>
+	void* MapRange(uint32_t offset, uint32_t length, BufferMapMode mode);
+	/// <summary>
 	/// Unmaps the buffers, so that the GPU can take control of the memory
 	/// </summary>
 	void Unmap();
@@ -107,6 +129,13 @@ public:
 	/// <param name="slot">The buffer slot to bind to, for the vast majority of cases this should be 0</param>
 	virtual void Bind(uint32_t slot) const;
 	/// <summary>
+	/// Binds a sub-range of this buffer to an indexed slot (ex: for uniform or shader storage buffers)
+	/// </summary>
+	/// <param name="slot">The buffer slot to bind to</param>
+	/// <param name="offset">The offset into the buffer in bytes, must respect the GL offset alignment for the buffer type</param>
+	/// <param name="size">The size of the range in bytes</param>
+	void BindRange(uint32_t slot, uint32_t offset, uint32_t size) const;
+	/// <summary>
 	/// Unbinds the buffer bound to the slot given by type
 	/// </summary>
 	/// <param name="type">The type or slot of buffer to unbind (ex: GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)</param>
@@ -134,4 +163,5 @@ protected:
 	uint32_t _size; // The size of the buffer in bytes
 	BufferUsage _usage; // The buffer usage mode (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	BufferType _type; // The buffer type (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)
+	bool _isImmutable; // True if the storage was allocated with glNamedBufferStorage
 };
@@ -30,6 +30,9 @@ public:
 	inline void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override {
 		throw std::runtime_error("Must use the templated overload, or the LoadData that specifies the element type");
 	}
+	inline void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount) override {
+		throw std::runtime_error("Must use the LoadImmutableData that specifies the element type");
+	}
 
 	/// <summary>
 	/// Loads some data into our index buffer, specifying the type of indices we are using via the elementType parameter
@@ -43,6 +46,18 @@ public:
 		_elementType = elementType;
 	}
 
+	/// <summary>
+	/// Loads some data into our index buffer using immutable storage, see IBuffer::LoadImmutableData
+	/// </summary>
+	/// <param name="data">The pointer to the data to load in</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	/// <param name="elementType">The type of elements you are storing (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)</param>
+	inline void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount, IndexType elementType) {
+		IBuffer::LoadImmutableData(data, elementSize, elementCount);
+		_elementType = elementType;
+	}
+
 	/// <summary>
 	/// Loads data of a known type into this index buffer
 	/// </summary>
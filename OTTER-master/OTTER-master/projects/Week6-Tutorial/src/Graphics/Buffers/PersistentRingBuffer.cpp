@@ -0,0 +1,129 @@
+#include "PersistentRingBuffer.h"
+#include "Logging.h"
+
+// The flags we need for a write-only buffer that stays mapped
+static const BufferMapMode PersistentFlags = BufferMapMode::Write | BufferMapMode::Persistent | BufferMapMode::Coherent;
+
+PersistentRingBuffer::PersistentRingBuffer(BufferType type, uint32_t segmentSize, uint32_t segmentCount) :
+	IBuffer(type, BufferUsage::StreamDraw),
+	_segmentSize(segmentSize),
+	_segmentCount(segmentCount),
+	_currentSegment(0),
+	_writeHead(0),
+	_alignment(4),
+	_mappedData(nullptr),
+	_fences(std::vector<GLsync>(segmentCount, nullptr))
+{
+	LOG_ASSERT(segmentCount > 0, "Ring buffer must have at least one segment!");
+
+	// Ranges of UBOs and SSBOs need to be bound at specific alignments
+	GLint alignment = 0;
+	if (type == BufferType::Uniform) {
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	} else if (type == BufferType::ShaderStorage) {
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	}
+	if (alignment > (GLint)_alignment) {
+		_alignment = alignment;
+	}
+
+	// Round our segments up to the alignment so that every segment starts aligned
+	_segmentSize = (_segmentSize + _alignment - 1) / _alignment * _alignment;
+
+	_Allocate();
+}
+
+PersistentRingBuffer::~PersistentRingBuffer() {
+	for (GLsync& fence : _fences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if (_mappedData != nullptr) {
+		Unmap();
+		_mappedData = nullptr;
+	}
+}
+
+void PersistentRingBuffer::BeginFrame(uint32_t requiredBytes) {
+	if (requiredBytes > _segmentSize) {
+		// Immutable storage can't be resized, so we need to wait for the GPU to finish
+		// with all our segments and then create a brand new buffer
+		for (uint32_t ix = 0; ix < _segmentCount; ix++) {
+			_WaitForSegment(ix);
+		}
+		Unmap();
+		glDeleteBuffers(1, &_rendererId);
+		glCreateBuffers(1, &_rendererId);
+
+		uint32_t newSize = _segmentSize * 2;
+		while (newSize < requiredBytes) {
+			newSize *= 2;
+		}
+		LOG_INFO("Expanding ring buffer segments from {} bytes to {} bytes", _segmentSize, newSize);
+		_segmentSize = (newSize + _alignment - 1) / _alignment * _alignment;
+		_currentSegment = 0;
+
+		_Allocate();
+	}
+
+	_WaitForSegment(_currentSegment);
+	_writeHead = 0;
+}
+
+void PersistentRingBuffer::EndFrame() {
+	_fences[_currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_currentSegment = (_currentSegment + 1) % _segmentCount;
+}
+
+void* PersistentRingBuffer::Allocate(uint32_t size, uint32_t& offset) {
+	uint32_t start = (_writeHead + _alignment - 1) / _alignment * _alignment;
+	if (start + size > _segmentSize) {
+		LOG_WARN("Ring buffer segment is out of space, did you pass the right size to BeginFrame?");
+		return nullptr;
+	}
+	_writeHead = start + size;
+
+	offset = _currentSegment * _segmentSize + start;
+	return _mappedData + offset;
+}
+
+void PersistentRingBuffer::LoadData(const void* /*data*/, uint32_t /*elementSize*/, uint32_t /*elementCount*/) {
+	LOG_ASSERT(false, "Cannot load data into a persistent ring buffer, use Allocate instead!");
+}
+
+void PersistentRingBuffer::UpdateData(const void* /*data*/, uint32_t /*elementSize*/, uint32_t /*elementCount*/, bool /*allowResize*/) {
+	LOG_ASSERT(false, "Cannot update data in a persistent ring buffer, use Allocate instead!");
+}
+
+void PersistentRingBuffer::_Allocate() {
+	_elementSize  = 1;
+	_elementCount = _segmentSize * _segmentCount;
+	_size         = _elementCount;
+
+	// Note that we need glNamedBufferStorage here, glNamedBufferData does not allow persistent mapping
+	glNamedBufferStorage(_rendererId, _size, nullptr, *PersistentFlags);
+	_mappedData = reinterpret_cast<uint8_t*>(Map(PersistentFlags));
+	LOG_ASSERT(_mappedData != nullptr, "Failed to persistently map ring buffer!");
+}
+
+void PersistentRingBuffer::_WaitForSegment(uint32_t segment) {
+	GLsync& fence = _fences[segment];
+	if (fence == nullptr) {
+		return;
+	}
+
+	// Wait in 1ms chunks, flushing the first time so the fence is guaranteed to be submitted
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		GLenum result = glClientWaitSync(fence, flags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+			break;
+		}
+		flags = 0;
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
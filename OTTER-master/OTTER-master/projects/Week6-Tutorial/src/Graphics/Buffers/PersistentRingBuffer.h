@@ -0,0 +1,100 @@
+#pragma once
+#include "IBuffer.h"
+#include <memory>
+
+/// <summary>
+/// A buffer with immutable storage that stays persistently mapped for it's whole lifetime,
+/// split into a number of segments (3 by default, for triple buffering)
+///
+/// Every frame, we write into a different segment, and drop a fence after the GPU commands
+/// that read from it. By the time we wrap back around to a segment, the GPU is almost always
+/// done with it, so we can write new data without stalling or re-mapping anything
+///
+/// Usage:
+///    ring->BeginFrame(bytesNeeded);
+///    uint32_t offset;
+///    MyData* data = ring->Allocate<MyData>(count, offset);
+///    ... write data, bind with ring->BindRange(slot, offset, size), draw ...
+///    ring->EndFrame();
+/// </summary>
+class PersistentRingBuffer : public IBuffer
+{
+public:
+	typedef std::shared_ptr<PersistentRingBuffer> Sptr;
+
+	static inline Sptr Create(BufferType type, uint32_t segmentSize, uint32_t segmentCount = 3) {
+		return std::make_shared<PersistentRingBuffer>(type, segmentSize, segmentCount);
+	}
+
+	/// <summary>
+	/// Creates a new persistently mapped ring buffer
+	/// </summary>
+	/// <param name="type">The type of buffer, this determines the alignment for allocations</param>
+	/// <param name="segmentSize">The initial size of a single segment in bytes, the buffer will grow as needed</param>
+	/// <param name="segmentCount">The number of segments to cycle through, 3 for triple buffering</param>
+	PersistentRingBuffer(BufferType type, uint32_t segmentSize, uint32_t segmentCount = 3);
+	virtual ~PersistentRingBuffer();
+
+	/// <summary>
+	/// Starts writing to the next segment in the ring. If the segment is still in use by the GPU, this will
+	/// wait for it to become available. If requiredBytes is larger than a segment, the buffer will be re-allocated
+	/// </summary>
+	/// <param name="requiredBytes">The number of bytes that will be allocated this frame, including alignment padding</param>
+	void BeginFrame(uint32_t requiredBytes);
+	/// <summary>
+	/// Places a fence after all commands that have been issued for the current segment, and moves to the next segment
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Allocates a range of the current segment for writing
+	/// </summary>
+	/// <param name="size">The size of the allocation, in bytes</param>
+	/// <param name="offset">Receives the offset of the allocation from the start of the buffer, for use with BindRange</param>
+	/// <returns>A CPU pointer to write the data to, or nullptr if the segment is out of space</returns>
+	void* Allocate(uint32_t size, uint32_t& offset);
+	/// <summary>
+	/// Allocates an array of elements in the current segment for writing
+	/// </summary>
+	/// <typeparam name="T">The type of element to allocate</typeparam>
+	/// <param name="count">The number of elements to allocate</param>
+	/// <param name="offset">Receives the offset of the allocation from the start of the buffer, for use with BindRange</param>
+	template <typename T>
+	T* Allocate(uint32_t count, uint32_t& offset) {
+		return reinterpret_cast<T*>(Allocate(count * sizeof(T), offset));
+	}
+
+	/// <summary>
+	/// Gets the alignment that all allocations are rounded up to
+	/// </summary>
+	uint32_t GetAlignment() const { return _alignment; }
+	/// <summary>
+	/// Gets the size of a single segment, in bytes
+	/// </summary>
+	uint32_t GetSegmentSize() const { return _segmentSize; }
+
+	// Persistent buffers should never be re-specified or mapped externally
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+
+protected:
+	uint32_t _segmentSize;
+	uint32_t _segmentCount;
+	uint32_t _currentSegment;
+	uint32_t _writeHead;
+	uint32_t _alignment;
+
+	// Points to the start of the persistently mapped memory
+	uint8_t* _mappedData;
+	// One fence per segment, nullptr if the segment has no pending GPU work
+	std::vector<GLsync> _fences;
+
+	/// <summary>
+	/// Allocates immutable storage for the whole ring and maps it
+	/// </summary>
+	void _Allocate();
+	/// <summary>
+	/// Waits for the fence on the given segment, if there is one
+	/// </summary>
+	void _WaitForSegment(uint32_t segment);
+};
@@ -9,6 +9,18 @@
 #include <Logging.h>
 #include <glm/glm.hpp>
 
+// The S3TC formats come from EXT_texture_compression_s3tc, which our glad loader was not
+// generated with, but is supported by every desktop driver we target
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT       0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT      0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT      0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT       0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 // We can use an enum to make our code more readable and restrict
 // values to only ones we want to accept
 ENUM(ShaderPartType, GLint,
@@ -49,10 +61,58 @@ ENUM(InternalFormat, GLint,
 	RGBA8        = GL_RGBA8,
 	SRGBA        = GL_SRGB8_ALPHA8,
 	RGBA16       = GL_RGBA16,
-	RGB32AF      = GL_RGBA32F
+	RGB32AF      = GL_RGBA32F,
+	// Block compressed formats, these can only be loaded with glCompressedTextureSubImage2D
+	BC1          = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+	BC1_SRGB     = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,
+	BC3          = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+	BC3_SRGB     = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+	BC4          = GL_COMPRESSED_RED_RGTC1,
+	BC5          = GL_COMPRESSED_RG_RGTC2,
+	BC7          = GL_COMPRESSED_RGBA_BPTC_UNORM,
+	BC7_SRGB     = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
 	// Note: There are sized internal formats but there is a LOT of them
 )
 
+/*
+ * Gets the number of bytes in a single 4x4 block of a block compressed format
+ * @param format The internal format to check
+ * @returns The size of a block in bytes, or 0 if the format is not block compressed
+ */
+constexpr size_t GetCompressedBlockSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC1_SRGB:
+		case InternalFormat::BC4:
+			return 8;
+		case InternalFormat::BC3:
+		case InternalFormat::BC3_SRGB:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+		case InternalFormat::BC7_SRGB:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * Returns true if the given internal format is block compressed
+ */
+constexpr bool IsCompressedFormat(InternalFormat format) {
+	return GetCompressedBlockSize(format) != 0;
+}
+
+/*
+ * Gets the number of bytes needed to store a single mip level of a block compressed image
+ * @param format The block compressed format of the image
+ * @param width The width of the mip level in pixels
+ * @param height The height of the mip level in pixels
+ */
+constexpr size_t GetCompressedImageSize(InternalFormat format, uint32_t width, uint32_t height) {
+	return GetCompressedBlockSize(format) * ((width + 3) / 4) * ((height + 3) / 4);
+}
+
 // The layout of the input pixel data
 ENUM(PixelFormat, GLint,
     Unknown      = GL_NONE,
@@ -746,9 +806,10 @@ ENUM(BlendEquation, uint32_t,
 /// </summary>
 /// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glBufferData.xhtml</see>
 ENUM(BufferType, GLenum,
-	Vertex  = GL_ARRAY_BUFFER,
-	Index   = GL_ELEMENT_ARRAY_BUFFER,
-	Uniform = GL_UNIFORM_BUFFER
+	Vertex        = GL_ARRAY_BUFFER,
+	Index         = GL_ELEMENT_ARRAY_BUFFER,
+	Uniform       = GL_UNIFORM_BUFFER,
+	ShaderStorage = GL_SHADER_STORAGE_BUFFER
 )
 
 /// <summary>
@@ -815,6 +876,22 @@ ENUM(AttributeType, GLenum,
 	 Unknown = GL_NONE
 )
 
+inline size_t GetAttributeTypeSize(AttributeType type) {
+	switch (type) {
+		case AttributeType::Byte:
+		case AttributeType::UByte:  return sizeof(uint8_t);
+		case AttributeType::Short:
+		case AttributeType::UShort: return sizeof(uint16_t);
+		case AttributeType::Int:
+		case AttributeType::UInt:   return sizeof(uint32_t);
+		case AttributeType::Float:  return sizeof(float);
+		case AttributeType::Double: return sizeof(double);
+		case AttributeType::Unknown:
+		default:
+			return 0;
+	}
+}
+
 /// <summary>
 /// Represents the mode in which a VAO will be drawn
 /// </summary>
@@ -0,0 +1,155 @@
+#include "Graphics/GpuProfiler.h"
+#include <glad/glad.h>
+#include <Logging.h>
+
+GpuProfiler::QueryPool GpuProfiler::__pools[GpuProfiler::POOL_COUNT];
+int GpuProfiler::__currentPool = 0;
+uint64_t GpuProfiler::__frameIndex = 0;
+bool GpuProfiler::__enabled = true;
+bool GpuProfiler::__scopeOpen = false;
+std::vector<GpuProfiler::PassTimings> GpuProfiler::__passes = std::vector<GpuProfiler::PassTimings>();
+std::unordered_map<std::string, size_t> GpuProfiler::__passLookup = std::unordered_map<std::string, size_t>();
+
+GpuProfiler::Scope::Scope(const std::string& name) :
+	_passIndex(0),
+	_query(0),
+	_active(false),
+	_startTime()
+{
+	if (!__enabled) {
+		return;
+	}
+
+	_active = true;
+	_passIndex = __GetPassIndex(name);
+
+	// Time elapsed queries can't overlap, so nested scopes only get CPU timings
+	if (!__scopeOpen) {
+		_query = __AllocateQuery();
+		glBeginQuery(GL_TIME_ELAPSED, _query);
+		__scopeOpen = true;
+	}
+
+	_startTime = std::chrono::high_resolution_clock::now();
+}
+
+GpuProfiler::Scope::~Scope()
+{
+	if (!_active) {
+		return;
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	float cpuTime = std::chrono::duration<float, std::milli>(endTime - _startTime).count();
+
+	if (_query != 0) {
+		glEndQuery(GL_TIME_ELAPSED);
+		__scopeOpen = false;
+	}
+
+	__pools[__currentPool].Samples.push_back({ _passIndex, _query, cpuTime });
+}
+
+void GpuProfiler::BeginFrame()
+{
+	__frameIndex++;
+	__currentPool = (__currentPool + 1) % POOL_COUNT;
+
+	// The pool we're switching to was filled two frames ago, so grab it's results before
+	// we start handing out it's queries again
+	QueryPool& pool = __pools[__currentPool];
+	__ResolvePool(pool);
+	pool.Samples.clear();
+	pool.Used = 0;
+}
+
+void GpuProfiler::EndFrame()
+{
+	LOG_ASSERT(!__scopeOpen, "A GPU profiler scope was left open at the end of the frame");
+}
+
+void GpuProfiler::SetEnabled(bool value) {
+	__enabled = value;
+}
+
+bool GpuProfiler::IsEnabled() {
+	return __enabled;
+}
+
+const std::vector<GpuProfiler::PassTimings>& GpuProfiler::GetPasses() {
+	return __passes;
+}
+
+uint64_t GpuProfiler::GetFrameIndex() {
+	return __frameIndex;
+}
+
+void GpuProfiler::Cleanup()
+{
+	for (int ix = 0; ix < POOL_COUNT; ix++) {
+		QueryPool& pool = __pools[ix];
+		if (!pool.Queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(pool.Queries.size()), pool.Queries.data());
+		}
+		pool.Queries.clear();
+		pool.Samples.clear();
+		pool.Used = 0;
+	}
+}
+
+size_t GpuProfiler::__GetPassIndex(const std::string& name)
+{
+	auto it = __passLookup.find(name);
+	if (it != __passLookup.end()) {
+		return it->second;
+	}
+
+	size_t index = __passes.size();
+	__passes.emplace_back();
+	__passes[index].Name = name;
+	__passLookup[name] = index;
+	return index;
+}
+
+uint32_t GpuProfiler::__AllocateQuery()
+{
+	QueryPool& pool = __pools[__currentPool];
+
+	// Grow the pool if we've got more passes than we've seen before, this only
+	// happens for the first couple of frames
+	if (pool.Used == pool.Queries.size()) {
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		pool.Queries.push_back(query);
+	}
+
+	return pool.Queries[pool.Used++];
+}
+
+void GpuProfiler::__ResolvePool(QueryPool& pool)
+{
+	for (const Sample& sample : pool.Samples) {
+		PassTimings& pass = __passes[sample.PassIndex];
+
+		// If the result isn't ready we keep the last value rather than waiting for it
+		if (sample.Query != 0) {
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(sample.Query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available != GL_FALSE) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(sample.Query, GL_QUERY_RESULT, &elapsed);
+				pass.LastGpuTime = static_cast<float>(elapsed) / 1000000.0f;
+			}
+		}
+		else {
+			pass.LastGpuTime = 0.0f;
+		}
+		pass.LastCpuTime = sample.CpuTime;
+
+		// Push into the ring buffer, overwriting the oldest sample
+		pass.GpuTimes[pass.Offset] = pass.LastGpuTime;
+		pass.CpuTimes[pass.Offset] = pass.LastCpuTime;
+		pass.Offset = (pass.Offset + 1) % HISTORY_LENGTH;
+		pass.LastFrame = __frameIndex;
+	}
+}
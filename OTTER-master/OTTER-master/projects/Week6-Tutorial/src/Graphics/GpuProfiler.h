@@ -0,0 +1,115 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+
+/// <summary>
+/// Measures how much GPU and CPU time named sections of a frame take, using
+/// GL_TIME_ELAPSED queries
+///
+/// Queries are allocated out of two pools that alternate every frame, and a pool is only
+/// read back right before it gets re-used. This means results show up a frame late, but
+/// we never have to wait on the GPU to get them. If a result still isn't ready by then
+/// the pass's last GPU time is recorded again in it's place
+///
+/// Note that GL_TIME_ELAPSED queries can not overlap, so scopes can not be nested. Any
+/// nested scope will only record CPU time
+/// </summary>
+class GpuProfiler {
+public:
+	// The number of frames of history we store for each pass
+	static const int HISTORY_LENGTH = 120;
+
+	/// <summary>
+	/// Stores the rolling timing history for a single named pass
+	/// </summary>
+	struct PassTimings {
+		std::string Name;
+		// Ring buffers of times in milliseconds, Offset is the index of the oldest value
+		float       GpuTimes[HISTORY_LENGTH] = { 0 };
+		float       CpuTimes[HISTORY_LENGTH] = { 0 };
+		int         Offset = 0;
+		float       LastGpuTime = 0.0f;
+		float       LastCpuTime = 0.0f;
+		// The last frame that this pass was run in, so we can hide passes that stop running
+		uint64_t    LastFrame = 0;
+	};
+
+	/// <summary>
+	/// RAII marker that times everything between it's construction and destruction
+	/// </summary>
+	class Scope {
+	public:
+		Scope(const std::string& name);
+		~Scope();
+
+		Scope(const Scope& other) = delete;
+		Scope& operator =(const Scope& other) = delete;
+
+	private:
+		size_t   _passIndex;
+		uint32_t _query;
+		bool     _active;
+		std::chrono::high_resolution_clock::time_point _startTime;
+	};
+
+	/// <summary>
+	/// Starts a new frame, reading back the results from the pool we're about to re-use.
+	/// Should be called once per frame before any scopes are created
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Ends the current frame
+	/// </summary>
+	static void EndFrame();
+
+	/// <summary>
+	/// Enables or disables the profiler, when disabled scopes do nothing
+	/// </summary>
+	static void SetEnabled(bool value);
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Gets the timings for all passes that have been recorded so far, in the order
+	/// they were first seen
+	/// </summary>
+	static const std::vector<PassTimings>& GetPasses();
+	/// <summary>
+	/// Gets the index of the current frame, used with PassTimings::LastFrame
+	/// </summary>
+	static uint64_t GetFrameIndex();
+
+	/// <summary>
+	/// Deletes all query objects, must be called before the GL context is destroyed
+	/// </summary>
+	static void Cleanup();
+
+private:
+	struct Sample {
+		size_t   PassIndex;
+		uint32_t Query;
+		float    CpuTime;
+	};
+
+	struct QueryPool {
+		std::vector<uint32_t> Queries;
+		std::vector<Sample>   Samples;
+		size_t                Used = 0;
+	};
+
+	static const int POOL_COUNT = 2;
+
+	static QueryPool __pools[POOL_COUNT];
+	static int __currentPool;
+	static uint64_t __frameIndex;
+	static bool __enabled;
+	static bool __scopeOpen;
+	static std::vector<PassTimings> __passes;
+	static std::unordered_map<std::string, size_t> __passLookup;
+
+	static size_t __GetPassIndex(const std::string& name);
+	static uint32_t __AllocateQuery();
+	static void __ResolvePool(QueryPool& pool);
+};
@@ -0,0 +1,133 @@
+#include "LightClusterGrid.h"
+#include <algorithm>
+#include <cmath>
+
+LightClusterGrid::LightClusterGrid() :
+	_clusters(std::vector<Cluster>(CLUSTER_COUNT, { 0, 0 })),
+	_lightIndices(std::vector<uint32_t>()),
+	_ranges(std::vector<LightRange>()),
+	_nearPlane(0.1f),
+	_farPlane(1000.0f),
+	_sliceScale(0.0f),
+	_sliceBias(0.0f)
+{ }
+
+void LightClusterGrid::Build(const std::vector<LightBounds>& lights, const glm::mat4& projection, float nearPlane, float farPlane) {
+	_nearPlane = nearPlane;
+	_farPlane  = farPlane;
+
+	// log(depth / near) / log(far / near) * SIZE_Z, rearranged so the shader only needs one log and a multiply-add
+	float logRatio = std::log(_farPlane / _nearPlane);
+	_sliceScale = (float)SIZE_Z / logRatio;
+	_sliceBias  = (float)SIZE_Z * std::log(_nearPlane) / logRatio;
+
+	for (Cluster& cluster : _clusters) {
+		cluster.Count = 0;
+	}
+
+	// First pass, figure out which clusters every light touches and count how many lights each cluster has
+	_ranges.resize(lights.size());
+	for (size_t ix = 0; ix < lights.size(); ix++) {
+		LightRange& range = _ranges[ix];
+		if (!_CalculateRange(lights[ix], projection, range)) {
+			// Empty range so the light is skipped in the next pass
+			range.Min = glm::uvec3(1);
+			range.Max = glm::uvec3(0);
+			continue;
+		}
+
+		for (uint32_t z = range.Min.z; z <= range.Max.z; z++) {
+			for (uint32_t y = range.Min.y; y <= range.Max.y; y++) {
+				for (uint32_t x = range.Min.x; x <= range.Max.x; x++) {
+					_clusters[GetClusterIndex(x, y, z)].Count++;
+				}
+			}
+		}
+	}
+
+	// Convert the counts into offsets in the index list
+	uint32_t total = 0;
+	for (Cluster& cluster : _clusters) {
+		cluster.Offset = total;
+		total += cluster.Count;
+		cluster.Count = 0;
+	}
+	_lightIndices.resize(total);
+
+	// Second pass, write the light indices into each cluster's range
+	for (size_t ix = 0; ix < lights.size(); ix++) {
+		const LightRange& range = _ranges[ix];
+		for (uint32_t z = range.Min.z; z <= range.Max.z; z++) {
+			for (uint32_t y = range.Min.y; y <= range.Max.y; y++) {
+				for (uint32_t x = range.Min.x; x <= range.Max.x; x++) {
+					Cluster& cluster = _clusters[GetClusterIndex(x, y, z)];
+					_lightIndices[cluster.Offset + cluster.Count] = (uint32_t)ix;
+					cluster.Count++;
+				}
+			}
+		}
+	}
+}
+
+uint32_t LightClusterGrid::GetSlice(float viewDepth) const {
+	if (viewDepth <= _nearPlane) {
+		return 0;
+	}
+	float slice = std::floor(std::log(viewDepth) * _sliceScale - _sliceBias);
+	return (uint32_t)std::clamp(slice, 0.0f, (float)(SIZE_Z - 1));
+}
+
+bool LightClusterGrid::_CalculateRange(const LightBounds& light, const glm::mat4& projection, LightRange& range) const {
+	// The camera looks down -Z, so flip to get positive depths
+	float minDepth = -(light.ViewPosition.z + light.Radius);
+	float maxDepth = -(light.ViewPosition.z - light.Radius);
+	if (maxDepth < _nearPlane || minDepth > _farPlane) {
+		return false;
+	}
+	range.Min.z = GetSlice(minDepth);
+	range.Max.z = GetSlice(maxDepth);
+
+	// If the light's sphere crosses the near plane, projecting it's bounds won't give us anything
+	// useful, so we just assume it covers the whole screen
+	if (minDepth <= _nearPlane) {
+		range.Min.x = 0;
+		range.Min.y = 0;
+		range.Max.x = SIZE_X - 1;
+		range.Max.y = SIZE_Y - 1;
+		return true;
+	}
+
+	// Project the corners of the light's view space bounding box to find it's screen space bounds
+	glm::vec2 ndcMin = glm::vec2( 1.0f);
+	glm::vec2 ndcMax = glm::vec2(-1.0f);
+	for (int ix = 0; ix < 8; ix++) {
+		glm::vec3 corner = light.ViewPosition + glm::vec3(
+			(ix & 1) ? light.Radius : -light.Radius,
+			(ix & 2) ? light.Radius : -light.Radius,
+			(ix & 4) ? light.Radius : -light.Radius
+		);
+		glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		if (ix == 0) {
+			ndcMin = ndcMax = ndc;
+		} else {
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+	}
+
+	// Fully off screen
+	if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f) {
+		return false;
+	}
+
+	// Convert from [-1, 1] to tile coordinates
+	glm::vec2 tileMin = glm::clamp((ndcMin * 0.5f + 0.5f) * glm::vec2(SIZE_X, SIZE_Y), glm::vec2(0.0f), glm::vec2(SIZE_X - 1, SIZE_Y - 1));
+	glm::vec2 tileMax = glm::clamp((ndcMax * 0.5f + 0.5f) * glm::vec2(SIZE_X, SIZE_Y), glm::vec2(0.0f), glm::vec2(SIZE_X - 1, SIZE_Y - 1));
+	range.Min.x = (uint32_t)tileMin.x;
+	range.Min.y = (uint32_t)tileMin.y;
+	range.Max.x = (uint32_t)tileMax.x;
+	range.Max.y = (uint32_t)tileMax.y;
+
+	return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Assigns lights to a grid of clusters in view space, so that the lighting pass only
+/// needs to consider the lights that can actually reach a given fragment
+///
+/// The grid is SIZE_X by SIZE_Y tiles in screen space, and SIZE_Z slices in depth. Depth
+/// slices are distributed exponentially between the near and far planes, so that clusters
+/// near the camera are about as deep as they are wide
+///
+/// This class does not touch OpenGL, the results are uploaded to SSBOs by the render layer
+/// and read by shaders/fragment_shaders/light_accumulation.glsl
+/// </summary>
+class LightClusterGrid {
+public:
+	// NOTE: these need to match the defines in light_accumulation.glsl
+	static const uint32_t SIZE_X = 16;
+	static const uint32_t SIZE_Y = 9;
+	static const uint32_t SIZE_Z = 24;
+	static const uint32_t CLUSTER_COUNT = SIZE_X * SIZE_Y * SIZE_Z;
+
+	/// <summary>
+	/// The range of the light index list that belongs to a single cluster
+	/// Matches the uvec2 layout in the shader
+	/// </summary>
+	struct Cluster {
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	/// <summary>
+	/// The information we need about a light to bin it
+	/// </summary>
+	struct LightBounds {
+		// The light's position in view space
+		glm::vec3 ViewPosition;
+		// The distance after which the light no longer contributes
+		float     Radius;
+	};
+
+	LightClusterGrid();
+	~LightClusterGrid() = default;
+
+	/// <summary>
+	/// Bins all the lights into the cluster grid, replacing any existing results
+	/// </summary>
+	/// <param name="lights">The lights to bin, the indices into this list are what will be stored in the clusters</param>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <param name="nearPlane">The distance to the camera's near plane</param>
+	/// <param name="farPlane">The distance to the camera's far plane</param>
+	void Build(const std::vector<LightBounds>& lights, const glm::mat4& projection, float nearPlane, float farPlane);
+
+	/// <summary>
+	/// Gets the depth slice for a given view space depth (the distance along the camera's forward axis)
+	/// </summary>
+	uint32_t GetSlice(float viewDepth) const;
+	/// <summary>
+	/// Gets the scale (x) and bias (y) for calculating depth slices in a shader, where
+	///    slice = floor(log(viewDepth) * scale - bias)
+	/// </summary>
+	glm::vec2 GetSliceParams() const { return glm::vec2(_sliceScale, _sliceBias); }
+
+	/// <summary>
+	/// Gets the flattened index of the cluster at the given coordinates
+	/// </summary>
+	static uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) { return (z * SIZE_Y + y) * SIZE_X + x; }
+
+	const std::vector<Cluster>&  GetClusters() const { return _clusters; }
+	const std::vector<uint32_t>& GetLightIndices() const { return _lightIndices; }
+
+protected:
+	std::vector<Cluster>  _clusters;
+	std::vector<uint32_t> _lightIndices;
+
+	// The cluster ranges that each light touches, stored as min (xyz) and max (xyz)
+	struct LightRange {
+		glm::uvec3 Min;
+		glm::uvec3 Max;
+	};
+	std::vector<LightRange> _ranges;
+
+	float _nearPlane;
+	float _farPlane;
+	float _sliceScale;
+	float _sliceBias;
+
+	/// <summary>
+	/// Calculates the range of clusters that a light overlaps
+	/// </summary>
+	/// <returns>False if the light is not visible at all</returns>
+	bool _CalculateRange(const LightBounds& light, const glm::mat4& projection, LightRange& range) const;
+};
@@ -0,0 +1,142 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <Logging.h>
+
+RenderQueue::RenderQueue() :
+	_entries(std::vector<Entry>()),
+	_scratch(std::vector<Entry>()),
+	_shaderIds(),
+	_materialIds(),
+	_vaoIds()
+{ }
+
+void RenderQueue::Clear() {
+	// clear() keeps the capacity around, so after the first frame this won't allocate
+	_entries.clear();
+	_shaderIds.clear();
+	_materialIds.clear();
+	_vaoIds.clear();
+}
+
+uint16_t RenderQueue::GetShaderID(uintptr_t shader) {
+	return _GetOrAssignID(_shaderIds, shader);
+}
+
+uint16_t RenderQueue::GetMaterialID(uintptr_t material) {
+	return _GetOrAssignID(_materialIds, material);
+}
+
+uint16_t RenderQueue::GetVaoID(uintptr_t vao) {
+	return _GetOrAssignID(_vaoIds, vao);
+}
+
+uint64_t RenderQueue::MakeKey(uint16_t shaderId, uint16_t materialId, uint16_t vaoId, float viewDepth, float maxDepth) {
+	// Quantize the depth into the bottom 16 bits, objects behind the camera or past the
+	// max depth get clamped into the first and last buckets
+	float normalized = maxDepth > 0.0f ? viewDepth / maxDepth : 0.0f;
+	normalized = std::clamp(normalized, 0.0f, 1.0f);
+	uint64_t depth = static_cast<uint64_t>(normalized * static_cast<float>(ID_MASK));
+
+	return
+		(static_cast<uint64_t>(shaderId)   << SHADER_SHIFT) |
+		(static_cast<uint64_t>(materialId) << MATERIAL_SHIFT) |
+		(static_cast<uint64_t>(vaoId)      << VAO_SHIFT) |
+		(depth                             << DEPTH_SHIFT);
+}
+
+void RenderQueue::Push(uint64_t key, uint32_t payload) {
+	_entries.push_back({ key, payload });
+}
+
+void RenderQueue::Sort() {
+	if (_entries.size() < 2) {
+		return;
+	}
+
+	// We can figure out which bytes actually differ between keys up front, and skip
+	// those passes entirely. In most scenes the high bytes of the IDs are all zero
+	uint64_t orBits  = 0;
+	uint64_t andBits = ~0ull;
+	for (const Entry& entry : _entries) {
+		orBits  |= entry.Key;
+		andBits &= entry.Key;
+	}
+	uint64_t varyingBits = orBits ^ andBits;
+
+	_scratch.resize(_entries.size());
+
+	// LSD radix sort, 8 bits at a time. Each pass is stable, so the lower
+	// bytes stay ordered as we work our way up to the most significant byte
+	for (int shift = 0; shift < 64; shift += 8) {
+		if (((varyingBits >> shift) & 0xFF) == 0) {
+			continue;
+		}
+
+		// Build a histogram of this byte
+		uint32_t offsets[256] = { 0 };
+		for (const Entry& entry : _entries) {
+			offsets[(entry.Key >> shift) & 0xFF]++;
+		}
+
+		// Convert the counts into starting offsets
+		uint32_t total = 0;
+		for (int ix = 0; ix < 256; ix++) {
+			uint32_t count = offsets[ix];
+			offsets[ix] = total;
+			total += count;
+		}
+
+		// Scatter into the scratch buffer, then swap so _entries holds the result
+		for (const Entry& entry : _entries) {
+			_scratch[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+		}
+		_entries.swap(_scratch);
+	}
+}
+
+RenderQueue::SwitchStats RenderQueue::CountSwitches() const {
+	SwitchStats result;
+
+	// Start with keys that can never occur, so that the first entry counts as a switch
+	uint32_t currentShader   = ~0u;
+	uint32_t currentMaterial = ~0u;
+	uint32_t currentVao      = ~0u;
+
+	for (const Entry& entry : _entries) {
+		uint16_t shader   = ExtractID(entry.Key, SHADER_SHIFT);
+		uint16_t material = ExtractID(entry.Key, MATERIAL_SHIFT);
+		uint16_t vao      = ExtractID(entry.Key, VAO_SHIFT);
+
+		if (shader != currentShader) {
+			currentShader = shader;
+			result.ProgramSwitches++;
+		}
+		if (material != currentMaterial) {
+			currentMaterial = material;
+			result.MaterialSwitches++;
+		}
+		if (vao != currentVao) {
+			currentVao = vao;
+			result.VaoSwitches++;
+		}
+		result.DrawCalls++;
+	}
+
+	return result;
+}
+
+uint16_t RenderQueue::_GetOrAssignID(std::unordered_map<uintptr_t, uint16_t>& map, uintptr_t value) {
+	auto it = map.find(value);
+	if (it != map.end()) {
+		return it->second;
+	}
+
+	if (map.size() > ID_MASK) {
+		LOG_WARN("Render queue has run out of state IDs, sorting will be sub-optimal");
+		return static_cast<uint16_t>(ID_MASK);
+	}
+
+	uint16_t id = static_cast<uint16_t>(map.size());
+	map[value] = id;
+	return id;
+}
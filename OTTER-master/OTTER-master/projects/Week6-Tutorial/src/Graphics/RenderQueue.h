@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+/// <summary>
+/// Stores a list of draw items for a single frame, keyed on a 64 bit sort key so that
+/// draws which share state end up next to each other in the queue
+///
+/// The key layout (most significant bits first) is:
+///    16 bits - shader ID
+///    16 bits - material ID
+///    16 bits - VAO ID
+///    16 bits - quantized view depth (front to back)
+///
+/// IDs are assigned per frame via the Get*ID functions, so they are always dense and
+/// never overflow their 16 bit slots the way raw GL handles or pointers could
+///
+/// Note that this class does not touch OpenGL at all, so it can be used and inspected
+/// without a GL context
+/// </summary>
+class RenderQueue {
+public:
+	/// <summary>
+	/// A single entry in the render queue, the payload is an index into
+	/// whatever array of draw data the owner of the queue is maintaining
+	/// </summary>
+	struct Entry {
+		uint64_t Key;
+		uint32_t Payload;
+	};
+
+	/// <summary>
+	/// Stores how many times each piece of render state changed while walking the
+	/// queue, in the order that it was sorted
+	/// </summary>
+	struct SwitchStats {
+		uint32_t ProgramSwitches  = 0;
+		uint32_t MaterialSwitches = 0;
+		uint32_t VaoSwitches      = 0;
+		uint32_t DrawCalls        = 0;
+	};
+
+	static const int      ID_BITS        = 16;
+	static const uint64_t ID_MASK        = (1ull << ID_BITS) - 1;
+	static const int      SHADER_SHIFT   = 48;
+	static const int      MATERIAL_SHIFT = 32;
+	static const int      VAO_SHIFT      = 16;
+	static const int      DEPTH_SHIFT    = 0;
+
+	RenderQueue();
+	~RenderQueue() = default;
+
+	/// <summary>
+	/// Removes all entries and ID mappings from the queue, should be called at
+	/// the start of every frame
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets or assigns a dense per-frame ID for a shader
+	/// </summary>
+	/// <param name="shader">Any unique value for the shader (ex: the GL handle)</param>
+	uint16_t GetShaderID(uintptr_t shader);
+	/// <summary>
+	/// Gets or assigns a dense per-frame ID for a material
+	/// </summary>
+	/// <param name="material">Any unique value for the material (ex: it's address)</param>
+	uint16_t GetMaterialID(uintptr_t material);
+	/// <summary>
+	/// Gets or assigns a dense per-frame ID for a vertex array object
+	/// </summary>
+	/// <param name="vao">Any unique value for the VAO (ex: the GL handle)</param>
+	uint16_t GetVaoID(uintptr_t vao);
+
+	/// <summary>
+	/// Packs the state IDs and view depth for a draw into a single sort key
+	/// </summary>
+	/// <param name="shaderId">The ID of the shader, from GetShaderID</param>
+	/// <param name="materialId">The ID of the material, from GetMaterialID</param>
+	/// <param name="vaoId">The ID of the VAO, from GetVaoID</param>
+	/// <param name="viewDepth">The distance of the object along the camera's forward axis</param>
+	/// <param name="maxDepth">The depth that maps to the farthest bucket (ex: the camera's far plane)</param>
+	static uint64_t MakeKey(uint16_t shaderId, uint16_t materialId, uint16_t vaoId, float viewDepth, float maxDepth);
+
+	/// <summary>
+	/// Adds a new entry to the queue
+	/// </summary>
+	/// <param name="key">The sort key, see MakeKey</param>
+	/// <param name="payload">The index of the draw item this entry refers to</param>
+	void Push(uint64_t key, uint32_t payload);
+
+	/// <summary>
+	/// Sorts the queue by key using an LSD radix sort, byte passes where
+	/// every key has the same value are skipped
+	/// </summary>
+	void Sort();
+
+	/// <summary>
+	/// Walks the queue in it's current order and counts how many state changes
+	/// would be required to render it
+	/// </summary>
+	SwitchStats CountSwitches() const;
+
+	const std::vector<Entry>& GetEntries() const { return _entries; }
+	size_t Size() const { return _entries.size(); }
+	bool Empty() const { return _entries.empty(); }
+
+	std::vector<Entry>::const_iterator begin() const { return _entries.begin(); }
+	std::vector<Entry>::const_iterator end() const { return _entries.end(); }
+
+	/// <summary>
+	/// Extracts the ID stored at the given shift in a sort key
+	/// </summary>
+	static uint16_t ExtractID(uint64_t key, int shift) { return static_cast<uint16_t>((key >> shift) & ID_MASK); }
+
+protected:
+	std::vector<Entry> _entries;
+	// Scratch space for the radix sort, kept around so we don't allocate every frame
+	std::vector<Entry> _scratch;
+
+	std::unordered_map<uintptr_t, uint16_t> _shaderIds;
+	std::unordered_map<uintptr_t, uint16_t> _materialIds;
+	std::unordered_map<uintptr_t, uint16_t> _vaoIds;
+
+	static uint16_t _GetOrAssignID(std::unordered_map<uintptr_t, uint16_t>& map, uintptr_t value);
+};
@@ -7,16 +7,54 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
 
+/// <summary>
+/// The header at the start of every file in the program binary cache, followed
+/// by Length bytes of binary data
+/// </summary>
+struct ProgramBinaryHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t Format;
+	uint32_t Length;
+	uint64_t Checksum;
+};
+
+static const uint32_t PROGRAM_BINARY_MAGIC   = 0x43425350; // "PSBC"
+static const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+// 64 bit FNV-1a, we don't need anything cryptographic, just something that's
+// unlikely to collide between two sets of shader sources
+static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= bytes[ix];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static uint64_t HashString(const std::string& value, uint64_t hash) {
+	// Include the length so that ("ab", "c") and ("a", "bc") hash differently
+	uint64_t length = value.size();
+	hash = HashBytes(&length, sizeof(uint64_t), hash);
+	return HashBytes(value.data(), value.size(), hash);
+}
+
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_interleavedVaryings(true),
+	_loadedFromCache(false)
 {
 	_rendererId = glCreateProgram();
 }
 
 ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths) :
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_interleavedVaryings(true),
+	_loadedFromCache(false)
 {
 	_rendererId = glCreateProgram();
 	for (auto& [type, path] : filePaths) {
@@ -33,11 +71,54 @@ ShaderProgram::~ShaderProgram() {
 }
 
 bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
+	if (source == nullptr || source[0] == '\0') {
+		LOG_WARN("Ignoring empty shader source for {}", ~type);
+		return false;
+	}
+
+	// If we're overwriting, warn before we replace the old source
+	if (_pendingSources.find(type) != _pendingSources.end()) {
+		LOG_WARN("Another shader has been attached to this slot, overwriting");
+	}
+
+	// We hold on to the source until Link, since if we have a cached binary we
+	// won't need to compile it at all
+	_pendingSources[type] = source;
+
+	// Store info about where we got this data from
+	_fileSourceMap[type].IsFilePath = false;
+	_fileSourceMap[type].Source = source;
+
+	return true;
+}
+
+bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
+	// Make sure that the file exists before we try reading
+	if (std::filesystem::exists(path)) {
+		// Load the source from the file, using our helper that will
+		// resolve #include directives
+		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// Pass off to LoadShaderPart
+		bool result =  LoadShaderPart(source.c_str(), type);
+		_fileSourceMap[type].IsFilePath = true;
+		_fileSourceMap[type].Source = path;
+		if (result == false) {
+			LOG_ERROR("Source File: {}", path);
+		}
+		return result; 
+	} else {
+		LOG_WARN("Could not open file at \"{}\"", path);
+		return false;
+	}
+}
+
+bool ShaderProgram::_CompileShaderPart(ShaderPartType type, const std::string& source) {
 	// Creates a new shader part (VS, FS, GS, etc...)
 	GLuint handle = glCreateShader((GLenum)type);
 
 	// Load the GLSL source and compile it
-	glShaderSource(handle, 1, &source, nullptr);
+	const char* sourcePtr = source.c_str();
+	glShaderSource(handle, 1, &sourcePtr, nullptr);
 	glCompileShader(handle);
 
 	// Get the compilation status for the shader part
@@ -57,6 +138,9 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 
 		// Dump error log
 		LOG_ERROR("Failed to compile shader part:\n{}", log);
+		if (_fileSourceMap[type].IsFilePath) {
+			LOG_ERROR("Source File: {}", _fileSourceMap[type].Source);
+		}
 
 		// Clean up our log memory
 		delete[] log;
@@ -68,42 +152,50 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 		return false;
 	}
 
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
-		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
+	if (_fileSourceMap[type].IsFilePath) {
+		glObjectLabel(GL_SHADER, handle, -1, _fileSourceMap[type].Source.c_str());
 	}
 	_handles[type] = handle;
 
-	// Store info about where we got this data from
-	_fileSourceMap[type].IsFilePath = false;
-	_fileSourceMap[type].Source = source;
-
-	return status != GL_FALSE;
+	return true;
 }
 
-bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
-	// Make sure that the file exists before we try reading
-	if (std::filesystem::exists(path)) {
-		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
-		// Pass off to LoadShaderPart
-		bool result =  LoadShaderPart(source.c_str(), type);
-		_fileSourceMap[type].IsFilePath = true;
-		_fileSourceMap[type].Source = path;
-		if (result == false) {
-			LOG_ERROR("Source File: {}", path);
+bool ShaderProgram::Link() {
+	_loadedFromCache = false;
+
+	// See if we can skip compiling entirely by loading a binary from a previous run
+	bool useCache = __binaryCacheEnabled && __SupportsProgramBinaries();
+	uint64_t cacheKey = 0;
+	if (useCache) {
+		cacheKey = _ComputeCacheKey();
+		if (_TryLoadBinary(cacheKey)) {
+			LOG_TRACE("Loaded shader program from binary cache ({:016x})", cacheKey);
+			_pendingSources.clear();
+			_loadedFromCache = true;
+			_Introspect();
+			return true;
 		}
-		glObjectLabel(GL_SHADER, _handles[type], -1, path);
-		return result; 
-	} else {
-		LOG_WARN("Could not open file at \"{}\"", path);
-		return false;
 	}
-}
 
-bool ShaderProgram::Link() {
+	// Cache miss, compile all of our shader parts. We keep going after a failure so
+	// that the errors for every part get logged at once
+	bool compiled = true;
+	for (auto& [type, source] : _pendingSources) {
+		compiled &= _CompileShaderPart(type, source);
+	}
+	_pendingSources.clear();
+
+	// No point linking if one of the parts is missing, clean up the parts that did compile
+	if (!compiled) {
+		for (auto& [type, id] : _handles) {
+			if (id != 0) {
+				glDeleteShader(id);
+			}
+		}
+		_handles.clear();
+		LOG_ERROR("Shader program was not linked, one or more parts failed to compile");
+		return false;
+	}
 
 	LOG_TRACE("Starting shader link:");
 	
@@ -115,6 +207,11 @@ bool ShaderProgram::Link() {
 		}
 	}
 
+	// Let the driver know we'd like to read the binary back after linking
+	if (useCache) {
+		glProgramParameteri(_rendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
 	// Perform linking
 	glLinkProgram(_rendererId);
 
@@ -149,6 +246,11 @@ bool ShaderProgram::Link() {
 		}
 	} else {
 		LOG_TRACE("Linking complete, starting introspection");
+
+		// Store the result so we can skip all of the above next time
+		if (useCache) {
+			_SaveBinary(cacheKey);
+		}
 	}
 
 	// Perform our uniform introspection to see what uniforms are in the shader
@@ -157,6 +259,160 @@ bool ShaderProgram::Link() {
 	return status != GL_FALSE;
 }
 
+uint64_t ShaderProgram::_ComputeCacheKey() const {
+	uint64_t hash = HashBytes(&PROGRAM_BINARY_VERSION, sizeof(uint32_t));
+
+	// Anything the driver could produce a different binary for needs to be in the key,
+	// a driver update will usually change the version string
+	const GLenum driverStrings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (int ix = 0; ix < 3; ix++) {
+		const char* value = reinterpret_cast<const char*>(glGetString(driverStrings[ix]));
+		hash = HashString(value != nullptr ? value : "", hash);
+	}
+
+	// Unordered map iteration order isn't stable, so hash the parts in a fixed order
+	const ShaderPartType order[5] = {
+		ShaderPartType::Vertex, ShaderPartType::TessControl, ShaderPartType::TessEval,
+		ShaderPartType::Geometry, ShaderPartType::Fragment
+	};
+	for (int ix = 0; ix < 5; ix++) {
+		auto it = _pendingSources.find(order[ix]);
+		if (it != _pendingSources.end()) {
+			GLint type = *order[ix];
+			hash = HashBytes(&type, sizeof(GLint), hash);
+			hash = HashString(it->second, hash);
+		}
+	}
+
+	for (const auto& varying : _varyings) {
+		hash = HashString(varying, hash);
+	}
+	hash = HashBytes(&_interleavedVaryings, sizeof(bool), hash);
+
+	return hash;
+}
+
+bool ShaderProgram::_TryLoadBinary(uint64_t key) {
+	std::string path = __GetBinaryCachePath(key);
+	if (!std::filesystem::exists(path)) {
+		return false;
+	}
+
+	std::string contents = FileHelpers::ReadFile(path);
+
+	// Validate the file before we hand anything to the driver, some drivers will
+	// happily crash if you feed them garbage
+	const char* reason = nullptr;
+	ProgramBinaryHeader header;
+	if (contents.size() < sizeof(ProgramBinaryHeader)) {
+		reason = "file is truncated";
+	} else {
+		memcpy(&header, contents.data(), sizeof(ProgramBinaryHeader));
+		const char* data = contents.data() + sizeof(ProgramBinaryHeader);
+
+		if (header.Magic != PROGRAM_BINARY_MAGIC || header.Version != PROGRAM_BINARY_VERSION) {
+			reason = "bad header";
+		} else if (header.Key != key) {
+			reason = "key mismatch";
+		} else if (header.Length != contents.size() - sizeof(ProgramBinaryHeader)) {
+			reason = "length mismatch";
+		} else if (header.Checksum != HashBytes(data, header.Length)) {
+			reason = "checksum mismatch";
+		} else {
+			// Make sure the driver still supports this binary format
+			GLint numFormats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+			std::vector<GLint> formats(numFormats);
+			glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+			if (std::find(formats.begin(), formats.end(), static_cast<GLint>(header.Format)) == formats.end()) {
+				reason = "unsupported binary format";
+			} else {
+				glProgramBinary(_rendererId, header.Format, data, header.Length);
+
+				// The driver may still reject it (ex: after a driver update that didn't change the version string)
+				GLint status = 0;
+				glGetProgramiv(_rendererId, GL_LINK_STATUS, &status);
+				if (status == GL_FALSE) {
+					reason = "rejected by driver";
+				}
+			}
+		}
+	}
+
+	if (reason != nullptr) {
+		LOG_WARN("Discarding cached shader binary \"{}\" ({}), compiling from source", path, reason);
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderProgram::_SaveBinary(uint64_t key) {
+	GLint length = 0;
+	glGetProgramiv(_rendererId, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<char> data(length);
+	GLenum format = 0;
+	glGetProgramBinary(_rendererId, length, &length, &format, data.data());
+
+	ProgramBinaryHeader header;
+	header.Magic    = PROGRAM_BINARY_MAGIC;
+	header.Version  = PROGRAM_BINARY_VERSION;
+	header.Key      = key;
+	header.Format   = format;
+	header.Length   = static_cast<uint32_t>(length);
+	header.Checksum = HashBytes(data.data(), length);
+
+	std::error_code error;
+	std::filesystem::create_directories(GetBinaryCacheDirectory(), error);
+
+	// Write to a temp file and then move it into place, so we never leave a half-written
+	// binary behind if we crash part way through
+	std::string path = __GetBinaryCachePath(key);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream output(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!output) {
+			LOG_WARN("Could not write shader binary to \"{}\"", tempPath);
+			return;
+		}
+		output.write(reinterpret_cast<const char*>(&header), sizeof(ProgramBinaryHeader));
+		output.write(data.data(), length);
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Could not write shader binary to \"{}\": {}", path, error.message());
+		std::filesystem::remove(tempPath, error);
+	}
+}
+
+const std::string& ShaderProgram::GetBinaryCacheDirectory() {
+	if (__binaryCacheDirectory.empty()) {
+		__binaryCacheDirectory = (std::filesystem::path(FileHelpers::GetExecutableDirectory()) / "shader-cache").string();
+	}
+	return __binaryCacheDirectory;
+}
+
+bool ShaderProgram::__SupportsProgramBinaries() {
+	// Some drivers expose the extension but don't actually support any formats
+	static int numFormats = -1;
+	if (numFormats < 0) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	}
+	return numFormats > 0;
+}
+
+std::string ShaderProgram::__GetBinaryCachePath(uint64_t key) {
+	char name[32];
+	snprintf(name, 32, "%016llx.bin", static_cast<unsigned long long>(key));
+	return (std::filesystem::path(GetBinaryCacheDirectory()) / name).string();
+}
+
 void ShaderProgram::Bind() {
 	// Simply calls glUseProgram with our shader handle
 	glUseProgram(_rendererId);
@@ -350,6 +606,33 @@ ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 void ShaderProgram::_Introspect() {
 	_IntrospectUniforms();
 	_IntrospectUnifromBlocks();
+	_IntrospectStorageBlocks();
+}
+
+void ShaderProgram::_IntrospectStorageBlocks() {
+	_storageBlocks.clear();
+
+	// Query program for the number of storage blocks
+	int numBlocks = 0;
+	glGetProgramInterfaceiv(_rendererId, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &numBlocks);
+
+	for (int ix = 0; ix < numBlocks; ix++) {
+		static GLenum pNames[] ={
+			GL_BUFFER_BINDING,
+			GL_NAME_LENGTH
+		};
+		int results[2];
+		glGetProgramResourceiv(_rendererId, GL_SHADER_STORAGE_BLOCK, ix, 2, pNames, 2, NULL, results);
+
+		// Query block name from the program
+		std::string name;
+		name.resize(results[1] - 1);
+		glGetProgramResourceName(_rendererId, GL_SHADER_STORAGE_BLOCK, ix, results[1], NULL, &name[0]);
+
+		LOG_TRACE("\tDetected a new storage block \"{}\" bound at {}", name, results[0]);
+
+		_storageBlocks[name] = results[0];
+	}
 }
 
 void ShaderProgram::_IntrospectUniforms() {
@@ -520,5 +803,7 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
+	_varyings.assign(names, names + numVaryings);
+	_interleavedVaryings = interleaved;
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
 }
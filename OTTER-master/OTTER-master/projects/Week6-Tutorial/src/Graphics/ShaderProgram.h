@@ -71,17 +71,20 @@ public:
 
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader)
+	/// 
+	/// Note that compilation is deferred until Link, so that we can skip it entirely if
+	/// we have a cached binary for the program. Compilation errors will be reported there
 	/// </summary>
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
-	/// <returns>True if the shader is loaded, false if there was an issue</returns>
+	/// <returns>True if the source was stored for Link, false if it was empty. This does not mean the source will compile</returns>
 	bool LoadShaderPart(const char* source, ShaderPartType type);
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader) from an external file (in res)
 	/// </summary>
 	/// <param name="path">The relative path to the file containing the source</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
-	/// <returns>True if the shader is loaded, false if there was an issue</returns>
+	/// <returns>True if the file was read and it's source stored for Link, see LoadShaderPart</returns>
 	bool LoadShaderPartFromFile(const char* path, ShaderPartType type);
 
 	/// <summary>
@@ -94,10 +97,31 @@ public:
 
 	/// <summary>
 	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// 
+	/// If the binary cache is enabled, this will first try to load a program binary that
+	/// was cached from a previous run with the exact same sources and driver, and only
+	/// compile from source if that fails
 	/// </summary>
-	/// <returns>True if the linking was successful, false if otherwise</returns>
+	/// <returns>True if the linking was successful, false if any part failed to compile or the program failed to link</returns>
 	bool Link();
 
+	/// <summary>
+	/// Returns true if the last call to Link loaded the program from the binary cache
+	/// </summary>
+	bool WasLoadedFromCache() const { return _loadedFromCache; }
+
+	/// <summary>
+	/// Enables or disables the on-disk program binary cache for all shaders linked afterwards
+	/// </summary>
+	static void SetBinaryCacheEnabled(bool value) { __binaryCacheEnabled = value; }
+	static bool IsBinaryCacheEnabled() { return __binaryCacheEnabled; }
+	/// <summary>
+	/// Sets the directory to store cached program binaries in, by default this is
+	/// a shader-cache folder beside the executable
+	/// </summary>
+	static void SetBinaryCacheDirectory(const std::string& value) { __binaryCacheDirectory = value; }
+	static const std::string& GetBinaryCacheDirectory();
+
 	/// <summary>
 	/// Binds this shader for use
 	/// </summary>
@@ -109,6 +133,12 @@ public:
 
 	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
 
+	/// <summary>
+	/// Returns true if the program contains an active shader storage block with the given name
+	/// </summary>
+	/// <param name="name">The name of the block as declared in GLSL (ex: b_InstanceData)</param>
+	bool HasStorageBlock(const std::string& name) const { return _storageBlocks.find(name) != _storageBlocks.end(); }
+
 	// Inherited from IGraphicsResource
 
 	virtual GlResourceType GetResourceClass() const override;
@@ -180,10 +210,20 @@ protected:
 	// Stores all the handles to our shaders until we
 	// are ready to compile them into a program
 	std::unordered_map<ShaderPartType, int> _handles;
+	// Stores the fully resolved source for each shader part until Link, where
+	// we either compile them or skip them if we have a cached binary
+	std::unordered_map<ShaderPartType, std::string> _pendingSources;
+	// The transform feedback varyings, since they change the linked program they
+	// need to be part of the binary cache key
+	std::vector<std::string> _varyings;
+	bool _interleavedVaryings;
+	bool _loadedFromCache;
 	
 	// Map access to look up uniform locations and blocks
 	std::unordered_map<std::string, UniformInfo> _uniforms;
 	std::unordered_map<std::string, UniformBlockInfo> _uniformBlocks;
+	// Maps active shader storage block names to their binding slots
+	std::unordered_map<std::string, int> _storageBlocks;
 
 	// Stores information about the source of our shader parts
 	// EX: if a VS shader is loaded from a file, will contain
@@ -208,6 +248,36 @@ protected:
 	/// fed data from a uniform buffer
 	/// </summary>
 	void _IntrospectUnifromBlocks();
+	/// <summary>
+	/// Introspects shader storage blocks, we only need to know their
+	/// names and bindings so that we can feed them from SSBOs
+	/// </summary>
+	void _IntrospectStorageBlocks();
+
+	/// <summary>
+	/// Compiles a single shader part and stores it's handle in _handles
+	/// </summary>
+	bool _CompileShaderPart(ShaderPartType type, const std::string& source);
+	/// <summary>
+	/// Computes the 64 bit key for the binary cache, from the resolved sources,
+	/// varyings and the GL vendor/renderer/version strings
+	/// </summary>
+	uint64_t _ComputeCacheKey() const;
+	/// <summary>
+	/// Attempts to load a program binary from the cache, returns false and removes
+	/// the cache file if it is missing, corrupted or rejected by the driver
+	/// </summary>
+	bool _TryLoadBinary(uint64_t key);
+	/// <summary>
+	/// Saves the currently linked program to the binary cache
+	/// </summary>
+	void _SaveBinary(uint64_t key);
 
 	int __GetUniformLocation(const std::string& name);
+
+	static inline bool __binaryCacheEnabled = true;
+	static inline std::string __binaryCacheDirectory = "";
+
+	static bool __SupportsProgramBinaries();
+	static std::string __GetBinaryCachePath(uint64_t key);
 };
\ No newline at end of file
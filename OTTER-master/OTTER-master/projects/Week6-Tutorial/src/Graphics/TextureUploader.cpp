@@ -0,0 +1,173 @@
+#include "Graphics/TextureUploader.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "Logging.h"
+
+uint32_t TextureUploader::__buffer = 0;
+uint8_t* TextureUploader::__mappedData = nullptr;
+size_t TextureUploader::__size = 0;
+size_t TextureUploader::__head = 0;
+std::deque<TextureUploader::Block> TextureUploader::__blocks;
+uint64_t TextureUploader::__nextId = 1;
+TextureUploader::Stats TextureUploader::__stats;
+std::mutex TextureUploader::__mutex;
+
+void TextureUploader::Init(size_t size) {
+	std::lock_guard<std::mutex> lock(__mutex);
+	LOG_ASSERT(__mappedData == nullptr, "Texture uploader has already been initialized!");
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &__buffer);
+	glNamedBufferStorage(__buffer, size, nullptr, flags);
+	__mappedData = reinterpret_cast<uint8_t*>(glMapNamedBufferRange(__buffer, 0, size, flags));
+
+	if (__mappedData == nullptr) {
+		LOG_WARN("Failed to map texture upload buffer, textures will be uploaded from client memory");
+		glDeleteBuffers(1, &__buffer);
+		__buffer = 0;
+		return;
+	}
+
+	__size = size;
+	__head = 0;
+	__stats = Stats();
+}
+
+void TextureUploader::Cleanup() {
+	std::lock_guard<std::mutex> lock(__mutex);
+	for (Block& block : __blocks) {
+		if (block.Fence != nullptr) {
+			glDeleteSync(reinterpret_cast<GLsync>(block.Fence));
+		}
+	}
+	__blocks.clear();
+
+	if (__buffer != 0) {
+		glUnmapNamedBuffer(__buffer);
+		glDeleteBuffers(1, &__buffer);
+	}
+	__buffer = 0;
+	__mappedData = nullptr;
+	__size = 0;
+	__head = 0;
+}
+
+TextureUploader::Staging TextureUploader::Allocate(size_t size) {
+	std::lock_guard<std::mutex> lock(__mutex);
+	Staging result;
+	if (__mappedData == nullptr || size == 0) {
+		return result;
+	}
+
+	size_t aligned = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	size_t offset  = 0;
+	bool   fits    = false;
+
+	if (__blocks.empty()) {
+		// Nothing is in use, so we can start back at the beginning
+		offset = 0;
+		fits = aligned <= __size;
+	} else {
+		size_t tail = __blocks.front().Offset;
+		if (__head > tail) {
+			// Free space is after the head, and before the tail once we wrap around. Note that we
+			// never let the head catch up with the tail, so that head == tail always means empty
+			if (__head + aligned <= __size) {
+				offset = __head;
+				fits = true;
+			} else if (aligned < tail) {
+				offset = 0;
+				fits = true;
+			}
+		} else if (__head + aligned < tail) {
+			offset = __head;
+			fits = true;
+		}
+	}
+
+	if (!fits) {
+		__stats.FallbackAllocs++;
+		return result;
+	}
+
+	__head = offset + aligned;
+	__blocks.push_back(Block{ __nextId, offset, aligned, BlockState::Writing, nullptr });
+	__stats.BytesInUse += aligned;
+	__stats.PeakBytesInUse = std::max(__stats.PeakBytesInUse, __stats.BytesInUse);
+
+	result.Data   = __mappedData + offset;
+	result.Offset = offset;
+	result.Size   = size;
+	result.Id     = __nextId++;
+	return result;
+}
+
+void TextureUploader::Cancel(Staging& staging) {
+	std::lock_guard<std::mutex> lock(__mutex);
+	Block* block = __FindBlock(staging.Id);
+	if (block != nullptr) {
+		block->State = BlockState::Free;
+	}
+	staging = Staging();
+}
+
+void* TextureUploader::BeginUpload(const Staging& staging) {
+	LOG_ASSERT(staging.IsValid(), "Cannot upload from an invalid staging region!");
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, __buffer);
+	return reinterpret_cast<void*>(staging.Offset);
+}
+
+void TextureUploader::EndUpload(Staging& staging) {
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	std::lock_guard<std::mutex> lock(__mutex);
+	Block* block = __FindBlock(staging.Id);
+	if (block != nullptr) {
+		block->State = BlockState::InFlight;
+		block->Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		__stats.BytesUploaded += staging.Size;
+		__stats.Uploads++;
+	}
+	staging = Staging();
+}
+
+void TextureUploader::Update() {
+	std::lock_guard<std::mutex> lock(__mutex);
+	while (!__blocks.empty()) {
+		Block& block = __blocks.front();
+		if (block.State == BlockState::InFlight) {
+			// A timeout of 0 just polls the fence
+			GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(block.Fence), 0, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+				break;
+			}
+			glDeleteSync(reinterpret_cast<GLsync>(block.Fence));
+		} else if (block.State != BlockState::Free) {
+			// Still being written by a worker, or waiting to be uploaded
+			break;
+		}
+
+		__stats.BytesInUse -= block.Size;
+		__blocks.pop_front();
+	}
+
+	if (__blocks.empty()) {
+		__head = 0;
+	}
+}
+
+TextureUploader::Stats TextureUploader::GetStats() {
+	std::lock_guard<std::mutex> lock(__mutex);
+	return __stats;
+}
+
+TextureUploader::Block* TextureUploader::__FindBlock(uint64_t id) {
+	for (Block& block : __blocks) {
+		if (block.Id == id) {
+			return &block;
+		}
+	}
+	return nullptr;
+}
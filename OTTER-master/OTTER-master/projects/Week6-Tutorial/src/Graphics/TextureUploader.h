@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/// <summary>
+/// Streams texture data to the GPU through a single persistently mapped pixel unpack buffer (PBO)
+/// that is used as a ring
+///
+/// Worker threads allocate a region of the ring and write decoded pixels straight into it. The main
+/// thread then issues the glTexture*SubImage call with the buffer bound, which lets the driver copy
+/// the data asynchronously instead of blocking on client memory, and drops a fence after it. Regions
+/// are reclaimed in allocation order once their fence has signaled
+///
+/// Allocating never blocks, if the ring is full (or has not been initialized) callers should fall back
+/// to uploading from client memory
+///
+/// Usage:
+///    // Worker thread
+///    TextureUploader::Staging staging = TextureUploader::Allocate(bytes);
+///    if (staging.IsValid()) { memcpy(staging.Data, pixels, bytes); }
+///    // Main thread
+///    glTextureSubImage2D(..., TextureUploader::BeginUpload(staging));
+///    TextureUploader::EndUpload(staging);
+/// </summary>
+class TextureUploader {
+public:
+	/// <summary>
+	/// A region of the ring that has been handed out for writing
+	/// </summary>
+	struct Staging {
+		uint8_t* Data   = nullptr;
+		size_t   Offset = 0;
+		size_t   Size   = 0;
+		uint64_t Id     = 0;
+
+		bool IsValid() const { return Data != nullptr; }
+	};
+
+	/// <summary>
+	/// Running totals for measuring upload throughput
+	/// </summary>
+	struct Stats {
+		// The total number of bytes that have been uploaded through the ring
+		uint64_t BytesUploaded    = 0;
+		// The number of uploads that have gone through the ring
+		uint64_t Uploads          = 0;
+		// The number of allocations that did not fit in the ring, and had to fall back to client memory
+		uint64_t FallbackAllocs   = 0;
+		// The number of bytes currently allocated, including regions waiting on the GPU
+		size_t   BytesInUse       = 0;
+		// The highest value BytesInUse has reached
+		size_t   PeakBytesInUse   = 0;
+	};
+
+	/// <summary>
+	/// Creates and maps the ring, must be called from the main thread with a GL context current
+	/// </summary>
+	/// <param name="size">The size of the ring in bytes</param>
+	static void Init(size_t size = DEFAULT_RING_SIZE);
+	/// <summary>
+	/// Unmaps and deletes the ring. Any outstanding allocations become invalid, so streaming
+	/// workers must be stopped before this is called
+	/// </summary>
+	static void Cleanup();
+	/// <summary>
+	/// Returns true if the ring has been created
+	/// </summary>
+	static bool IsInitialized() { return __mappedData != nullptr; }
+
+	/// <summary>
+	/// Allocates a region of the ring for writing. Safe to call from any thread
+	/// </summary>
+	/// <param name="size">The number of bytes required</param>
+	/// <returns>The allocated region, or an invalid region if there is not enough space</returns>
+	static Staging Allocate(size_t size);
+	/// <summary>
+	/// Releases a region that will never be uploaded (ex: decoding failed). Safe to call from any thread
+	/// </summary>
+	static void Cancel(Staging& staging);
+
+	/// <summary>
+	/// Binds the ring as the pixel unpack buffer for uploading the given region, must be called from the main thread
+	/// </summary>
+	/// <returns>The pointer to pass to glTexture*SubImage, which GL treats as an offset into the buffer</returns>
+	static void* BeginUpload(const Staging& staging);
+	/// <summary>
+	/// Fences the commands that read from the region and unbinds the ring, the region will be
+	/// reclaimed once the fence signals. Must be called from the main thread
+	/// </summary>
+	static void EndUpload(Staging& staging);
+
+	/// <summary>
+	/// Reclaims any regions whose uploads have finished, without waiting on the GPU. Should be
+	/// called once per frame from the main thread
+	/// </summary>
+	static void Update();
+
+	/// <summary>
+	/// Gets the size of the ring in bytes
+	/// </summary>
+	static size_t GetSize() { return __size; }
+	/// <summary>
+	/// Gets the upload statistics since the ring was created
+	/// </summary>
+	static Stats GetStats();
+
+	static const size_t DEFAULT_RING_SIZE = 64 * 1024 * 1024;
+
+private:
+	// Offsets are aligned so that they're valid for any pixel type
+	static const size_t ALIGNMENT = 16;
+
+	enum class BlockState {
+		Writing,
+		InFlight,
+		Free
+	};
+
+	struct Block {
+		uint64_t   Id;
+		size_t     Offset;
+		size_t     Size;
+		BlockState State;
+		void*      Fence;
+	};
+
+	static uint32_t __buffer;
+	static uint8_t* __mappedData;
+	static size_t   __size;
+	// Where the next allocation will start
+	static size_t   __head;
+	// Allocated regions, in the order that they were allocated
+	static std::deque<Block> __blocks;
+	static uint64_t __nextId;
+	static Stats    __stats;
+	static std::mutex __mutex;
+
+	static Block* __FindBlock(uint64_t id);
+};
@@ -0,0 +1,418 @@
+#include "Graphics/Textures/CompressedImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "Utils/MappedFile.h"
+
+namespace {
+	// See https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+	struct DdsPixelFormat {
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DdsHeader {
+		uint32_t       Size;
+		uint32_t       Flags;
+		uint32_t       Height;
+		uint32_t       Width;
+		uint32_t       PitchOrLinearSize;
+		uint32_t       Depth;
+		uint32_t       MipMapCount;
+		uint32_t       Reserved1[11];
+		DdsPixelFormat PixelFormat;
+		uint32_t       Caps;
+		uint32_t       Caps2;
+		uint32_t       Caps3;
+		uint32_t       Caps4;
+		uint32_t       Reserved2;
+	};
+
+	struct DdsHeaderDx10 {
+		uint32_t DxgiFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+
+	constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+		return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+	}
+
+	const uint32_t DDS_MAGIC             = MakeFourCC('D', 'D', 'S', ' ');
+	const uint32_t DDS_FLAG_MIPMAPCOUNT  = 0x20000;
+	const uint32_t DDS_PF_FOURCC         = 0x4;
+	const uint32_t DDS_CAPS2_CUBEMAP     = 0x200;
+	const uint32_t DDS_CAPS2_VOLUME      = 0x200000;
+	const uint32_t DDS_DIMENSION_TEX2D   = 3;
+
+	// See https://github.khronos.org/KTX-Specification/
+	struct Ktx2Header {
+		uint8_t  Identifier[12];
+		uint32_t VkFormat;
+		uint32_t TypeSize;
+		uint32_t PixelWidth;
+		uint32_t PixelHeight;
+		uint32_t PixelDepth;
+		uint32_t LayerCount;
+		uint32_t FaceCount;
+		uint32_t LevelCount;
+		uint32_t SupercompressionScheme;
+		uint32_t DfdByteOffset;
+		uint32_t DfdByteLength;
+		uint32_t KvdByteOffset;
+		uint32_t KvdByteLength;
+		uint64_t SgdByteOffset;
+		uint64_t SgdByteLength;
+	};
+
+	struct Ktx2LevelIndex {
+		uint64_t ByteOffset;
+		uint64_t ByteLength;
+		uint64_t UncompressedByteLength;
+	};
+
+	// A 32 bit dimension can't have more mip levels than this, anything past it is garbage
+	const uint32_t MAX_LEVELS = 32;
+
+	const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	template <typename T>
+	bool ReadStruct(const uint8_t* data, size_t size, size_t offset, T& result) {
+		if (offset > size || sizeof(T) > size - offset) {
+			return false;
+		}
+		memcpy(&result, data + offset, sizeof(T));
+		return true;
+	}
+
+	InternalFormat GetFormatFromFourCC(uint32_t fourCC) {
+		switch (fourCC) {
+			case MakeFourCC('D', 'X', 'T', '1'): return InternalFormat::BC1;
+			case MakeFourCC('D', 'X', 'T', '5'): return InternalFormat::BC3;
+			case MakeFourCC('A', 'T', 'I', '1'):
+			case MakeFourCC('B', 'C', '4', 'U'): return InternalFormat::BC4;
+			case MakeFourCC('A', 'T', 'I', '2'):
+			case MakeFourCC('B', 'C', '5', 'U'): return InternalFormat::BC5;
+			default: return InternalFormat::Unknown;
+		}
+	}
+
+	InternalFormat GetFormatFromDxgi(uint32_t dxgiFormat) {
+		switch (dxgiFormat) {
+			case 71: return InternalFormat::BC1;      // DXGI_FORMAT_BC1_UNORM
+			case 72: return InternalFormat::BC1_SRGB; // DXGI_FORMAT_BC1_UNORM_SRGB
+			case 77: return InternalFormat::BC3;      // DXGI_FORMAT_BC3_UNORM
+			case 78: return InternalFormat::BC3_SRGB; // DXGI_FORMAT_BC3_UNORM_SRGB
+			case 80: return InternalFormat::BC4;      // DXGI_FORMAT_BC4_UNORM
+			case 83: return InternalFormat::BC5;      // DXGI_FORMAT_BC5_UNORM
+			case 98: return InternalFormat::BC7;      // DXGI_FORMAT_BC7_UNORM
+			case 99: return InternalFormat::BC7_SRGB; // DXGI_FORMAT_BC7_UNORM_SRGB
+			default: return InternalFormat::Unknown;
+		}
+	}
+
+	InternalFormat GetFormatFromVulkan(uint32_t vkFormat) {
+		switch (vkFormat) {
+			case 131: return InternalFormat::BC1;      // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+			case 132: return InternalFormat::BC1_SRGB; // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+			case 137: return InternalFormat::BC3;      // VK_FORMAT_BC3_UNORM_BLOCK
+			case 138: return InternalFormat::BC3_SRGB; // VK_FORMAT_BC3_SRGB_BLOCK
+			case 139: return InternalFormat::BC4;      // VK_FORMAT_BC4_UNORM_BLOCK
+			case 141: return InternalFormat::BC5;      // VK_FORMAT_BC5_UNORM_BLOCK
+			case 145: return InternalFormat::BC7;      // VK_FORMAT_BC7_UNORM_BLOCK
+			case 146: return InternalFormat::BC7_SRGB; // VK_FORMAT_BC7_SRGB_BLOCK
+			default: return InternalFormat::Unknown;
+		}
+	}
+
+	// BC1 color blocks store two 16 bit endpoints, followed by one byte of 2 bit indices per row
+	void FlipBc1Block(uint8_t* block, uint32_t rows) {
+		std::reverse(block + 4, block + 4 + rows);
+	}
+
+	// BC4 blocks (also used for the BC3 alpha and both BC5 channels) store two 8 bit endpoints,
+	// followed by 48 bits of 3 bit indices, 12 bits per row
+	void FlipBc4Block(uint8_t* block, uint32_t rows) {
+		uint64_t bits = 0;
+		for (int ix = 0; ix < 6; ix++) {
+			bits |= (uint64_t)block[2 + ix] << (8 * ix);
+		}
+
+		uint64_t result = bits;
+		for (uint32_t row = 0; row < rows; row++) {
+			uint32_t target = rows - 1 - row;
+			result &= ~(0xFFFull << (12 * target));
+			result |= ((bits >> (12 * row)) & 0xFFF) << (12 * target);
+		}
+
+		for (int ix = 0; ix < 6; ix++) {
+			block[2 + ix] = (uint8_t)(result >> (8 * ix));
+		}
+	}
+}
+
+CompressedImage::CompressedImage() :
+	_format(InternalFormat::Unknown),
+	_width(0),
+	_height(0),
+	_isTopDown(true),
+	_levels(std::vector<MipLevel>()),
+	_data(std::vector<uint8_t>())
+{ }
+
+bool CompressedImage::FlipVertically() {
+	if (_format == InternalFormat::BC7 || _format == InternalFormat::BC7_SRGB) {
+		return false;
+	}
+
+	// Blocks that straddle the flipped rows would need to be re-encoded, so check every level
+	// before we modify anything
+	for (const MipLevel& level : _levels) {
+		if (level.Height > 4 && level.Height % 4 != 0) {
+			return false;
+		}
+	}
+
+	const size_t blockSize = GetCompressedBlockSize(_format);
+	for (const MipLevel& level : _levels) {
+		uint8_t* data = _data.data() + level.Offset;
+		const uint32_t blocksX  = (level.Width + 3) / 4;
+		const uint32_t blocksY  = (level.Height + 3) / 4;
+		const uint32_t rows     = std::min<uint32_t>(level.Height, 4);
+		const size_t   rowPitch = blocksX * blockSize;
+
+		// Reverse the order of the block rows
+		for (uint32_t y = 0; y < blocksY / 2; y++) {
+			std::swap_ranges(data + y * rowPitch, data + (y + 1) * rowPitch, data + (blocksY - 1 - y) * rowPitch);
+		}
+
+		// Reverse the pixel rows inside of each block
+		for (size_t offset = 0; offset < level.Size; offset += blockSize) {
+			uint8_t* block = data + offset;
+			switch (_format) {
+				case InternalFormat::BC1:
+				case InternalFormat::BC1_SRGB:
+					FlipBc1Block(block, rows);
+					break;
+				case InternalFormat::BC3:
+				case InternalFormat::BC3_SRGB:
+					FlipBc4Block(block, rows);
+					FlipBc1Block(block + 8, rows);
+					break;
+				case InternalFormat::BC4:
+					FlipBc4Block(block, rows);
+					break;
+				case InternalFormat::BC5:
+					FlipBc4Block(block, rows);
+					FlipBc4Block(block + 8, rows);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	_isTopDown = !_isTopDown;
+	return true;
+}
+
+bool CompressedImage::IsCompressedImageFile(const std::string& filename) {
+	std::string extension = std::filesystem::path(filename).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+	return extension == ".dds" || extension == ".ktx2";
+}
+
+CompressedImage::Sptr CompressedImage::LoadFromFile(const std::string& filename, bool bottomUp) {
+	MappedFile file;
+	if (!file.Open(filename)) {
+		LOG_WARN("Failed to open compressed image \"{}\"", filename);
+		return nullptr;
+	}
+
+	// We check the magic rather than the extension, so misnamed files still load
+	CompressedImage::Sptr result = nullptr;
+	uint32_t magic = 0;
+	if (ReadStruct(file.GetData(), file.GetSize(), 0, magic) && magic == DDS_MAGIC) {
+		result = LoadDds(file.GetData(), file.GetSize(), filename);
+	} else if (file.GetSize() >= sizeof(KTX2_IDENTIFIER) && memcmp(file.GetData(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+		result = LoadKtx2(file.GetData(), file.GetSize(), filename);
+	} else {
+		LOG_WARN("\"{}\" is not a DDS or KTX2 file", filename);
+	}
+
+	if (result != nullptr && bottomUp && result->IsTopDown() && !result->FlipVertically()) {
+		LOG_WARN("Could not flip \"{}\" ({}) to be bottom up, it will be upside down unless it is authored that way", filename, result->GetFormat());
+	}
+	return result;
+}
+
+CompressedImage::Sptr CompressedImage::LoadDds(const uint8_t* data, size_t size, const std::string& debugName) {
+	DdsHeader header;
+	if (!ReadStruct(data, size, sizeof(uint32_t), header) || header.Size != sizeof(DdsHeader)) {
+		LOG_WARN("\"{}\" has an invalid DDS header", debugName);
+		return nullptr;
+	}
+	size_t dataOffset = sizeof(uint32_t) + sizeof(DdsHeader);
+
+	if ((header.Caps2 & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME)) != 0) {
+		LOG_WARN("\"{}\" is a cubemap or volume DDS, only 2D textures are supported", debugName);
+		return nullptr;
+	}
+	if ((header.PixelFormat.Flags & DDS_PF_FOURCC) == 0) {
+		LOG_WARN("\"{}\" is an uncompressed DDS, only BCn textures are supported", debugName);
+		return nullptr;
+	}
+
+	InternalFormat format = InternalFormat::Unknown;
+	if (header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0')) {
+		DdsHeaderDx10 dx10;
+		if (!ReadStruct(data, size, dataOffset, dx10)) {
+			LOG_WARN("\"{}\" has an invalid DX10 header", debugName);
+			return nullptr;
+		}
+		if (dx10.ResourceDimension != DDS_DIMENSION_TEX2D || dx10.ArraySize > 1) {
+			LOG_WARN("\"{}\" is not a single 2D texture", debugName);
+			return nullptr;
+		}
+		dataOffset += sizeof(DdsHeaderDx10);
+		format = GetFormatFromDxgi(dx10.DxgiFormat);
+	} else {
+		format = GetFormatFromFourCC(header.PixelFormat.FourCC);
+	}
+
+	if (format == InternalFormat::Unknown) {
+		LOG_WARN("\"{}\" uses an unsupported DDS format", debugName);
+		return nullptr;
+	}
+
+	CompressedImage::Sptr result = std::make_shared<CompressedImage>();
+	result->_format = format;
+	result->_width  = header.Width;
+	result->_height = header.Height;
+	// DDS files are always stored top to bottom
+	result->_isTopDown = true;
+
+	uint32_t levelCount = (header.Flags & DDS_FLAG_MIPMAPCOUNT) != 0 ? std::clamp(header.MipMapCount, 1u, MAX_LEVELS) : 1;
+
+	// DDS levels are stored back to back, starting with the largest
+	std::vector<size_t> offsets;
+	offsets.reserve(levelCount);
+	for (uint32_t level = 0; level < levelCount; level++) {
+		offsets.push_back(dataOffset);
+		dataOffset += GetCompressedImageSize(format, std::max(header.Width >> level, 1u), std::max(header.Height >> level, 1u));
+	}
+
+	if (!result->_CopyLevels(data, size, offsets)) {
+		LOG_WARN("\"{}\" is truncated", debugName);
+		return nullptr;
+	}
+	return result;
+}
+
+CompressedImage::Sptr CompressedImage::LoadKtx2(const uint8_t* data, size_t size, const std::string& debugName) {
+	Ktx2Header header;
+	if (!ReadStruct(data, size, 0, header) || memcmp(header.Identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+		LOG_WARN("\"{}\" has an invalid KTX2 header", debugName);
+		return nullptr;
+	}
+	if (header.SupercompressionScheme != 0) {
+		LOG_WARN("\"{}\" uses supercompression, which is not supported", debugName);
+		return nullptr;
+	}
+	if (header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1) {
+		LOG_WARN("\"{}\" is not a single 2D texture", debugName);
+		return nullptr;
+	}
+
+	InternalFormat format = GetFormatFromVulkan(header.VkFormat);
+	if (format == InternalFormat::Unknown) {
+		LOG_WARN("\"{}\" uses an unsupported KTX2 format ({})", debugName, header.VkFormat);
+		return nullptr;
+	}
+
+	CompressedImage::Sptr result = std::make_shared<CompressedImage>();
+	result->_format = format;
+	result->_width  = header.PixelWidth;
+	result->_height = header.PixelHeight;
+	// KTX2 images are top down unless the KTXorientation key says otherwise (ex: "ru")
+	result->_isTopDown = true;
+
+	size_t kvdEnd = (size_t)header.KvdByteOffset + header.KvdByteLength;
+	if (header.KvdByteLength > 0 && kvdEnd <= size) {
+		size_t offset = header.KvdByteOffset;
+		uint32_t entrySize = 0;
+		while (ReadStruct(data, size, offset, entrySize) && offset + sizeof(uint32_t) + entrySize <= kvdEnd) {
+			const char* entry = reinterpret_cast<const char*>(data + offset + sizeof(uint32_t));
+			const char* key = "KTXorientation";
+			size_t keySize = strlen(key) + 1;
+			if (entrySize >= keySize + 2 && memcmp(entry, key, keySize) == 0) {
+				result->_isTopDown = entry[keySize + 1] != 'u';
+			}
+			// Entries are padded to 4 byte alignment
+			offset += sizeof(uint32_t) + ((entrySize + 3) & ~3u);
+		}
+	}
+
+	// A level count of zero means that the loader should generate mip maps, which we can't do
+	// for block compressed data, so we just use the single level that's stored
+	uint32_t levelCount = std::clamp(header.LevelCount, 1u, MAX_LEVELS);
+	std::vector<size_t> offsets;
+	offsets.reserve(levelCount);
+	for (uint32_t level = 0; level < levelCount; level++) {
+		Ktx2LevelIndex index;
+		size_t expected = GetCompressedImageSize(format, std::max(header.PixelWidth >> level, 1u), std::max(header.PixelHeight >> level, 1u));
+		if (!ReadStruct(data, size, sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), index) || index.ByteLength != expected) {
+			LOG_WARN("\"{}\" has an invalid level index for level {}", debugName, level);
+			return nullptr;
+		}
+		offsets.push_back((size_t)index.ByteOffset);
+	}
+
+	if (!result->_CopyLevels(data, size, offsets)) {
+		LOG_WARN("\"{}\" is truncated", debugName);
+		return nullptr;
+	}
+	return result;
+}
+
+bool CompressedImage::_CopyLevels(const uint8_t* fileData, size_t fileSize, const std::vector<size_t>& offsets) {
+	_levels.clear();
+	_levels.reserve(offsets.size());
+
+	size_t total = 0;
+	for (size_t ix = 0; ix < offsets.size(); ix++) {
+		MipLevel level;
+		level.Width  = std::max(_width >> ix, 1u);
+		level.Height = std::max(_height >> ix, 1u);
+		level.Offset = total;
+		level.Size   = GetCompressedImageSize(_format, level.Width, level.Height);
+
+		if (offsets[ix] > fileSize || level.Size > fileSize - offsets[ix]) {
+			return false;
+		}
+
+		_levels.push_back(level);
+		total += level.Size;
+
+		// Stop once we reach the 1x1 level, some files claim more levels than the image can have
+		if (level.Width == 1 && level.Height == 1) {
+			break;
+		}
+	}
+
+	_data.resize(total);
+	for (size_t ix = 0; ix < _levels.size(); ix++) {
+		memcpy(_data.data() + _levels[ix].Offset, fileData + offsets[ix], _levels[ix].Size);
+	}
+	return _width > 0 && _height > 0;
+}
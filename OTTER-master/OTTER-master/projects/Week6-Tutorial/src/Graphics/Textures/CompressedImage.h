@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+#include "Graphics/GlEnums.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Stores a block compressed (BCn) image and it's prebuilt mip chain in CPU memory, as loaded
+/// from a DDS or KTX2 file. This class never touches OpenGL, so images can be loaded on
+/// worker threads, or by tools that don't have a GL context
+/// </summary>
+class CompressedImage {
+public:
+	MAKE_PTRS(CompressedImage);
+
+	/// <summary>
+	/// Describes where a single mip level is stored in the image's data
+	/// </summary>
+	struct MipLevel {
+		uint32_t Width;
+		uint32_t Height;
+		size_t   Offset;
+		size_t   Size;
+	};
+
+	CompressedImage();
+	~CompressedImage() = default;
+
+	/// <summary>
+	/// Gets the block compressed format of the image
+	/// </summary>
+	InternalFormat GetFormat() const { return _format; }
+	/// <summary>
+	/// Gets the width of the top mip level, in pixels
+	/// </summary>
+	uint32_t GetWidth() const { return _width; }
+	/// <summary>
+	/// Gets the height of the top mip level, in pixels
+	/// </summary>
+	uint32_t GetHeight() const { return _height; }
+	/// <summary>
+	/// Gets the mip levels stored in the image, starting with the largest
+	/// </summary>
+	const std::vector<MipLevel>& GetLevels() const { return _levels; }
+	/// <summary>
+	/// Gets a pointer to the blocks for the given mip level
+	/// </summary>
+	const uint8_t* GetLevelData(size_t level) const { return _data.data() + _levels[level].Offset; }
+	/// <summary>
+	/// Gets the total size of all the mip levels, in bytes
+	/// </summary>
+	size_t GetDataSize() const { return _data.size(); }
+	/// <summary>
+	/// Returns true if the first row of blocks is the top of the image (DDS and most KTX2 files),
+	/// false if it is the bottom of the image (the OpenGL convention)
+	/// </summary>
+	bool IsTopDown() const { return _isTopDown; }
+
+	/// <summary>
+	/// Flips the image vertically in place, by reversing the order of the block rows and of the
+	/// pixel rows inside each block. BC7 blocks can't be flipped without re-encoding them, and
+	/// neither can levels whose height is not a multiple of 4 (other than the 1 and 2 pixel tall
+	/// levels at the end of a mip chain)
+	/// </summary>
+	/// <returns>True if the image was flipped, false if the image was left unchanged</returns>
+	bool FlipVertically();
+
+	/// <summary>
+	/// Returns true if the file extension is one that we load as a compressed image (.dds or .ktx2)
+	/// </summary>
+	static bool IsCompressedImageFile(const std::string& filename);
+
+	/// <summary>
+	/// Loads a DDS or KTX2 file containing a single 2D image in one of our supported BCn formats
+	/// </summary>
+	/// <param name="filename">The path to the file to load</param>
+	/// <param name="bottomUp">True to flip top down images so the first row is the bottom of the image, matching how stb_image loads textures</param>
+	/// <returns>The loaded image, or nullptr if the file is missing, invalid or unsupported</returns>
+	static CompressedImage::Sptr LoadFromFile(const std::string& filename, bool bottomUp = true);
+	/// <summary>
+	/// Loads a compressed image from a DDS file that has been read into memory
+	/// </summary>
+	static CompressedImage::Sptr LoadDds(const uint8_t* data, size_t size, const std::string& debugName);
+	/// <summary>
+	/// Loads a compressed image from a KTX2 file that has been read into memory
+	/// </summary>
+	static CompressedImage::Sptr LoadKtx2(const uint8_t* data, size_t size, const std::string& debugName);
+
+protected:
+	InternalFormat        _format;
+	uint32_t              _width;
+	uint32_t              _height;
+	bool                  _isTopDown;
+	std::vector<MipLevel> _levels;
+	std::vector<uint8_t>  _data;
+
+	/// <summary>
+	/// Copies the given mip levels out of a file buffer, validating that they all fit inside it
+	/// </summary>
+	/// <param name="fileData">The start of the file</param>
+	/// <param name="fileSize">The size of the file in bytes</param>
+	/// <param name="offsets">The offset of each level within the file, starting with the largest</param>
+	/// <returns>True if all levels were copied, false if any level was outside of the file</returns>
+	bool _CopyLevels(const uint8_t* fileData, size_t fileSize, const std::vector<size_t>& offsets);
+};
@@ -1,5 +1,6 @@
 #include "Texture2D.h"
 #include <stb_image.h>
+#include <cstring>
 #include <Logging.h>
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
@@ -28,7 +29,8 @@ nlohmann::json Texture2D::ToJson() const {
 	if (!_description.Filename.empty()) {
 		result["filename"] = _description.Filename;
 	}
-	else if (_pixelType != PixelType::Unknown) {
+	// Compressed textures always come from a file, we never read them back for embedding
+	else if (_pixelType != PixelType::Unknown && !IsCompressed()) {
 		result["size_x"] = _description.Width;
 		result["size_y"] = _description.Width;
 
@@ -45,6 +47,43 @@ nlohmann::json Texture2D::ToJson() const {
 	return result;
 }
 
+size_t Texture2D::GetGpuMemoryUsage() const {
+	// Compressed textures store their exact mip chain, so we can add up each level
+	if (IsCompressed()) {
+		size_t result = 0;
+		int levels = std::max(_numLevels, 1);
+		for (int ix = 0; ix < levels; ix++) {
+			result += GetCompressedImageSize(_description.Format, std::max(_description.Width >> ix, 1u), std::max(_description.Height >> ix, 1u));
+		}
+		return result;
+	}
+
+	// We only know the exact texel size once data has been loaded, otherwise assume 4 bytes per texel
+	size_t texelSize = _pixelType != PixelType::Unknown ? GetTexelSize(_description.FormatHint, _pixelType) : 4;
+	size_t result = texelSize * _description.Width * _description.Height * std::max<uint8_t>(_description.MultisampleCount, 1);
+	// A full mip chain adds another third on top of the base level
+	if (_description.GenerateMipMaps && _description.MultisampleCount <= 1) {
+		result += result / 3;
+	}
+	return result;
+}
+
+Texture2D::Sptr Texture2D::FromJsonDeferred(const nlohmann::json& data) {
+	// Textures with embedded data don't have anything to stream
+	std::string filename = JsonGet<std::string>(data, "filename", "");
+	if (filename.empty()) {
+		return FromJson(data);
+	}
+
+	// Create the texture without a filename so that the constructor doesn't load it, then
+	// restore the filename for StreamDecode
+	nlohmann::json placeholder = data;
+	placeholder["filename"] = "";
+	Texture2D::Sptr result = FromJson(placeholder);
+	result->_description.Filename = filename;
+	return result;
+}
+
 Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 {
 	Texture2DDescription descr = Texture2DDescription();
@@ -76,7 +115,14 @@ Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 Texture2D::Texture2D(const Texture2DDescription& description) : 
 	ITexture(TextureType::_2D),
 	_description(description),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_streamPixels(nullptr),
+	_streamWidth(0),
+	_streamHeight(0),
+	_streamChannels(0),
+	_streamStaging(),
+	_streamCompressed(nullptr),
+	_numLevels(0)
 {
 	_SetTextureParams();
 	if (!description.Filename.empty()) {
@@ -87,13 +133,31 @@ Texture2D::Texture2D(const Texture2DDescription& description) :
 Texture2D::Texture2D(const std::string& filePath) : 
 	ITexture(TextureType::_2D),
 	_description(Texture2DDescription()),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_streamPixels(nullptr),
+	_streamWidth(0),
+	_streamHeight(0),
+	_streamChannels(0),
+	_streamStaging(),
+	_streamCompressed(nullptr),
+	_numLevels(0)
 {
 	_description.Filename = filePath;
 	_SetTextureParams();
 	_LoadDataFromFile();
 }
 
+Texture2D::~Texture2D() {
+	// If we were destroyed part way through streaming, we still own the decoded image
+	if (_streamPixels != nullptr) {
+		stbi_image_free(_streamPixels);
+		_streamPixels = nullptr;
+	}
+	if (_streamStaging.IsValid()) {
+		TextureUploader::Cancel(_streamStaging);
+	}
+}
+
 void Texture2D::SetMinFilter(MinFilter value) {
 	if (_description.MultisampleCount == 1) {
 		_description.MinificationFilter = value;
@@ -118,7 +182,8 @@ void Texture2D::SetAnisoLevel(float value) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
 
-		if (_description.GenerateMipMaps) {
+		// Compressed textures come with their mip chain, and GL can't generate mips for them anyways
+		if (_description.GenerateMipMaps && !IsCompressed()) {
 			glGenerateTextureMipmap(_rendererId);
 		}
 	}
@@ -128,6 +193,7 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	// Ensure the rectangle we're setting is within the bounds of the image
 	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
 	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+	LOG_ASSERT(!IsCompressed(), "Cannot load uncompressed pixel data into a compressed texture!");
 
 	_description.FormatHint = format;
 	_pixelType = type;
@@ -147,29 +213,73 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 }
 
 void Texture2D::_LoadDataFromFile() {
+	stbi_set_flip_vertically_on_load(true);
+	if (StreamDecode()) {
+		StreamFinalize();
+	} else {
+		LOG_WARN("Failed to load image from \"{}\"", _description.Filename);
+	}
+}
+
+bool Texture2D::StreamDecode() {
+	// Note that this may be on a worker thread, so no OpenGL calls are allowed here, and we
+	// rely on the resource manager having set the vertical flip flag up front
+	if (_description.Filename.empty()) {
+		return true;
+	}
+
+	// DDS and KTX2 files already contain the final GPU data, so we just need to read them in
+	if (CompressedImage::IsCompressedImageFile(_description.Filename)) {
+		_streamCompressed = CompressedImage::LoadFromFile(_description.Filename);
+		return _streamCompressed != nullptr;
+	}
+
+	const int targetChannels = GetTexelComponentCount(_description.FormatHint);
+	_streamPixels = stbi_load(_description.Filename.c_str(), &_streamWidth, &_streamHeight, &_streamChannels, targetChannels);
+
+	// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
+	if (targetChannels != 0) {
+		_streamChannels = targetChannels;
+	}
+
+	if (_streamPixels == nullptr) {
+		return false;
+	}
+
+	// stb can't decode into memory we give it, so we copy the image into the upload ring here on the
+	// worker rather than on the main thread. If the ring is full we just keep the stb image around
+	size_t bytes = (size_t)_streamWidth * _streamHeight * _streamChannels;
+	_streamStaging = TextureUploader::Allocate(bytes);
+	if (_streamStaging.IsValid()) {
+		memcpy(_streamStaging.Data, _streamPixels, bytes);
+		stbi_image_free(_streamPixels);
+		_streamPixels = nullptr;
+	}
+
+	return true;
+}
+
+size_t Texture2D::GetStreamUploadSize() const {
+	if (_streamCompressed != nullptr) {
+		return _streamCompressed->GetDataSize();
+	}
+	return (size_t)_streamWidth * _streamHeight * _streamChannels;
+}
+
+void Texture2D::StreamFinalize() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
-	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
-		int width, height, numChannels;
-		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
-
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
-
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
-			return ;
-		}
+	if (_streamCompressed != nullptr) {
+		_UploadCompressed(_streamCompressed);
+		_streamCompressed = nullptr;
+	}
+	else if (_streamPixels != nullptr || _streamStaging.IsValid()) {
+		int width       = _streamWidth;
+		int height      = _streamHeight;
+		int numChannels = _streamChannels;
 
 		// We should estimate a good format for our data
 
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
-
 		// We'll determine a recommended format for the image based on number of channels
 		// We hinted that we wanted a certain number of channels, but we're not guaranteed
 		// that all those channels exist (ex: loading an RGB image but requesting RGBA)
@@ -189,11 +299,17 @@ void Texture2D::_LoadDataFromFile() {
 		// Allocates our memory
 		_SetTextureParams();
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
+		// Upload data to our texture, either from the upload ring or the STBI data
+		if (_streamStaging.IsValid()) {
+			LoadData(width, height, image_format, PixelType::UByte, TextureUploader::BeginUpload(_streamStaging));
+			TextureUploader::EndUpload(_streamStaging);
+		} else {
+			LoadData(width, height, image_format, PixelType::UByte, _streamPixels);
 
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
+			// We now have data in the image, we can clear the STBI data
+			stbi_image_free(_streamPixels);
+			_streamPixels = nullptr;
+		}
 	}
 	
 	SetDebugName(_description.Filename);
@@ -217,7 +333,7 @@ void Texture2D::_SetTextureParams() {
 		// If the texture is NOT multisampled, we proceed as normal
 		if (_description.MultisampleCount == 1) {
 			// Calculate how many layers of storage to allocate based on whether mipmaps are enabled or not
-			int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1;
+			int layers = _numLevels > 0 ? _numLevels : _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1;
 			// Allocates the memory for our texture
 			glTextureStorage2D(_rendererId, layers, (GLenum)_description.Format, _description.Width, _description.Height);
 
@@ -235,6 +351,29 @@ void Texture2D::_SetTextureParams() {
 	}
 }
 
+void Texture2D::_UploadCompressed(const CompressedImage::Sptr& image) {
+	const std::vector<CompressedImage::MipLevel>& levels = image->GetLevels();
+
+	// Update our description to match what we loaded, we'll only allocate the levels that
+	// are in the file
+	_description.Format = image->GetFormat();
+	_description.Width  = image->GetWidth();
+	_description.Height = image->GetHeight();
+	_numLevels = static_cast<int>(levels.size());
+
+	// Allocates our memory
+	_SetTextureParams();
+
+	// If the file has a partial mip chain, we need to tell GL or the texture will be incomplete
+	glTextureParameteri(_rendererId, GL_TEXTURE_MAX_LEVEL, _numLevels - 1);
+
+	for (int ix = 0; ix < _numLevels; ix++) {
+		const CompressedImage::MipLevel& level = levels[ix];
+		glCompressedTextureSubImage2D(_rendererId, ix, 0, 0, level.Width, level.Height, *_description.Format,
+			static_cast<GLsizei>(level.Size), image->GetLevelData(ix));
+	}
+}
+
 Texture2D::Sptr Texture2D::LoadFromFile(const std::string& path, const Texture2DDescription& description, bool forceRgba) {
 	// Create a copy of the description and change filename to the path
 	Texture2DDescription desc = description;
@@ -1,5 +1,7 @@
 #pragma once
 #include "ITexture.h"
+#include "Graphics/Textures/CompressedImage.h"
+#include "Graphics/TextureUploader.h"
 
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
@@ -80,7 +82,7 @@ public:
 	DEFINE_RESOURCE(Texture2D)
 
 	// Make sure we mark our destructor as virtual so base class is called
-	virtual ~Texture2D() = default;
+	virtual ~Texture2D();
 
 public:
 	Texture2D(const std::string& filePath);
@@ -122,7 +124,12 @@ public:
 	void SetAnisoLevel(float value);
 
 	/// <summary>
-	/// Loads a region of data into this texture
+	/// Returns true if this texture was loaded from a block compressed (DDS or KTX2) file
+	/// </summary>
+	bool IsCompressed() const { return IsCompressedFormat(_description.Format); }
+
+	/// <summary>
+	/// Loads a region of data into this texture, not supported for compressed textures
 	/// Bounds must be contained by the bounds of the texture
 	/// format and type must be convertible to the texture's internal format
 	/// </summary>
@@ -143,11 +150,34 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Creates a texture from JSON without loading it's image, the image will be
+	/// loaded when the resource manager streams it in
+	/// </summary>
+	static Texture2D::Sptr FromJsonDeferred(const nlohmann::json& data);
+
+	virtual bool StreamDecode() override;
+	virtual void StreamFinalize() override;
+	virtual size_t GetGpuMemoryUsage() const override;
+	virtual size_t GetStreamUploadSize() const override;
 
 protected:
 	Texture2DDescription _description;
 	PixelType _pixelType;
 
+	// Image data that has been decoded by StreamDecode, but not uploaded yet
+	uint8_t* _streamPixels;
+	int      _streamWidth;
+	int      _streamHeight;
+	int      _streamChannels;
+	// If there was space in the upload ring, the decoded image is copied here instead of being kept in _streamPixels
+	TextureUploader::Staging _streamStaging;
+	// Block compressed image that has been loaded by StreamDecode, but not uploaded yet
+	CompressedImage::Sptr _streamCompressed;
+
+	// The number of mip levels to allocate, or 0 to determine it from GenerateMipMaps
+	int _numLevels;
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
@@ -157,6 +187,10 @@ protected:
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
+	/// <summary>
+	/// Allocates our texture's memory to match a compressed image, and uploads all of it's mip levels
+	/// </summary>
+	void _UploadCompressed(const CompressedImage::Sptr& image);
 
 public:
 	static Texture2D::Sptr LoadFromFile(const std::string& path, const Texture2DDescription& description = Texture2DDescription(), bool forceRgba = true);
@@ -1,11 +1,17 @@
 #include "TextureCube.h"
 #include <filesystem>
+#include <future>
+#include <cstring>
 #include "stb_image.h"
 #include "Utils/JsonGlmHelpers.h"
 
 TextureCube::TextureCube(const std::string& baseFilename) :
 	ITexture(TextureType::Cubemap),
-	_description(TextureCubeDescription())
+	_description(TextureCubeDescription()),
+	_streamSize(0),
+	_streamChannels(0),
+	_streamStaging(),
+	_streamData()
 {
 	_description.Filename = baseFilename;
 	_LoadFromDescription();
@@ -13,7 +19,11 @@ TextureCube::TextureCube(const std::string& baseFilename) :
 
 TextureCube::TextureCube(const std::unordered_map<CubeMapFace, std::string>& faceFilenames) :
 	ITexture(TextureType::Cubemap),
-	_description(TextureCubeDescription())
+	_description(TextureCubeDescription()),
+	_streamSize(0),
+	_streamChannels(0),
+	_streamStaging(),
+	_streamData()
 {
 	_description.FaceFileNames = faceFilenames;
 	_LoadFromDescription();
@@ -21,11 +31,23 @@ TextureCube::TextureCube(const std::unordered_map<CubeMapFace, std::string>& fac
 
 TextureCube::TextureCube(const TextureCubeDescription& description) :
 	ITexture(TextureType::Cubemap),
-	_description(description)
+	_description(description),
+	_streamSize(0),
+	_streamChannels(0),
+	_streamStaging(),
+	_streamData()
 {
 	_LoadFromDescription();
 }
 
+TextureCube::~TextureCube()
+{
+	// If we were destroyed part way through streaming, give back our part of the upload ring
+	if (_streamStaging.IsValid()) {
+		TextureUploader::Cancel(_streamStaging);
+	}
+}
+
 nlohmann::json TextureCube::ToJson() const
 {
 	nlohmann::json result;
@@ -45,6 +67,26 @@ nlohmann::json TextureCube::ToJson() const
 }
 
 TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
+{
+	return std::make_shared<TextureCube>(_ParseDescription(data));
+}
+
+TextureCube::Sptr TextureCube::FromJsonDeferred(const nlohmann::json& data)
+{
+	// Create the cubemap without any files so that the constructor doesn't load it, then
+	// restore the files for StreamDecode
+	TextureCubeDescription descr = _ParseDescription(data);
+	TextureCubeDescription placeholder = descr;
+	placeholder.Filename = "";
+	placeholder.FaceFileNames.clear();
+
+	TextureCube::Sptr result = std::make_shared<TextureCube>(placeholder);
+	result->_description.Filename = descr.Filename;
+	result->_description.FaceFileNames = descr.FaceFileNames;
+	return result;
+}
+
+TextureCubeDescription TextureCube::_ParseDescription(const nlohmann::json& data)
 {
 	TextureCubeDescription descr = TextureCubeDescription();
 	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
@@ -58,10 +100,23 @@ TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
 			}
 		}
 	}
-	return std::make_shared<TextureCube>(descr);
+	return descr;
 }
 
 void TextureCube::_LoadFromDescription()
+{
+	// Cubemaps that are created for streaming won't have any files yet
+	if (_description.FaceFileNames.empty() && _description.Filename.empty()) {
+		return;
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+	if (StreamDecode()) {
+		StreamFinalize();
+	}
+}
+
+void TextureCube::_ResolveFaceFilenames()
 {
 	// If we weren't passed face filenames but WERE passed a base filename, try and get the 6 face files
 	if (_description.FaceFileNames.empty() && !_description.Filename.empty()) {
@@ -87,83 +142,102 @@ void TextureCube::_LoadFromDescription()
 			}
 		}
 	}
+}
+
+bool TextureCube::StreamDecode()
+{
+	// Note that this may be on a worker thread, so no OpenGL calls are allowed here, and we
+	// rely on the vertical flip flag having been set up front
+	_ResolveFaceFilenames();
 
 	// If we don't have 6 faces for our cube, something has gone horribly wrong (or the files don't exist)
 	if (_description.FaceFileNames.size() != 6) {
 		LOG_ERROR("TextureCube was not given 6 faces, aborting load");
-		return;
+		return false;
 	}
 
-	// Load all the images into the texture
-	_LoadImages(_description.FaceFileNames);
-}
+	struct FaceImage {
+		uint8_t* Data     = nullptr;
+		int      Width    = 0;
+		int      Height   = 0;
+		int      Channels = 0;
+	};
 
-void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames)
-{
-	// Will store all of our texture data, back to back in memory
-	uint8_t* datastore = nullptr;
-	// The size of a single face's texture, in bytes
-	size_t textureDataSize = 0;
-
-	// The number of channels that we're expecting
-	int numChannels = 0;
-
-	// Load all 6 faces
+	// The faces don't depend on each other, so we can decode all 6 at once
+	std::future<FaceImage> futures[6];
 	for (int ix = 0; ix < 6; ix++) {
-		CubeMapFace face = (CubeMapFace)ix;
-		
-		const std::string& filename = _description.FaceFileNames[face];
-		int fileWidth, fileHeight, fileNumChannels;
-
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
-
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			if (data != nullptr) { delete[] datastore; }
+		const std::string& filename = _description.FaceFileNames[(CubeMapFace)ix];
+		futures[ix] = std::async(std::launch::async, [filename]() {
+			FaceImage result;
+			result.Data = stbi_load(filename.c_str(), &result.Width, &result.Height, &result.Channels, 0);
+			return result;
+		});
+	}
+	FaceImage faces[6];
+	for (int ix = 0; ix < 6; ix++) {
+		faces[ix] = futures[ix].get();
+	}
+
+	// Make sure that all the faces loaded, are square, and match the first face
+	bool success = true;
+	for (int ix = 0; ix < 6 && success; ix++) {
+		const std::string& filename = _description.FaceFileNames[(CubeMapFace)ix];
+		if (faces[ix].Data == nullptr) {
 			LOG_ERROR("STBI Failed to load image from \"{}\"", filename);
-			return;
+			success = false;
 		}
-		// If the texture is not square, warn and abort
-		if (fileWidth != fileHeight) {
-			if (data != nullptr) { delete[] datastore; }
+		else if (faces[ix].Width != faces[ix].Height) {
 			LOG_ERROR("Image loaded from \"{}\" was not square", filename);
-			stbi_image_free(data);
-			return;
+			success = false;
 		}
-		// If the dataStore is empty, this is the first texture we loaded
-		if (datastore == nullptr) {
-			// Store the size and number of channels
-			_description.Size = fileWidth;
-			numChannels = fileNumChannels;
-
-			// Get the format and pixel format for the number of channels
-			_description.Format = GetInternalFormatForChannels8(numChannels);
-			_description.FormatHint = GetPixelFormatForChannels(numChannels);
-
-			// Determine how many bytes we'll need to store a single face worth of data
-			textureDataSize = ((size_t)_description.Size * _description.Size * GetTexelSize(_description.FormatHint, PixelType::Byte));
-
-			// This is one of those poorly documented things in OpenGL
-			if ((GetTexelSize(_description.FormatHint, PixelType::Byte) * _description.Size) % 4 != 0) {
-				LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
-			}
+		else if (faces[ix].Width != faces[0].Width || faces[ix].Channels != faces[0].Channels) {
+			LOG_WARN("Image \"{}\" did not match size or format of texture cube", filename);
+			success = false;
+		}
+	}
 
-			// Allocate the data store for our image data
-			datastore = new uint8_t[textureDataSize * 6];
+	if (success) {
+		_streamSize = faces[0].Width;
+		_streamChannels = faces[0].Channels;
+
+		// Copy all the faces back to back into the upload ring, or into client memory if the ring is full
+		size_t faceDataSize = (size_t)_streamSize * _streamSize * _streamChannels;
+		uint8_t* datastore = nullptr;
+		_streamStaging = TextureUploader::Allocate(faceDataSize * 6);
+		if (_streamStaging.IsValid()) {
+			datastore = _streamStaging.Data;
+		} else {
+			_streamData.resize(faceDataSize * 6);
+			datastore = _streamData.data();
 		}
-		// If this is NOT the first image, and it does not match previous images, abort
-		else if (fileWidth != _description.Size || fileNumChannels != numChannels) {
-			delete[] datastore;
-			LOG_WARN("Image \"{}\" did not match size or format of texture cube", filename);
-			stbi_image_free(data);
-			return;
+		for (int ix = 0; ix < 6; ix++) {
+			memcpy(datastore + faceDataSize * ix, faces[ix].Data, faceDataSize);
 		}
+	}
 
-		// Copy the data we loaded into the corresponding location in the data store
-		memcpy(datastore + textureDataSize * ix, data, textureDataSize);
-		stbi_image_free(data);
+	for (int ix = 0; ix < 6; ix++) {
+		if (faces[ix].Data != nullptr) {
+			stbi_image_free(faces[ix].Data);
+		}
+	}
+
+	return success;
+}
+
+void TextureCube::StreamFinalize()
+{
+	if (!_streamStaging.IsValid() && _streamData.empty()) {
+		return;
+	}
+
+	// Get the format and pixel format for the number of channels
+	_description.Size = _streamSize;
+	_description.Format = GetInternalFormatForChannels8(_streamChannels);
+	_description.FormatHint = GetPixelFormatForChannels(_streamChannels);
+
+	// This is one of those poorly documented things in OpenGL
+	if ((GetTexelSize(_description.FormatHint, PixelType::Byte) * _description.Size) % 4 != 0) {
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
 	}
 
 	// Allocate memory and set up initial parameters
@@ -173,8 +247,19 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
 	// Upload our data to our image (note that the custom enum tools let us convert to base type [GLenum] with the * operator)
-	glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, datastore);
-	delete[] datastore;
+	if (_streamStaging.IsValid()) {
+		glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, TextureUploader::BeginUpload(_streamStaging));
+		TextureUploader::EndUpload(_streamStaging);
+	} else {
+		glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, _streamData.data());
+		// Release the memory rather than just clearing it
+		std::vector<uint8_t>().swap(_streamData);
+	}
+}
+
+size_t TextureCube::GetStreamUploadSize() const
+{
+	return (size_t)_streamSize * _streamSize * _streamChannels * 6;
 }
 
 void TextureCube::_SetTextureParams(){
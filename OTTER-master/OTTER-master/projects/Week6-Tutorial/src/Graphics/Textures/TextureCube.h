@@ -1,6 +1,7 @@
 #pragma once
 #include <EnumToString.h>
 #include "ITexture.h"
+#include "Graphics/TextureUploader.h"
 
 /*
 0 	GL_TEXTURE_CUBE_MAP_POSITIVE_X
@@ -78,7 +79,7 @@ public:
 	DEFINE_RESOURCE(TextureCube);
 
 	// Make sure we mark our destructor as virtual so base class is called
-	virtual ~TextureCube() = default;
+	virtual ~TextureCube();
 
 public:
 	TextureCube(const std::string& baseFilename);
@@ -110,12 +111,33 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static TextureCube::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Creates a cubemap from JSON without loading it's faces, the faces will be
+	/// loaded when the resource manager streams it in
+	/// </summary>
+	static TextureCube::Sptr FromJsonDeferred(const nlohmann::json& data);
+
+	virtual bool StreamDecode() override;
+	virtual void StreamFinalize() override;
+	virtual size_t GetStreamUploadSize() const override;
 
 protected:
 	TextureCubeDescription _description;
 
+	// The face size and channel count that StreamDecode loaded, but has not uploaded yet
+	uint32_t _streamSize;
+	int      _streamChannels;
+	// All 6 faces back to back, either in the upload ring or in client memory if the ring was full
+	TextureUploader::Staging _streamStaging;
+	std::vector<uint8_t>     _streamData;
+
+	static TextureCubeDescription _ParseDescription(const nlohmann::json& data);
+
 	virtual void _LoadFromDescription();
-	virtual void _LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames);
+	/// <summary>
+	/// Fills in the face filenames from the base filename, if the face filenames were not provided
+	/// </summary>
+	void _ResolveFaceFilenames();
 
 	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
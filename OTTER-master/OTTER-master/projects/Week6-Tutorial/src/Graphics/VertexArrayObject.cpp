@@ -103,6 +103,11 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 
 void VertexArrayObject::Draw(DrawMode mode) {
 	Bind();
+	DrawBound(mode);
+	Unbind();
+}
+
+void VertexArrayObject::DrawBound(DrawMode mode) {
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArrays((GLenum)mode, 0, elements);
@@ -110,12 +115,17 @@ void VertexArrayObject::Draw(DrawMode mode) {
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
 		glDrawElements((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr);
 	}
-	Unbind();
 }
 
 void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
 {
 	Bind();
+	DrawInstancedBound(instanceCount, mode);
+	Unbind();
+}
+
+void VertexArrayObject::DrawInstancedBound(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
+{
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArraysInstanced((GLenum)mode, 0, elements, instanceCount);
@@ -124,8 +134,6 @@ void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*=
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
 		glDrawElementsInstanced((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount);
 	}
-	Unbind();
-	
 }
 
 void VertexArrayObject::Bind() {
@@ -163,6 +171,14 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::GetBufferBinding(Attr
 	return nullptr;
 }
 
+size_t VertexArrayObject::GetTotalBufferSize() const {
+	size_t result = _indexBuffer != nullptr ? _indexBuffer->GetTotalSize() : 0;
+	for (const auto& binding : _vertexBuffers) {
+		result += binding->Buffer != nullptr ? binding->Buffer->GetTotalSize() : 0;
+	}
+	return result;
+}
+
 VertexArrayObject::Sptr VertexArrayObject::Clone() const
 {
 	VertexArrayObject::Sptr result = Create();
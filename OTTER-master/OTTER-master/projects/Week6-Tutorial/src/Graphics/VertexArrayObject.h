@@ -88,6 +88,10 @@ public:
 	uint32_t GetVertexCount() const { return _vertexCount; }
 	uint32_t GetIndexCount() const { return _indexBuffer != nullptr ? _indexBuffer->GetElementCount() : 0; }
 	uint32_t GetElementCount() const { return _elementCount; }
+	/// <summary>
+	/// Gets the total size in bytes of the index and vertex buffers attached to this VAO
+	/// </summary>
+	size_t GetTotalBufferSize() const;
 
 	/// <summary>
 	/// Creates a copy of this VAO pointing to the same buffers, with the same attributes
@@ -134,6 +138,20 @@ public:
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
 	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
 
+	/// <summary>
+	/// Renders this VAO without binding or unbinding it. The VAO must already be bound
+	/// via Bind(), this lets us issue many draws with the same VAO without re-binding
+	/// </summary>
+	/// <param name="mode">The draw mode for primitives in this VAO</param>
+	void DrawBound(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders this VAO with the given instance count without binding or unbinding it.
+	/// The VAO must already be bound via Bind()
+	/// </summary>
+	/// <param name="instanceCount">The number of instances to render</param>
+	/// <param name="mode">The primitive mode for rendering the mesh</param>
+	void DrawInstancedBound(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
+
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
 	/// </summary>
@@ -5,6 +5,10 @@
 
 #include "Utils/StringUtils.h"
 
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
 std::string FileHelpers::ReadFile(const std::string& filename) {
 	std::string result;
 	std::ifstream in(filename, std::ios::in | std::ios::binary); // ifstream closes itself due to RAII
@@ -100,3 +104,14 @@ void FileHelpers::WriteContentsToFile(const std::string& filename, const std::st
 	std::ofstream output(filename, std::ios::out | (append ? std::ios::app : 0));
 	output << contents;
 }
+
+std::string FileHelpers::GetExecutableDirectory() {
+#ifdef _WIN32
+	char buffer[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+	if (length > 0 && length < MAX_PATH) {
+		return std::filesystem::path(buffer).parent_path().string();
+	}
+#endif
+	return std::filesystem::current_path().string();
+}
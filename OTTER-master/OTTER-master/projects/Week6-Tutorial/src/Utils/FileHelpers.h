@@ -29,4 +29,10 @@ public:
 	/// <param name="contents">The contents of the file to write</param>
 	/// <param name="append">True if contents should be appended to end of existing files</param>
 	static void WriteContentsToFile(const std::string& filename, const std::string& contents, bool append = false);
+
+	/// <summary>
+	/// Gets the directory that the running executable resides in, falling back to the
+	/// current working directory if it can't be determined
+	/// </summary>
+	static std::string GetExecutableDirectory();
 };
\ No newline at end of file
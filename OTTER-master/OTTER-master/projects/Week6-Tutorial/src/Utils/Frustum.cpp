@@ -0,0 +1,58 @@
+#include "Frustum.h"
+
+Frustum::Frustum() {
+	for (int ix = 0; ix < Plane::Count; ix++) {
+		Planes[ix] = glm::vec4(0.0f);
+	}
+}
+
+void Frustum::Extract(const glm::mat4& viewProjection) {
+	// GLM is column major, so we need to pull the rows out manually
+	glm::vec4 rows[4];
+	for (int ix = 0; ix < 4; ix++) {
+		rows[ix] = glm::vec4(viewProjection[0][ix], viewProjection[1][ix], viewProjection[2][ix], viewProjection[3][ix]);
+	}
+
+	// OpenGL clip space is [-w, w] on all axes
+	Planes[Plane::Left]   = rows[3] + rows[0];
+	Planes[Plane::Right]  = rows[3] - rows[0];
+	Planes[Plane::Bottom] = rows[3] + rows[1];
+	Planes[Plane::Top]    = rows[3] - rows[1];
+	Planes[Plane::Near]   = rows[3] + rows[2];
+	Planes[Plane::Far]    = rows[3] - rows[2];
+
+	// Normalize the planes so that the distances are in world units
+	for (int ix = 0; ix < Plane::Count; ix++) {
+		float length = glm::length(glm::vec3(Planes[ix]));
+		if (length > 0.0f) {
+			Planes[ix] /= length;
+		}
+	}
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const {
+	for (int ix = 0; ix < Plane::Count; ix++) {
+		const glm::vec4& plane = Planes[ix];
+
+		// Select the corner of the box that is furthest along the plane's normal, if
+		// even that corner is behind the plane then the whole box is outside
+		glm::vec3 positive = glm::vec3(
+			plane.x >= 0.0f ? max.x : min.x,
+			plane.y >= 0.0f ? max.y : min.y,
+			plane.z >= 0.0f ? max.z : min.z
+		);
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::ContainsPoint(const glm::vec3& point) const {
+	for (int ix = 0; ix < Plane::Count; ix++) {
+		if (glm::dot(glm::vec3(Planes[ix]), point) + Planes[ix].w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Represents the 6 planes of a camera's view volume, in world space
+///
+/// Each plane is stored as (normal, distance), with the normal pointing into
+/// the frustum, so a point p is on the inside of a plane when
+///    dot(plane.xyz, p) + plane.w >= 0
+/// </summary>
+struct Frustum {
+	enum Plane {
+		Left   = 0,
+		Right  = 1,
+		Bottom = 2,
+		Top    = 3,
+		Near   = 4,
+		Far    = 5,
+		Count  = 6
+	};
+
+	glm::vec4 Planes[Plane::Count];
+
+	Frustum();
+
+	/// <summary>
+	/// Extracts the frustum planes from a view-projection matrix (Gribb/Hartmann method)
+	/// </summary>
+	/// <param name="viewProjection">The combined view-projection matrix of the camera</param>
+	void Extract(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Returns true if the axis aligned bounding box is at least partially inside the frustum
+	/// Note that this is conservative, some boxes near the corners of the frustum will be
+	/// reported as visible even though they are not
+	/// </summary>
+	/// <param name="min">The minimum corner of the box, in world space</param>
+	/// <param name="max">The maximum corner of the box, in world space</param>
+	bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+
+	/// <summary>
+	/// Returns true if the point is inside the frustum
+	/// </summary>
+	/// <param name="point">The point to test, in world space</param>
+	bool ContainsPoint(const glm::vec3& point) const;
+};
@@ -0,0 +1,154 @@
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+
+#include "Logging.h"
+
+std::vector<std::unique_ptr<JobSystem::Worker>> JobSystem::_workers;
+std::mutex JobSystem::_wakeMutex;
+std::condition_variable JobSystem::_wakeCondition;
+std::atomic<size_t> JobSystem::_queuedJobs(0);
+std::atomic<bool> JobSystem::_stopWorkers(false);
+std::atomic<size_t> JobSystem::_nextWorker(0);
+thread_local int JobSystem::_workerIndex = -1;
+
+void JobSystem::Init(int threadCount) {
+	LOG_ASSERT(_workers.empty(), "Job system has already been initialized!");
+
+	// By default we leave one core free, since the main thread helps out while it waits
+	if (threadCount <= 0) {
+		threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+
+	_stopWorkers = false;
+	_queuedJobs = 0;
+
+	// Create all the workers before starting any threads, so that stealing never sees a partial list
+	for (int ix = 0; ix < threadCount; ix++) {
+		_workers.push_back(std::make_unique<Worker>());
+	}
+	for (int ix = 0; ix < threadCount; ix++) {
+		_workers[ix]->Thread = std::thread(&JobSystem::_WorkerThread, ix);
+	}
+
+	LOG_INFO("Started job system with {} worker threads", threadCount);
+}
+
+void JobSystem::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_stopWorkers = true;
+	}
+	_wakeCondition.notify_all();
+
+	for (auto& worker : _workers) {
+		worker->Thread.join();
+	}
+	_workers.clear();
+	_queuedJobs = 0;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t chunkSize, const RangeFunc& func) {
+	if (count == 0) {
+		return;
+	}
+	chunkSize = std::max<size_t>(chunkSize, 1);
+
+	// Not worth the overhead of waking the workers, or there are none to wake
+	if (_workers.empty() || count <= chunkSize) {
+		func(0, count);
+		return;
+	}
+
+	// The counter lives on our stack, which is safe since we don't return until it reaches 0
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	std::atomic<size_t> remaining(chunkCount);
+
+	for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+		size_t begin = chunk * chunkSize;
+		size_t end = std::min(begin + chunkSize, count);
+		_Push([&func, &remaining, begin, end]() {
+			func(begin, end);
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	// Help out until all of our chunks are done, this is the barrier for the calling thread
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (!_TryRunJob(_workerIndex)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::_WorkerThread(int index) {
+	_workerIndex = index;
+	while (true) {
+		if (_TryRunJob(index)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_wakeMutex);
+		_wakeCondition.wait(lock, []() { return _stopWorkers || _queuedJobs > 0; });
+		if (_stopWorkers) {
+			return;
+		}
+	}
+}
+
+void JobSystem::_Push(Job&& job) {
+	// Workers push to their own deque so nested work stays local, anything else gets spread round robin
+	size_t target = _workerIndex >= 0 ?
+		static_cast<size_t>(_workerIndex) :
+		_nextWorker.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+
+	Worker& worker = *_workers[target];
+	{
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		worker.Jobs.push_back(std::move(job));
+	}
+
+	// Take the wake lock before notifying, so a worker can't miss the job between checking and sleeping
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_queuedJobs++;
+	}
+	_wakeCondition.notify_one();
+}
+
+bool JobSystem::_TryRunJob(int index) {
+	Job job;
+	size_t workerCount = _workers.size();
+
+	// Our own deque is used like a stack, since the most recent jobs are the most likely to be in cache
+	if (index >= 0) {
+		Worker& worker = *_workers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (!worker.Jobs.empty()) {
+			job = std::move(worker.Jobs.back());
+			worker.Jobs.pop_back();
+		}
+	}
+
+	// Steal the oldest job from someone else, starting with our neighbour so that thieves spread out
+	for (size_t offset = 1; !job && offset <= workerCount; offset++) {
+		size_t victim = (static_cast<size_t>(index + 1) + offset - 1) % workerCount;
+		if (static_cast<int>(victim) == index) {
+			continue;
+		}
+		Worker& worker = *_workers[victim];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (!worker.Jobs.empty()) {
+			job = std::move(worker.Jobs.front());
+			worker.Jobs.pop_front();
+		}
+	}
+
+	if (!job) {
+		return false;
+	}
+
+	_queuedJobs--;
+	job();
+	return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <condition_variable>
+
+/// <summary>
+/// A small work stealing job system, used to spread per-frame work (like component updates)
+/// across all of the CPU cores
+///
+/// The system owns a fixed pool of worker threads, each with it's own deque of jobs. Workers
+/// take jobs from the back of their own deque, and when it runs dry they steal from the front
+/// of the other workers' deques. The thread that submits work helps run jobs until it has
+/// finished, so calls like ParallelFor act as a barrier for the calling thread
+///
+/// If the system has not been initialized, all work runs inline on the calling thread
+///
+/// Usage:
+///    JobSystem::ParallelFor(items.size(), 64, [&](size_t begin, size_t end) {
+///        for (size_t ix = begin; ix < end; ix++) { Process(items[ix]); }
+///    });
+/// </summary>
+class JobSystem {
+public:
+	typedef std::function<void()> Job;
+	typedef std::function<void(size_t begin, size_t end)> RangeFunc;
+
+	/// <summary>
+	/// Starts the worker threads, must be called from the main thread
+	/// </summary>
+	/// <param name="threadCount">The number of worker threads, or 0 to pick based on the number of CPU cores</param>
+	static void Init(int threadCount = 0);
+	/// <summary>
+	/// Stops the worker threads, any jobs that have not started yet are discarded
+	/// </summary>
+	static void Shutdown();
+	/// <summary>
+	/// Returns true if the worker threads have been started
+	/// </summary>
+	static bool IsInitialized() { return !_workers.empty(); }
+	/// <summary>
+	/// Gets the number of worker threads, not including the thread that submits work
+	/// </summary>
+	static int GetWorkerCount() { return static_cast<int>(_workers.size()); }
+
+	/// <summary>
+	/// Splits the range [0, count) into chunks and invokes func for each chunk across the worker
+	/// threads. Blocks until every chunk has completed, with the calling thread running jobs while
+	/// it waits. Chunks may run in any order, so func must not depend on the order of iteration
+	/// </summary>
+	/// <param name="count">The number of items to iterate over</param>
+	/// <param name="chunkSize">The maximum number of items handed to a single invocation of func</param>
+	/// <param name="func">The function to invoke with the [begin, end) range of each chunk</param>
+	static void ParallelFor(size_t count, size_t chunkSize, const RangeFunc& func);
+
+	static const size_t DEFAULT_CHUNK_SIZE = 256;
+
+private:
+	struct Worker {
+		std::deque<Job> Jobs;
+		std::mutex      Mutex;
+		std::thread     Thread;
+	};
+
+	static std::vector<std::unique_ptr<Worker>> _workers;
+	// Guards sleeping and waking workers, the job deques have their own locks
+	static std::mutex              _wakeMutex;
+	static std::condition_variable _wakeCondition;
+	// The number of jobs sitting in any deque, so sleeping workers know when to wake up
+	static std::atomic<size_t>     _queuedJobs;
+	static std::atomic<bool>       _stopWorkers;
+	// Where the next submitted job is pushed, so that work is spread over every deque
+	static std::atomic<size_t>     _nextWorker;
+
+	// The index of the worker running on this thread, or -1 for threads outside of the pool
+	static thread_local int _workerIndex;
+
+	static void _WorkerThread(int index);
+	static void _Push(Job&& job);
+	/// <summary>
+	/// Runs a single job, preferring the given worker's own deque and stealing from the others
+	/// </summary>
+	/// <returns>True if a job was run, false if every deque was empty</returns>
+	static bool _TryRunJob(int index);
+};
@@ -0,0 +1,102 @@
+#include "Utils/MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile() :
+	_data(nullptr),
+	_size(0),
+#ifdef _WIN32
+	_fileHandle(INVALID_HANDLE_VALUE),
+	_mappingHandle(nullptr)
+#else
+	_fileDescriptor(-1)
+#endif
+{ }
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filename) {
+	Close();
+
+#ifdef _WIN32
+	_fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_fileHandle, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	_mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mappingHandle == nullptr) {
+		Close();
+		return false;
+	}
+
+	_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	_size = static_cast<size_t>(size.QuadPart);
+#else
+	_fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (_fileDescriptor < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(_fileDescriptor, &info) != 0 || info.st_size == 0) {
+		Close();
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+	if (mapping != MAP_FAILED) {
+		// We read meshes start to finish, so let the kernel read ahead
+		madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+		_data = reinterpret_cast<const uint8_t*>(mapping);
+		_size = static_cast<size_t>(info.st_size);
+	}
+#endif
+
+	if (_data == nullptr) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(_mappingHandle);
+		_mappingHandle = nullptr;
+	}
+	if (_fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(_fileHandle);
+		_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (_data != nullptr) {
+		munmap(const_cast<uint8_t*>(_data), _size);
+	}
+	if (_fileDescriptor >= 0) {
+		close(_fileDescriptor);
+		_fileDescriptor = -1;
+	}
+#endif
+	_data = nullptr;
+	_size = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <memory>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Maps an entire file into memory as read-only, so that it can be read without
+/// copying it into a heap buffer first. The mapping is released when the object
+/// is destroyed or Close is called
+/// </summary>
+class MappedFile {
+public:
+	MAKE_PTRS(MappedFile);
+	NO_COPY(MappedFile);
+	NO_MOVE(MappedFile);
+
+	MappedFile();
+	~MappedFile();
+
+	/// <summary>
+	/// Opens and maps the given file, closing any file that is already mapped
+	/// </summary>
+	/// <param name="filename">The path of the file to map</param>
+	/// <returns>True if the file was mapped, false if it could not be opened or is empty</returns>
+	bool Open(const std::string& filename);
+	/// <summary>
+	/// Releases the mapping and closes the underlying file
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// Gets a pointer to the start of the mapped file, or nullptr if nothing is mapped
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the mapped file in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+	/// <summary>
+	/// Returns true if a file is currently mapped
+	/// </summary>
+	bool IsOpen() const { return _data != nullptr; }
+
+protected:
+	const uint8_t* _data;
+	size_t         _size;
+
+#ifdef _WIN32
+	void* _fileHandle;
+	void* _mappingHandle;
+#else
+	int   _fileDescriptor;
+#endif
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
+#include <Logging.h>
 #include "Graphics/VertexArrayObject.h"
+#include "Utils/MeshOptimizer.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -116,18 +118,58 @@ public:
 	/// </summary>
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
+	/// <summary>
+	/// Re-orders the triangles and vertices in this mesh so that it makes better use of the GPU's vertex
+	/// cache, the set of triangles in the mesh is unchanged. Has no effect on meshes without indices
+	/// </summary>
+	/// <param name="flags">The optimizations to apply, only VertexCache and VertexFetch are used</param>
+	void Optimize(MeshOptimizeFlags flags = MeshOptimizeFlags::VertexCache | MeshOptimizeFlags::VertexFetch) {
+		if (_indices.size() == 0) {
+			return;
+		}
+
+		float acmrBefore = MeshOptimizer::CalculateACMR(_indices.data(), _indices.size(), _vertices.size());
+
+		// Order the triangles first, since the vertex order depends on the order they are used in
+		if (*(flags & MeshOptimizeFlags::VertexCache)) {
+			MeshOptimizer::OptimizeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		}
+		if (*(flags & MeshOptimizeFlags::VertexFetch)) {
+			std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(_indices.data(), _indices.size(), _vertices.size());
+			std::vector<VertType> reordered(_vertices.size());
+			for (size_t ix = 0; ix < _vertices.size(); ix++) {
+				reordered[remap[ix]] = _vertices[ix];
+			}
+			_vertices.swap(reordered);
+		}
+
+		float acmrAfter = MeshOptimizer::CalculateACMR(_indices.data(), _indices.size(), _vertices.size());
+		LOG_TRACE("Optimized mesh with {} triangles, ACMR {:.3f} -> {:.3f}", GetTriangleCount(), acmrBefore, acmrAfter);
+	}
+
 	/// <summary>
 	/// Creates and returns a VertexArraybject from the current data
 	/// </summary>
+	/// <param name="flags">The optimizations to apply to the mesh before it is uploaded, by default the mesh is uploaded as is</param>
 	/// <returns>A VertexArrayObject</returns>
-	VertexArrayObject::Sptr Bake() {
+	VertexArrayObject::Sptr Bake(MeshOptimizeFlags flags = MeshOptimizeFlags::None) {
+		if (*(flags & (MeshOptimizeFlags::VertexCache | MeshOptimizeFlags::VertexFetch))) {
+			Optimize(flags);
+		}
+
 		VertexBuffer::Sptr vbo = VertexBuffer::Create();
 		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
 
 		IndexBuffer::Sptr ebo = nullptr;
 		if (_indices.size() > 0) {
 			ebo = IndexBuffer::Create();
-			ebo->LoadData(GetIndexDataPtr(), _indices.size());
+			// If every index fits in 16 bits, we can halve the size of the index buffer
+			if (*(flags & MeshOptimizeFlags::ShortIndices) && _vertices.size() < 65536) {
+				std::vector<uint16_t> shortIndices(_indices.begin(), _indices.end());
+				ebo->LoadData(shortIndices.data(), shortIndices.size());
+			} else {
+				ebo->LoadData(GetIndexDataPtr(), _indices.size());
+			}
 		}
 
 		// Create VAO and attach the buffers
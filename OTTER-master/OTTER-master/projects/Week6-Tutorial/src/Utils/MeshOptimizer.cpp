@@ -0,0 +1,232 @@
+#include "Utils/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <Logging.h>
+
+namespace {
+	// The size of the LRU cache that Forsyth's algorithm models, and the scoring parameters from the paper
+	const int   FORSYTH_CACHE_SIZE  = 32;
+	const float CACHE_DECAY_POWER   = 1.5f;
+	const float LAST_TRI_SCORE      = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+	// Valence scores above this just use the last entry in the table
+	const int   MAX_VALENCE         = 64;
+
+	const uint32_t INVALID_INDEX = ~0u;
+
+	/// <summary>
+	/// Pre-calculates the score tables so we don't have to call pow in the inner loop
+	/// </summary>
+	struct ScoreTables {
+		float Cache[FORSYTH_CACHE_SIZE];
+		float Valence[MAX_VALENCE + 1];
+
+		ScoreTables() {
+			for (int ix = 0; ix < FORSYTH_CACHE_SIZE; ix++) {
+				// The vertices of the last triangle get a fixed score, so that we don't favor any particular winding
+				if (ix < 3) {
+					Cache[ix] = LAST_TRI_SCORE;
+				} else {
+					float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+					Cache[ix] = std::pow(1.0f - (ix - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+			Valence[0] = 0.0f;
+			for (int ix = 1; ix <= MAX_VALENCE; ix++) {
+				// Vertices with only a few triangles left get boosted, so we don't leave lone triangles behind
+				Valence[ix] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(ix), -VALENCE_BOOST_POWER);
+			}
+		}
+
+		float Score(int cachePosition, uint32_t activeTris) const {
+			// Vertices with no triangles left don't matter anymore
+			if (activeTris == 0) {
+				return -1.0f;
+			}
+			float score = cachePosition >= 0 ? Cache[cachePosition] : 0.0f;
+			return score + Valence[std::min<uint32_t>(activeTris, MAX_VALENCE)];
+		}
+	};
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	static const ScoreTables scores;
+
+	const size_t triCount = indexCount / 3;
+	if (triCount < 2 || !_ValidateIndices(indices, triCount * 3, vertexCount)) {
+		return;
+	}
+
+	// Build a list of the triangles that use each vertex. The first activeTris[v] entries in a vertex's
+	// list are the triangles that have not been output yet
+	std::vector<uint32_t> activeTris(vertexCount, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		activeTris[indices[ix]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		offsets[ix + 1] = offsets[ix] + activeTris[ix];
+	}
+	std::vector<uint32_t> vertexTris(triCount * 3);
+	{
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t ix = 0; ix < triCount * 3; ix++) {
+			vertexTris[cursor[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	// Calculate our starting scores, nothing is in the cache yet
+	std::vector<int>   cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = scores.Score(-1, activeTris[ix]);
+	}
+	std::vector<float> triScores(triCount);
+	std::vector<bool>  triAdded(triCount, false);
+	uint32_t bestTri = INVALID_INDEX;
+	float    bestScore = -1.0f;
+	for (size_t ix = 0; ix < triCount; ix++) {
+		triScores[ix] = vertexScores[indices[ix * 3]] + vertexScores[indices[ix * 3 + 1]] + vertexScores[indices[ix * 3 + 2]];
+		if (triScores[ix] > bestScore) {
+			bestScore = triScores[ix];
+			bestTri = static_cast<uint32_t>(ix);
+		}
+	}
+
+	// The modelled LRU cache, with room for the 3 vertices that get pushed in before we trim it
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	int      cacheCount = 0;
+
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+	// Where to resume scanning for an unused triangle if there are none connected to the cache
+	size_t scanCursor = 0;
+
+	for (size_t count = 0; count < triCount; count++) {
+		// If none of the triangles around the cache are left, just take the next unused triangle
+		if (bestTri == INVALID_INDEX) {
+			while (triAdded[scanCursor]) {
+				scanCursor++;
+			}
+			bestTri = static_cast<uint32_t>(scanCursor);
+		}
+
+		// Output the triangle, and remove it from the active lists of it's vertices
+		triAdded[bestTri] = true;
+		const uint32_t* tri = indices + bestTri * 3;
+		for (int ix = 0; ix < 3; ix++) {
+			uint32_t vert = tri[ix];
+			output.push_back(vert);
+
+			uint32_t* list = vertexTris.data() + offsets[vert];
+			uint32_t* end = list + activeTris[vert];
+			uint32_t* it = std::find(list, end, bestTri);
+			std::swap(*it, *(end - 1));
+			activeTris[vert]--;
+		}
+
+		// Move the triangle's vertices to the front of the cache
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		int      newCount = 0;
+		for (int ix = 0; ix < 3; ix++) {
+			if (std::find(newCache, newCache + newCount, tri[ix]) == newCache + newCount) {
+				newCache[newCount++] = tri[ix];
+			}
+		}
+		for (int ix = 0; ix < cacheCount; ix++) {
+			if (cache[ix] != tri[0] && cache[ix] != tri[1] && cache[ix] != tri[2]) {
+				newCache[newCount++] = cache[ix];
+			}
+		}
+
+		// Update the scores of everything that was in the cache, including anything that just fell out of it
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vert = newCache[ix];
+			cachePositions[vert] = ix < FORSYTH_CACHE_SIZE ? ix : -1;
+			vertexScores[vert] = scores.Score(cachePositions[vert], activeTris[vert]);
+		}
+
+		// Then re-score the triangles that those vertices touch, and pick our next triangle from them
+		bestTri = INVALID_INDEX;
+		bestScore = -1.0f;
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vert = newCache[ix];
+			for (uint32_t jx = 0; jx < activeTris[vert]; jx++) {
+				uint32_t t = vertexTris[offsets[vert] + jx];
+				triScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+				if (triScores[t] > bestScore) {
+					bestScore = triScores[t];
+					bestTri = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+	if (!_ValidateIndices(indices, indexCount, vertexCount)) {
+		// Leave everything where it is
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			remap[ix] = static_cast<uint32_t>(ix);
+		}
+		return remap;
+	}
+
+	// Give each vertex the next free slot the first time we see it
+	uint32_t next = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& target = remap[indices[ix]];
+		if (target == INVALID_INDEX) {
+			target = next++;
+		}
+		indices[ix] = target;
+	}
+
+	// Keep any vertices that aren't used, just move them out of the way
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		if (remap[ix] == INVALID_INDEX) {
+			remap[ix] = next++;
+		}
+	}
+
+	return remap;
+}
+
+float MeshOptimizer::CalculateACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	const size_t triCount = indexCount / 3;
+	if (triCount == 0 || !_ValidateIndices(indices, triCount * 3, vertexCount)) {
+		return 0.0f;
+	}
+
+	// Rather than keeping an actual queue, we track when each vertex was last put in the cache. A vertex
+	// is still in a FIFO cache if fewer than cacheSize vertices have been added since then
+	std::vector<size_t> timestamps(vertexCount, 0);
+	size_t time = cacheSize + 1;
+	size_t misses = 0;
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		uint32_t vert = indices[ix];
+		if (time - timestamps[vert] > cacheSize) {
+			timestamps[vert] = time++;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / static_cast<float>(triCount);
+}
+
+bool MeshOptimizer::_ValidateIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		if (indices[ix] >= vertexCount) {
+			LOG_WARN("Mesh has an index outside of it's vertices, skipping optimization");
+			return false;
+		}
+	}
+	return true;
+}
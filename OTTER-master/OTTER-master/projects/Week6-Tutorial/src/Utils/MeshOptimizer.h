@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <EnumToString.h>
+
+/// <summary>
+/// The optimizations that MeshBuilder can apply to a mesh when it is baked
+/// </summary>
+ENUM_FLAGS(MeshOptimizeFlags, uint32_t,
+	None         = 0,
+	// Re-orders triangles to make better use of the GPU's post-transform vertex cache
+	VertexCache  = 1 << 0,
+	// Re-orders vertices into the order that they are first used, so vertex fetches are more linear
+	VertexFetch  = 1 << 1,
+	// Uses 16 bit indices when the mesh has few enough vertices
+	ShortIndices = 1 << 2,
+	All          = VertexCache | VertexFetch | ShortIndices
+);
+
+/// <summary>
+/// Helpers for re-ordering indexed triangle lists so that they render faster. None of these
+/// touch OpenGL, and none of them change the set of triangles in the mesh
+/// </summary>
+class MeshOptimizer {
+public:
+	/// <summary>
+	/// Re-orders the triangles in an index buffer using Tom Forsyth's linear-speed vertex cache
+	/// optimization, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+	/// </summary>
+	/// <param name="indices">The triangle list to re-order in place</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Works out a new vertex order where vertices are sorted by the first time they are used, and
+	/// re-writes the indices to use it. Unused vertices are moved to the end
+	/// </summary>
+	/// <param name="indices">The triangle list to re-map in place</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <returns>The new index of each vertex, the caller is responsible for moving it's vertices</returns>
+	static std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Calculates the average cache miss ratio (the number of vertices transformed per triangle) of a
+	/// triangle list by simulating a FIFO vertex cache. Lower is better, 0.5 is the best case for a
+	/// regular grid and 3 is the worst case
+	/// </summary>
+	/// <param name="indices">The triangle list to measure</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="cacheSize">The number of entries in the simulated cache</param>
+	static float CalculateACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = DEFAULT_CACHE_SIZE);
+
+	// The cache size we measure against, roughly what most desktop GPUs behave like
+	static const size_t DEFAULT_CACHE_SIZE = 16;
+
+protected:
+	MeshOptimizer() = default;
+	~MeshOptimizer() = default;
+
+	/// <summary>
+	/// Returns true if every index is less than the vertex count
+	/// </summary>
+	static bool _ValidateIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount);
+};
\ No newline at end of file
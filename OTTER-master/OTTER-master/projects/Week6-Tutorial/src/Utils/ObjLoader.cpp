@@ -0,0 +1,205 @@
+#include "Utils/ObjLoader.h"
+
+#include <charconv>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Utils/MappedFile.h"
+#include "Logging.h"
+
+namespace {
+	// Helpers for walking through the file buffer, these never read past end
+
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipSpaces(const char* ptr, const char* end) {
+		while (ptr < end && IsSpace(*ptr)) {
+			ptr++;
+		}
+		return ptr;
+	}
+
+	inline const char* SkipLine(const char* ptr, const char* end) {
+		while (ptr < end && *ptr != '\n') {
+			ptr++;
+		}
+		return ptr < end ? ptr + 1 : end;
+	}
+
+	// Parses a float, skipping any whitespace before it. Leaves the value untouched if there is no number
+	inline const char* ParseFloat(const char* ptr, const char* end, float& value) {
+		ptr = SkipSpaces(ptr, end);
+		// from_chars does not accept a leading +, but some exporters write them
+		if (ptr < end && *ptr == '+') {
+			ptr++;
+		}
+		std::from_chars_result result = std::from_chars(ptr, end, value);
+		return result.ptr;
+	}
+
+	// Parses an integer at the current location, returns false if there is no number there
+	inline bool ParseInt(const char*& ptr, const char* end, int& value) {
+		std::from_chars_result result = std::from_chars(ptr, end, value);
+		if (result.ec != std::errc()) {
+			return false;
+		}
+		ptr = result.ptr;
+		return true;
+	}
+
+	// Converts a 1-based OBJ index (or a negative index relative to the end) to a 0-based index,
+	// returns -1 if the index is out of range
+	inline int ResolveIndex(int index, size_t count) {
+		int result = index < 0 ? static_cast<int>(count) + index : index - 1;
+		return (result >= 0 && static_cast<size_t>(result) < count) ? result : -1;
+	}
+
+	// Hashes the full position/UV/normal index tuple of a vertex, so that there is no limit on
+	// how many attributes a file can have before different vertices start to collide
+	struct VertexKeyHash {
+		inline size_t operator()(const glm::ivec3& key) const {
+			uint64_t hash = static_cast<uint32_t>(key.x);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.y);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.z);
+			// Finalizer from MurmurHash3, so that sequential indices spread across the buckets
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ull;
+			hash ^= hash >> 33;
+			return static_cast<size_t>(hash);
+		}
+	};
+}
+
+void ObjLoader::ParseFile(const std::string& filename, ObjMeshData& result) {
+	// Map the whole file so we can scan through it without any stream or string overhead
+	MappedFile file;
+	// If our file fails to open, we will throw an error
+	if (!file.Open(filename)) {
+		// Empty files can't be mapped, but they're still valid (if not very useful) OBJ files
+		std::error_code error;
+		if (std::filesystem::is_regular_file(filename, error) && std::filesystem::file_size(filename, error) == 0) {
+			return;
+		}
+		throw std::runtime_error("Failed to open file");
+	}
+
+	const char* ptr = reinterpret_cast<const char*>(file.GetData());
+	const char* end = ptr + file.GetSize();
+
+	// Maps the obj indices of a vertex to the index of a vertex that
+	// has been added to the mesh already
+	std::unordered_map<glm::ivec3, uint32_t, VertexKeyHash> vertexMap;
+
+	// Storage for the vertices of the face we're currently reading, reused between faces
+	std::vector<uint32_t> edges;
+	edges.reserve(8);
+
+	bool warnedInvalidFace = false;
+	glm::vec3 vecData;
+
+	// Read and process the entire file
+	while (ptr < end) {
+		ptr = SkipSpaces(ptr, end);
+		if (ptr >= end) {
+			break;
+		}
+
+		// Read in the first part of the line (ex: f, v, vn, etc...)
+		const char* command = ptr;
+		while (ptr < end && !IsSpace(*ptr) && *ptr != '\n') {
+			ptr++;
+		}
+		const size_t commandLength = ptr - command;
+
+		// The v command defines a vertex's position
+		if (commandLength == 1 && command[0] == 'v') {
+			vecData = glm::vec3(0.0f);
+			ptr = ParseFloat(ptr, end, vecData.x);
+			ptr = ParseFloat(ptr, end, vecData.y);
+			ptr = ParseFloat(ptr, end, vecData.z);
+			result.Positions.push_back(vecData);
+		}
+		else if (commandLength == 2 && command[0] == 'v' && command[1] == 'n') {
+			vecData = glm::vec3(0.0f);
+			ptr = ParseFloat(ptr, end, vecData.x);
+			ptr = ParseFloat(ptr, end, vecData.y);
+			ptr = ParseFloat(ptr, end, vecData.z);
+			result.Normals.push_back(vecData);
+		}
+		else if (commandLength == 2 && command[0] == 'v' && command[1] == 't') {
+			vecData = glm::vec3(0.0f);
+			ptr = ParseFloat(ptr, end, vecData.x);
+			ptr = ParseFloat(ptr, end, vecData.y);
+			result.UVs.push_back(glm::vec2(vecData));
+		}
+
+		// The f command defines a polygon in the mesh, with any number of sides
+		else if (commandLength == 1 && command[0] == 'f') {
+			edges.clear();
+			bool valid = true;
+
+			// Each corner is one of v, v/vt, v//vn or v/vt/vn
+			ptr = SkipSpaces(ptr, end);
+			while (ptr < end && *ptr != '\n') {
+				int position = 0, uv = 0, normal = 0;
+				if (!ParseInt(ptr, end, position)) {
+					valid = false;
+					break;
+				}
+				if (ptr < end && *ptr == '/') {
+					ptr++;
+					// The UV may be left empty when there's only a normal (v//vn)
+					ParseInt(ptr, end, uv);
+					if (ptr < end && *ptr == '/') {
+						ptr++;
+						ParseInt(ptr, end, normal);
+					}
+				}
+
+				// Resolve the indices against the attributes we've seen so far
+				glm::ivec3 vertexIndices;
+				vertexIndices.x = ResolveIndex(position, result.Positions.size());
+				vertexIndices.y = uv     != 0 ? ResolveIndex(uv,     result.UVs.size())     : -1;
+				vertexIndices.z = normal != 0 ? ResolveIndex(normal, result.Normals.size()) : -1;
+				if (vertexIndices.x < 0) {
+					valid = false;
+					break;
+				}
+
+				// Find the index associated with the combination of attributes, or add a new vertex
+				auto it = vertexMap.find(vertexIndices);
+				if (it != vertexMap.end()) {
+					edges.push_back(it->second);
+				} else {
+					uint32_t index = static_cast<uint32_t>(result.Vertices.size());
+					result.Vertices.push_back(vertexIndices);
+					vertexMap.emplace(vertexIndices, index);
+					edges.push_back(index);
+				}
+
+				ptr = SkipSpaces(ptr, end);
+			}
+
+			if (!valid || edges.size() < 3) {
+				if (!warnedInvalidFace) {
+					LOG_WARN("Skipping invalid faces in OBJ file \"{}\"", filename);
+					warnedInvalidFace = true;
+				}
+			} else {
+				// Triangulate as a fan around the first corner, this is correct for any convex polygon
+				for (size_t ix = 1; ix + 1 < edges.size(); ix++) {
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[ix]);
+					result.Indices.push_back(edges[ix + 1]);
+				}
+			}
+		}
+
+		// Anything else (comments, groups, materials) gets ignored
+		ptr = SkipLine(ptr, end);
+	}
+}
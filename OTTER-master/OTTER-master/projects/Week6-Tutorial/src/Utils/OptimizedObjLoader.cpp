@@ -9,6 +9,7 @@
 #include <filesystem>
 
 #include "Utils/StringUtils.h"
+#include "Utils/MappedFile.h"
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 
@@ -27,12 +28,16 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	if (extension == ".obj") {
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
-			ConvertToBinary(filename, binPath.string());
+		// If the binary file exists and is up to date with the OBJ file, we can use it as is
+		if (fs::exists(binPath)) {
+			VertexArrayObject::Sptr result = _LoadFromBinFile(binPath.string(), filename);
+			if (result != nullptr) {
+				return result;
+			}
 		}
-		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		// Otherwise convert the OBJ file to a binary file, and load that
+		ConvertToBinary(filename, binPath.string());
+		return _LoadFromBinFile(binPath.string(), filename);
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
@@ -62,8 +67,11 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 		outFileName = path.string();
 	}
 
+	// OBJ files keep their face order, so we optimize the mesh once here rather than every time it loads
+	mesh->Optimize();
+
 	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	SaveBinaryFile(*mesh, outFileName, inFile);
 
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
@@ -73,152 +81,33 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 }
 
 MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
-
-	// If our file fails to open, we will throw an error
-	if (!file) {
-		throw std::runtime_error("Failed to open file");
-	}
-
 	// Could also take this in as a parameter
 	glm::vec4 color = glm::vec4(1.0f);
 
-	// Our attributes
-	std::vector<glm::vec3>  positions;
-	std::vector<glm::vec3>  normals;
-	std::vector<glm::vec2>  uvs;
-	std::vector<glm::ivec3> vertices;
-	std::vector<uint32_t>   indices;
+	float startTime = static_cast<float>(glfwGetTime());
 
-	// Maps a key generated from obj indices to a vertex index that
-	// has been added to the mesh already
-	std::unordered_map<uint64_t, uint32_t> vertexMap;
+	// Read and process the entire file
+	ObjMeshData data;
+	ObjLoader::ParseFile(filename, data);
 
 	// We'll use the mesh builder since it supports easily adding
 	// vertices and indices
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
 
-	// Storage for temporary data
-	std::string line;
-	glm::vec3 vecData;
-	glm::ivec3 vertexIndices;
-
-	float startTime = static_cast<float>(glfwGetTime());
-
-	// Read and process the entire file
-	while (file.peek() != EOF) {
-		// Read in the first part of the line (ex: f, v, vn, etc...)
-		std::string command;
-		file >> command;
-
-		// We will ignore the rest of the line for comment lines
-		if (command == "#") {
-			std::getline(file, line);
-		}
-
-		// The v command defines a vertex's position
-		else if (command == "v") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			positions.push_back(vecData);
-		}
-		// TODO: handle normals and textures
-		else if (command == "vn") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			normals.push_back(vecData);
-		} else if (command == "vt") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y;
-			uvs.push_back(vecData);
-		}
-
-		// The f command defines a polygon in the mesh
-		// NOTE: make sure you triangulate in blender, otherwise it will
-		// output quads instead of triangles
-		else if (command == "f") {
-			// Read the rest of the line from the file
-			std::getline(file, line);
-			// Trim whitespace from either end of the line
-			StringTools::Trim(line);
-			// Create a string stream so we can use streaming operators on it
-			std::stringstream stream = std::stringstream(line);
-
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() + 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = uvs.size()       + 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size()   + 1 + vertexIndices.z; }
-
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = vertexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != vertexMap.end()) {
-						edges[ix] = it->second;
-					} else {
-						vertices.push_back(vertexIndices - glm::ivec3(1));
-						uint32_t index = static_cast<uint32_t>(vertices.size()) - 1;
-
-						// Cache the index based on our key
-						vertexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				}
-				// We've reached the end of the line, break out of the loop
-				else { break; }
-			}
-
-			// Handling for triangle faces
-			if (ix == 3) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-
-				indices.push_back(edges[0]);
-				indices.push_back(edges[2]);
-				indices.push_back(edges[3]);
-			}
-		}
-	}
-
-	mesh->ReserveVertexSpace(vertices.size());
-	for (const auto& vertexIndices : vertices) {
+	mesh->ReserveVertexSpace(data.Vertices.size());
+	for (const auto& vertexIndices : data.Vertices) {
 		// Construct a new vertex using the indices for the vertex
 		VertexPosNormTexColTangents vertex;
-		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Position = data.Positions[vertexIndices.x];
+		vertex.UV       = vertexIndices.y >= 0 ? data.UVs[vertexIndices.y] : glm::vec2(0.0f);
+		vertex.Normal   = vertexIndices.z >= 0 ? data.Normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
 		vertex.Color    = color;
 
 		// Add to the mesh, get index of the added vertex
 		mesh->AddVertex(vertex);
 	}
-	mesh->ReserveIndexSpace(indices.size());
-	for (uint32_t ix : indices) {
+	mesh->ReserveIndexSpace(data.Indices.size());
+	for (uint32_t ix : data.Indices) {
 		mesh->AddIndex(ix);
 	}
 
@@ -233,96 +122,317 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	return mesh;
 }
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
-
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, const std::string& sourceFile) {
+	// Map the file instead of reading it, so the data can go straight from the page cache to OpenGL
+	MappedFile file;
 	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
+	if (!file.Open(filename)) { throw std::runtime_error("Failed to open file"); }
 
 	float startTime = static_cast<float>(glfwGetTime());
 
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
-
-	// Read the header from the file
-	BinaryHeader header = BinaryHeader();
-	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
-	} else {
-		LOG_ERROR("Not enough data in the file!");
+	BinaryMeshView mesh;
+	if (!_ParseBinFile(file.GetData(), file.GetSize(), filename, sourceFile, mesh)) {
 		return nullptr;
 	}
 
-	// TODO: validate header
+	// These will have the buffer pointers
+	IndexBuffer::Sptr indices = nullptr;
+	VertexBuffer::Sptr vertices = nullptr;
+
+	// If we have index data, load it straight from the mapped file
+	if (mesh.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadImmutableData(mesh.IndexData, static_cast<uint32_t>(GetIndexTypeSize(mesh.IndicesType)), mesh.NumIndices, mesh.IndicesType);
+	}
+
+	// Create a new VBO, again loading directly from the mapped file
+	vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	vertices->LoadImmutableData(mesh.VertexData, mesh.VertexStride, mesh.NumVertices);
+
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, mesh.VertexDeclaration);
+
+	// Copy in the vertex declaration we loaded
+	result->SetVDecl(mesh.VertexDeclaration);
+
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh.NumVertices, mesh.NumIndices);
+
+	return result;
+}
+
+bool OptimizedObjLoader::_ParseBinFile(const uint8_t* data, size_t size, const std::string& filename, const std::string& sourceFile, BinaryMeshView& result) {
+	// Every version starts with the magic bytes followed by the version number
+	uint16_t version = 0;
+	if (size < sizeof(HEADER_BYTES) + sizeof(uint16_t) || memcmp(data, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		LOG_WARN("\"{}\" is not a binary mesh file", filename);
+		return false;
+	}
+	memcpy(&version, data + sizeof(HEADER_BYTES), sizeof(uint16_t));
+
+	// These will be filled in by the version specific loaders below
+	uint8_t        numAttributes = 0;
+	const uint8_t* attributeData = nullptr;
+
+	// Set if the file fails validation, so we can log why
+	const char* reason = nullptr;
 
 	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
-		size_t requiredBytes =
-			sizeof(BinaryHeader) +
-			(header.NumAttributes * sizeof(BufferAttribute)) +
-			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-
-		// Make sure there's enough data in the file
-		if (size < requiredBytes) {
-			LOG_ERROR("Not enough data in the file!");
-			return nullptr;
+	if (version == 0x01) {
+		// Version 1 files don't know what they were generated from, so if we have a source file we
+		// can't trust it, just regenerate the file
+		if (!sourceFile.empty()) {
+			LOG_INFO("Upgrading binary mesh \"{}\" to version 2", filename);
+			return false;
 		}
 
-		// Read all attributes from the file, this is basically our VDECL
-		std::vector<BufferAttribute> vertexDeclaration;
-		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
+		BinaryHeaderV1 header = BinaryHeaderV1();
+		if (size < sizeof(BinaryHeaderV1)) {
+			reason = "file is truncated";
+		} else {
+			memcpy(&header, data, sizeof(BinaryHeaderV1));
+
+			// Determine how many bytes we need in the file
+			size_t requiredBytes =
+				sizeof(BinaryHeaderV1) +
+				(header.NumAttributes * sizeof(BufferAttribute)) +
+				(header.VertexStride * (size_t)header.NumVertices) +
+				(header.NumIndices * GetIndexTypeSize(header.IndicesType));
+
+			if (header.NumIndices > 0 && GetIndexTypeSize(header.IndicesType) == 0) {
+				reason = "invalid index type";
+			} else if (size < requiredBytes) {
+				reason = "file is truncated";
+			} else {
+				result.NumIndices   = header.NumIndices;
+				result.IndicesType  = header.IndicesType;
+				result.NumVertices  = header.NumVertices;
+				result.VertexStride = header.VertexStride;
+				numAttributes       = header.NumAttributes;
+				attributeData       = data + sizeof(BinaryHeaderV1);
+				result.IndexData    = attributeData + numAttributes * sizeof(BufferAttribute);
+				result.VertexData   = result.IndexData + result.NumIndices * GetIndexTypeSize(result.IndicesType);
+			}
+		}
+	}
+	else if (version == 0x02) {
+		BinaryHeaderV2 header = BinaryHeaderV2();
+		if (size < sizeof(BinaryHeaderV2)) {
+			reason = "file is truncated";
+		} else {
+			memcpy(&header, data, sizeof(BinaryHeaderV2));
+
+			// Check the header checksum before we trust any of the offsets or counts in it
+			uint32_t headerCrc = header.HeaderCrc;
+			header.HeaderCrc = 0;
+			const size_t attributeBytes = header.NumAttributes * sizeof(BufferAttribute);
+			const size_t indexBytes     = header.NumIndices * GetIndexTypeSize(header.IndicesType);
+			const size_t vertexBytes    = header.VertexStride * (size_t)header.NumVertices;
+
+			if (header.HeaderSize != sizeof(BinaryHeaderV2) || headerCrc != _Crc32(&header, sizeof(BinaryHeaderV2))) {
+				reason = "header is corrupted";
+			} else if (header.NumIndices > 0 && GetIndexTypeSize(header.IndicesType) == 0) {
+				reason = "invalid index type";
+			} else if (header.IndicesOffset < sizeof(BinaryHeaderV2) + attributeBytes || header.IndicesOffset > size ||
+					   header.VerticesOffset < header.IndicesOffset + indexBytes || header.VerticesOffset > size ||
+					   header.IndicesOffset % SECTION_ALIGNMENT != 0 || header.VerticesOffset % SECTION_ALIGNMENT != 0) {
+				reason = "invalid section offsets";
+			} else if (size != header.VerticesOffset + vertexBytes) {
+				reason = "file is truncated";
+			} else if (!sourceFile.empty()) {
+				// Make sure the file was generated from the current version of the source file
+				uint64_t sourceSize = 0;
+				int64_t  sourceTime = 0;
+				_GetSourceStamp(sourceFile, sourceSize, sourceTime);
+				if (sourceSize != header.SourceSize || sourceTime != header.SourceTime) {
+					LOG_INFO("Binary mesh \"{}\" is out of date with \"{}\"", filename, sourceFile);
+					return false;
+				}
+			}
+
+			// We only pay for the payload checksum once everything else looks good
+			if (reason == nullptr && header.PayloadCrc != _Crc32(data + sizeof(BinaryHeaderV2), size - sizeof(BinaryHeaderV2))) {
+				reason = "checksum mismatch";
+			}
+
+			if (reason == nullptr) {
+				result.NumIndices   = header.NumIndices;
+				result.IndicesType  = header.IndicesType;
+				result.NumVertices  = header.NumVertices;
+				result.VertexStride = header.VertexStride;
+				numAttributes       = header.NumAttributes;
+				attributeData       = data + sizeof(BinaryHeaderV2);
+				result.IndexData    = data + header.IndicesOffset;
+				result.VertexData   = data + header.VerticesOffset;
+			}
 		}
+	}
+	else {
+		reason = "unknown version";
+	}
 
-		// These will have the buffer pointers
-		IndexBuffer::Sptr indices = nullptr;
-		VertexBuffer::Sptr vertices = nullptr;
-
-		// If we have index data, load it
-		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+	if (reason == nullptr && (result.NumVertices == 0 || result.VertexStride == 0)) {
+		reason = "mesh has no vertices";
+	}
+
+	// Read all attributes from the file, this is basically our VDECL
+	if (reason == nullptr) {
+		result.VertexDeclaration.resize(numAttributes);
+		for (int ix = 0; ix < numAttributes; ix++) {
+			memcpy(&result.VertexDeclaration[ix], attributeData + ix * sizeof(BufferAttribute), sizeof(BufferAttribute));
+			// An attribute that doesn't fit inside the vertex would have the GPU (or our collision
+			// loader) reading past the end of the buffer
+			const BufferAttribute& attrib = result.VertexDeclaration[ix];
+			size_t attribBytes = GetAttributeTypeSize(attrib.Type) * (size_t)attrib.Size;
+			if (attrib.Offset < 0 || attrib.Size < 1 || attrib.Size > 4 || attribBytes == 0 ||
+				(size_t)attrib.Offset + attribBytes > result.VertexStride ||
+				(attrib.Stride != 0 && attrib.Stride != result.VertexStride)) {
+				reason = "invalid vertex declaration";
+				break;
+			}
 		}
+	}
+
+	if (reason != nullptr) {
+		LOG_WARN("Failed to load binary mesh \"{}\" ({})", filename, reason);
+		return false;
+	}
+
+	return true;
+}
+
+bool OptimizedObjLoader::LoadCollisionData(const std::string& filename, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+	// Get the file extension and lowercase it
+	fs::path filePath = std::filesystem::path(filename);
+	std::string extension = filePath.extension().string();
+	StringTools::ToLower(extension);
+
+	// Work out which binary file we'll be reading from, the same way LoadFromFile does
+	std::string binFile   = filename;
+	std::string sourceFile = "";
+	if (extension == ".obj") {
+		binFile = filePath.replace_extension(binaryExtension).string();
+		sourceFile = filename;
+	}
+	else if (extension != ".bin") {
+		LOG_WARN("Cannot load collision data from \"{}\"", filename);
+		return false;
+	}
 
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	MappedFile file;
+	BinaryMeshView mesh;
+	bool loaded = fs::exists(binFile) && file.Open(binFile) && _ParseBinFile(file.GetData(), file.GetSize(), binFile, sourceFile, mesh);
 
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
+	// If the binary file is missing or stale we can regenerate it from the OBJ file
+	if (!loaded && !sourceFile.empty()) {
+		file.Close();
+		ConvertToBinary(sourceFile, binFile);
+		loaded = file.Open(binFile) && _ParseBinFile(file.GetData(), file.GetSize(), binFile, sourceFile, mesh);
+	}
+	if (!loaded) {
+		return false;
+	}
 
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+	// Find where the positions are in our vertices
+	auto it = std::find_if(mesh.VertexDeclaration.begin(), mesh.VertexDeclaration.end(), [](const BufferAttribute& attrib) {
+		return attrib.Usage == AttribUsage::Position;
+	});
+	if (it == mesh.VertexDeclaration.end() || it->Type != AttributeType::Float || it->Size < 3 || it->Offset + sizeof(glm::vec3) > mesh.VertexStride) {
+		LOG_WARN("Binary mesh \"{}\" does not have float3 positions", binFile);
+		return false;
+	}
 
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
+	// Pull the positions out of the interleaved vertex data
+	positions.resize(mesh.NumVertices);
+	for (uint32_t ix = 0; ix < mesh.NumVertices; ix++) {
+		memcpy(&positions[ix], mesh.VertexData + (size_t)ix * mesh.VertexStride + it->Offset, sizeof(glm::vec3));
+	}
+
+	// Widen the indices to 32 bits, and make sure they are all in range since the hull builder trusts them
+	indices.resize(mesh.NumIndices);
+	for (uint32_t ix = 0; ix < mesh.NumIndices; ix++) {
+		switch (mesh.IndicesType) {
+			case IndexType::UByte:
+				indices[ix] = mesh.IndexData[ix];
+				break;
+			case IndexType::UShort:
+			{
+				// Version 1 files don't align their sections, so we can't read the indices in place
+				uint16_t index = 0;
+				memcpy(&index, mesh.IndexData + ix * sizeof(uint16_t), sizeof(uint16_t));
+				indices[ix] = index;
+				break;
+			}
+			case IndexType::UInt:
+			default:
+				memcpy(&indices[ix], mesh.IndexData + ix * sizeof(uint32_t), sizeof(uint32_t));
+				break;
+		}
+		if (indices[ix] >= mesh.NumVertices) {
+			LOG_WARN("Binary mesh \"{}\" has out of range indices", binFile);
+			indices.clear();
+			positions.clear();
+			return false;
+		}
+	}
 
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
+	return true;
+}
 
-		// Calculate and trace out how long it took us to load
-		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+void OptimizedObjLoader::_GetSourceStamp(const std::string& filename, uint64_t& size, int64_t& time) {
+	std::error_code error;
+	size = static_cast<uint64_t>(fs::file_size(filename, error));
+	if (error) {
+		size = 0;
+	}
+	time = static_cast<int64_t>(fs::last_write_time(filename, error).time_since_epoch().count());
+	if (error) {
+		time = 0;
+	}
+}
 
+uint32_t OptimizedObjLoader::_Crc32(const void* data, size_t size, uint32_t crc) {
+	// Slicing-by-8 tables, these let us process 8 bytes per iteration instead of 1 which
+	// matters when we're checksumming tens of megabytes of vertex data on load
+	static const auto tables = []() {
+		std::vector<uint32_t> result(8 * 256);
+		for (uint32_t ix = 0; ix < 256; ix++) {
+			uint32_t value = ix;
+			for (int bit = 0; bit < 8; bit++) {
+				value = (value >> 1) ^ (0xEDB88320u & (0u - (value & 1u)));
+			}
+			result[ix] = value;
+		}
+		for (uint32_t ix = 0; ix < 256; ix++) {
+			for (int slice = 1; slice < 8; slice++) {
+				uint32_t prev = result[(slice - 1) * 256 + ix];
+				result[slice * 256 + ix] = (prev >> 8) ^ result[prev & 0xFF];
+			}
+		}
 		return result;
+	}();
+	const uint32_t* table = tables.data();
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	crc = ~crc;
+	while (size >= 8) {
+		uint32_t low, high;
+		memcpy(&low, bytes, sizeof(uint32_t));
+		memcpy(&high, bytes + 4, sizeof(uint32_t));
+		low ^= crc;
+		crc =
+			table[7 * 256 + (low & 0xFF)]  ^ table[6 * 256 + ((low >> 8) & 0xFF)] ^
+			table[5 * 256 + ((low >> 16) & 0xFF)] ^ table[4 * 256 + (low >> 24)] ^
+			table[3 * 256 + (high & 0xFF)] ^ table[2 * 256 + ((high >> 8) & 0xFF)] ^
+			table[1 * 256 + ((high >> 16) & 0xFF)] ^ table[0 * 256 + (high >> 24)];
+		bytes += 8;
+		size -= 8;
 	}
-
-	return nullptr;
+	while (size-- > 0) {
+		crc = (crc >> 8) ^ table[(crc ^ *bytes++) & 0xFF];
+	}
+	return ~crc;
 }
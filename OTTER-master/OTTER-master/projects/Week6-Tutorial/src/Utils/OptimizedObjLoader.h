@@ -7,6 +7,7 @@
  */
 #pragma once
 #include <fstream>
+#include <filesystem>
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
@@ -21,7 +22,8 @@ class OptimizedObjLoader {
 public:
 	/// <summary>
 	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
-	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
+	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead. If the
+	/// OBJ file has changed since the binary was created, or the binary is damaged, it will be re-generated
 	/// </summary>
 	/// <param name="filename">The path to the .obj or .bin file to load</param>
 	/// <returns>A VAO loaded from disk</returns>
@@ -32,19 +34,32 @@ public:
 	/// <param name="inFile">The path to OBJ file to convert</param>
 	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
 	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
+	/// <summary>
+	/// Loads just the positions and indices of a mesh into CPU memory, without touching OpenGL. Like LoadFromFile,
+	/// OBJ files are read through their binary file, which will be generated if it is missing or out of date
+	/// </summary>
+	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="positions">Will be filled with the position of each vertex</param>
+	/// <param name="indices">Will be filled with the mesh's indices, or left empty if the mesh is not indexed</param>
+	/// <returns>True if the data was loaded, false if otherwise</returns>
+	static bool LoadCollisionData(const std::string& filename, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices);
 
 	/// <summary>
 	/// Saves a mesh builder of the given type to a binary file
 	/// </summary>
-	/// <typeparam name="VertexType"></typeparam>
-	/// <param name="mesh"></param>
-	/// <param name="outFilename"></param>
+	/// <typeparam name="VertexType">The type of vertex stored in the mesh</typeparam>
+	/// <param name="mesh">The mesh to save</param>
+	/// <param name="outFilename">The path to write the binary file to</param>
+	/// <param name="sourceFile">The file the mesh was loaded from, used to detect when the binary file is out of date</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::string& sourceFile = "");
 
 protected:
-	// Will be put at the start of the binary file, contains info about the contents of the file
-	struct BinaryHeader {
+	// All sections in a version 2 file start on a multiple of this many bytes
+	static const size_t SECTION_ALIGNMENT = 64;
+
+	// The header used by version 1 files, we only read these now
+	struct BinaryHeaderV1 {
 		// A check value so we can ensure that we're loading in the right file type
 		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
 		// The version code, we can use this to create different loaders if our format changes
@@ -61,42 +76,156 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// Will be put at the start of the binary file, contains info about the contents of the file. The header
+	// is followed by the vertex declaration, then the index data and finally the vertex data, with each of the
+	// data sections starting on a SECTION_ALIGNMENT boundary
+	struct BinaryHeaderV2 {
+		// A check value so we can ensure that we're loading in the right file type
+		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
+		// The version code, we can use this to create different loaders if our format changes
+		uint16_t  Version = 0x02;
+		// The size of this header, so we can catch files written with a different layout
+		uint16_t  HeaderSize = sizeof(BinaryHeaderV2);
+		// The number of indices in the mesh
+		uint32_t  NumIndices = 0;
+		// The type of index to load
+		IndexType IndicesType = IndexType::Unknown;
+		// The number of vertices in the mesh
+		uint32_t  NumVertices = 0;
+		// The size of a single vertex structure
+		uint16_t  VertexStride = 0;
+		// The number of vertex attributes (basically how many VDECL entries there are)
+		uint8_t   NumAttributes = 0;
+		uint8_t   Reserved = 0;
+		// The size and modified time of the file this was generated from, used to detect stale files
+		uint64_t  SourceSize = 0;
+		int64_t   SourceTime = 0;
+		// Offsets to the index and vertex data from the start of the file
+		uint64_t  IndicesOffset = 0;
+		uint64_t  VerticesOffset = 0;
+		// CRC32 of everything after the header
+		uint32_t  PayloadCrc = 0;
+		// CRC32 of this header, calculated with this field set to zero
+		uint32_t  HeaderCrc = 0;
+	};
+	static_assert(sizeof(BinaryHeaderV2) == SECTION_ALIGNMENT, "Binary header must fill exactly one section");
+
+	// The contents of a binary file that has passed validation, the data pointers point into the file
+	struct BinaryMeshView {
+		uint32_t       NumIndices = 0;
+		IndexType      IndicesType = IndexType::Unknown;
+		uint32_t       NumVertices = 0;
+		uint16_t       VertexStride = 0;
+		std::vector<BufferAttribute> VertexDeclaration;
+		const uint8_t* IndexData = nullptr;
+		const uint8_t* VertexData = nullptr;
+	};
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	/// <summary>
+	/// Loads a binary mesh file
+	/// </summary>
+	/// <param name="filename">The path of the binary file to load</param>
+	/// <param name="sourceFile">If not empty, the file will be rejected if it was not generated from the current version of this file</param>
+	/// <returns>The loaded mesh, or nullptr if the file is invalid or out of date</returns>
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, const std::string& sourceFile = "");
+	/// <summary>
+	/// Validates the contents of a binary mesh file, shared by the GPU and collision loaders
+	/// </summary>
+	/// <param name="data">The contents of the file</param>
+	/// <param name="size">The size of the file in bytes</param>
+	/// <param name="filename">The path of the binary file, for logging</param>
+	/// <param name="sourceFile">If not empty, the file will be rejected if it was not generated from the current version of this file</param>
+	/// <param name="result">Will be filled in with the mesh layout and data if the file is valid</param>
+	/// <returns>True if the file is valid and up to date</returns>
+	static bool _ParseBinFile(const uint8_t* data, size_t size, const std::string& filename, const std::string& sourceFile, BinaryMeshView& result);
+
+	/// <summary>
+	/// Gets the size and modified time of a file, for detecting stale binary files
+	/// </summary>
+	static void _GetSourceStamp(const std::string& filename, uint64_t& size, int64_t& time);
+	/// <summary>
+	/// Updates a running CRC32 with the given data, pass the result back in to checksum data in pieces
+	/// </summary>
+	static uint32_t _Crc32(const void* data, size_t size, uint32_t crc = 0);
+	/// <summary>
+	/// Rounds the given offset up to the next section boundary
+	/// </summary>
+	static size_t _AlignSection(size_t offset) { return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1); }
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
-	}
-
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::string& sourceFile) {
 	// Create the fixed size header for our output file
-	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
-	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
-
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
+	BinaryHeaderV2 header = BinaryHeaderV2();
+	header.NumIndices     = mesh.GetIndexCount();
+	header.IndicesType    = IndexType::UInt;
+	header.NumVertices    = mesh.GetVertexCount();
+	header.VertexStride   = sizeof(VertexType);
+	header.NumAttributes  = static_cast<uint8_t>(VertexType::V_DECL.size());
+	if (!sourceFile.empty()) {
+		_GetSourceStamp(sourceFile, header.SourceSize, header.SourceTime);
 	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
+
+	// Lay out our sections so that the index and vertex data start on section boundaries
+	const size_t attributeBytes = header.NumAttributes * sizeof(BufferAttribute);
+	const size_t indexBytes     = header.NumIndices * sizeof(uint32_t);
+	const size_t vertexBytes    = header.NumVertices * sizeof(VertexType);
+	header.IndicesOffset  = _AlignSection(sizeof(BinaryHeaderV2) + attributeBytes);
+	header.VerticesOffset = _AlignSection(header.IndicesOffset + indexBytes);
+
+	// Write to a temp file and then move it into place, so a crash part way through never leaves a partial file behind
+	std::string tempFilename = outFilename + ".tmp";
+	{
+		std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open output file");
+		}
+
+		// Writes a block to the file, and adds it to our payload checksum
+		uint64_t offset = 0;
+		auto writeBlock = [&](const void* data, size_t size) {
+			file.write(reinterpret_cast<const char*>(data), size);
+			header.PayloadCrc = _Crc32(data, size, header.PayloadCrc);
+			offset += size;
+		};
+		// Pads the file out with zeros until we hit the given offset
+		auto padTo = [&](uint64_t target) {
+			static const char zeros[SECTION_ALIGNMENT] = { 0 };
+			writeBlock(zeros, static_cast<size_t>(target - offset));
+		};
+
+		// Leave space for the header, we'll fill it in once we know the checksum
+		file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeaderV2));
+		offset = sizeof(BinaryHeaderV2);
+
+		// Write which attributes we have, then any index data, then the vertex data
+		writeBlock(VertexType::V_DECL.data(), attributeBytes);
+		padTo(header.IndicesOffset);
+		if (header.NumIndices > 0) {
+			writeBlock(mesh.GetIndexDataPtr(), indexBytes);
+		}
+		padTo(header.VerticesOffset);
+		writeBlock(mesh.GetVertexDataPtr(), vertexBytes);
+
+		// Now that the payload checksum is known we can go back and fill in the header
+		header.HeaderCrc = 0;
+		header.HeaderCrc = _Crc32(&header, sizeof(BinaryHeaderV2));
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeaderV2));
+
+		if (!file) {
+			throw std::runtime_error("Failed to write output file");
+		}
 	}
 
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+	std::error_code error;
+	std::filesystem::rename(tempFilename, outFilename, error);
+	if (error) {
+		std::filesystem::remove(tempFilename, error);
+		throw std::runtime_error("Failed to move binary file into place");
+	}
 }
@@ -12,6 +12,11 @@
 /// Resources must additionally define a static method as such:
 /// static std::shared_ptr<Type> FromJson(const nlohmann::json&);
 /// where Type is the Type of resource
+/// 
+/// Resources that support streaming may also define:
+/// static std::shared_ptr<Type> FromJsonDeferred(const nlohmann::json&);
+/// which returns a placeholder resource, that is filled in by StreamDecode
+/// and StreamFinalize
 /// </summary>
 class IResource {
 public:
@@ -33,6 +38,29 @@ public:
 
 	virtual void ResolveReferences() {};
 
+	/// <summary>
+	/// Invoked on a worker thread when the resource is being streamed in, should perform
+	/// any file IO and CPU side decoding. This must NOT touch OpenGL!
+	/// </summary>
+	/// <returns>True if the resource was decoded, false if loading failed</returns>
+	virtual bool StreamDecode() { return true; }
+	/// <summary>
+	/// Invoked on the main thread after StreamDecode has succeeded, should create any
+	/// OpenGL objects from the decoded data and release the CPU side copy
+	/// </summary>
+	virtual void StreamFinalize() {}
+
+	/// <summary>
+	/// Gets an estimate of how much GPU memory this resource is using, in bytes. This is used
+	/// by the resource manager to decide when it needs to evict unused resources
+	/// </summary>
+	virtual size_t GetGpuMemoryUsage() const { return 0; }
+	/// <summary>
+	/// Gets the number of bytes that StreamFinalize will upload to the GPU, used to spread
+	/// large uploads over multiple frames. Only called after StreamDecode has succeeded
+	/// </summary>
+	virtual size_t GetStreamUploadSize() const { return 0; }
+
 	/// <summary>
 	/// Converts this resource into it's JSON manifest format
 	/// Should contain all the data required to reconstruct the
@@ -1,20 +1,60 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 
+#include <chrono>
+#include <algorithm>
+#include <queue>
+#include <unordered_set>
+#include <stb_image.h>
+#include <Logging.h>
+
 #include "Utils/ObjLoader.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
 
 std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
 std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::map<std::string, std::function<IResource::Sptr(const nlohmann::json&)>> ResourceManager::_streamLoaders;
+
+std::unordered_map<Guid, ResourceLoadRequest::Sptr> ResourceManager::_requests;
+
+std::vector<std::thread> ResourceManager::_workers;
+std::vector<ResourceLoadRequest::Sptr> ResourceManager::_decodeQueue;
+std::deque<ResourceLoadRequest::Sptr> ResourceManager::_finalizeQueue;
+std::mutex ResourceManager::_queueMutex;
+std::condition_variable ResourceManager::_workAvailable;
+std::condition_variable ResourceManager::_workDecoded;
+bool ResourceManager::_stopWorkers = false;
+
+uint64_t ResourceManager::_nextSequence = 0;
+float ResourceManager::_streamingBudget = 0.002f;
+size_t ResourceManager::_uploadBudget = 16 * 1024 * 1024;
+
+std::list<ResourceManager::UnusedResource> ResourceManager::_unusedResources;
+std::unordered_map<Guid, std::list<ResourceManager::UnusedResource>::iterator> ResourceManager::_unusedLookup;
+
+size_t ResourceManager::_memoryBudget = 0;
+size_t ResourceManager::_totalGpuMemory = 0;
+std::vector<ResourceMemoryStats> ResourceManager::_memoryStats;
+
+std::map<std::string, ResourceLoadTiming> ResourceManager::_loadTimings;
+bool ResourceManager::_preloadInProgress = false;
+std::chrono::high_resolution_clock::time_point ResourceManager::_preloadStart;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
+/// <summary>
+/// Orders the decode queue heap so that the highest priority, oldest request is at the front
+/// </summary>
+inline bool RequestHasLowerPriority(const ResourceLoadRequest::Sptr& a, const ResourceLoadRequest::Sptr& b) {
+	return a->Priority != b->Priority ? a->Priority < b->Priority : a->Sequence > b->Sequence;
+}
+
 void ResourceManager::Init() {
-	// TODO: initialize the resource manager once it's a bit more complex
-	//_manifest["textures"]  = std::vector<nlohmann::json>();
-	//_manifest["meshes"]    = std::vector<nlohmann::json>();
-	//_manifest["shaders"]   = std::vector<nlohmann::json>();
-	//_manifest["materials"] = std::vector<nlohmann::json>();
+	// The vertical flip setting is global in the version of stb_image that we use, so we set it once
+	// here rather than having the worker threads race to set it
+	stbi_set_flip_vertically_on_load(true);
+
+	_StartWorkers(0);
 }
 
 const nlohmann::ordered_json& ResourceManager::GetManifest() {
@@ -27,15 +67,120 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 	_manifest = blob;
 
 	if (preloadAssets) {
-		for (auto& [typeName, items] : blob.items()) {
-			auto& func = _typeLoaders[typeName];
-			if (func) {
-				for (auto& [guid, blob] : items.items()) {
-					func(blob);
+		_PreloadManifest(blob);
+	}
+}
+
+void ResourceManager::_PreloadManifest(const nlohmann::ordered_json& manifest) {
+	using Clock = std::chrono::high_resolution_clock;
+	_loadTimings.clear();
+	_preloadInProgress = true;
+	_preloadStart = Clock::now();
+
+	// Gather up every entry that we know how to load. Note that we point into our own copy of the manifest,
+	// since loading resources can add entries to _manifest
+	struct ManifestEntry {
+		std::string                  TypeName;
+		const nlohmann::ordered_json* Data;
+		bool                         Streamed;
+		// The entries that reference this one, and the number of entries this one references
+		std::vector<size_t>          Dependents;
+		size_t                       DependencyCount;
+	};
+	std::vector<ManifestEntry> entries;
+	std::unordered_map<std::string, size_t> lookup;
+	for (auto& [typeName, items] : manifest.items()) {
+		if (!_typeLoaders[typeName]) {
+			continue;
+		}
+		bool streamed = _streamLoaders.find(typeName) != _streamLoaders.end();
+		for (auto& [guid, data] : items.items()) {
+			lookup[guid] = entries.size();
+			entries.push_back(ManifestEntry{ typeName, &data, streamed, {}, 0 });
+		}
+	}
+
+	// Any string in an entry that matches the GUID of another entry is a dependency
+	for (size_t ix = 0; ix < entries.size(); ix++) {
+		std::unordered_set<size_t> dependencies;
+		std::function<void(const nlohmann::ordered_json&)> findReferences = [&](const nlohmann::ordered_json& value) {
+			if (value.is_string()) {
+				auto it = lookup.find(value.get_ref<const std::string&>());
+				if (it != lookup.end() && it->second != ix) {
+					dependencies.insert(it->second);
+				}
+			} else if (value.is_structured()) {
+				for (const auto& child : value) {
+					findReferences(child);
 				}
 			}
+		};
+		findReferences(*entries[ix].Data);
+
+		for (size_t dependency : dependencies) {
+			entries[dependency].Dependents.push_back(ix);
+			entries[ix].DependencyCount++;
+		}
+	}
+
+	// Sort the entries so that dependencies come first, otherwise keeping to the manifest's order
+	std::vector<size_t> order;
+	order.reserve(entries.size());
+	std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+	for (size_t ix = 0; ix < entries.size(); ix++) {
+		if (entries[ix].DependencyCount == 0) {
+			ready.push(ix);
+		}
+	}
+	while (!ready.empty()) {
+		size_t ix = ready.top();
+		ready.pop();
+		order.push_back(ix);
+		for (size_t dependent : entries[ix].Dependents) {
+			if (--entries[dependent].DependencyCount == 0) {
+				ready.push(dependent);
+			}
+		}
+	}
+	// Anything left over is part of a cycle, these will fall back to being loaded when they are first referenced
+	if (order.size() < entries.size()) {
+		LOG_WARN("Resource manifest has {} entries with circular references", entries.size() - order.size());
+		for (size_t ix = 0; ix < entries.size(); ix++) {
+			if (entries[ix].DependencyCount > 0) {
+				order.push_back(ix);
+			}
+		}
+	}
+
+	// Queue up all the streamed resources first so that the workers can start decoding them right away, anything
+	// else gets loaded on this thread in dependency order. Streamed resources are ready as placeholders as soon
+	// as they're queued, so they'll always be available for the resources that reference them
+	for (size_t ix : order) {
+		if (entries[ix].Streamed) {
+			_BeginLoad(entries[ix].TypeName, *entries[ix].Data, 0);
+		}
+	}
+	for (size_t ix : order) {
+		if (!entries[ix].Streamed) {
+			_BeginLoad(entries[ix].TypeName, *entries[ix].Data, 0);
 		}
 	}
+
+	// If nothing is streaming, we're already done
+	if (_requests.empty()) {
+		_LogLoadTimings();
+	}
+}
+
+void ResourceManager::_LogLoadTimings() {
+	using Clock = std::chrono::high_resolution_clock;
+	_preloadInProgress = false;
+
+	LOG_INFO("Preloaded resource manifest in {:.2f} ms", std::chrono::duration<float, std::milli>(Clock::now() - _preloadStart).count());
+	for (const auto& [typeName, timing] : _loadTimings) {
+		LOG_INFO("    {:<20} {:>5} loaded, decode: {:>8.2f} ms, GPU: {:>8.2f} ms, main thread load: {:>8.2f} ms",
+			typeName, timing.Count, timing.DecodeTime * 1000.0f, timing.FinalizeTime * 1000.0f, timing.LoadTime * 1000.0f);
+	}
 }
 
 void ResourceManager::SaveManifest(const std::string& path) {
@@ -53,8 +198,317 @@ void ResourceManager::SaveManifest(const std::string& path) {
 }
 
 void ResourceManager::Cleanup() {
+	// Make sure none of the workers are still using resources before we release them
+	_StopWorkers();
+	_decodeQueue.clear();
+	_finalizeQueue.clear();
+	_requests.clear();
+	_unusedResources.clear();
+	_unusedLookup.clear();
+
 	for (auto& [type, map] : _resources) {
 		map.clear();
 	}
 }
 
+void ResourceManager::WaitFor(const IResource::Sptr& resource) {
+	if (resource == nullptr || _requests.empty()) {
+		return;
+	}
+	auto it = _requests.find(resource->GetGUID());
+	if (it == _requests.end() || it->second->Resource != resource) {
+		return;
+	}
+	ResourceLoadRequest::Sptr request = it->second;
+
+	// If no worker has picked up the request yet, it's faster to just decode it ourselves
+	// than to wait for it to get to the front of the queue
+	if (!_DecodeRequest(request)) {
+		std::unique_lock<std::mutex> lock(_queueMutex);
+		_workDecoded.wait(lock, [&]() { return request->State != ResourceLoadState::Decoding; });
+	}
+	_FinalizeRequest(request);
+}
+
+bool ResourceManager::IsLoading(const IResource::Sptr& resource) {
+	if (resource == nullptr) {
+		return false;
+	}
+	auto it = _requests.find(resource->GetGUID());
+	return it != _requests.end() && it->second->Resource == resource;
+}
+
+void ResourceManager::WaitForAll() {
+	while (!_requests.empty()) {
+		WaitFor(_requests.begin()->second->Resource);
+	}
+}
+
+void ResourceManager::PollStreaming() {
+	using Clock = std::chrono::high_resolution_clock;
+	Clock::time_point start = Clock::now();
+	size_t uploaded = 0;
+
+	do {
+		ResourceLoadRequest::Sptr request;
+		{
+			std::lock_guard<std::mutex> lock(_queueMutex);
+			if (_finalizeQueue.empty()) {
+				break;
+			}
+			request = _finalizeQueue.front();
+
+			// Leave the request for next frame if it would take us over our upload budget
+			size_t bytes = request->State == ResourceLoadState::Decoded ? request->Resource->GetStreamUploadSize() : 0;
+			if (uploaded > 0 && uploaded + bytes > _uploadBudget) {
+				break;
+			}
+			uploaded += bytes;
+
+			_finalizeQueue.pop_front();
+		}
+		_FinalizeRequest(request);
+	} while (std::chrono::duration<float>(Clock::now() - start).count() < _streamingBudget);
+}
+
+void ResourceManager::EnforceMemoryBudget() {
+	_memoryStats.clear();
+	_totalGpuMemory = 0;
+
+	for (auto& [type, map] : _resources) {
+		ResourceMemoryStats stats;
+		stats.TypeName = StringTools::SanitizeClassName(type.name());
+
+		for (auto& [guid, res] : map) {
+			// Get will leave empty entries behind for resources that don't exist
+			if (res == nullptr) {
+				continue;
+			}
+
+			size_t bytes = res->GetGpuMemoryUsage();
+			stats.Count++;
+			stats.GpuBytes += bytes;
+
+			// If our map is the only thing holding the resource, nothing is using it. Resources
+			// that are still streaming are held by their request, so they'll never count as unused
+			bool unused = res.use_count() == 1;
+			auto it = _unusedLookup.find(guid);
+			if (unused) {
+				stats.UnusedCount++;
+				stats.UnusedGpuBytes += bytes;
+				if (it == _unusedLookup.end()) {
+					_unusedLookup[guid] = _unusedResources.insert(_unusedResources.end(), UnusedResource{ type, guid, bytes });
+				} else {
+					it->second->GpuBytes = bytes;
+				}
+			} else if (it != _unusedLookup.end()) {
+				_unusedResources.erase(it->second);
+				_unusedLookup.erase(it);
+			}
+		}
+
+		_totalGpuMemory += stats.GpuBytes;
+		_memoryStats.push_back(stats);
+	}
+
+	if (_memoryBudget == 0) {
+		return;
+	}
+
+	// Evict the resources that have been unused the longest until we're back under budget
+	auto it = _unusedResources.begin();
+	while (_totalGpuMemory > _memoryBudget && it != _unusedResources.end()) {
+		std::string typeName = StringTools::SanitizeClassName(it->Type.name());
+
+		// We can only evict resources that we know how to load again
+		if (!_typeLoaders[typeName]) {
+			it++;
+			continue;
+		}
+
+		auto& map = _resources[it->Type];
+		auto res = map.find(it->Id);
+		if (res != map.end() && res->second != nullptr) {
+			// Store the resource's current state in the manifest, so that it comes back the same way
+			std::string guid = it->Id.str();
+			_manifest[typeName][guid] = res->second->ToJson();
+			_manifest[typeName][guid]["guid"] = guid;
+
+			LOG_INFO("Evicting unused {} {} ({} KB)", typeName, guid, it->GpuBytes / 1024);
+			map.erase(res);
+		}
+
+		_totalGpuMemory -= std::min(_totalGpuMemory, it->GpuBytes);
+		_unusedLookup.erase(it->Id);
+		it = _unusedResources.erase(it);
+	}
+}
+
+void ResourceManager::SetWorkerCount(int count) {
+	_StopWorkers();
+	_StartWorkers(count);
+}
+
+ResourceLoadRequest::Sptr ResourceManager::_BeginLoad(const std::string& typeName, const nlohmann::json& data, int priority) {
+	// Manifests get preloaded on every scene load, so most of the time a lot of the resources are already
+	// around. Replacing an in-flight request would orphan it's placeholder (and anything it has claimed,
+	// like texture upload space), and re-loading a finished resource would just waste the work
+	Guid id = Guid(data["guid"].get<std::string>());
+	auto existing = _requests.find(id);
+	if (existing != _requests.end()) {
+		return existing->second;
+	}
+	if (_FindLoaded(id) != nullptr) {
+		return nullptr;
+	}
+
+	// If the type doesn't support streaming, we have to load it right now
+	auto loader = _streamLoaders.find(typeName);
+	if (loader == _streamLoaders.end()) {
+		using Clock = std::chrono::high_resolution_clock;
+		Clock::time_point start = Clock::now();
+		_typeLoaders[typeName](data);
+
+		ResourceLoadTiming& timing = _loadTimings[typeName];
+		timing.Count++;
+		timing.LoadTime += std::chrono::duration<float>(Clock::now() - start).count();
+		return nullptr;
+	}
+
+	// Create the placeholder, this will also store it in our resources
+	ResourceLoadRequest::Sptr request = std::make_shared<ResourceLoadRequest>();
+	request->Resource = loader->second(data);
+	request->Priority = priority;
+	request->Sequence = _nextSequence++;
+	request->TypeName = typeName;
+	_requests[request->Resource->GetGUID()] = request;
+
+	// Hand the request off to the workers
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_decodeQueue.push_back(request);
+		std::push_heap(_decodeQueue.begin(), _decodeQueue.end(), RequestHasLowerPriority);
+	}
+	_workAvailable.notify_one();
+
+	return request;
+}
+
+bool ResourceManager::_DecodeRequest(const ResourceLoadRequest::Sptr& request) {
+	// Claim the request, so that no other thread tries to decode it
+	ResourceLoadState expected = ResourceLoadState::Queued;
+	if (!request->State.compare_exchange_strong(expected, ResourceLoadState::Decoding)) {
+		return false;
+	}
+
+	// Our loaders report errors by throwing, we don't want that to take down a worker
+	using Clock = std::chrono::high_resolution_clock;
+	Clock::time_point start = Clock::now();
+	bool success = false;
+	try {
+		success = request->Resource->StreamDecode();
+	}
+	catch (const std::exception& e) {
+		request->Error = e.what();
+	}
+	request->DecodeTime = std::chrono::duration<float>(Clock::now() - start).count();
+
+	// Let the main thread know it has work to do
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		request->State = success ? ResourceLoadState::Decoded : ResourceLoadState::Failed;
+		_finalizeQueue.push_back(request);
+	}
+	_workDecoded.notify_all();
+
+	return true;
+}
+
+void ResourceManager::_FinalizeRequest(const ResourceLoadRequest::Sptr& request) {
+	// The request may have already been finished early via WaitFor
+	auto it = _requests.find(request->Resource->GetGUID());
+	if (it == _requests.end() || it->second != request) {
+		return;
+	}
+
+	ResourceLoadState state = request->State;
+	if (state == ResourceLoadState::Decoded) {
+		using Clock = std::chrono::high_resolution_clock;
+		Clock::time_point start = Clock::now();
+		request->Resource->StreamFinalize();
+		request->FinalizeTime = std::chrono::duration<float>(Clock::now() - start).count();
+		request->State = ResourceLoadState::Ready;
+	} else if (state == ResourceLoadState::Failed) {
+		LOG_WARN("Failed to stream in resource {} {}", request->Resource->GetGUID().str(), request->Error);
+	} else {
+		// This should only happen if we're called before the request was decoded
+		LOG_ASSERT(false, "Attempting to finalize a resource that has not been decoded!");
+		return;
+	}
+
+	ResourceLoadTiming& timing = _loadTimings[request->TypeName];
+	timing.Count++;
+	timing.DecodeTime += request->DecodeTime;
+	timing.FinalizeTime += request->FinalizeTime;
+
+	_requests.erase(it);
+
+	if (_preloadInProgress && _requests.empty()) {
+		_LogLoadTimings();
+	}
+}
+
+IResource::Sptr ResourceManager::_FindLoaded(Guid id) {
+	// GUIDs are unique across all types, and there are only a handful of types to check
+	for (auto& [type, map] : _resources) {
+		auto it = map.find(id);
+		if (it != map.end() && it->second != nullptr) {
+			return it->second;
+		}
+	}
+	return nullptr;
+}
+
+void ResourceManager::_WorkerThread() {
+	while (true) {
+		ResourceLoadRequest::Sptr request;
+		{
+			std::unique_lock<std::mutex> lock(_queueMutex);
+			_workAvailable.wait(lock, []() { return _stopWorkers || !_decodeQueue.empty(); });
+			if (_stopWorkers) {
+				return;
+			}
+			std::pop_heap(_decodeQueue.begin(), _decodeQueue.end(), RequestHasLowerPriority);
+			request = _decodeQueue.back();
+			_decodeQueue.pop_back();
+		}
+		_DecodeRequest(request);
+	}
+}
+
+void ResourceManager::_StartWorkers(int count) {
+	// By default we leave one core free for the main thread
+	if (count <= 0) {
+		count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+
+	_stopWorkers = false;
+	for (int ix = 0; ix < count; ix++) {
+		_workers.emplace_back(&ResourceManager::_WorkerThread);
+	}
+}
+
+void ResourceManager::_StopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_stopWorkers = true;
+	}
+	_workAvailable.notify_all();
+
+	// Any requests still in the decode queue stay there, so the next set of workers will pick them up
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+}
+
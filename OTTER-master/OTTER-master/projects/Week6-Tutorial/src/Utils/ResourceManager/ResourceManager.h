@@ -3,11 +3,82 @@
 #include <json.hpp>
 #include <unordered_map>
 #include <typeindex>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <list>
+#include <chrono>
+#include <EnumToString.h>
 
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/StringUtils.h"
 
+/// <summary>
+/// The stages that a streamed resource goes through while it's being loaded
+/// </summary>
+ENUM(ResourceLoadState, int,
+	Queued   = 0, // Waiting for a worker thread to pick it up
+	Decoding = 1, // A worker thread is reading and decoding the resource
+	Decoded  = 2, // Waiting for the main thread to create the GPU resources
+	Ready    = 3, // Fully loaded
+	Failed   = 4  // Decoding failed, the resource will stay as a placeholder
+);
+
+/// <summary>
+/// Tracks a single resource that is being streamed in by the resource manager
+/// </summary>
+struct ResourceLoadRequest {
+	typedef std::shared_ptr<ResourceLoadRequest> Sptr;
+
+	// The placeholder resource that will be filled in once loading completes
+	IResource::Sptr                Resource;
+	std::atomic<ResourceLoadState> State;
+	// Higher priority requests are decoded first
+	int                            Priority;
+	// Requests with the same priority are decoded in the order they were made
+	uint64_t                       Sequence;
+	// Set by the worker if decoding throws, so the main thread can report it
+	std::string                    Error;
+	// The name of the resource's type, and how long each stage took in seconds, used for load timing stats
+	std::string                    TypeName;
+	float                          DecodeTime;
+	float                          FinalizeTime;
+
+	ResourceLoadRequest() : Resource(nullptr), State(ResourceLoadState::Queued), Priority(0), Sequence(0), Error(""), TypeName(""), DecodeTime(0.0f), FinalizeTime(0.0f) {}
+};
+
+/// <summary>
+/// Memory usage for all loaded resources of a single type
+/// </summary>
+struct ResourceMemoryStats {
+	std::string TypeName;
+	// The number of loaded resources of this type
+	size_t      Count          = 0;
+	// The number of resources that are only referenced by the resource manager, and can be evicted
+	size_t      UnusedCount    = 0;
+	size_t      GpuBytes       = 0;
+	size_t      UnusedGpuBytes = 0;
+};
+
+/// <summary>
+/// How long it took to load all resources of a single type, in seconds
+/// </summary>
+struct ResourceLoadTiming {
+	size_t Count        = 0;
+	// Time spent in StreamDecode, this is reading files and decoding them on the worker threads
+	float  DecodeTime   = 0.0f;
+	// Time spent in StreamFinalize, creating the GPU objects on the main thread
+	float  FinalizeTime = 0.0f;
+	// Time spent loading types that don't support streaming, all on the main thread
+	float  LoadTime     = 0.0f;
+};
+
+template <typename T>
+class ResourceHandle;
+
 /// <summary>
 /// Utility class for managing and loading resources from JSON
 /// manifest files
@@ -46,7 +117,13 @@ public:
 	}
 
 	/// <summary>
-	/// Gets a shared pointer to the resource with the given type and GUID
+	/// Gets a shared pointer to the resource with the given type and GUID. If the resource is not
+	/// loaded it will be loaded immediately
+	///
+	/// NOTE: If the resource is still streaming in (ex: it was preloaded by LoadManifest), this returns
+	/// it's placeholder right away, which may not have any GPU objects yet. The placeholder is filled in
+	/// in place once the load is done, so it is safe to hold on to. Use GetAsync for a handle that can
+	/// be checked and waited on, or IsLoading and WaitFor if you already have the resource
 	/// </summary>
 	/// <typeparam name="T">The type of resource to retreive</typeparam>
 	/// <param name="id">The ID of the resource to retrieve</param>
@@ -75,6 +152,105 @@ public:
 		return result;
 	}
 
+	/// <summary>
+	/// Gets a handle to the resource with the given type and GUID, starting to stream it in on the worker
+	/// threads if it has not been loaded yet. Until the load is complete, the handle will point to a
+	/// placeholder resource. Types that do not support streaming will be loaded immediately
+	/// </summary>
+	/// <typeparam name="T">The type of resource to retreive</typeparam>
+	/// <param name="id">The ID of the resource to retrieve</param>
+	/// <param name="priority">The priority of the load, higher priority loads are decoded first</param>
+	/// <returns>A handle to the resource, which will be invalid if the resource does not exist</returns>
+	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	static ResourceHandle<T> GetAsync(Guid id, int priority = 0) {
+		std::type_index type = std::type_index(typeid(T));
+
+		// If the resource is already loaded (or is being loaded), hand back what we have, along with it's
+		// request if it's still streaming in
+		IResource::Sptr existing = _resources[type][id];
+		if (existing != nullptr) {
+			auto it = _requests.find(id);
+			bool streaming = it != _requests.end() && it->second->Resource == existing;
+			return ResourceHandle<T>(std::dynamic_pointer_cast<T>(existing), streaming ? it->second : nullptr);
+		}
+
+		// If the manifest has an entry, we can start loading it
+		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		if (_manifest[typeName].contains(id)) {
+			ResourceLoadRequest::Sptr request = _BeginLoad(typeName, _manifest[typeName][id], priority);
+			return ResourceHandle<T>(std::dynamic_pointer_cast<T>(_resources[type][id]), request);
+		}
+
+		return ResourceHandle<T>();
+	}
+
+	/// <summary>
+	/// If the given resource is still streaming in, finishes loading it on the calling thread. Must be called from the main thread
+	/// </summary>
+	/// <param name="resource">The resource to wait for</param>
+	static void WaitFor(const IResource::Sptr& resource);
+	/// <summary>
+	/// Blocks until all resources that are streaming in have finished loading. Must be called from the main thread
+	/// </summary>
+	static void WaitForAll();
+	/// <summary>
+	/// Finishes loading any resources that the worker threads have decoded, by creating their GPU objects. This
+	/// should be called once per frame from the main thread, and will stop once the streaming budget has been used
+	/// </summary>
+	static void PollStreaming();
+	/// <summary>
+	/// Returns true if the given resource is a placeholder that is still streaming in
+	/// </summary>
+	static bool IsLoading(const IResource::Sptr& resource);
+	/// <summary>
+	/// Gets the number of resources that are still streaming in
+	/// </summary>
+	static size_t GetPendingLoadCount() { return _requests.size(); }
+
+	/// <summary>
+	/// Sets the number of worker threads used for streaming, restarting the workers if needed
+	/// </summary>
+	/// <param name="count">The number of worker threads, or 0 to pick based on the number of CPU cores</param>
+	static void SetWorkerCount(int count);
+	/// <summary>
+	/// Gets the number of worker threads used for streaming
+	/// </summary>
+	static int GetWorkerCount() { return static_cast<int>(_workers.size()); }
+	/// <summary>
+	/// Sets the maximum time in seconds that PollStreaming should spend creating GPU resources per frame. At least
+	/// one resource will always be finished per call, so that large resources can't stall streaming
+	/// </summary>
+	static void SetStreamingBudget(float seconds) { _streamingBudget = seconds; }
+	static float GetStreamingBudget() { return _streamingBudget; }
+	/// <summary>
+	/// Sets the maximum number of bytes that PollStreaming should upload to the GPU per frame (see
+	/// IResource::GetStreamUploadSize). As with the time budget, at least one resource is always finished
+	/// </summary>
+	static void SetUploadBudget(size_t bytes) { _uploadBudget = bytes; }
+	static size_t GetUploadBudget() { return _uploadBudget; }
+
+	/// <summary>
+	/// Updates our memory statistics, and if the loaded resources are using more GPU memory than the
+	/// budget allows, evicts the resources that have been unused the longest. Evicted resources will
+	/// be re-loaded from the manifest the next time they are requested. Should be called once per frame
+	/// from the main thread
+	/// </summary>
+	static void EnforceMemoryBudget();
+	/// <summary>
+	/// Sets the amount of GPU memory that resources may use before unused resources are evicted
+	/// </summary>
+	/// <param name="bytes">The budget in bytes, or 0 to never evict resources</param>
+	static void SetMemoryBudget(size_t bytes) { _memoryBudget = bytes; }
+	static size_t GetMemoryBudget() { return _memoryBudget; }
+	/// <summary>
+	/// Gets the per-type memory statistics from the last call to EnforceMemoryBudget
+	/// </summary>
+	static const std::vector<ResourceMemoryStats>& GetMemoryStats() { return _memoryStats; }
+	/// <summary>
+	/// Gets the total estimated GPU memory used by all loaded resources, as of the last call to EnforceMemoryBudget
+	/// </summary>
+	static size_t GetTotalGpuMemory() { return _totalGpuMemory; }
+
 	/// <summary>
 	/// Registers a resource type with the resource manager, only types that have been registered
 	/// can be loaded from JSON manifest files!
@@ -94,6 +270,16 @@ public:
 			return res->GetGUID();
 		};
 
+		// If the type supports streaming, we also need a loader that creates it's placeholder
+		if constexpr (test_json_deferred<T, const nlohmann::json&>::value) {
+			_streamLoaders[typeName] = [](const nlohmann::json& data) {
+				IResource::Sptr res = T::FromJsonDeferred(data);
+				res->OverrideGUID(Guid(data["guid"]));
+				_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
+				return res;
+			};
+		}
+
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
 		if (!_manifest.contains(typeName)) {
@@ -131,23 +317,32 @@ public:
 	static const nlohmann::ordered_json& GetManifest();
 	/// <summary>
 	/// Loads a manifest file into the resource manager. Note that this will not perform load on the assets themselves 
-	/// unless preloadAssets is set to true
+	/// unless preloadAssets is set to true, in which case any types that support streaming will be loaded in the background
+	///
+	/// When preloading, resources are loaded in dependency order (based on the GUIDs that each manifest entry references),
+	/// so resources like materials never have to load their textures or shaders part way through their own load. Once
+	/// everything has finished, a breakdown of how long each type took to load is logged
 	/// </summary>
 	/// <param name="path">The path to the JSON manifest file</param>
 	/// <param name="preloadAssets">True if all assets should be loaded into memory</param>
 	static void LoadManifest(const std::string& path, bool preloadAssets = false);
 	/// <summary>
+	/// Gets how long each type took to load during the last preload, keyed by type name
+	/// </summary>
+	static const std::map<std::string, ResourceLoadTiming>& GetLoadTimings() { return _loadTimings; }
+	/// <summary>
 	/// Saves the manifest to the given JSON file
 	/// </summary>
 	/// <param name="path">The path to the file to output</param>
 	static void SaveManifest(const std::string& path);
 
 	/// <summary>
-	/// Releases all resources held by the resource manager
+	/// Releases all resources held by the resource manager, and stops the streaming worker threads
 	/// </summary>
 	static void Cleanup();
 
 protected:
+
 	/// <summary>
 	/// This is a map of maps
 	/// The top level map uses type_index, so there's a map per resource type
@@ -158,10 +353,133 @@ protected:
 	/// This map stores registered types, so we can load them from JSON files
 	/// </summary>
 	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
+	/// <summary>
+	/// Stores loaders that create placeholders for types that support streaming
+	/// </summary>
+	static std::map<std::string, std::function<IResource::Sptr(const nlohmann::json&)>> _streamLoaders;
+
+	// All the resources that are currently streaming in, only accessed from the main thread
+	static std::unordered_map<Guid, ResourceLoadRequest::Sptr> _requests;
+
+	// Worker threads, and the queues that they share with the main thread. Both queues are guarded by _queueMutex
+	static std::vector<std::thread> _workers;
+	static std::vector<ResourceLoadRequest::Sptr> _decodeQueue; // Kept as a heap sorted by priority
+	static std::deque<ResourceLoadRequest::Sptr> _finalizeQueue;
+	static std::mutex _queueMutex;
+	static std::condition_variable _workAvailable;
+	static std::condition_variable _workDecoded;
+	static bool _stopWorkers;
+
+	static uint64_t _nextSequence;
+	static float _streamingBudget;
+	static size_t _uploadBudget;
+
+	// An entry in our list of resources that only the resource manager is holding on to
+	struct UnusedResource {
+		std::type_index Type;
+		Guid            Id;
+		size_t          GpuBytes;
+	};
+	// Resources that nothing else is using, in the order that they became unused. We evict from the front
+	static std::list<UnusedResource> _unusedResources;
+	static std::unordered_map<Guid, std::list<UnusedResource>::iterator> _unusedLookup;
+
+	static size_t _memoryBudget;
+	static size_t _totalGpuMemory;
+	static std::vector<ResourceMemoryStats> _memoryStats;
+
+	// Load timings for each type since the last manifest preload was started, only accessed from the main thread
+	static std::map<std::string, ResourceLoadTiming> _loadTimings;
+	// Set while a manifest preload is in progress, so that we know to log the timings once it's done
+	static bool _preloadInProgress;
+	static std::chrono::high_resolution_clock::time_point _preloadStart;
+
+	/// <summary>
+	/// Starts loading a resource from it's manifest entry. Types that support streaming are queued for the
+	/// worker threads, any other types are loaded immediately. Resources that are already loaded are left
+	/// alone, and resources that are already streaming keep their existing request
+	/// </summary>
+	/// <returns>The load request, or nullptr if the resource was loaded immediately or was already loaded</returns>
+	static ResourceLoadRequest::Sptr _BeginLoad(const std::string& typeName, const nlohmann::json& data, int priority);
+	/// <summary>
+	/// Starts loading every resource in the manifest. Entries are sorted so that any resource that another entry
+	/// references by GUID is loaded first, and all streamable resources are queued before the others are loaded
+	/// so that the workers can decode them while the main thread is busy
+	/// </summary>
+	/// <param name="manifest">The manifest to load, must stay alive until this returns</param>
+	static void _PreloadManifest(const nlohmann::ordered_json& manifest);
+	/// <summary>
+	/// Logs the load timings for each type, and stops tracking the current preload
+	/// </summary>
+	static void _LogLoadTimings();
+	/// <summary>
+	/// Decodes a queued request on the calling thread
+	/// </summary>
+	/// <returns>True if the request was decoded, false if another thread had already claimed it</returns>
+	static bool _DecodeRequest(const ResourceLoadRequest::Sptr& request);
+	/// <summary>
+	/// Creates the GPU resources for a decoded request, must be called from the main thread
+	/// </summary>
+	static void _FinalizeRequest(const ResourceLoadRequest::Sptr& request);
+	/// <summary>
+	/// Searches every type's resources for a loaded resource with the given GUID
+	/// </summary>
+	static IResource::Sptr _FindLoaded(Guid id);
+	static void _WorkerThread();
+	static void _StartWorkers(int count);
+	static void _StopWorkers();
 
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// A handle to a resource that may still be streaming in. Until the load is complete,
+/// the handle points to a placeholder resource that will be filled in in place
+/// </summary>
+/// <typeparam name="T">The type of resource the handle refers to</typeparam>
+template <typename T>
+class ResourceHandle {
+public:
+	ResourceHandle() : _resource(nullptr), _request(nullptr) {}
+	ResourceHandle(const std::shared_ptr<T>& resource, const ResourceLoadRequest::Sptr& request) :
+		_resource(resource), _request(request) {}
+
+	/// <summary>
+	/// Gets the resource, note that this will be a placeholder if IsReady returns false
+	/// </summary>
+	const std::shared_ptr<T>& Get() const { return _resource; }
+	/// <summary>
+	/// Returns true if the handle refers to a resource
+	/// </summary>
+	bool IsValid() const { return _resource != nullptr; }
+	/// <summary>
+	/// Returns true if the resource has finished loading (or has failed to load)
+	/// </summary>
+	bool IsReady() const { return _request == nullptr || _request->State >= ResourceLoadState::Ready; }
+	/// <summary>
+	/// Returns true if the resource failed to load, and will remain a placeholder
+	/// </summary>
+	bool HasFailed() const { return _request != nullptr && _request->State == ResourceLoadState::Failed; }
+
+	/// <summary>
+	/// Blocks until the resource has finished loading, must be called from the main thread
+	/// </summary>
+	/// <returns>The fully loaded resource</returns>
+	const std::shared_ptr<T>& Wait() const {
+		if (!IsReady()) {
+			ResourceManager::WaitFor(_resource);
+		}
+		return _resource;
+	}
+
+	T* operator->() const { return _resource.get(); }
+	explicit operator bool() const { return IsValid(); }
+
+private:
+	std::shared_ptr<T>         _resource;
+	ResourceLoadRequest::Sptr  _request;
+};